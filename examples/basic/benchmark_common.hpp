@@ -0,0 +1,218 @@
+#ifndef BENCHMARK_COMMON_HPP
+#define BENCHMARK_COMMON_HPP
+
+#include <nexus.hpp>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/*
+ * Helpers shared by the headless benchmarks of the gfx module.
+ *
+ * The benchmarks take `[scenario] [count]`, every scenario being run when none is given,
+ * and 'verify' runs their checks instead, the process then returning 1 if any of them failed.
+ */
+
+/* Arguments */
+
+struct BenchmarkArgs
+{
+    std::string scenario;   ///< Scenario to run, every scenario if empty, or "verify"
+    int count;              ///< Number of runs of each scenario
+
+    bool IsVerify() const
+    {
+        return scenario == "verify";
+    }
+
+    bool Selects(const char* name) const
+    {
+        return scenario.empty() || scenario == name;
+    }
+};
+
+inline BenchmarkArgs ParseBenchmarkArgs(int argc, char** argv, int defaultCount)
+{
+    return {
+        argc > 1 ? argv[1] : "",
+        argc > 2 ? std::max(1, std::atoi(argv[2])) : defaultCount
+    };
+}
+
+/* Timing */
+
+/**
+ * @brief Calls `func` `count` times and returns the average time of a call, in milliseconds.
+ */
+template <typename F>
+double TimePerCall(F&& func, int count)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < count; i++)
+    {
+        func();
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - start).count() / count;
+}
+
+/* Random data */
+
+struct Lcg
+{
+    // Deterministic generator, so that all the runs draw exactly the same thing
+    Uint32 state = 12345;
+
+    Uint32 Next()
+    {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    int Next(int min, int max)
+    {
+        return min + static_cast<int>(Next() % static_cast<Uint32>(max - min + 1));
+    }
+
+    float NextFloat()
+    {
+        return Next() / 16777216.0f;
+    }
+};
+
+/**
+ * @brief Creates an RGBA32 surface of random pixels, which only depend on the seed and their position.
+ */
+inline nexus::gfx::Surface NewRandomImage(int w, int h, Uint64 seed, bool opaque = true)
+{
+    nexus::gfx::Surface surface(w, h, nexus::gfx::Blank, nexus::gfx::PixelFormat::RGBA32);
+    const nexus::core::CounterRandomGenerator gen(seed);
+
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            const Uint64 bits = gen.Get(x, y);
+            surface.SetPixelUnsafe<nexus::gfx::PixelFormat::RGBA32>(x, y, nexus::gfx::Color(
+                static_cast<Uint8>(bits), static_cast<Uint8>(bits >> 8), static_cast<Uint8>(bits >> 16),
+                opaque ? 255 : static_cast<Uint8>(bits >> 24)));
+        }
+    }
+
+    return surface;
+}
+
+/* Encoding */
+
+inline void Append16(std::vector<Uint8>& data, Uint32 value)
+{
+    data.push_back(static_cast<Uint8>(value));
+    data.push_back(static_cast<Uint8>(value >> 8));
+}
+
+inline void Append32(std::vector<Uint8>& data, Uint32 value)
+{
+    Append16(data, value);
+    Append16(data, value >> 16);
+}
+
+/**
+ * @brief Encodes a 24-bit bottom-up BMP, the simplest format every image decoder reads.
+ */
+inline std::vector<Uint8> EncodeBMP(const nexus::gfx::Surface& image)
+{
+    const int w = image.GetWidth(), h = image.GetHeight();
+    const Uint32 pitch = (3 * w + 3) & ~3;
+
+    std::vector<Uint8> data = { 'B', 'M' };
+    Append32(data, 54 + pitch * h);
+    Append32(data, 0);
+    Append32(data, 54);
+    Append32(data, 40);
+    Append32(data, w);
+    Append32(data, h);
+    Append16(data, 1);
+    Append16(data, 24);
+    Append32(data, 0);
+    Append32(data, pitch * h);
+    Append32(data, 2835);
+    Append32(data, 2835);
+    Append32(data, 0);
+    Append32(data, 0);
+
+    for (int y = h - 1; y >= 0; y--)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            const nexus::gfx::Color c = image.GetPixelUnsafe(x, y);
+            data.insert(data.end(), { c.b, c.g, c.r });
+        }
+
+        data.resize(data.size() + pitch - 3 * w, 0);
+    }
+
+    return data;
+}
+
+/* Verification */
+
+/**
+ * @brief Largest difference between the channels of two surfaces over the given area.
+ */
+inline int MaxError(const nexus::gfx::Surface& a, const nexus::gfx::Surface& b, int x0, int y0, int w, int h)
+{
+    int error = 0;
+
+    for (int y = y0; y < y0 + h; y++)
+    {
+        for (int x = x0; x < x0 + w; x++)
+        {
+            const nexus::gfx::Color ca = a.GetPixelUnsafe(x, y), cb = b.GetPixelUnsafe(x, y);
+            error = std::max({ error, std::abs(ca.r - cb.r), std::abs(ca.g - cb.g), std::abs(ca.b - cb.b), std::abs(ca.a - cb.a) });
+        }
+    }
+
+    return error;
+}
+
+inline int MaxError(const nexus::gfx::Surface& a, const nexus::gfx::Surface& b)
+{
+    return MaxError(a, b, 0, 0, a.GetWidth(), a.GetHeight());
+}
+
+/**
+ * @brief Prints the result of each check of a 'verify' run and counts the failures.
+ */
+class Checks
+{
+  public:
+    void Check(const std::string& name, bool ok, const std::string& details = "")
+    {
+        std::cout << name << ": " << (ok ? "OK" : "FAILED");
+        if (!details.empty()) std::cout << " (" << details << ")";
+        std::cout << "\n";
+
+        failures += !ok;
+    }
+
+    void CheckError(const std::string& name, int error, int tolerance)
+    {
+        Check(name, error <= tolerance, "max error " + std::to_string(error));
+    }
+
+    int GetExitCode() const
+    {
+        return failures == 0 ? 0 : 1;
+    }
+
+  private:
+    int failures = 0;
+};
+
+#endif //BENCHMARK_COMMON_HPP
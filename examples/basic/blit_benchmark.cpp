@@ -0,0 +1,356 @@
+#include "benchmark_common.hpp"
+#include <iomanip>
+
+using namespace nexus;
+
+/*
+ * Headless benchmark of the surface blitters.
+ *
+ * Usage: blit_benchmark [scenario] [frames]
+ *        blit_benchmark verify
+ *
+ * Each scenario draws sprites or images onto an 800x600 RGBA32 surface and reports the average
+ * time per frame with `gfx::Surface::DrawImage` / `DrawImageScaled`, then with the SDL blit the
+ * surface used before (`SDL_BlitSurface`, or `SDL_BlitScaled` which scales with the nearest pixel).
+ * Without arguments every scenario is run with the default frame count.
+ *
+ * 'verify' checks that the SIMD blit kernels give exactly the same pixels as the scalar ones,
+ * and that the sprites drawn with straight or premultiplied alpha and the images scaled with
+ * bilinear filtering match a floating-point reference, including when they are clipped.
+ */
+
+constexpr int ScreenWidth = 800;
+constexpr int ScreenHeight = 600;
+
+gfx::Surface GenSprite(bool premultiplied)
+{
+    // 64x64 disc with a soft edge and transparent corners, like most sprites
+
+    gfx::Surface sprite(64, 64, gfx::Blank);
+
+    for (int y = 0; y < 64; y++)
+    {
+        for (int x = 0; x < 64; x++)
+        {
+            const float d = std::sqrt((x - 31.5f) * (x - 31.5f) + (y - 31.5f) * (y - 31.5f));
+            const Uint8 a = static_cast<Uint8>(std::clamp((30.0f - d) * 64.0f, 0.0f, 255.0f));
+            gfx::Color c(Uint8(x * 4), Uint8(y * 4), Uint8(255 - x * 2), a);
+
+            if (premultiplied)
+            {
+                c.r = Uint8((c.r * a + 127) / 255), c.g = Uint8((c.g * a + 127) / 255), c.b = Uint8((c.b * a + 127) / 255);
+            }
+
+            sprite.SetPixelUnsafe(x, y, c);
+        }
+    }
+
+    sprite.SetAlphaPremultiplied(premultiplied);
+
+    return sprite;
+}
+
+gfx::Surface GenBackground(int w, int h)
+{
+    // Opaque gradient with a checkerboard, whose sharp edges show the scaling filter
+
+    gfx::Surface image(w, h, gfx::Blank);
+
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            const bool odd = ((x >> 3) ^ (y >> 3)) & 1;
+            image.SetPixelUnsafe(x, y, gfx::Color(Uint8(x * 255 / w), Uint8(y * 255 / h), odd ? 200 : 40, 255));
+        }
+    }
+
+    image.SetBlendMode(gfx::BlendMode::None);
+
+    return image;
+}
+
+struct Scenario
+{
+    const char *name;
+    const char *description;
+    std::function<void(gfx::Surface&, bool)> draw;     ///< Draws a frame, with SDL if the flag is set
+};
+
+void DrawSprites(gfx::Surface& target, const gfx::Surface& sprite, float scale, bool sdl)
+{
+    // 500 sprites at fixed random positions, some of them partially outside the target
+
+    Lcg rng;
+
+    for (int i = 0; i < 500; i++)
+    {
+        const int x = rng.Next(-32, ScreenWidth - 32), y = rng.Next(-32, ScreenHeight - 32);
+
+        if (!sdl)
+        {
+            if (scale == 1.0f) target.DrawImage(sprite, x, y);
+            else target.DrawImageScaled(sprite, x, y, scale, scale);
+            continue;
+        }
+
+        SDL_Rect dst = { x, y, int(std::round(sprite.GetWidth() * scale)), int(std::round(sprite.GetHeight() * scale)) };
+
+        if (scale == 1.0f) SDL_BlitSurface(sprite, nullptr, target, &dst);
+        else SDL_BlitScaled(sprite, nullptr, target, &dst);
+    }
+}
+
+const gfx::Surface& GetSprite(bool premultiplied, bool bilinear)
+{
+    static gfx::Surface straight = GenSprite(false);
+    static gfx::Surface premul = GenSprite(true);
+
+    gfx::Surface &sprite = premultiplied ? premul : straight;
+    sprite.SetBilinearScaling(bilinear);
+
+    return sprite;
+}
+
+const gfx::Surface& GetBackground(bool bilinear)
+{
+    static gfx::Surface background = GenBackground(320, 240);
+    background.SetBilinearScaling(bilinear);
+    return background;
+}
+
+const Scenario scenarios[] = {
+
+    { "sprites_straight", "500 sprites of 64x64 with straight alpha",
+        [](gfx::Surface& target, bool sdl)
+        {
+            target.Fill(gfx::Black);
+            DrawSprites(target, GetSprite(false, false), 1.0f, sdl);
+        }
+    },
+
+    { "sprites_premultiplied", "Same as 'sprites_straight' with premultiplied alpha (straight alpha with SDL)",
+        [](gfx::Surface& target, bool sdl)
+        {
+            target.Fill(gfx::Black);
+            DrawSprites(target, GetSprite(!sdl, false), 1.0f, sdl);
+        }
+    },
+
+    { "sprites_scaled", "500 sprites scaled by 1.5 with bilinear filtering (nearest pixel with SDL)",
+        [](gfx::Surface& target, bool sdl)
+        {
+            target.Fill(gfx::Black);
+            DrawSprites(target, GetSprite(false, true), 1.5f, sdl);
+        }
+    },
+
+    { "background_scaled", "Opaque 320x240 image scaled to the whole target with bilinear filtering (nearest pixel with SDL)",
+        [](gfx::Surface& target, bool sdl)
+        {
+            const gfx::Surface &background = GetBackground(true);
+            if (!sdl) target.DrawImage(background, background.GetRectSize(), target.GetRectSize());
+            else SDL_BlitScaled(background, nullptr, target, nullptr);
+        }
+    },
+};
+
+double RunScenario(const Scenario& scenario, int frames, bool sdl)
+{
+    gfx::Surface target(ScreenWidth, ScreenHeight, gfx::Black);
+
+    scenario.draw(target, sdl);     // Warm-up
+
+    return TimePerCall([&] { scenario.draw(target, sdl); }, frames);
+}
+
+int CountKernelMismatches()
+{
+    // Random rows of every length up to a few SIMD widths, with runs of transparent and opaque pixels
+
+    const _gfx_impl::BlitKernels &reference = _gfx_impl::GetBlitKernels(false);
+    const _gfx_impl::BlitKernels &kernels = _gfx_impl::GetBlitKernels(true);
+
+    Lcg rng;
+    int mismatches = 0;
+
+    auto random = [&rng](std::vector<gfx::Color>& colors)
+    {
+        for (auto& c : colors)
+        {
+            const Uint32 v = rng.Next();
+            c = gfx::Color(Uint8(v), Uint8(v >> 8), Uint8(v >> 16), Uint8(rng.Next()));
+            if ((v & 3) == 0) c.a = 0;
+            if ((v & 3) == 1) c.a = 255;
+        }
+    };
+
+    auto differ = [](const std::vector<gfx::Color>& a, const std::vector<gfx::Color>& b)
+    {
+        return std::memcmp(a.data(), b.data(), a.size() * sizeof(gfx::Color)) != 0;
+    };
+
+    for (int n = 1; n <= 40; n++)
+    {
+        for (int iter = 0; iter < 200; iter++)
+        {
+            std::vector<gfx::Color> src(n), dst(n), expected, result;
+            random(src), random(dst);
+
+            expected = dst, result = dst;
+            reference.BlendRow(expected.data(), src.data(), n);
+            kernels.BlendRow(result.data(), src.data(), n);
+            mismatches += differ(expected, result);
+
+            expected = dst, result = dst;
+            reference.BlendRowPremultiplied(expected.data(), src.data(), n);
+            kernels.BlendRowPremultiplied(result.data(), src.data(), n);
+            mismatches += differ(expected, result);
+
+            // Samples spread over the whole row, at the start, the end, or a random position
+            const int width = 2 + iter % 30;
+            const Sint32 maxU = (width - 1) << 16;
+            const Sint32 du = n > 1 ? static_cast<Sint32>(rng.Next() % (maxU / (n - 1) + 1)) : 0;
+            const Sint32 u = static_cast<Sint32>(rng.Next() % (maxU - du * (n - 1) + 1));
+            const int fy = rng.Next(0, 256);
+
+            std::vector<gfx::Color> row0(width), row1(width);
+            random(row0), random(row1);
+
+            for (const bool premultiply : { false, true })
+            {
+                expected.assign(n, gfx::Blank), result.assign(n, gfx::Blank);
+                reference.ScaleRowBilinear(expected.data(), row0.data(), row1.data(), width, u, du, fy, n, premultiply);
+                kernels.ScaleRowBilinear(result.data(), row0.data(), row1.data(), width, u, du, fy, n, premultiply);
+                mismatches += differ(expected, result);
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+int CheckSprites(bool premultiplied)
+{
+    // Sprites over a translucent gradient, blended in floating-point as a reference
+
+    gfx::Surface target(ScreenWidth, ScreenHeight, gfx::Blank);
+    gfx::Surface reference(ScreenWidth, ScreenHeight, gfx::Blank);
+
+    for (int y = 0; y < ScreenHeight; y++)
+    {
+        for (int x = 0; x < ScreenWidth; x++)
+        {
+            const gfx::Color color(Uint8(x), Uint8(y), 128, Uint8(x + y));
+            target.SetPixelUnsafe(x, y, color);
+            reference.SetPixelUnsafe(x, y, color);
+        }
+    }
+    const gfx::Surface &sprite = GetSprite(premultiplied, false);
+
+    Lcg rng;
+
+    for (int i = 0; i < 50; i++)
+    {
+        const int px = rng.Next(-32, ScreenWidth - 32), py = rng.Next(-32, ScreenHeight - 32);
+
+        target.DrawImage(sprite, px, py);
+
+        for (int y = std::max(0, py); y < std::min(ScreenHeight, py + 64); y++)
+        {
+            for (int x = std::max(0, px); x < std::min(ScreenWidth, px + 64); x++)
+            {
+                const gfx::Color s = sprite.GetPixelUnsafe(x - px, y - py), d = reference.GetPixelUnsafe(x, y);
+                const float a = s.a / 255.0f, sw = premultiplied ? 1.0f : a;
+
+                reference.SetPixelUnsafe(x, y, gfx::Color(
+                    Uint8(std::lround(s.r * sw + d.r * (1 - a))), Uint8(std::lround(s.g * sw + d.g * (1 - a))),
+                    Uint8(std::lround(s.b * sw + d.b * (1 - a))), Uint8(std::lround(s.a + d.a * (1 - a)))));
+            }
+        }
+    }
+
+    return MaxError(target, reference);
+}
+
+int CheckBilinear()
+{
+    // Background scaled by 2.5 and moved partially outside the target, filtered in floating-point as a reference
+
+    const gfx::Surface &image = GetBackground(true);
+    const int w = image.GetWidth() * 5 / 2, h = image.GetHeight() * 5 / 2;
+    const int px = -100, py = 50;
+
+    gfx::Surface target(ScreenWidth, ScreenHeight, gfx::Black);
+    gfx::Surface reference(ScreenWidth, ScreenHeight, gfx::Black);
+
+    target.DrawImageScaled(image, px, py, 2.5f, 2.5f);
+
+    auto texel = [&image](int x, int y)
+    {
+        return image.GetPixelUnsafe(std::clamp(x, 0, image.GetWidth() - 1), std::clamp(y, 0, image.GetHeight() - 1));
+    };
+
+    for (int y = std::max(0, py); y < std::min(ScreenHeight, py + h); y++)
+    {
+        for (int x = std::max(0, px); x < std::min(ScreenWidth, px + w); x++)
+        {
+            const float u = std::clamp((x - px + 0.5f) / 2.5f - 0.5f, 0.0f, image.GetWidth() - 1.0f);
+            const float v = std::clamp((y - py + 0.5f) / 2.5f - 0.5f, 0.0f, image.GetHeight() - 1.0f);
+            const int x0 = int(u), y0 = int(v);
+            const float fx = u - x0, fy = v - y0;
+
+            const gfx::Color c00 = texel(x0, y0), c01 = texel(x0 + 1, y0), c10 = texel(x0, y0 + 1), c11 = texel(x0 + 1, y0 + 1);
+
+            auto filter = [fx, fy](float v00, float v01, float v10, float v11)
+            {
+                return Uint8(std::lround((v00 * (1 - fx) + v01 * fx) * (1 - fy) + (v10 * (1 - fx) + v11 * fx) * fy));
+            };
+
+            reference.SetPixelUnsafe(x, y, gfx::Color(filter(c00.r, c01.r, c10.r, c11.r), filter(c00.g, c01.g, c10.g, c11.g),
+                                                      filter(c00.b, c01.b, c10.b, c11.b), filter(c00.a, c01.a, c10.a, c11.a)));
+        }
+    }
+
+    return MaxError(target, reference);
+}
+
+int Verify()
+{
+    Checks checks;
+
+    const int mismatches = CountKernelMismatches();
+    checks.Check("kernels", mismatches == 0, mismatches ? std::to_string(mismatches) + " rows differ" : "");
+
+    // The integer arithmetic rounds like the reference, the premultiplied sprite being rounded once more
+    checks.CheckError("straight alpha", CheckSprites(false), 1);
+    checks.CheckError("premultiplied alpha", CheckSprites(true), 1);
+
+    // The weights are rounded to 1/256, and both interpolations to 8 bits
+    checks.CheckError("bilinear scaling", CheckBilinear(), 2);
+
+    return checks.GetExitCode();
+}
+
+int main(int argc, char** argv)
+{
+    const BenchmarkArgs args = ParseBenchmarkArgs(argc, argv, 100);
+
+    if (args.IsVerify())
+    {
+        return Verify();
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+
+    for (const auto& scenario : scenarios)
+    {
+        if (!args.Selects(scenario.name)) continue;
+
+        std::cout << scenario.name << " - " << scenario.description << "\n";
+        std::cout << "    " << std::setw(10) << std::left << "nexus" << RunScenario(scenario, args.count, false) << " ms/frame\n";
+        std::cout << "    " << std::setw(10) << std::left << "sdl" << RunScenario(scenario, args.count, true) << " ms/frame\n";
+    }
+
+    return 0;
+}
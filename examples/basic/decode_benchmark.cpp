@@ -0,0 +1,156 @@
+#include "benchmark_common.hpp"
+#include <iomanip>
+
+using namespace nexus;
+
+/*
+ * Headless benchmark of `gfx::Surface::QueryImageSize` and `gfx::Surface::DecodeInto`.
+ *
+ * Usage: decode_benchmark [count]
+ *        decode_benchmark verify
+ *
+ * An image encoded in memory is loaded `count` times as an RGBA32 surface, first by loading it
+ * into a new surface then converting it, as before, then by decoding it into a buffer reused
+ * between the loads and wrapping this buffer with a Surface, and the average times are reported.
+ *
+ * 'verify' checks the sizes read from the headers of each supported format, that both paths give
+ * the same pixels, that the pitch of the buffer is respected, that invalid buffers are rejected and
+ * that the Surface wrapping a buffer writes into it without freeing it.
+ */
+
+/* Verification */
+
+int Verify()
+{
+    Checks checks;
+
+    auto throws = [](auto&& func)
+    {
+        try { func(); } catch (const core::NexusException&) { return true; }
+        return false;
+    };
+
+    const gfx::Surface image = NewRandomImage(123, 45, 9);
+    const std::vector<Uint8> bmp = EncodeBMP(image);
+
+    // Headers of the other formats, only their size being read
+    {
+        const std::vector<Uint8> png = {
+            0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n', 0, 0, 0, 13, 'I', 'H', 'D', 'R',
+            0, 0, 0x01, 0x2C, 0, 0, 0, 0xC8, 8, 6, 0, 0, 0
+        };
+
+        const std::vector<Uint8> gif = { 'G', 'I', 'F', '8', '9', 'a', 0x2C, 0x01, 0xC8, 0x00, 0, 0, 0 };
+        const std::vector<Uint8> qoi = { 'q', 'o', 'i', 'f', 0, 0, 0x01, 0x2C, 0, 0, 0, 0xC8, 4, 0 };
+
+        // SOI, fill byte, APP0 and DHT segments, then SOF2 (progressive)
+        const std::vector<Uint8> jpeg = {
+            0xFF, 0xD8, 0xFF, 0xFF, 0xE0, 0x00, 0x06, 'J', 'F', 'I', 'F', 0xFF, 0xC4, 0x00, 0x03, 0x00,
+            0xFF, 0xC2, 0x00, 0x0B, 0x08, 0x00, 0xC8, 0x01, 0x2C, 0x01, 0x01, 0x11, 0x00
+        };
+
+        const std::string pnm = "P6\n# comment\n300 # width\n200\n255\n";
+
+        checks.Check("size [png]", gfx::Surface::QueryImageSize(png.data(), png.size()) == math::IVec2(300, 200));
+        checks.Check("size [gif]", gfx::Surface::QueryImageSize(gif.data(), gif.size()) == math::IVec2(300, 200));
+        checks.Check("size [qoi]", gfx::Surface::QueryImageSize(qoi.data(), qoi.size()) == math::IVec2(300, 200));
+        checks.Check("size [jpeg]", gfx::Surface::QueryImageSize(jpeg.data(), jpeg.size()) == math::IVec2(300, 200));
+        checks.Check("size [pnm]", gfx::Surface::QueryImageSize(pnm.data(), pnm.size()) == math::IVec2(300, 200));
+        checks.Check("size [bmp]", gfx::Surface::QueryImageSize(bmp.data(), bmp.size()) == math::IVec2(123, 45));
+        checks.Check("size [invalid]", throws([] { gfx::Surface::QueryImageSize("nope", 4); }));
+    }
+
+    // Contiguous rows, then padded rows whose padding must be kept
+    for (const int pitch : { 0, 4 * 123 + 20 })
+    {
+        const int stride = pitch ? pitch : 4 * 123;
+        std::vector<Uint32> buffer(stride / 4 * 45, 0xDEADBEEF);
+
+        const math::IVec2 size = gfx::Surface::DecodeInto(bmp.data(), bmp.size(), buffer.data(), 4 * buffer.size(), pitch);
+        const gfx::Surface wrapped(size.x, size.y, buffer.data(), stride);
+
+        bool same = size == image.GetSize();
+        for (int y = 0; same && y < size.y; y++)
+        {
+            for (int x = 0; same && x < size.x; x++) same = wrapped.GetPixelUnsafe(x, y) == image.GetPixelUnsafe(x, y);
+            for (int x = 4 * size.x; same && x < stride; x += 4) same = buffer[(y * stride + x) / 4] == 0xDEADBEEF;
+        }
+
+        checks.Check(pitch ? "decode [pitch]" : "decode [contiguous]", same);
+    }
+
+    // Same pixels as the surface loaded then converted
+    {
+        const gfx::Surface loaded = gfx::Surface(bmp.data(), bmp.size()).Clone(gfx::PixelFormat::RGBA32);
+
+        std::vector<Uint32> buffer(123 * 45);
+        gfx::Surface::DecodeInto(bmp.data(), bmp.size(), buffer.data(), 4 * buffer.size());
+
+        checks.Check("decode [previous path]", std::memcmp(loaded.GetPixels(), buffer.data(), 4 * buffer.size()) == 0);
+    }
+
+    // Buffers too small, misaligned or with a wrong pitch
+    {
+        std::vector<Uint32> buffer(124 * 45 + 1);
+        Uint8 *bytes = reinterpret_cast<Uint8*>(buffer.data());
+
+        checks.Check("reject [capacity]", throws([&] { gfx::Surface::DecodeInto(bmp.data(), bmp.size(), bytes, 4 * 123 * 45 - 1); }));
+        checks.Check("reject [alignment]", throws([&] { gfx::Surface::DecodeInto(bmp.data(), bmp.size(), bytes + 1, 4 * 123 * 45); }));
+        checks.Check("reject [pitch]", throws([&] { gfx::Surface::DecodeInto(bmp.data(), bmp.size(), bytes, 4 * buffer.size(), 4 * 123 + 2); }));
+        checks.Check("reject [narrow pitch]", throws([&] { gfx::Surface::DecodeInto(bmp.data(), bmp.size(), bytes, 4 * buffer.size(), 4 * 122); }));
+        checks.Check("reject [wrap]", throws([&] { gfx::Surface(123, 45, bytes + 2, 4 * 123); }));
+    }
+
+    // The wrapping Surface draws into the buffer, which stays valid after its destruction
+    {
+        std::vector<Uint32> buffer(16 * 16, 0);
+
+        {
+            gfx::Surface wrapped(16, 16, buffer.data(), 4 * 16);
+            wrapped.DrawRectangle(0, 0, 16, 16, gfx::Red);
+        }
+
+        bool written = true;
+        for (Uint32 pixel : buffer) written &= gfx::Surface(1, 1, &pixel, 4).GetPixelUnsafe(0, 0) == gfx::Red;
+        checks.Check("wrap [write through]", written);
+    }
+
+    return checks.GetExitCode();
+}
+
+int main(int argc, char** argv)
+{
+    const std::string arg = argc > 1 ? argv[1] : "";
+
+    if (arg == "verify")
+    {
+        return Verify();
+    }
+
+    const int count = !arg.empty() ? std::max(1, std::atoi(arg.c_str())) : 32;
+    const std::vector<Uint8> bmp = EncodeBMP(NewRandomImage(1024, 1024, 1));
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "decode (1024x1024 BMP -> RGBA32)\n";
+
+    const double previous = TimePerCall([&]
+    {
+        const gfx::Surface surface = gfx::Surface(bmp.data(), bmp.size()).Clone(gfx::PixelFormat::RGBA32);
+    }, count);
+
+    std::vector<Uint32> buffer;
+
+    const double current = TimePerCall([&]
+    {
+        const math::IVec2 size = gfx::Surface::QueryImageSize(bmp.data(), bmp.size());
+        if (buffer.size() < static_cast<size_t>(size.x) * size.y) buffer.resize(static_cast<size_t>(size.x) * size.y);
+
+        gfx::Surface::DecodeInto(bmp.data(), bmp.size(), buffer.data(), 4 * buffer.size());
+        const gfx::Surface surface(size.x, size.y, buffer.data(), 4 * size.x);
+    }, count);
+
+    std::cout << "    " << std::setw(24) << std::left << "load + convert" << previous << " ms\n";
+    std::cout << "    " << std::setw(24) << std::left << "decode into buffer" << current << " ms\n";
+
+    return 0;
+}
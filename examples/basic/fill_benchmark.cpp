@@ -0,0 +1,358 @@
+#include "benchmark_common.hpp"
+#include <iomanip>
+
+using namespace nexus;
+
+/*
+ * Headless benchmark of the polygon and mesh filling of gfx::Surface.
+ *
+ * Usage: fill_benchmark [scenario] [frames]
+ *        fill_benchmark verify
+ *
+ * Each scenario fills shapes on a 1024x1024 RGBA32 surface and reports the average time per frame.
+ * The polygon scenarios also report the time taken by testing every pixel of the bounding box with
+ * `Polygon::CollisionPoint`, which is how `DrawPolygon` used to fill them.
+ * Without arguments every scenario is run with the default frame count.
+ *
+ * 'verify' checks the filled pixels against per-pixel references: `CollisionPoint` for the even-odd
+ * rule, the winding number for the non-zero rule, a 32x32 supersampling for the anti-aliased coverage
+ * and the barycentric interpolation for the vertex colors. It also checks that the adjacent triangles
+ * of a mesh neither overlap nor leave gaps between them.
+ */
+
+constexpr int TargetSize = 1024;
+
+shape2D::Polygon GenOutline(int vertexCount, float radius, Uint32 seed)
+{
+    // Concave outline with a noisy radius, like the coastline of a map
+
+    shape2D::Polygon poly;
+    Lcg rng{ seed };
+
+    for (int i = 0; i < vertexCount; i++)
+    {
+        const float angle = i * 2.0f * math::Pi / vertexCount;
+        const float r = radius * (0.6f + 0.25f * std::sin(angle * 7.0f) + 0.15f * rng.NextFloat());
+        poly.vertices.emplace_back(TargetSize * 0.5f + 0.5f + r * std::cos(angle), TargetSize * 0.5f + 0.5f + r * std::sin(angle));
+    }
+
+    return poly;
+}
+
+shape2D::Polygon GenStar(int points, float radius, float cx, float cy)
+{
+    // Self-intersecting star, whose center is only filled with the non-zero rule
+
+    shape2D::Polygon poly;
+
+    for (int i = 0; i < points; i++)
+    {
+        const float angle = i * 2.0f * math::Pi * (points / 2) / points + 0.1f;
+        poly.vertices.emplace_back(cx + radius * std::cos(angle), cy + radius * std::sin(angle));
+    }
+
+    return poly;
+}
+
+shape2D::Mesh GenGrid(int columns, int rows, float x, float y, float cellSize, bool translucent)
+{
+    // Grid of quads made of two triangles each, with a color per vertex
+
+    shape2D::Mesh mesh;
+
+    auto vertex = [&](int i, int j)
+    {
+        const Uint8 a = translucent ? 128 : 255;
+        return shape2D::Vertex(x + i * cellSize, y + j * cellSize, Uint8(i * 255 / columns), Uint8(j * 255 / rows), 128, a);
+    };
+
+    for (int j = 0; j < rows; j++)
+    {
+        for (int i = 0; i < columns; i++)
+        {
+            const shape2D::Vertex v00 = vertex(i, j), v10 = vertex(i + 1, j), v01 = vertex(i, j + 1), v11 = vertex(i + 1, j + 1);
+            mesh.vertices.insert(mesh.vertices.end(), { v00, v01, v11, v11, v10, v00 });
+        }
+    }
+
+    return mesh;
+}
+
+void FillPerPixel(const gfx::Surface& target, const shape2D::Polygon& poly, const gfx::Color& color)
+{
+    // Previous implementation of DrawPolygon, kept as a baseline
+
+    shape2D::AABB bounds = poly.GetAABB();
+
+    bounds.min = bounds.min.Clamp({ 0, 0 }, target.GetSize());
+    bounds.max = bounds.max.Clamp({ 0, 0 }, target.GetSize());
+
+    for (int y = bounds.min.y; y < bounds.max.y; y++)
+    {
+        for (int x = bounds.min.x; x < bounds.max.x; x++)
+        {
+            if (poly.CollisionPoint(math::IVec2{ x, y }))
+            {
+                target.SetPixelUnsafe(x, y, color);
+            }
+        }
+    }
+}
+
+struct Scenario
+{
+    const char *name;
+    const char *description;
+    std::function<void(gfx::Surface&)> draw;
+    std::function<void(gfx::Surface&)> baseline;    ///< Same drawing the way it was done before, if any
+};
+
+const shape2D::Polygon& GetOutline()
+{
+    static const shape2D::Polygon outline = GenOutline(4000, TargetSize * 0.5f, 1);
+    return outline;
+}
+
+const Scenario scenarios[] = {
+
+    { "outline", "Concave polygon of 4000 vertices covering most of the target",
+        [](gfx::Surface& target) { target.DrawPolygon(GetOutline(), gfx::Green); },
+        [](gfx::Surface& target) { FillPerPixel(target, GetOutline(), gfx::Green); }
+    },
+
+    { "outline_aa", "Same as 'outline' with anti-aliasing",
+        [](gfx::Surface& target) { target.DrawPolygon(GetOutline(), gfx::Green, gfx::FillRule::EvenOdd, true); },
+        nullptr
+    },
+
+    { "stars_nonzero", "100 self-intersecting stars of 11 points with the non-zero rule",
+        [](gfx::Surface& target)
+        {
+            for (int i = 0; i < 100; i++)
+            {
+                target.DrawPolygon(GenStar(11, 60, 64.5f + (i % 10) * 100, 64.5f + (i / 10) * 100), gfx::Yellow, gfx::FillRule::NonZero);
+            }
+        },
+        nullptr
+    },
+
+    { "mesh_colors", "Mesh of 100x100 quads with vertex colors covering most of the target",
+        [](gfx::Surface& target)
+        {
+            static const shape2D::Mesh mesh = GenGrid(100, 100, 12.25f, 12.25f, 10.0f, false);
+            target.DrawMesh(mesh);
+        },
+        nullptr
+    },
+};
+
+double RunDraw(const std::function<void(gfx::Surface&)>& draw, int frames)
+{
+    gfx::Surface target(TargetSize, TargetSize, gfx::Black);
+
+    draw(target);   // Warm-up
+
+    return TimePerCall([&] { draw(target); }, frames);
+}
+
+int WindingNumber(const shape2D::Polygon& poly, float px, float py)
+{
+    int winding = 0;
+
+    for (size_t i = 0, j = poly.vertices.size() - 1; i < poly.vertices.size(); j = i++)
+    {
+        const math::Vec2 &a = poly.vertices[j], &b = poly.vertices[i];
+        const float cross = (b.x - a.x) * (py - a.y) - (px - a.x) * (b.y - a.y);
+
+        if (a.y <= py && b.y > py && cross > 0) winding++;
+        else if (b.y <= py && a.y > py && cross < 0) winding--;
+    }
+
+    return winding;
+}
+
+int CountRuleMismatches(gfx::FillRule rule)
+{
+    // Random polygons, with vertices inside and outside of the target so that they are also clipped
+
+    Lcg rng{ rule == gfx::FillRule::EvenOdd ? 7u : 11u };
+    int mismatches = 0;
+
+    for (int iter = 0; iter < 20; iter++)
+    {
+        shape2D::Polygon poly;
+
+        for (int i = 0; i < 5 + iter; i++)
+        {
+            poly.vertices.emplace_back(rng.NextFloat() * 300.0f - 50.0f, rng.NextFloat() * 300.0f - 50.0f);
+        }
+
+        gfx::Surface target(200, 200, gfx::Black);
+        target.DrawPolygon(poly, gfx::White, rule);
+
+        for (int y = 0; y < 200; y++)
+        {
+            for (int x = 0; x < 200; x++)
+            {
+                const bool inside = rule == gfx::FillRule::EvenOdd
+                    ? poly.CollisionPoint(math::Vec2(x, y))
+                    : WindingNumber(poly, x, y) != 0;
+
+                mismatches += inside != (target.GetPixelUnsafe(x, y).r == 255);
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+int CheckCoverage()
+{
+    // White polygons over black, each pixel then being its coverage, compared with a supersampling of the pixel
+
+    Lcg rng{ 3 };
+    int maxError = 0;
+
+    for (int iter = 0; iter < 10; iter++)
+    {
+        shape2D::Polygon poly;
+
+        for (int i = 0; i < 3 + iter; i++)
+        {
+            poly.vertices.emplace_back(rng.NextFloat() * 80.0f - 8.0f, rng.NextFloat() * 80.0f - 8.0f);
+        }
+
+        gfx::Surface target(64, 64, gfx::Black);
+        target.DrawPolygon(poly, gfx::White, gfx::FillRule::EvenOdd, true);
+
+        for (int y = 0; y < 64; y++)
+        {
+            for (int x = 0; x < 64; x++)
+            {
+                int covered = 0;
+
+                for (int sy = 0; sy < 32; sy++)
+                {
+                    for (int sx = 0; sx < 32; sx++)
+                    {
+                        covered += poly.CollisionPoint(math::Vec2(x - 0.5f + (sx + 0.5f) / 32, y - 0.5f + (sy + 0.5f) / 32));
+                    }
+                }
+
+                maxError = std::max(maxError, std::abs(target.GetPixelUnsafe(x, y).r - covered * 255 / 1024));
+            }
+        }
+    }
+
+    return maxError;
+}
+
+int CountMeshOverlaps()
+{
+    // Translucent grid over black: each pixel of the grid must be blended exactly once with the color of its cell
+
+    constexpr int Columns = 30, Rows = 20;
+    constexpr float Origin = 10.3f, CellSize = 7.7f;
+
+    const shape2D::Mesh mesh = GenGrid(Columns, Rows, Origin, Origin, CellSize, true);
+
+    gfx::Surface target(256, 256, gfx::Black);
+    target.DrawMesh(mesh);
+
+    int errors = 0;
+
+    for (int y = 0; y < 256; y++)
+    {
+        for (int x = 0; x < 256; x++)
+        {
+            const bool inside = x >= Origin && x < Origin + Columns * CellSize && y >= Origin && y < Origin + Rows * CellSize;
+            const gfx::Color c = target.GetPixelUnsafe(x, y);
+
+            // Blue is constant, blended once it gives 64, twice 96, and 0 if the pixel was missed
+            errors += inside ? std::abs(c.b - 64) > 2 : c.b != 0;
+        }
+    }
+
+    return errors;
+}
+
+int CheckTriangleColors()
+{
+    const shape2D::Vertex v0(20.3f, 10.7f, 255, 0, 0, 255), v1(5.1f, 190.2f, 0, 255, 0, 255), v2(230.8f, 120.4f, 0, 0, 255, 255);
+
+    gfx::Surface target(256, 256, gfx::Black);
+    target.DrawTriangleColors(v0, v1, v2);
+
+    const float area = (v1.position.x - v0.position.x) * (v2.position.y - v0.position.y) - (v2.position.x - v0.position.x) * (v1.position.y - v0.position.y);
+
+    int maxError = 0;
+
+    for (int y = 0; y < 256; y++)
+    {
+        for (int x = 0; x < 256; x++)
+        {
+            auto weight = [x, y, area](const math::Vec2& a, const math::Vec2& b)
+            {
+                return ((b.x - a.x) * (y - a.y) - (x - a.x) * (b.y - a.y)) / area;
+            };
+
+            const float w0 = weight(v1.position, v2.position), w1 = weight(v2.position, v0.position), w2 = weight(v0.position, v1.position);
+            if (w0 < 0 || w1 < 0 || w2 < 0) continue;
+
+            const gfx::Color c = target.GetPixelUnsafe(x, y);
+
+            maxError = std::max({ maxError, std::abs(c.r - int(255 * w0)), std::abs(c.g - int(255 * w1)), std::abs(c.b - int(255 * w2)) });
+        }
+    }
+
+    return maxError;
+}
+
+int Verify()
+{
+    Checks checks;
+
+    // The sample points of random vertices never lie exactly on an edge, so both rules must match exactly
+    const int evenOdd = CountRuleMismatches(gfx::FillRule::EvenOdd);
+    checks.Check("even-odd rule", evenOdd == 0, std::to_string(evenOdd) + " pixels differ");
+
+    const int nonZero = CountRuleMismatches(gfx::FillRule::NonZero);
+    checks.Check("non-zero rule", nonZero == 0, std::to_string(nonZero) + " pixels differ");
+
+    // The coverage is sampled over 16 rows, so an edge may be off by 1/16 of a pixel vertically
+    checks.CheckError("anti-aliasing", CheckCoverage(), 20);
+
+    const int overlaps = CountMeshOverlaps();
+    checks.Check("mesh edges", overlaps == 0, std::to_string(overlaps) + " pixels missed or blended twice");
+
+    checks.CheckError("vertex colors", CheckTriangleColors(), 1);
+
+    return checks.GetExitCode();
+}
+
+int main(int argc, char** argv)
+{
+    const BenchmarkArgs args = ParseBenchmarkArgs(argc, argv, 20);
+
+    if (args.IsVerify())
+    {
+        return Verify();
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+
+    for (const auto& scenario : scenarios)
+    {
+        if (!args.Selects(scenario.name)) continue;
+
+        std::cout << scenario.name << " - " << scenario.description << "\n";
+        std::cout << "    " << std::setw(10) << std::left << "scanline" << RunDraw(scenario.draw, args.count) << " ms/frame\n";
+
+        if (scenario.baseline)
+        {
+            std::cout << "    " << std::setw(10) << std::left << "per-pixel" << RunDraw(scenario.baseline, args.count) << " ms/frame\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,283 @@
+#include "benchmark_common.hpp"
+#include <iomanip>
+#include <thread>
+#include <memory>
+
+using namespace nexus;
+
+/*
+ * Headless benchmark of the procedural surface generators, as used at level-load time.
+ *
+ * Usage: generation_benchmark [scenario] [count]
+ *        generation_benchmark verify
+ *
+ * Each scenario creates `count` 128x128 surfaces then `count / 64` 1024x1024 surfaces with one of
+ * the `gfx::Surface::New*` factories, and reports the average time per surface, the rows of the large
+ * surfaces being shared by a worker pool (see `gfx::SetWorkerPool`). The time taken by the previous
+ * single-threaded per-pixel loops is reported as well.
+ * Without arguments every scenario is run with the default count.
+ *
+ * 'verify' checks that the gradients and checks match the previous loops, that the noise and the
+ * cellular pattern are the same for the same seed whatever the size and pixel format of the surface
+ * (the large surfaces being generated in parallel, the small ones not), with or without a worker pool,
+ * and that the noise density follows the requested factor.
+ */
+
+/* Previous implementations, kept as a baseline */
+
+gfx::Surface OldGradientLinear(int w, int h, float direction, const gfx::Color& start, const gfx::Color& end)
+{
+    gfx::Surface surface(w, h, gfx::Blank);
+
+    direction = (90 - direction) * math::Deg2Rad;
+    const float c = std::cos(direction), s = std::sin(direction);
+
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            const float factor = std::clamp((x * c + y * s) / (w * c + h * s), 0.0f, 1.0f);
+            surface.SetPixelUnsafe(x, y, end.Normalized() * factor + start.Normalized() * (1.0f - factor));
+        }
+    }
+
+    return surface;
+}
+
+gfx::Surface OldGradientRadial(int w, int h, float density, const gfx::Color& inner, const gfx::Color& outer)
+{
+    gfx::Surface surface(w, h, gfx::Blank);
+
+    const math::IVec2 center(w * 0.5f, h * 0.5f);
+    const float radius = std::min(center.x, center.y);
+
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            const float dist = std::hypotf(x - center.x, y - center.y);
+            const float factor = std::clamp((dist - radius * density) / (radius * (1.0f - density)), 0.0f, 1.0f);
+            surface.SetPixelUnsafe(x, y, outer.Normalized() * factor + inner.Normalized() * (1.0f - factor));
+        }
+    }
+
+    return surface;
+}
+
+gfx::Surface OldGradientSquare(int w, int h, float density, const gfx::Color& inner, const gfx::Color& outer)
+{
+    gfx::Surface surface(w, h, gfx::Blank);
+
+    const math::IVec2 center(w * 0.5f, h * 0.5f);
+
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            const math::Vec2 dist = (math::Vec2(x, y) - center).Abs() / center;
+            const float factor = std::clamp((std::max(dist.x, dist.y) - density) / (1.0f - density), 0.0f, 1.0f);
+            surface.SetPixelUnsafe(x, y, outer.Normalized() * factor + inner.Normalized() * (1.0f - factor));
+        }
+    }
+
+    return surface;
+}
+
+gfx::Surface OldChecked(int w, int h, int checksX, int checksY, const gfx::Color& col1, const gfx::Color& col2)
+{
+    gfx::Surface surface(w, h, gfx::Blank);
+
+    int i = 0;
+    for (int y = 0; y < h; y += checksY, i++)
+    {
+        for (int x = 0; x < w; x += checksX)
+        {
+            surface.DrawRectangle(x, y, checksX, checksY, i++ % 2 ? col1 : col2);
+        }
+    }
+
+    return surface;
+}
+
+gfx::Surface OldWhiteNoise(int w, int h, float factor)
+{
+    gfx::Surface surface(w, h, gfx::Blank);
+    core::RandomGenerator gen;
+
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            surface.SetPixelUnsafe(x, y, gen.Random(0.0f, 1.0f) < factor ? gfx::White : gfx::Black);
+        }
+    }
+
+    return surface;
+}
+
+gfx::Surface OldCellular(int w, int h, int tileSize)
+{
+    gfx::Surface surface(w, h, gfx::Blank);
+    core::RandomGenerator gen;
+
+    const int seedsPerRow = w / tileSize, seedsPerCol = h / tileSize;
+    std::vector<math::Vec2> seeds(seedsPerRow * seedsPerCol);
+
+    for (size_t i = 0; i < seeds.size(); i++)
+    {
+        seeds[i] = math::Vec2((i % seedsPerRow) * tileSize + gen.Random(0, tileSize - 1),
+                              (i / seedsPerRow) * tileSize + gen.Random(0, tileSize - 1));
+    }
+
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            const int tileX = x / tileSize, tileY = y / tileSize;
+            float minDistance = 65536.0f;
+
+            for (int i = -1; i < 2; i++)
+            {
+                for (int j = -1; j < 2; j++)
+                {
+                    if (tileX + i < 0 || tileX + i >= seedsPerRow || tileY + j < 0 || tileY + j >= seedsPerCol) continue;
+                    const math::Vec2 &seed = seeds[(tileY + j) * seedsPerRow + tileX + i];
+                    minDistance = std::min(minDistance, std::hypotf(x - seed.x, y - seed.y));
+                }
+            }
+
+            const Uint8 intensity = std::min(minDistance * 256.0f / tileSize, 255.0f);
+            surface.SetPixelUnsafe(x, y, { intensity, intensity, intensity, 255 });
+        }
+    }
+
+    return surface;
+}
+
+/* Scenarios */
+
+struct Scenario
+{
+    const char *name;
+    std::function<gfx::Surface(int size)> generate;
+    std::function<gfx::Surface(int size)> previous;
+};
+
+const Scenario scenarios[] = {
+    { "gradient_linear",
+        [](int size) { return gfx::Surface::NewGradientLinear(size, size, 30, gfx::Red, gfx::Blue); },
+        [](int size) { return OldGradientLinear(size, size, 30, gfx::Red, gfx::Blue); } },
+    { "gradient_radial",
+        [](int size) { return gfx::Surface::NewGradientRadial(size, size, 0.25f, gfx::White, gfx::Black); },
+        [](int size) { return OldGradientRadial(size, size, 0.25f, gfx::White, gfx::Black); } },
+    { "gradient_square",
+        [](int size) { return gfx::Surface::NewGradientSquare(size, size, 0.25f, gfx::Yellow, gfx::Purple); },
+        [](int size) { return OldGradientSquare(size, size, 0.25f, gfx::Yellow, gfx::Purple); } },
+    { "checked",
+        [](int size) { return gfx::Surface::NewChecked(size, size, 16, 16, gfx::Red, gfx::Blue); },
+        [](int size) { return OldChecked(size, size, 16, 16, gfx::Red, gfx::Blue); } },
+    { "white_noise",
+        [](int size) { return gfx::Surface::NewWhiteNoise(size, size, 0.5f, 1234); },
+        [](int size) { return OldWhiteNoise(size, size, 0.5f); } },
+    { "cellular",
+        [](int size) { return gfx::Surface::NewCellular(size, size, 32, 1234); },
+        [](int size) { return OldCellular(size, size, 32); } },
+};
+
+double TimePerSurface(const std::function<gfx::Surface(int)>& generate, int size, int count)
+{
+    return TimePerCall([&] { generate(size); }, count);
+}
+
+/* Verification */
+
+int Verify()
+{
+    Checks checks;
+
+    // Same formulas as before, the radial distance only being computed without std::hypotf
+    for (const int size : { 96, 1024 })
+    {
+        const std::string suffix = " [" + std::to_string(size) + "x" + std::to_string(size) + "]";
+        checks.CheckError("gradient linear" + suffix, MaxError(scenarios[0].generate(size), scenarios[0].previous(size)), 0);
+        checks.CheckError("gradient radial" + suffix, MaxError(scenarios[1].generate(size), scenarios[1].previous(size)), 1);
+        checks.CheckError("gradient square" + suffix, MaxError(scenarios[2].generate(size), scenarios[2].previous(size)), 0);
+        checks.CheckError("checked" + suffix, MaxError(scenarios[3].generate(size), scenarios[3].previous(size)), 0);
+    }
+
+    // The noise only depends on the seed and the pixel position, so the parallel generation of a large surface
+    // gives the same pixels as the serial one of a small surface, whatever the format of the surface
+    const gfx::Surface serialNoise = gfx::Surface::NewWhiteNoise(1024, 1024, 0.3f, 42);
+
+    utils::ThreadPool pool(3);
+    gfx::SetWorkerPool(&pool);
+
+    const gfx::Surface noise = gfx::Surface::NewWhiteNoise(1024, 1024, 0.3f, 42);
+    const gfx::Surface smallNoise = gfx::Surface::NewWhiteNoise(100, 100, 0.3f, 42);
+
+    gfx::Surface noiseArgb(1024, 1024, gfx::Blank, gfx::PixelFormat::ARGB8888);
+    noiseArgb.DrawWhiteNoise(noiseArgb.GetRectSize(), 0.3f, 42);
+
+    checks.CheckError("white noise [same seed]", MaxError(noise, gfx::Surface::NewWhiteNoise(1024, 1024, 0.3f, 42)), 0);
+    checks.CheckError("white noise [serial]", MaxError(noise, smallNoise, 0, 0, 100, 100), 0);
+    checks.CheckError("white noise [no pool]", MaxError(noise, serialNoise), 0);
+    checks.CheckError("white noise [format]", MaxError(noise, noiseArgb), 0);
+
+    checks.Check("white noise [other seed]", MaxError(noise, gfx::Surface::NewWhiteNoise(1024, 1024, 0.3f, 43)) != 0);
+
+    int white = 0;
+    for (int y = 0; y < 1024; y++)
+    {
+        for (int x = 0; x < 1024; x++) white += noise.GetPixelUnsafe(x, y).r == 255;
+    }
+
+    const float density = white / (1024.0f * 1024.0f);
+    checks.Check("white noise [density]", std::abs(density - 0.3f) < 0.01f, std::to_string(density));
+
+    // The cells of the small surface next to its right and bottom edges lack neighbors the large one has
+    const gfx::Surface cellular = gfx::Surface::NewCellular(1024, 1024, 32, 42);
+
+    gfx::Surface cellularArgb(1024, 1024, gfx::Blank, gfx::PixelFormat::ARGB8888);
+    cellularArgb.DrawCellular(cellularArgb.GetRectSize(), 32, 42);
+
+    checks.CheckError("cellular [same seed]", MaxError(cellular, gfx::Surface::NewCellular(1024, 1024, 32, 42)), 0);
+    checks.CheckError("cellular [serial]", MaxError(cellular, gfx::Surface::NewCellular(128, 128, 32, 42), 0, 0, 64, 64), 0);
+    checks.CheckError("cellular [format]", MaxError(cellular, cellularArgb), 0);
+
+    gfx::SetWorkerPool(nullptr);
+
+    return checks.GetExitCode();
+}
+
+int main(int argc, char** argv)
+{
+    const BenchmarkArgs args = ParseBenchmarkArgs(argc, argv, 256);
+
+    if (args.IsVerify())
+    {
+        return Verify();
+    }
+
+    const unsigned numThreads = std::thread::hardware_concurrency();
+    const std::unique_ptr<utils::ThreadPool> pool = numThreads > 1 ? std::make_unique<utils::ThreadPool>(numThreads - 1) : nullptr;
+    gfx::SetWorkerPool(pool.get());
+
+    std::cout << std::fixed << std::setprecision(3);
+
+    for (const auto& scenario : scenarios)
+    {
+        if (!args.Selects(scenario.name)) continue;
+
+        const int count = args.count, largeCount = std::max(1, count / 64);
+
+        std::cout << scenario.name << "\n";
+        std::cout << "    128x128     " << std::setw(10) << std::left << "current" << TimePerSurface(scenario.generate, 128, count) << " ms/surface\n";
+        std::cout << "    128x128     " << std::setw(10) << std::left << "previous" << TimePerSurface(scenario.previous, 128, count) << " ms/surface\n";
+        std::cout << "    1024x1024   " << std::setw(10) << std::left << "current" << TimePerSurface(scenario.generate, 1024, largeCount) << " ms/surface\n";
+        std::cout << "    1024x1024   " << std::setw(10) << std::left << "previous" << TimePerSurface(scenario.previous, 1024, largeCount) << " ms/surface\n";
+    }
+
+    gfx::SetWorkerPool(nullptr);
+
+    return 0;
+}
@@ -0,0 +1,213 @@
+#include "benchmark_common.hpp"
+#include <iomanip>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace nexus;
+
+/*
+ * Benchmark of `gfx::AsyncImageLoader` against loading the images one by one on the main thread.
+ *
+ * Usage: image_loading_benchmark [directory] [count]
+ *        image_loading_benchmark verify
+ *
+ * Every file of the directory (the example images by default) is loaded `count` times, serially with
+ * `gfx::Surface(const std::string&)`, then with the loader on every hardware thread, without budget and
+ * with a budget of a quarter of the decoded pixels, the completion callbacks being run as in a game loop.
+ * The throughput of each path is reported in images and megabytes of decoded pixels per second.
+ *
+ * 'verify' checks that the loader gives the same pixels as the serial path, that the callbacks run on the
+ * polling thread before the futures are fulfilled, that the memory budget is respected, including for an
+ * image larger than the budget, and that the errors are reported through the futures.
+ */
+
+/* Images */
+
+size_t PixelBytes(const gfx::Surface& surface)
+{
+    return static_cast<size_t>(surface.GetPitch()) * surface.GetHeight();
+}
+
+/* Verification */
+
+int Verify()
+{
+    Checks checks;
+
+    std::vector<std::vector<Uint8>> images;
+    for (int i = 0; i < 24; i++) images.push_back(EncodeBMP(NewRandomImage(37 + 29 * i, 91 + 13 * i, i)));
+
+    // Same pixels as the serial path, whatever the budget
+    for (const size_t budget : { size_t(0), size_t(200000) })
+    {
+        gfx::AsyncImageLoader loader(3, budget);
+
+        std::vector<std::future<gfx::Surface>> futures;
+        for (const auto& data : images) futures.push_back(loader.Load(data.data(), data.size()));
+
+        bool same = true;
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            const gfx::Surface serial(images[i].data(), images[i].size());
+            const gfx::Surface loaded = futures[i].get();
+
+            same &= loaded.GetSize() == serial.GetSize() && loaded.GetPixelFormat() == serial.GetPixelFormat()
+                 && std::memcmp(loaded.GetPixels(), serial.GetPixels(), PixelBytes(serial)) == 0;
+        }
+
+        checks.Check(budget ? "pixels [budget]" : "pixels", same);
+
+        loader.Flush();
+        checks.Check(budget ? "pending [budget]" : "pending", loader.GetPendingCount() == 0 && loader.GetMemoryUsage() == 0);
+    }
+
+    // Callbacks, run on this thread before the futures are fulfilled, under a budget smaller than the largest image
+    {
+        const size_t budget = 4 * 400 * 300;
+        gfx::AsyncImageLoader loader(3, budget);
+
+        const std::thread::id mainThread = std::this_thread::get_id();
+        bool sameThread = true, underBudget = true;
+        size_t calls = 0, peak = 0;
+
+        std::vector<std::future<gfx::Surface>> futures;
+
+        for (const auto& data : images)
+        {
+            futures.push_back(loader.Load(data.data(), data.size(), [&](gfx::Surface& surface)
+            {
+                sameThread &= std::this_thread::get_id() == mainThread;
+                peak = std::max(peak, loader.GetMemoryUsage());
+                underBudget &= loader.GetMemoryUsage() <= std::max(budget, PixelBytes(surface));
+                surface.SetPixel(0, 0, gfx::Red);
+                calls++;
+            }));
+        }
+
+        while (loader.GetPendingCount() > 0)
+        {
+            loader.Poll();
+            std::this_thread::yield();
+        }
+
+        bool modified = true;
+        for (auto& future : futures) modified &= future.get().GetPixel(0, 0) == gfx::Red;
+
+        checks.Check("callback [thread]", sameThread && calls == images.size());
+        checks.Check("callback [before future]", modified);
+        checks.Check("budget", underBudget && peak > 0);
+    }
+
+    // Indices of the bulk loads, then errors
+    {
+        const std::string directory = "image_loading_benchmark_verify/";
+        std::filesystem::create_directories(directory);
+
+        std::vector<std::string> paths;
+        for (size_t i = 0; i < 4; i++)
+        {
+            paths.push_back(directory + std::to_string(i) + ".bmp");
+            std::ofstream(paths.back(), std::ios::binary).write(reinterpret_cast<const char*>(images[i].data()), images[i].size());
+        }
+
+        gfx::AsyncImageLoader loader(2);
+
+        bool indices = true;
+        auto futures = loader.Load(paths, [&](size_t i, gfx::Surface& surface)
+        {
+            indices &= surface.GetWidth() == 37 + 29 * static_cast<int>(i);
+        });
+
+        loader.Flush();
+        checks.Check("bulk [indices]", indices && futures.size() == paths.size());
+
+        auto throws = [](std::future<gfx::Surface> future)
+        {
+            try { future.get(); } catch (const core::NexusException&) { return true; }
+            return false;
+        };
+
+        const char garbage[] = "not an image";
+        checks.Check("error [memory]", throws(loader.Load(garbage, sizeof(garbage))));
+        checks.Check("error [file]", throws(loader.Load(directory + "missing.bmp", [](gfx::Surface&) { })));
+
+        std::filesystem::remove_all(directory);
+    }
+
+    return checks.GetExitCode();
+}
+
+/* Benchmark */
+
+int main(int argc, char** argv)
+{
+    const std::string directory = argc > 1 ? argv[1] : RESOURCES_PATH "images/";
+    const int count = argc > 2 ? std::max(1, std::atoi(argv[2])) : 4;
+
+    if (directory == "verify")
+    {
+        return Verify();
+    }
+
+    const std::vector<std::string> files = core::GetDirectoryFiles(directory);
+
+    // Size of the decoded pixels, only the files that can be loaded are kept
+    std::vector<std::string> paths;
+    size_t bytes = 0;
+
+    for (const auto& file : files)
+    {
+        const gfx::Surface surface(file);
+        if (!surface.IsValid()) continue;
+        bytes += PixelBytes(surface);
+        paths.push_back(file);
+    }
+
+    if (paths.empty())
+    {
+        std::cerr << "No image found in '" << directory << "'\n";
+        return 1;
+    }
+
+    const double megabytes = bytes / (1024.0 * 1024.0);
+
+    auto report = [&](const char* name, double milliseconds)
+    {
+        const double seconds = milliseconds / 1000.0;
+
+        std::cout << "    " << std::setw(24) << std::left << name << std::setw(10) << milliseconds << " ms"
+                  << std::setw(10) << std::right << paths.size() / seconds << " img/s"
+                  << std::setw(10) << megabytes / seconds << " MB/s\n";
+    };
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << paths.size() << " images, " << megabytes << " MB decoded, from '" << directory << "'\n";
+
+    report("serial", TimePerCall([&]
+    {
+        for (const auto& path : paths) gfx::Surface surface(path);
+    }, count));
+
+    auto loadAll = [&](size_t budget)
+    {
+        gfx::AsyncImageLoader loader(0, budget);
+        size_t loaded = 0;
+
+        loader.Load(paths, [&](size_t, gfx::Surface&) { loaded++; });
+
+        // As the main loop of a game would, the completion callbacks are run between frames
+        while (loader.GetPendingCount() > 0)
+        {
+            loader.Poll();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    };
+
+    report("async", TimePerCall([&] { loadAll(0); }, count));
+    report("async [budget 1/4]", TimePerCall([&] { loadAll(bytes / 4); }, count));
+
+    std::cout << "    (" << std::thread::hardware_concurrency() << " hardware threads)\n";
+
+    return 0;
+}
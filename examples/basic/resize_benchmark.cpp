@@ -0,0 +1,267 @@
+#include "benchmark_common.hpp"
+#include <iomanip>
+#include <thread>
+#include <memory>
+
+using namespace nexus;
+
+/*
+ * Headless benchmark of the image resampler behind `gfx::Surface::Resize` and `gfx::Surface::GenerateMipChain`.
+ *
+ * Usage: resize_benchmark [scenario] [count]
+ *        resize_benchmark verify
+ *
+ * Each scenario resamples a random RGBA image `count` times with every filter and reports the average
+ * time, with the SIMD kernels split across a thread pool, with the SIMD kernels on a single thread and
+ * with the portable kernels on a single thread. The 'mip_chain' scenario compares `GenerateMipChain`,
+ * using the same pool through `gfx::SetWorkerPool`, with the previous 2x2 averaging loop of the software
+ * rasterizer textures.
+ * Without arguments every scenario is run with the default count.
+ *
+ * 'verify' checks that the SIMD, portable and multithreaded paths give the same pixels, with or without
+ * a worker pool set for `gfx::Surface::Resize`, that flat areas
+ * stay flat, that the box filter matches the previous 2x2 averaging, that transparent pixels do not bleed
+ * their color, that the other pixel formats are resized like RGBA32, and the sizes of the mip chain.
+ */
+
+/* Previous implementation, kept as a baseline */
+
+std::vector<gfx::Surface> OldMipChain(const gfx::Surface& surface)
+{
+    std::vector<gfx::Surface> mipmaps;
+    const gfx::Surface *previous = &surface;
+
+    int levelCount = 0;
+    for (int w = surface.GetWidth(), h = surface.GetHeight(); w > 1 || h > 1; w = std::max(1, w / 2), h = std::max(1, h / 2))
+    {
+        levelCount++;
+    }
+
+    mipmaps.reserve(levelCount);
+
+    for (int i = 0; i < levelCount; i++)
+    {
+        const int pw = previous->GetWidth(), ph = previous->GetHeight();
+        const int w = std::max(1, pw / 2), h = std::max(1, ph / 2);
+
+        gfx::Surface &level = mipmaps.emplace_back(w, h, gfx::Blank, gfx::PixelFormat::RGBA32);
+
+        for (int y = 0; y < h; y++)
+        {
+            const int y0 = std::min(2 * y, ph - 1), y1 = std::min(2 * y + 1, ph - 1);
+
+            for (int x = 0; x < w; x++)
+            {
+                const int x0 = std::min(2 * x, pw - 1), x1 = std::min(2 * x + 1, pw - 1);
+
+                const gfx::Color c00 = previous->GetPixelUnsafe(x0, y0), c10 = previous->GetPixelUnsafe(x1, y0);
+                const gfx::Color c01 = previous->GetPixelUnsafe(x0, y1), c11 = previous->GetPixelUnsafe(x1, y1);
+
+                level.SetPixelUnsafe<gfx::PixelFormat::RGBA32>(x, y, gfx::Color(
+                    static_cast<Uint8>((c00.r + c10.r + c01.r + c11.r + 2) >> 2),
+                    static_cast<Uint8>((c00.g + c10.g + c01.g + c11.g + 2) >> 2),
+                    static_cast<Uint8>((c00.b + c10.b + c01.b + c11.b + 2) >> 2),
+                    static_cast<Uint8>((c00.a + c10.a + c01.a + c11.a + 2) >> 2)));
+            }
+        }
+
+        previous = &level;
+    }
+
+    return mipmaps;
+}
+
+/* Images */
+
+const gfx::Color* Pixels(const gfx::Surface& surface)
+{
+    return static_cast<const gfx::Color*>(surface.GetPixels());
+}
+
+gfx::Color* Pixels(gfx::Surface& surface)
+{
+    return static_cast<gfx::Color*>(surface.GetPixels());
+}
+
+/* Scenarios */
+
+struct Scenario
+{
+    const char *name;
+    int srcSize;
+    int dstSize;
+};
+
+const Scenario scenarios[] = {
+    { "downscale", 2048, 683 },
+    { "upscale", 512, 1536 },
+    { "mip_chain", 2048, 1024 },
+};
+
+const std::pair<const char*, gfx::ResizeFilter> filters[] = {
+    { "box", gfx::ResizeFilter::Box },
+    { "bilinear", gfx::ResizeFilter::Bilinear },
+    { "bicubic", gfx::ResizeFilter::Bicubic },
+    { "lanczos", gfx::ResizeFilter::Lanczos },
+};
+
+/* Verification */
+
+int Verify()
+{
+    Checks checks;
+
+    utils::ThreadPool pool(3);
+
+    // Odd sizes, images narrower than the filters and single rows or columns
+    const std::pair<math::IVec2, math::IVec2> sizes[] = {
+        { { 300, 200 }, { 97, 61 } }, { { 97, 61 }, { 300, 200 } }, { { 5, 3 }, { 17, 11 } },
+        { { 64, 64 }, { 1, 1 } }, { { 1, 40 }, { 3, 7 } }, { { 129, 1 }, { 64, 2 } },
+    };
+
+    for (const auto& [name, filter] : filters)
+    {
+        int simdError = 0, poolError = 0;
+
+        for (const auto& [src, dst] : sizes)
+        {
+            const gfx::Surface image = NewRandomImage(src.x, src.y, 7, false);
+            gfx::Surface portable(dst.x, dst.y), simd(dst.x, dst.y), parallel(dst.x, dst.y);
+
+            const _gfx_impl::Resampler resampler(src.x, src.y, dst.x, dst.y, filter);
+            resampler.Resample(Pixels(image), src.x, Pixels(portable), dst.x, false, nullptr, false);
+            resampler.Resample(Pixels(image), src.x, Pixels(simd), dst.x, false, nullptr, true);
+            resampler.Resample(Pixels(image), src.x, Pixels(parallel), dst.x, false, &pool, true);
+
+            simdError = std::max(simdError, MaxError(portable, simd));
+            poolError = std::max(poolError, MaxError(portable, parallel));
+        }
+
+        checks.CheckError(std::string(name) + " [simd]", simdError, 0);
+        checks.CheckError(std::string(name) + " [threads]", poolError, 0);
+
+        // A flat translucent color only loses the precision of its premultiplication
+        gfx::Surface flat(300, 200, gfx::Color(200, 100, 50, 128));
+        flat.Resize(97, 161, filter);
+        checks.CheckError(std::string(name) + " [flat]", MaxError(flat, gfx::Surface(97, 161, gfx::Color(200, 100, 50, 128))), 1);
+    }
+
+    // Reducing an even size by two with the box filter is the previous rounded 2x2 average
+    {
+        const gfx::Surface image = NewRandomImage(256, 128, 3, true);
+        const std::vector<gfx::Surface> chain = image.GenerateMipChain();
+        const std::vector<gfx::Surface> previous = OldMipChain(image);
+
+        int error = 0;
+        for (size_t i = 0; i < chain.size(); i++) error = std::max(error, MaxError(chain[i], previous[i]));
+        checks.CheckError("mip chain [2x2 average]", error, 0);
+
+        bool sizes = chain.size() == previous.size();
+        for (size_t i = 0; sizes && i < chain.size(); i++) sizes = chain[i].GetSize() == previous[i].GetSize();
+        checks.Check("mip chain [sizes]", sizes && chain.back().GetSize() == math::IVec2(1, 1));
+    }
+
+    // Opaque red next to transparent green, whose color must not appear in the visible pixels
+    for (const auto& [name, filter] : filters)
+    {
+        gfx::Surface image(64, 64, gfx::Color(0, 255, 0, 0));
+        image.DrawRectangle(0, 0, 32, 64, gfx::Red);
+        image.Resize(40, 40, filter);
+
+        int bleed = 0;
+        for (int y = 0; y < 40; y++)
+        {
+            for (int x = 0; x < 40; x++)
+            {
+                const gfx::Color c = image.GetPixelUnsafe(x, y);
+                if (c.a > 0) bleed = std::max<int>(bleed, c.g);
+            }
+        }
+
+        checks.CheckError(std::string(name) + " [bleeding]", bleed, 0);
+    }
+
+    // The other formats go through RGBA32
+    {
+        gfx::Surface rgba = NewRandomImage(150, 90, 11, true);
+        gfx::Surface argb = rgba.Clone(gfx::PixelFormat::ARGB8888);
+
+        rgba.Resize(61, 200, gfx::ResizeFilter::Bicubic);
+        argb.Resize(61, 200, gfx::ResizeFilter::Bicubic);
+
+        const bool kept = argb.GetPixelFormat() == gfx::PixelFormat::ARGB8888;
+        checks.CheckError(std::string("format") + (kept ? "" : " [not kept]"), kept ? MaxError(rgba, argb) : 256, 0);
+    }
+
+    // Surface::Resize only shares the rows when a worker pool is set, with the same pixels
+    {
+        gfx::Surface serial = NewRandomImage(640, 480, 13, true);
+        gfx::Surface parallel = NewRandomImage(640, 480, 13, true);
+
+        serial.Resize(301, 517, gfx::ResizeFilter::Lanczos);
+
+        gfx::SetWorkerPool(&pool);
+        parallel.Resize(301, 517, gfx::ResizeFilter::Lanczos);
+        gfx::SetWorkerPool(nullptr);
+
+        checks.CheckError("worker pool", MaxError(serial, parallel), 0);
+    }
+
+    return checks.GetExitCode();
+}
+
+int main(int argc, char** argv)
+{
+    const BenchmarkArgs args = ParseBenchmarkArgs(argc, argv, 8);
+    const int count = args.count;
+
+    if (args.IsVerify())
+    {
+        return Verify();
+    }
+
+    const unsigned numThreads = std::thread::hardware_concurrency();
+    const std::unique_ptr<utils::ThreadPool> pool = numThreads > 1 ? std::make_unique<utils::ThreadPool>(numThreads - 1) : nullptr;
+    gfx::SetWorkerPool(pool.get());
+
+    std::cout << std::fixed << std::setprecision(3);
+
+    for (const auto& scenario : scenarios)
+    {
+        if (!args.Selects(scenario.name)) continue;
+
+        const int src = scenario.srcSize, dst = scenario.dstSize;
+        const gfx::Surface image = NewRandomImage(src, src, 5, false);
+
+        std::cout << scenario.name << " (" << src << "x" << src << " -> " << dst << "x" << dst << ")\n";
+
+        if (std::string(scenario.name) == "mip_chain")
+        {
+            std::cout << "    " << std::setw(10) << std::left << "box" << std::setw(10) << "current"
+                      << TimePerCall([&] { image.GenerateMipChain(); }, count) << " ms\n";
+            std::cout << "    " << std::setw(10) << std::left << "2x2" << std::setw(10) << "previous"
+                      << TimePerCall([&] { OldMipChain(image); }, count) << " ms\n";
+            continue;
+        }
+
+        gfx::Surface target(dst, dst);
+
+        for (const auto& [name, resizeFilter] : filters)
+        {
+            const _gfx_impl::Resampler resampler(src, src, dst, dst, resizeFilter);
+
+            auto run = [&](utils::ThreadPool* p, bool simd)
+            {
+                return TimePerCall([&] { resampler.Resample(Pixels(image), src, Pixels(target), dst, false, p, simd); }, count);
+            };
+
+            std::cout << "    " << std::setw(10) << std::left << name << std::setw(10) << "threads" << run(pool.get(), true) << " ms\n";
+            std::cout << "    " << std::setw(10) << std::left << name << std::setw(10) << "simd" << run(nullptr, true) << " ms\n";
+            std::cout << "    " << std::setw(10) << std::left << name << std::setw(10) << "portable" << run(nullptr, false) << " ms\n";
+        }
+    }
+
+    gfx::SetWorkerPool(nullptr);
+
+    return 0;
+}
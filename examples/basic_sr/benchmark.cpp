@@ -0,0 +1,1602 @@
+#include <nexus.hpp>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+using namespace nexus;
+
+/*
+ * Headless benchmark of the software rasterizer.
+ *
+ * Usage: sr_benchmark [scenario] [frames]
+ *        sr_benchmark verify
+ *
+ * Each scenario renders into an offscreen 800x600 framebuffer and reports the average
+ * time per frame, for each rasterization path supported by the CPU, in deferred mode, with
+ * the parallel vertex processing and with both, followed by the number of triangles culled,
+ * clipped or occluded and the number of pixels the triangle rasterizers tested and shaded
+ * per frame.
+ * Without arguments every scenario is run with the default frame count.
+ *
+ * 'verify' renders each scenario once with every supported rasterization path, then in
+ * deferred mode with the lazy clear, then with the parallel vertex processing, and checks
+ * that the pixels and the depth values are identical to the scalar path. It then checks
+ * that a mesh of adjacent triangles covers every pixel exactly once, that multisampling
+ * only changes the pixels along the edges and the intersections of the triangles, and that
+ * the damaged areas reported by the framebuffer contain every pixel changed from one frame
+ * to the next, and that rendering all the scenarios concurrently into offscreen targets
+ * gives the same results.
+ */
+
+constexpr int ScreenWidth = 800;
+constexpr int ScreenHeight = 600;
+
+struct Scenario
+{
+    const char *name;
+    const char *description;
+    std::function<void(sr::Framebuffer&, sr::Context&)> draw;
+};
+
+struct Lcg
+{
+    // Deterministic generator, so that all the runs render exactly the same thing
+    Uint32 state = 12345;
+
+    float Next(float min, float max)
+    {
+        state = state * 1664525u + 1013904223u;
+        return min + (state >> 8) * (1.0f / 16777216.0f) * (max - min);
+    }
+};
+
+void DrawPrimitives2D(sr::Context& ctx)
+{
+    // Same workload as 'primitives_2d.cpp', the six shape groups drawn on one row
+
+    constexpr float s = 80;
+    constexpr float h = 40;
+    constexpr float q = 20;
+    constexpr float y = h + 10;
+
+    float x = h + 10;
+
+    sr::DrawRectangleLines(ctx, x - h, y - h, s, s, gfx::Red);
+    sr::DrawRectangleGradient(ctx, { x - q, y - q, h, h }, gfx::Red, gfx::Green, gfx::Red, gfx::Blue);
+    x += s;
+
+    sr::DrawRectangleRoundedLines(ctx, { x - h, y - h, s, s }, 0.5f, 8, 1,  gfx::Red);
+    sr::DrawRectangleRounded(ctx, { x - q, y - q, h, h }, 0.5f, 8, gfx::Red);
+    x += s;
+
+    sr::DrawPolygonLines(ctx, { x, y }, 8, h, 0, gfx::Red);
+    sr::DrawPolygon(ctx, { x, y }, 6, q, 0, gfx::Red);
+    x += s;
+
+    sr::DrawCircleSector(ctx, { x, y }, h * 0.75f, 0, 270, 36, gfx::Red);
+    sr::DrawCircleSectorLines(ctx, { { x, y }, h }, 0, 270, 36, gfx::Red);
+    x += s;
+
+    sr::DrawPolygonLines(ctx, { x, y }, 3, h, 90.0f, gfx::Red);
+    sr::DrawPolygon(ctx, { x, y }, 3, h, 270.0f, gfx::Red);
+    x += s;
+
+    sr::DrawEllipseLines(ctx, { x, y }, h, q, gfx::Red);
+    sr::DrawEllipse(ctx, { x, y }, q, q*0.5f, gfx::Red);
+
+    sr::DrawLineBezier(ctx, { 10, 590 }, { 790, 550 }, 3, gfx::Red);
+}
+
+void DrawQuadGrid(sr::Context& ctx, bool batched)
+{
+    // 4800 small quads, submitted either as one Begin/End batch or with one Begin/End per quad
+
+    if (batched) ctx.Begin(sr::DrawMode::Quads);
+
+    for (int y = 0; y < ScreenHeight; y += 10)
+    {
+        for (int x = 0; x < ScreenWidth; x += 10)
+        {
+            if (!batched) ctx.Begin(sr::DrawMode::Quads);
+
+            ctx.Color(Uint8(x * 255 / ScreenWidth), Uint8(y * 255 / ScreenHeight), 128);
+            ctx.Vertex(x + 1, y + 1);
+            ctx.Vertex(x + 1, y + 9);
+            ctx.Vertex(x + 9, y + 9);
+            ctx.Vertex(x + 9, y + 1);
+
+            if (!batched) ctx.End();
+        }
+    }
+
+    if (batched) ctx.End();
+}
+
+void DrawTriangles2D(sr::Context& ctx)
+{
+    // 1000 triangles of random sizes with translucent vertex colors
+
+    Lcg rng;
+
+    ctx.Begin(sr::DrawMode::Triangles);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        const float x = rng.Next(0, ScreenWidth), y = rng.Next(0, ScreenHeight);
+        const float size = rng.Next(4, 120);
+
+        for (int j = 0; j < 3; j++)
+        {
+            const float angle = -(j * 120.0f + rng.Next(-30, 30)) * math::Deg2Rad;
+            ctx.Color(Uint8(rng.Next(0, 255)), Uint8(rng.Next(0, 255)), Uint8(rng.Next(0, 255)), Uint8(rng.Next(64, 255)));
+            ctx.Vertex(x + std::cos(angle) * size, y + std::sin(angle) * size);
+        }
+    }
+
+    ctx.End();
+}
+
+void DrawLargeTriangles(sr::Context& ctx)
+{
+    // 20 translucent triangles covering most of the screen
+
+    Lcg rng;
+
+    ctx.Begin(sr::DrawMode::Triangles);
+
+    for (int i = 0; i < 20; i++)
+    {
+        ctx.Color(Uint8(rng.Next(0, 255)), Uint8(rng.Next(0, 255)), Uint8(rng.Next(0, 255)), 96);
+        ctx.Vertex(rng.Next(0, 100), rng.Next(0, 100));
+        ctx.Vertex(rng.Next(0, 300), rng.Next(500, ScreenHeight));
+        ctx.Vertex(rng.Next(700, ScreenWidth), rng.Next(300, ScreenHeight));
+    }
+
+    ctx.End();
+}
+
+void DrawSkinnyTriangles(sr::Context& ctx)
+{
+    // 200 long and thin triangles crossing the screen diagonally, the worst case for bounding box traversal
+
+    Lcg rng;
+
+    ctx.Begin(sr::DrawMode::Triangles);
+
+    for (int i = 0; i < 200; i++)
+    {
+        const float x0 = rng.Next(0, ScreenWidth), y0 = rng.Next(0, ScreenHeight);
+        const float x1 = rng.Next(0, ScreenWidth), y1 = rng.Next(0, ScreenHeight);
+        const float width = rng.Next(1, 4);
+
+        ctx.Color(Uint8(rng.Next(0, 255)), Uint8(rng.Next(0, 255)), Uint8(rng.Next(0, 255)), 255);
+        ctx.Vertex(x0, y0);
+        ctx.Vertex(x1, y1);
+        ctx.Vertex(x1 + width, y1 + width);
+    }
+
+    ctx.End();
+}
+
+void DrawScene3D(sr::Context& ctx)
+{
+    // Grid of cubes and spheres seen in perspective, with depth testing
+
+    const double nearPlane = 0.1, farPlane = 100.0;
+    const double top = nearPlane * std::tan(60.0 * 0.5 * math::Deg2Rad);
+    const double right = top * (static_cast<double>(ScreenWidth) / ScreenHeight);
+
+    ctx.MatrixMode(sr::MatrixMode::Projection);
+    ctx.PushMatrix();
+    ctx.LoadIdentity();
+    ctx.Frustum(-right, right, -top, top, nearPlane, farPlane);
+
+    ctx.MatrixMode(sr::MatrixMode::ModelView);
+    ctx.LoadIdentity();
+    ctx.MultMatrix(math::Mat4::LookAt(math::Vec3(0, 10, -20), math::Vec3(0, 0, 0), math::Vec3(0, 1, 0)));
+
+    ctx.EnableDepthTest();
+
+        for (int z = -2; z <= 2; z++)
+        {
+            for (int x = -3; x <= 3; x++)
+            {
+                const bool cube = (x + z) & 1;
+                const gfx::Color color(Uint8(128 + x * 40), Uint8(128 + z * 50), 200, cube ? 255 : 160);
+
+                if (cube) sr::DrawCube(ctx, { x * 4.0f, 1, z * 4.0f }, { 2.5f, 2.5f, 2.5f }, color);
+                else sr::DrawSphere(ctx, { x * 4.0f, 1.5f, z * 4.0f }, 1.5f, 12, 12, color);
+            }
+        }
+
+        sr::DrawGrid(ctx, 30, 1.0f);
+
+    ctx.DisableDepthTest();
+
+    ctx.MatrixMode(sr::MatrixMode::Projection);
+    ctx.PopMatrix();
+
+    ctx.MatrixMode(sr::MatrixMode::ModelView);
+    ctx.LoadIdentity();
+}
+
+void DrawIntersectingWalls(sr::Context& ctx)
+{
+    // Two opaque walls covering the screen, crossing along a slanted line through its center,
+    // so that their only visible edge is their intersection, resolved by the depth test
+
+    const double nearPlane = 0.1, farPlane = 100.0;
+    const double top = nearPlane * std::tan(60.0 * 0.5 * math::Deg2Rad);
+    const double right = top * (static_cast<double>(ScreenWidth) / ScreenHeight);
+
+    ctx.MatrixMode(sr::MatrixMode::Projection);
+    ctx.PushMatrix();
+    ctx.LoadIdentity();
+    ctx.Frustum(-right, right, -top, top, nearPlane, farPlane);
+
+    ctx.MatrixMode(sr::MatrixMode::ModelView);
+    ctx.LoadIdentity();
+    ctx.MultMatrix(math::Mat4::LookAt(math::Vec3(0, 0, -10), math::Vec3(0, 0, 0), math::Vec3(0, 1, 0)));
+
+    ctx.EnableDepthTest();
+    ctx.Begin(sr::DrawMode::Quads);
+
+        ctx.Color(gfx::Red);
+        ctx.Vertex(-20, -20, 0); ctx.Vertex(-20, 20, 0); ctx.Vertex(20, 20, 0); ctx.Vertex(20, -20, 0);
+
+        ctx.Color(gfx::Blue);
+        ctx.Vertex(-8, -20, -14); ctx.Vertex(-8, 20, -2); ctx.Vertex(8, 20, 14); ctx.Vertex(8, -20, 2);
+
+    ctx.End();
+    ctx.DisableDepthTest();
+
+    ctx.MatrixMode(sr::MatrixMode::Projection);
+    ctx.PopMatrix();
+
+    ctx.MatrixMode(sr::MatrixMode::ModelView);
+    ctx.LoadIdentity();
+}
+
+void DrawDenseSpheres(sr::Context& ctx)
+{
+    // 3x3 spheres of about 18k triangles each, small on screen, so that the vertex processing dominates,
+    // their back faces are drawn too so that the result depends on the order of the triangles
+
+    static const shape3D::Mesh sphere = shape3D::Mesh::Sphere(1.5f, 96, 96);
+
+    const double nearPlane = 0.1, farPlane = 100.0;
+    const double top = nearPlane * std::tan(60.0 * 0.5 * math::Deg2Rad);
+    const double right = top * (static_cast<double>(ScreenWidth) / ScreenHeight);
+
+    ctx.MatrixMode(sr::MatrixMode::Projection);
+    ctx.PushMatrix();
+    ctx.LoadIdentity();
+    ctx.Frustum(-right, right, -top, top, nearPlane, farPlane);
+
+    ctx.MatrixMode(sr::MatrixMode::ModelView);
+    ctx.LoadIdentity();
+    ctx.MultMatrix(math::Mat4::LookAt(math::Vec3(0, 6, -14), math::Vec3(0, 0, 0), math::Vec3(0, 1, 0)));
+
+    ctx.EnableDepthTest();
+    ctx.DisableBackfaceCulling();
+
+        for (int z = -1; z <= 1; z++)
+        {
+            for (int x = -1; x <= 1; x++)
+            {
+                ctx.PushMatrix();
+                ctx.Translate(x * 4.0f, 0, z * 4.0f);
+
+                ctx.Begin(sr::DrawMode::Triangles);
+
+                for (size_t i = 0; i < sphere.indices.size(); i++)
+                {
+                    const Uint16 index = sphere.indices[i];
+                    ctx.Color(gfx::Color(Uint8(128 + x * 60), Uint8(128 + z * 60), Uint8(index * 7), 200));
+                    ctx.Vertex(sphere.positions[index]);
+                }
+
+                ctx.End();
+                ctx.PopMatrix();
+            }
+        }
+
+    ctx.EnableBackfaceCulling();
+    ctx.DisableDepthTest();
+
+    ctx.MatrixMode(sr::MatrixMode::Projection);
+    ctx.PopMatrix();
+
+    ctx.MatrixMode(sr::MatrixMode::ModelView);
+    ctx.LoadIdentity();
+}
+
+void DrawOccludedScene3D(sr::Context& ctx)
+{
+    // Two walls drawn first hide most of the 66 objects behind them, only a gap in the middle shows some
+
+    const double nearPlane = 0.1, farPlane = 100.0;
+    const double top = nearPlane * std::tan(60.0 * 0.5 * math::Deg2Rad);
+    const double right = top * (static_cast<double>(ScreenWidth) / ScreenHeight);
+
+    ctx.MatrixMode(sr::MatrixMode::Projection);
+    ctx.PushMatrix();
+    ctx.LoadIdentity();
+    ctx.Frustum(-right, right, -top, top, nearPlane, farPlane);
+
+    ctx.MatrixMode(sr::MatrixMode::ModelView);
+    ctx.LoadIdentity();
+    ctx.MultMatrix(math::Mat4::LookAt(math::Vec3(0, 2, -12), math::Vec3(0, 2, 0), math::Vec3(0, 1, 0)));
+
+    ctx.EnableDepthTest();
+    ctx.EnableOcclusionCulling();
+
+        sr::DrawCube(ctx, { -6, 2, -2 }, { 8, 12, 0.5f }, gfx::Gray);
+        sr::DrawCube(ctx, { 6, 2, -2 }, { 8, 12, 0.5f }, gfx::Gray);
+
+        for (int z = 0; z < 6; z++)
+        {
+            for (int x = -5; x <= 5; x++)
+            {
+                const gfx::Color color(Uint8(128 + x * 20), Uint8(80 + z * 30), 200, 255);
+
+                if ((x + z) & 1) sr::DrawCube(ctx, { x * 2.0f, 1, z * 3.0f }, { 1.5f, 1.5f, 1.5f }, color);
+                else sr::DrawSphere(ctx, { x * 2.0f, 1.5f, z * 3.0f }, 0.9f, 16, 16, color);
+            }
+        }
+
+    ctx.DisableOcclusionCulling();
+    ctx.DisableDepthTest();
+
+    ctx.MatrixMode(sr::MatrixMode::Projection);
+    ctx.PopMatrix();
+
+    ctx.MatrixMode(sr::MatrixMode::ModelView);
+    ctx.LoadIdentity();
+}
+
+const gfx::Surface& GetTexture()
+{
+    // 256x256 image like the one of 'texture.cpp', generated so that the benchmark needs no resources
+
+    static const gfx::Surface texture = []
+    {
+        gfx::Surface surface(256, 256, gfx::Blank);
+
+        for (int y = 0; y < 256; y++)
+        {
+            for (int x = 0; x < 256; x++)
+            {
+                const bool odd = ((x >> 4) ^ (y >> 4)) & 1;
+                surface.SetPixelUnsafe(x, y, gfx::Color(Uint8(x), Uint8(y), odd ? 255 : 64, 255));
+            }
+        }
+
+        return surface;
+    }();
+
+    return texture;
+}
+
+struct TintShader : sr::Shader
+{
+    // Only overrides the per-fragment entry point, so rows are shaded by the default span implementation
+
+    using sr::Shader::Fragment;
+
+    gfx::Color Fragment(const gfx::Surface* image, const math::IVec2& fragCoord, const math::Vec2& texCoord, const math::Vec3 fragNormal, const gfx::Color& fragColor) override
+    {
+        (void)fragCoord; (void)fragNormal;
+        const gfx::Color texel = image->GetFragUnsafe(texCoord) * fragColor;
+        return gfx::Color(texel.b, texel.g, texel.r, texel.a);
+    }
+};
+
+void DrawTextureFill(sr::Context& ctx, sr::Shader* shader)
+{
+    // Fill rate workload of 'texture.cpp': 10 textured quads covering the whole screen, then the image drawn at its size
+
+    ctx.SetShader(shader);
+    ctx.SetTexture(GetTexture());
+
+    ctx.Begin(sr::DrawMode::Quads);
+
+    for (int i = 0; i < 10; i++)
+    {
+        ctx.Color(gfx::Color(255, 255, 255, i == 0 ? 255 : 128));
+        ctx.TexCoord(0, 0); ctx.Vertex(0, 0);
+        ctx.TexCoord(0, 1); ctx.Vertex(0, ScreenHeight);
+        ctx.TexCoord(1, 1); ctx.Vertex(ScreenWidth, ScreenHeight);
+        ctx.TexCoord(1, 0); ctx.Vertex(ScreenWidth, 0);
+    }
+
+    const float x = (ScreenWidth - 256) / 2, y = (ScreenHeight - 256) / 2;
+
+    ctx.Color(gfx::White);
+    ctx.TexCoord(0, 0); ctx.Vertex(x, y);
+    ctx.TexCoord(0, 1); ctx.Vertex(x, y + 256);
+    ctx.TexCoord(1, 1); ctx.Vertex(x + 256, y + 256);
+    ctx.TexCoord(1, 0); ctx.Vertex(x + 256, y);
+
+    ctx.End();
+
+    ctx.UnsetTexture();
+    ctx.SetShader(nullptr);
+}
+
+const sr::Texture& GetFloorTexture()
+{
+    // 512x512 checkerboard with its mip chain, its context is never used since it is only bound with Context::SetTexture
+
+    static sr::Framebuffer framebuffer(1, 1);
+    static sr::Context ctx(framebuffer);
+
+    static const sr::Texture texture = []
+    {
+        sr::Texture texture(ctx, 512, 512);
+
+        for (int y = 0; y < 512; y++)
+        {
+            for (int x = 0; x < 512; x++)
+            {
+                const bool odd = ((x >> 5) ^ (y >> 5)) & 1;
+                texture->SetPixelUnsafe(x, y, odd ? gfx::Color(230, 230, 230) : gfx::Color(Uint8(x / 2), 40, Uint8(y / 2)));
+            }
+        }
+
+        texture->GenerateMipmaps();
+
+        return texture;
+    }();
+
+    return texture;
+}
+
+void DrawTexturedFloor(sr::Context& ctx, sr::TextureFilter filter, bool mipmaps)
+{
+    // Floor of 32x32 quads extending far away, the texture repeated once per quad and minified with the distance
+
+    const double nearPlane = 0.1, farPlane = 200.0;
+    const double top = nearPlane * std::tan(60.0 * 0.5 * math::Deg2Rad);
+    const double right = top * (static_cast<double>(ScreenWidth) / ScreenHeight);
+
+    ctx.MatrixMode(sr::MatrixMode::Projection);
+    ctx.PushMatrix();
+    ctx.LoadIdentity();
+    ctx.Frustum(-right, right, -top, top, nearPlane, farPlane);
+
+    ctx.MatrixMode(sr::MatrixMode::ModelView);
+    ctx.LoadIdentity();
+    ctx.MultMatrix(math::Mat4::LookAt(math::Vec3(0, 3, -40), math::Vec3(0, 0, 0), math::Vec3(0, 1, 0)));
+
+    const sr::Texture &texture = GetFloorTexture();
+
+    sr::TextureSampler sampler = texture->GetSampler();
+    sampler.filter = filter;
+    if (!mipmaps) sampler.mipmaps = nullptr, sampler.mipmapCount = 0;
+
+    ctx.EnableDepthTest();
+    ctx.SetTexture(texture, sampler);
+
+    ctx.Begin(sr::DrawMode::Quads);
+    ctx.Color(gfx::White);
+
+    for (int z = -16; z < 16; z++)
+    {
+        for (int x = -16; x < 16; x++)
+        {
+            const float x0 = x * 4.0f, z0 = z * 4.0f, x1 = x0 + 4.0f, z1 = z0 + 4.0f;
+
+            ctx.TexCoord(0, 0); ctx.Vertex(x0, 0, z0);
+            ctx.TexCoord(0, 1); ctx.Vertex(x0, 0, z1);
+            ctx.TexCoord(1, 1); ctx.Vertex(x1, 0, z1);
+            ctx.TexCoord(1, 0); ctx.Vertex(x1, 0, z0);
+        }
+    }
+
+    ctx.End();
+
+    ctx.UnsetTexture();
+    ctx.DisableDepthTest();
+
+    ctx.MatrixMode(sr::MatrixMode::Projection);
+    ctx.PopMatrix();
+
+    ctx.MatrixMode(sr::MatrixMode::ModelView);
+    ctx.LoadIdentity();
+}
+
+void DrawFloorQuads(sr::Context& ctx, int quadsPerSide)
+{
+    // Floor of 64x64 units textured once with the checkerboard, nearest sampled, split in quadsPerSide x quadsPerSide quads
+    // A single quad gives two large triangles whose texture coordinates vary the most with the perspective
+
+    const double nearPlane = 0.1, farPlane = 200.0;
+    const double top = nearPlane * std::tan(60.0 * 0.5 * math::Deg2Rad);
+    const double right = top * (static_cast<double>(ScreenWidth) / ScreenHeight);
+
+    ctx.MatrixMode(sr::MatrixMode::Projection);
+    ctx.PushMatrix();
+    ctx.LoadIdentity();
+    ctx.Frustum(-right, right, -top, top, nearPlane, farPlane);
+
+    ctx.MatrixMode(sr::MatrixMode::ModelView);
+    ctx.LoadIdentity();
+    ctx.MultMatrix(math::Mat4::LookAt(math::Vec3(0, 3, -40), math::Vec3(0, 0, 0), math::Vec3(0, 1, 0)));
+
+    const sr::Texture &texture = GetFloorTexture();
+
+    sr::TextureSampler sampler = texture->GetSampler();
+    sampler.filter = sr::TextureFilter::Nearest;
+    sampler.mipmaps = nullptr, sampler.mipmapCount = 0;
+
+    ctx.EnableDepthTest();
+    ctx.SetTexture(texture, sampler);
+
+    ctx.Begin(sr::DrawMode::Quads);
+    ctx.Color(gfx::White);
+
+    const float size = 64.0f / quadsPerSide, step = 1.0f / quadsPerSide;
+
+    for (int z = 0; z < quadsPerSide; z++)
+    {
+        for (int x = 0; x < quadsPerSide; x++)
+        {
+            const float x0 = x * size - 32.0f, z0 = z * size - 32.0f, x1 = x0 + size, z1 = z0 + size;
+            const float u0 = x * step, v0 = z * step, u1 = u0 + step, v1 = v0 + step;
+
+            ctx.TexCoord(u0, v0); ctx.Vertex(x0, 0, z0);
+            ctx.TexCoord(u0, v1); ctx.Vertex(x0, 0, z1);
+            ctx.TexCoord(u1, v1); ctx.Vertex(x1, 0, z1);
+            ctx.TexCoord(u1, v0); ctx.Vertex(x1, 0, z0);
+        }
+    }
+
+    ctx.End();
+
+    ctx.UnsetTexture();
+    ctx.DisableDepthTest();
+
+    ctx.MatrixMode(sr::MatrixMode::Projection);
+    ctx.PopMatrix();
+
+    ctx.MatrixMode(sr::MatrixMode::ModelView);
+    ctx.LoadIdentity();
+}
+
+const sr::Texture& GetLargeTexture(sr::TextureLayout layout)
+{
+    // 1024x1024 noisy texture, too large for the caches, in both layouts
+
+    static sr::Framebuffer framebuffer(1, 1);
+    static sr::Context ctx(framebuffer);
+
+    const auto generate = [](sr::TextureLayout layout)
+    {
+        sr::Texture texture(ctx, 1024, 1024);
+        Lcg rng;
+
+        for (int y = 0; y < 1024; y++)
+        {
+            for (int x = 0; x < 1024; x++)
+            {
+                texture->SetPixelUnsafe(x, y, gfx::Color(Uint8(x / 4), Uint8(y / 4), Uint8(rng.Next(0, 255))));
+            }
+        }
+
+        texture->SetLayout(layout);
+
+        return texture;
+    };
+
+    static const sr::Texture linear = generate(sr::TextureLayout::Linear);
+    static const sr::Texture tiled = generate(sr::TextureLayout::Tiled);
+
+    return layout == sr::TextureLayout::Tiled ? tiled : linear;
+}
+
+void DrawRotatedQuads(sr::Context& ctx, sr::TextureLayout layout)
+{
+    // 8 quads covering the screen, rotated so that the texture is walked across its rows,
+    // with about one texel per pixel
+
+    const sr::Texture &texture = GetLargeTexture(layout);
+
+    ctx.SetTexture(texture, texture->GetSampler());
+
+    for (int i = 0; i < 8; i++)
+    {
+        ctx.PushMatrix();
+        ctx.Translate(ScreenWidth / 2, ScreenHeight / 2);
+        ctx.Rotate(90.0f + i * 22.5f);
+
+        ctx.Begin(sr::DrawMode::Quads);
+        ctx.Color(gfx::Color(255, 255, 255, i == 0 ? 255 : 160));
+        ctx.TexCoord(0, 0); ctx.Vertex(-512, -512);
+        ctx.TexCoord(0, 1); ctx.Vertex(-512, 512);
+        ctx.TexCoord(1, 1); ctx.Vertex(512, 512);
+        ctx.TexCoord(1, 0); ctx.Vertex(512, -512);
+        ctx.End();
+
+        ctx.PopMatrix();
+    }
+
+    ctx.UnsetTexture();
+}
+
+void DrawJitteredMesh(sr::Context& ctx)
+{
+    // Grid of 40x30 cells covering exactly the screen, whose inner vertices are moved randomly by up to 0.2 cell,
+    // each cell being split into two triangles along one of its diagonals, with a translucent color
+
+    constexpr int cellsX = 40, cellsY = 30;
+    constexpr float cellW = float(ScreenWidth) / cellsX, cellH = float(ScreenHeight) / cellsY;
+
+    static const std::vector<math::Vec2> vertices = []
+    {
+        std::vector<math::Vec2> vertices;
+        Lcg rng;
+
+        for (int y = 0; y <= cellsY; y++)
+        {
+            for (int x = 0; x <= cellsX; x++)
+            {
+                math::Vec2 v(x * cellW, y * cellH);
+
+                if (x > 0 && x < cellsX) v.x += rng.Next(-0.2f, 0.2f) * cellW;
+                if (y > 0 && y < cellsY) v.y += rng.Next(-0.2f, 0.2f) * cellH;
+
+                vertices.push_back(v);
+            }
+        }
+
+        return vertices;
+    }();
+
+    const auto vertex = [&ctx](const math::Vec2& v) { ctx.Vertex(v.x, v.y); };
+
+    ctx.Begin(sr::DrawMode::Triangles);
+    ctx.Color(gfx::Color(255, 255, 255, 127));
+
+    for (int y = 0; y < cellsY; y++)
+    {
+        for (int x = 0; x < cellsX; x++)
+        {
+            const math::Vec2 &v00 = vertices[y * (cellsX + 1) + x], &v10 = vertices[y * (cellsX + 1) + x + 1];
+            const math::Vec2 &v01 = vertices[(y + 1) * (cellsX + 1) + x], &v11 = vertices[(y + 1) * (cellsX + 1) + x + 1];
+
+            if ((x + y) & 1)
+            {
+                vertex(v00); vertex(v01); vertex(v11);
+                vertex(v00); vertex(v11); vertex(v10);
+            }
+            else
+            {
+                vertex(v00); vertex(v01); vertex(v10);
+                vertex(v10); vertex(v01); vertex(v11);
+            }
+        }
+    }
+
+    ctx.End();
+}
+
+const Scenario scenarios[] = {
+
+    { "primitives_2d", "'primitives_2d.cpp' workload (x100 per frame)",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Black);
+            for (int i = 0; i < 100; i++) DrawPrimitives2D(ctx);
+        }
+    },
+
+    { "quads_per_primitive", "4800 quads, one Begin/End per quad",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Black);
+            DrawQuadGrid(ctx, false);
+        }
+    },
+
+    { "quads_batched", "4800 quads, a single Begin/End batch",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Black);
+            DrawQuadGrid(ctx, true);
+        }
+    },
+
+    { "triangles_2d", "1000 translucent triangles of random sizes",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Black);
+            DrawTriangles2D(ctx);
+        }
+    },
+
+    { "triangles_2d_msaa", "Same as 'triangles_2d' with 4 samples per pixel",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.SetSampleCount(sr::Framebuffer::MaxSamples);
+            fb.Clear(gfx::Black);
+            DrawTriangles2D(ctx);
+        }
+    },
+
+    { "large_triangles", "20 translucent triangles covering most of the screen",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Black);
+            DrawLargeTriangles(ctx);
+        }
+    },
+
+    { "skinny_triangles", "200 long and thin triangles crossing the screen",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Black);
+            DrawSkinnyTriangles(ctx);
+        }
+    },
+
+    { "jittered_mesh", "2400 triangles of a jittered grid covering the screen exactly once",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Blank);
+            DrawJitteredMesh(ctx);
+        }
+    },
+
+    { "scene_3d", "35 cubes and spheres in perspective with depth testing",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Black);
+            DrawScene3D(ctx);
+        }
+    },
+
+    { "occluded_3d", "66 objects mostly hidden behind two walls, with occlusion culling",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Black);
+            DrawOccludedScene3D(ctx);
+        }
+    },
+
+    { "dense_spheres", "9 translucent spheres of 18k triangles each, in perspective with depth testing",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Black);
+            DrawDenseSpheres(ctx);
+        }
+    },
+
+    { "scene_3d_msaa", "Same as 'scene_3d' with 4 samples per pixel",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.SetSampleCount(sr::Framebuffer::MaxSamples);
+            fb.Clear(gfx::Black);
+            DrawScene3D(ctx);
+        }
+    },
+
+    { "scene_3d_unorm16", "Same as 'scene_3d' with a 16-bit depth buffer",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.SetDepthFormat(sr::DepthFormat::Unorm16);
+            fb.Clear(gfx::Black);
+            DrawScene3D(ctx);
+        }
+    },
+
+    { "scene_3d_reversed", "Same as 'scene_3d' with a reversed float depth buffer",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.SetDepthFormat(sr::DepthFormat::ReversedFloat32);
+            fb.Clear(gfx::Black);
+            DrawScene3D(ctx);
+        }
+    },
+
+    { "occluded_3d_unorm16", "Same as 'occluded_3d' with a 16-bit depth buffer",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.SetDepthFormat(sr::DepthFormat::Unorm16);
+            fb.Clear(gfx::Black);
+            DrawOccludedScene3D(ctx);
+        }
+    },
+
+    { "texture_fill", "'texture.cpp' workload, 10 full screen textured quads and the image (default shader)",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::White);
+            DrawTextureFill(ctx, nullptr);
+        }
+    },
+
+    { "texture_fill_shader", "Same as 'texture_fill' with a custom fragment shader",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            static TintShader shader;
+            fb.Clear(gfx::White);
+            DrawTextureFill(ctx, &shader);
+        }
+    },
+
+    { "floor_nearest", "Textured floor of 2048 triangles, nearest sampling of the full size texture",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Black);
+            DrawTexturedFloor(ctx, sr::TextureFilter::Nearest, false);
+        }
+    },
+
+    { "floor_mipmapped", "Same as 'floor_nearest' with mipmaps",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Black);
+            DrawTexturedFloor(ctx, sr::TextureFilter::Nearest, true);
+        }
+    },
+
+    { "floor_bilinear", "Same as 'floor_nearest' with mipmaps and bilinear filtering",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Black);
+            DrawTexturedFloor(ctx, sr::TextureFilter::Bilinear, true);
+        }
+    },
+
+    { "floor_trilinear", "Same as 'floor_nearest' with mipmaps and trilinear filtering",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Black);
+            DrawTexturedFloor(ctx, sr::TextureFilter::Trilinear, true);
+        }
+    },
+
+    { "floor_single_quad", "Floor of a single textured quad in perspective, two large triangles (nearest sampling)",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Black);
+            DrawFloorQuads(ctx, 1);
+        }
+    },
+
+    { "rotated_linear", "8 rotated quads covering the screen with a 1024x1024 texture in the linear layout",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Black);
+            DrawRotatedQuads(ctx, sr::TextureLayout::Linear);
+        }
+    },
+
+    { "rotated_tiled", "Same as 'rotated_linear' with the texture in the tiled layout",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Black);
+            DrawRotatedQuads(ctx, sr::TextureLayout::Tiled);
+        }
+    },
+
+    { "clear", "Clear of the framebuffer alone",
+        [](sr::Framebuffer& fb, sr::Context&)
+        {
+            fb.Clear(gfx::Black);
+        }
+    },
+
+    { "hud_eager", "'primitives_2d.cpp' workload drawn once over the top of the screen",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.Clear(gfx::Black);
+            DrawPrimitives2D(ctx);
+        }
+    },
+
+    { "hud_lazy", "Same as 'hud_eager' with the lazy clear of the framebuffer",
+        [](sr::Framebuffer& fb, sr::Context& ctx)
+        {
+            fb.SetLazyClear(true);
+            fb.Clear(gfx::Black);
+            DrawPrimitives2D(ctx);
+        }
+    },
+};
+
+const std::pair<sr::SimdPath, const char*> simdPaths[] = {
+    { sr::SimdPath::Scalar, "scalar" },
+    { sr::SimdPath::SSE2, "sse2" },
+    { sr::SimdPath::AVX2, "avx2" },
+    { sr::SimdPath::NEON, "neon" },
+};
+
+double RunScenario(const Scenario& scenario, int frames, int deferredThreads, int vertexThreads = -1)
+{
+    sr::Framebuffer framebuffer(ScreenWidth, ScreenHeight);
+    sr::Context ctx(framebuffer);
+    ctx.SetViewport(0, 0, ScreenWidth, ScreenHeight);
+
+    if (deferredThreads >= 0)
+    {
+        ctx.EnableDeferredRendering(deferredThreads);
+    }
+
+    if (vertexThreads >= 0)
+    {
+        ctx.EnableParallelVertexProcessing(vertexThreads);
+    }
+
+    scenario.draw(framebuffer, ctx);    // Warm-up
+    ctx.Flush();
+    framebuffer.End();
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // The pending clears are applied and the samples resolved as before presenting each frame
+    for (int i = 0; i < frames; i++)
+    {
+        scenario.draw(framebuffer, ctx);
+        ctx.Flush();
+        framebuffer.End();
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - start).count() / frames;
+}
+
+sr::PipelineStats RenderStats(const Scenario& scenario)
+{
+    sr::Framebuffer framebuffer(ScreenWidth, ScreenHeight);
+    sr::Context ctx(framebuffer);
+    ctx.SetViewport(0, 0, ScreenWidth, ScreenHeight);
+
+    scenario.draw(framebuffer, ctx);
+    ctx.Flush();
+
+    return ctx.GetStats();
+}
+
+Uint64 HashFramebuffer(const sr::Framebuffer& framebuffer)
+{
+    // FNV-1a over the pixels and the depth values of every sample
+    Uint64 hash = 14695981039346656037ull;
+
+    auto feed = [&hash](const void* data, size_t size)
+    {
+        const Uint8 *bytes = static_cast<const Uint8*>(data);
+        for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 1099511628211ull;
+    };
+
+    feed(framebuffer.GetPixels(), framebuffer.GetWidth() * framebuffer.GetHeight() * framebuffer.GetBytesPerPixel());
+
+    for (int s = 0; s < framebuffer.GetSampleCount(); s++)
+    {
+        feed(framebuffer.GetDepthData(s), framebuffer.GetWidth() * framebuffer.GetHeight() * framebuffer.GetDepthBytesPerPixel());
+    }
+
+    return hash;
+}
+
+Uint64 RenderChecksum(const Scenario& scenario, bool lazyClear = false, int deferredThreads = -1, int vertexThreads = -1)
+{
+    sr::Framebuffer framebuffer(ScreenWidth, ScreenHeight);
+    sr::Context ctx(framebuffer);
+    ctx.SetViewport(0, 0, ScreenWidth, ScreenHeight);
+
+    if (deferredThreads >= 0)
+    {
+        ctx.EnableDeferredRendering(deferredThreads);
+    }
+
+    if (vertexThreads >= 0)
+    {
+        ctx.EnableParallelVertexProcessing(vertexThreads);
+    }
+
+    // With lazy clear, a first frame is rendered so that the second one reuses its cleared tiles
+    framebuffer.SetLazyClear(lazyClear);
+
+    for (int i = 0; i < (lazyClear ? 2 : 1); i++)
+    {
+        scenario.draw(framebuffer, ctx);
+        ctx.Flush();
+        framebuffer.End();
+    }
+
+    return HashFramebuffer(framebuffer);
+}
+
+int CountBatchMismatches()
+{
+    std::vector<Uint64> hashes(std::size(scenarios));
+
+    // The targets are reused from one scenario to the next, so their settings are reset first
+    sr::OffscreenBatch batch(ScreenWidth, ScreenHeight, 4);
+
+    batch.Render(static_cast<int>(hashes.size()),
+        [](sr::Offscreen& target, int index)
+        {
+            target.GetFramebuffer().SetSampleCount(1);
+            target.GetFramebuffer().SetLazyClear(false);
+            target.GetFramebuffer().SetDepthFormat(sr::DepthFormat::Float32);
+            scenarios[index].draw(target.GetFramebuffer(), target.GetContext());
+        },
+        [&hashes](const sr::Framebuffer& result, int index)
+        {
+            hashes[index] = HashFramebuffer(result);
+        });
+
+    int mismatches = 0;
+
+    for (size_t i = 0; i < hashes.size(); i++)
+    {
+        mismatches += hashes[i] != RenderChecksum(scenarios[i]);
+    }
+
+    return mismatches;
+}
+
+int CountCoverageErrors(int deferredThreads)
+{
+    // Blended once over a blank framebuffer, the translucent white of the mesh gives about 127,
+    // against 0 for a missed pixel and about 191 for a pixel covered twice
+
+    sr::Framebuffer framebuffer(ScreenWidth, ScreenHeight);
+    sr::Context ctx(framebuffer);
+    ctx.SetViewport(0, 0, ScreenWidth, ScreenHeight);
+
+    if (deferredThreads >= 0)
+    {
+        ctx.EnableDeferredRendering(deferredThreads);
+    }
+
+    framebuffer.Clear(gfx::Blank);
+    DrawJitteredMesh(ctx);
+    ctx.Flush();
+
+    int errors = 0;
+
+    for (int y = 0; y < ScreenHeight; y++)
+    {
+        for (int x = 0; x < ScreenWidth; x++)
+        {
+            const Uint8 value = framebuffer.GetPixelUnsafe(x, y).r;
+            errors += value < 64 || value > 160;
+        }
+    }
+
+    return errors;
+}
+
+int CountPerspectiveErrors(int& floorPixels)
+{
+    // The floor drawn as a single quad must look the same as when split into 16x16 quads, which is only
+    // the case if the texture coordinates are interpolated with the perspective, a few texels at the
+    // borders of the checkerboard squares may still differ because of the rounding
+
+    sr::Framebuffer single(ScreenWidth, ScreenHeight), split(ScreenWidth, ScreenHeight);
+
+    for (auto [framebuffer, quadsPerSide] : { std::make_pair(&single, 1), std::make_pair(&split, 16) })
+    {
+        sr::Context ctx(*framebuffer);
+        ctx.SetViewport(0, 0, ScreenWidth, ScreenHeight);
+
+        framebuffer->Clear(gfx::Blank);
+        DrawFloorQuads(ctx, quadsPerSide);
+        ctx.Flush();
+    }
+
+    const gfx::Color *a = static_cast<const gfx::Color*>(single.GetPixels());
+    const gfx::Color *b = static_cast<const gfx::Color*>(split.GetPixels());
+
+    int errors = 0;
+    floorPixels = 0;
+
+    for (int i = 0; i < ScreenWidth * ScreenHeight; i++)
+    {
+        floorPixels += a[i].a != 0;
+        errors += std::abs(a[i].r - b[i].r) > 8 || std::abs(a[i].g - b[i].g) > 8 || std::abs(a[i].b - b[i].b) > 8;
+    }
+
+    return errors;
+}
+
+int CountClippingErrors()
+{
+    // A 2D triangle far larger than the screen must cover all of it (the interpolated color may be off
+    // by a few units over such an area, only the coverage is checked), and 2D lines crossing the edges
+    // of a viewport smaller than the framebuffer must stop at its last column and row
+
+    int errors = 0;
+
+    {
+        sr::Framebuffer framebuffer(ScreenWidth, ScreenHeight);
+        sr::Context ctx(framebuffer);
+        ctx.SetViewport(0, 0, ScreenWidth, ScreenHeight);
+
+        framebuffer.Clear(gfx::Blank);
+
+        ctx.Begin(sr::DrawMode::Triangles);
+        ctx.Color(gfx::White);
+        ctx.Vertex(-40000, -40000);
+        ctx.Vertex(-40000, 120000);
+        ctx.Vertex(120000, -40000);
+        ctx.End();
+        ctx.Flush();
+
+        for (int y = 0; y < ScreenHeight; y++)
+        {
+            for (int x = 0; x < ScreenWidth; x++)
+            {
+                errors += framebuffer.GetPixelUnsafe(x, y) == gfx::Blank;
+            }
+        }
+    }
+
+    {
+        constexpr int ViewportWidth = 200, ViewportHeight = 100;
+
+        sr::Framebuffer framebuffer(ScreenWidth, ScreenHeight);
+        sr::Context ctx(framebuffer);
+        ctx.SetViewport(0, 0, ViewportWidth, ViewportHeight);
+
+        framebuffer.Clear(gfx::Blank);
+
+        ctx.Begin(sr::DrawMode::Lines);
+        ctx.Color(gfx::White);
+        ctx.Vertex(-50, 50), ctx.Vertex(400, 50);
+        ctx.Vertex(150, -30), ctx.Vertex(150, 500);
+        ctx.Vertex(-10, -10), ctx.Vertex(500, 300);
+        ctx.End();
+        ctx.Flush();
+
+        for (int y = 0; y < ScreenHeight; y++)
+        {
+            for (int x = 0; x < ScreenWidth; x++)
+            {
+                const bool outside = x >= ViewportWidth || y >= ViewportHeight;
+                errors += outside && framebuffer.GetPixelUnsafe(x, y) != gfx::Blank;
+            }
+        }
+
+        // The lines still reach the last column and row of the viewport
+        errors += framebuffer.GetPixelUnsafe(ViewportWidth - 1, 50) != gfx::White;
+        errors += framebuffer.GetPixelUnsafe(150, ViewportHeight - 1) != gfx::White;
+    }
+
+    // With a viewport away from the origin, the triangles, clipped or not, and the lines must all stop
+    // at the same last column and row, the 2D coordinates still being those of the framebuffer
+    for (const float size : { 1000.0f, 40000.0f, 0.0f })
+    {
+        constexpr int ViewportX = 100, ViewportY = 50, ViewportWidth = 200, ViewportHeight = 100;
+
+        sr::Framebuffer framebuffer(ScreenWidth, ScreenHeight);
+        sr::Context ctx(framebuffer);
+        ctx.SetViewport(ViewportX, ViewportY, ViewportWidth, ViewportHeight);
+
+        framebuffer.Clear(gfx::Blank);
+
+        const bool lines = size == 0.0f;
+
+        ctx.Begin(lines ? sr::DrawMode::Lines : sr::DrawMode::Triangles);
+        ctx.Color(gfx::White);
+
+        if (lines)
+        {
+            ctx.Vertex(-50, 100), ctx.Vertex(900, 100);
+            ctx.Vertex(200, -30), ctx.Vertex(200, 700);
+        }
+        else
+        {
+            ctx.Vertex(-size, -size);
+            ctx.Vertex(-size, 3 * size);
+            ctx.Vertex(3 * size, -size);
+        }
+
+        ctx.End();
+        ctx.Flush();
+
+        for (int y = 0; y < ScreenHeight; y++)
+        {
+            for (int x = 0; x < ScreenWidth; x++)
+            {
+                const bool inside = x >= ViewportX && x < ViewportX + ViewportWidth && y >= ViewportY && y < ViewportY + ViewportHeight;
+                const bool covered = framebuffer.GetPixelUnsafe(x, y) != gfx::Blank;
+                errors += inside ? (!lines && !covered) : covered;
+            }
+        }
+
+        if (lines)
+        {
+            errors += framebuffer.GetPixelUnsafe(ViewportX, 100) != gfx::White;
+            errors += framebuffer.GetPixelUnsafe(ViewportX + ViewportWidth - 1, 100) != gfx::White;
+            errors += framebuffer.GetPixelUnsafe(200, ViewportY) != gfx::White;
+            errors += framebuffer.GetPixelUnsafe(200, ViewportY + ViewportHeight - 1) != gfx::White;
+        }
+    }
+
+    return errors;
+}
+
+int CountDepthAccessErrors()
+{
+    // Depths written and read through the accessors of the buffer come back in every format,
+    // up to the precision of the stored keys, and are written in every sample
+
+    int errors = 0;
+
+    for (const sr::DepthFormat format : { sr::DepthFormat::Float32, sr::DepthFormat::ReversedFloat32, sr::DepthFormat::Unorm16 })
+    {
+        sr::DepthBuffer depth(8, 8, format);
+        depth.SetSampleCount(2);
+
+        depth.Get(3, 5) = 0.25f;
+        depth.Get(7) = -0.5f;
+
+        const float tolerance = format == sr::DepthFormat::Unorm16 ? 1.0f / sr::DepthBuffer::Unorm16Scale : 0.0f;
+
+        errors += std::abs(depth.Get(3, 5) - 0.25f) > tolerance;
+        errors += std::abs(static_cast<const sr::DepthBuffer&>(depth).Get(7) + 0.5f) > tolerance;
+        errors += depth.GetKey(depth.GetPlaneSize() + 5 * 8 + 3) != depth.Encode(0.25f);
+    }
+
+    return errors;
+}
+
+int CountDepthCollisions(sr::DepthFormat format)
+{
+    // Two parallel quads covering the screen far from the eye, 5 mm apart at 500 m: the farther one, drawn
+    // last, only shows where the depths of both quads round to the same value
+
+    sr::Framebuffer framebuffer(ScreenWidth, ScreenHeight);
+    sr::Context ctx(framebuffer);
+    ctx.SetViewport(0, 0, ScreenWidth, ScreenHeight);
+
+    framebuffer.SetDepthFormat(format);
+    framebuffer.Clear(gfx::Blank);
+
+    const double nearPlane = 0.1, farPlane = 1000.0;
+    const double top = nearPlane * std::tan(60.0 * 0.5 * math::Deg2Rad);
+    const double right = top * (static_cast<double>(ScreenWidth) / ScreenHeight);
+
+    ctx.MatrixMode(sr::MatrixMode::Projection);
+    ctx.LoadIdentity();
+    ctx.Frustum(-right, right, -top, top, nearPlane, farPlane);
+
+    ctx.MatrixMode(sr::MatrixMode::ModelView);
+    ctx.LoadIdentity();
+
+    ctx.EnableDepthTest();
+    ctx.Begin(sr::DrawMode::Quads);
+
+        for (const auto& [color, z] : { std::make_pair(gfx::Green, -500.0f), std::make_pair(gfx::Red, -500.005f) })
+        {
+            ctx.Color(color);
+            ctx.Vertex(-600, -600, z); ctx.Vertex(600, -600, z); ctx.Vertex(600, 600, z); ctx.Vertex(-600, 600, z);
+        }
+
+    ctx.End();
+    ctx.Flush();
+
+    int collisions = 0;
+
+    for (int y = 0; y < ScreenHeight; y++)
+    {
+        for (int x = 0; x < ScreenWidth; x++)
+        {
+            collisions += framebuffer.GetPixelUnsafe(x, y) == gfx::Red;
+        }
+    }
+
+    return collisions;
+}
+
+bool CheckDrawModeChange()
+{
+    // Switching the draw mode with an incomplete primitive pending must be refused rather than
+    // dropping it, and must be accepted once the batch has been reset
+
+    sr::Pipeline pipeline;
+    pipeline.AddVertex(sr::DrawMode::Triangles, {}, {}, {}, gfx::White);
+
+    try
+    {
+        pipeline.AddVertex(sr::DrawMode::Lines, {}, {}, {}, gfx::White);
+        return false;
+    }
+    catch (const core::NexusException&) { }
+
+    pipeline.Reset();
+
+    return !pipeline.AddVertex(sr::DrawMode::Lines, {}, {}, {}, gfx::White);
+}
+
+int CountMultisampleErrors(int& edgePixels, int& mixedPixels)
+{
+    // With 4 samples per pixel, only the pixels around the edges of the triangles may differ from the
+    // rendering with one sample. The only edge of the walls being their intersection, its pixels only
+    // get a blend of both colors if the depth test is done for each sample
+
+    int errors = 0;
+    edgePixels = mixedPixels = 0;
+
+    for (const bool walls : { true, false })
+    {
+        sr::Framebuffer single(ScreenWidth, ScreenHeight), multi(ScreenWidth, ScreenHeight);
+        multi.SetSampleCount(sr::Framebuffer::MaxSamples);
+
+        for (sr::Framebuffer *framebuffer : { &single, &multi })
+        {
+            sr::Context ctx(*framebuffer);
+            ctx.SetViewport(0, 0, ScreenWidth, ScreenHeight);
+
+            framebuffer->Clear(gfx::Black);
+            if (walls) DrawIntersectingWalls(ctx);
+            else DrawTriangles2D(ctx);
+            ctx.Flush();
+
+            framebuffer->End();
+        }
+
+        for (int y = 0; y < ScreenHeight; y++)
+        {
+            for (int x = 0; x < ScreenWidth; x++)
+            {
+                // The triangles sharing an edge may round their colors differently, a few units apart
+                const gfx::Color color = multi.GetPixelUnsafe(x, y), reference = single.GetPixelUnsafe(x, y);
+                if (std::abs(color.r - reference.r) <= 2 && std::abs(color.g - reference.g) <= 2 && std::abs(color.b - reference.b) <= 2) continue;
+
+                mixedPixels += walls && color.r > 32 && color.b > 32;
+
+                // Pixels whose neighbors all have the same color with one sample are entirely inside a triangle
+                bool edge = false;
+
+                for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, ScreenHeight - 1); ny++)
+                {
+                    for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, ScreenWidth - 1); nx++)
+                    {
+                        edge |= single.GetPixelUnsafe(nx, ny) != reference;
+                    }
+                }
+
+                errors += !edge;
+                edgePixels += edge;
+            }
+        }
+    }
+
+    return errors;
+}
+
+int CountUndamagedChanges(bool lazyClear, int deferredThreads, float& damagedRatio)
+{
+    // A frame with the 2D primitives at the top is followed by one with the primitives lower on the screen,
+    // every pixel that differs between the two frames must be within the damaged areas of the second one
+
+    sr::Framebuffer framebuffer(ScreenWidth, ScreenHeight);
+    sr::Context ctx(framebuffer);
+    ctx.SetViewport(0, 0, ScreenWidth, ScreenHeight);
+
+    if (deferredThreads >= 0)
+    {
+        ctx.EnableDeferredRendering(deferredThreads);
+    }
+
+    framebuffer.SetLazyClear(lazyClear);
+
+    framebuffer.Clear(gfx::Black);
+    DrawPrimitives2D(ctx);
+    ctx.Flush();
+    framebuffer.ApplyPendingClear();
+
+    const std::vector<gfx::Color> previous(static_cast<const gfx::Color*>(framebuffer.GetPixels()),
+        static_cast<const gfx::Color*>(framebuffer.GetPixels()) + ScreenWidth * ScreenHeight);
+
+    framebuffer.ResetDamage();
+
+    framebuffer.Clear(gfx::Black);
+    ctx.PushMatrix();
+    ctx.Translate(0, 300);
+    DrawPrimitives2D(ctx);
+    ctx.PopMatrix();
+    ctx.Flush();
+    framebuffer.ApplyPendingClear();
+
+    std::vector<shape2D::Rectangle> rects;
+    framebuffer.GetDamagedRects(rects);
+
+    std::vector<Uint8> damaged(ScreenWidth * ScreenHeight, 0);
+    int damagedPixels = 0;
+
+    for (const auto& rect : rects)
+    {
+        for (int y = rect.y; y < rect.y + rect.h; y++)
+        {
+            for (int x = rect.x; x < rect.x + rect.w; x++)
+            {
+                damagedPixels += !damaged[y * ScreenWidth + x];     // Rectangles must not overlap, but just in case
+                damaged[y * ScreenWidth + x] = 1;
+            }
+        }
+    }
+
+    damagedRatio = float(damagedPixels) / (ScreenWidth * ScreenHeight);
+
+    int errors = 0;
+
+    for (int i = 0; i < ScreenWidth * ScreenHeight; i++)
+    {
+        const gfx::Color pixel = static_cast<const gfx::Color*>(framebuffer.GetPixels())[i];
+        errors += !damaged[i] && (pixel.r != previous[i].r || pixel.g != previous[i].g || pixel.b != previous[i].b || pixel.a != previous[i].a);
+    }
+
+    return errors;
+}
+
+int Verify()
+{
+    const sr::SimdPath defaultPath = sr::GetSimdPath();
+    int failures = 0;
+
+    for (const auto& scenario : scenarios)
+    {
+        sr::SetSimdPath(sr::SimdPath::Scalar);
+        const Uint64 reference = RenderChecksum(scenario);
+
+        for (const auto& [path, name] : simdPaths)
+        {
+            if (path == sr::SimdPath::Scalar || !sr::SetSimdPath(path)) continue;
+
+            const bool identical = RenderChecksum(scenario) == reference;
+            std::cout << scenario.name << " [" << name << "]: " << (identical ? "OK" : "MISMATCH") << "\n";
+            failures += !identical;
+        }
+
+        // Clearing the tiles lazily, concurrently in deferred mode, must not change the result
+        sr::SetSimdPath(defaultPath);
+
+        const bool identical = RenderChecksum(scenario, true, 0) == reference;
+        std::cout << scenario.name << " [lazy clear]: " << (identical ? "OK" : "MISMATCH") << "\n";
+        failures += !identical;
+
+        // Processing the vertices by chunks on several threads must keep the order of the triangles,
+        // the threads are requested explicitly so that the chunks are split even on a single core
+        const bool ordered = RenderChecksum(scenario, false, -1, 4) == reference;
+        std::cout << scenario.name << " [parallel vertices]: " << (ordered ? "OK" : "MISMATCH") << "\n";
+        failures += !ordered;
+    }
+
+    // Adjacent triangles must not leave gaps nor overlap
+    for (const auto& [path, name] : simdPaths)
+    {
+        if (!sr::SetSimdPath(path)) continue;
+
+        const int errors = CountCoverageErrors(-1);
+        std::cout << "watertight [" << name << "]: " << (errors ? "FAILED (" + std::to_string(errors) + " pixels)" : "OK") << "\n";
+        failures += errors != 0;
+    }
+
+    sr::SetSimdPath(defaultPath);
+
+    const int errors = CountCoverageErrors(0);
+    std::cout << "watertight [deferred]: " << (errors ? "FAILED (" + std::to_string(errors) + " pixels)" : "OK") << "\n";
+    failures += errors != 0;
+
+    // Large triangles must be textured with the perspective
+    int floorPixels = 0;
+    const int perspectiveErrors = CountPerspectiveErrors(floorPixels);
+    const bool perspectiveCorrect = perspectiveErrors * 100 < floorPixels;
+
+    std::cout << "perspective: " << (perspectiveCorrect ? "OK" : "FAILED") << " (" << perspectiveErrors << " of " << floorPixels << " pixels differ)\n";
+    failures += !perspectiveCorrect;
+
+    // Multisampling must only antialias the edges, including the intersections of the triangles
+    int edgePixels = 0, mixedPixels = 0;
+    const int multisampleErrors = CountMultisampleErrors(edgePixels, mixedPixels);
+    const bool multisampleCorrect = multisampleErrors == 0 && edgePixels > 0 && mixedPixels > 0;
+
+    std::cout << "multisampling: " << (multisampleCorrect ? "OK" : "FAILED") << " (" << edgePixels << " edge pixels antialiased, "
+              << mixedPixels << " on the intersection, " << multisampleErrors << " inner pixels changed)\n";
+    failures += !multisampleCorrect;
+
+    // The depths must be accessible as floats whatever the storage format
+    const int depthErrors = CountDepthAccessErrors();
+    std::cout << "depth access: " << (depthErrors ? "FAILED (" + std::to_string(depthErrors) + " values)" : "OK") << "\n";
+    failures += depthErrors != 0;
+
+    // Reversed depths must keep distant surfaces apart where floats storing the depth as is cannot
+    const int floatCollisions = CountDepthCollisions(sr::DepthFormat::Float32);
+    const int reversedCollisions = CountDepthCollisions(sr::DepthFormat::ReversedFloat32);
+    const bool reversedPrecise = reversedCollisions < floatCollisions;
+
+    std::cout << "reversed depth: " << (reversedPrecise ? "OK" : "FAILED") << " (" << reversedCollisions << " colliding pixels, "
+              << floatCollisions << " with floats)\n";
+    failures += !reversedPrecise;
+
+    // The pending vertices must not be lost when the draw mode changes
+    const bool drawModeChecked = CheckDrawModeChange();
+    std::cout << "draw mode change: " << (drawModeChecked ? "OK" : "FAILED") << "\n";
+    failures += !drawModeChecked;
+
+    // Huge 2D triangles and lines must be clipped to the viewport
+    const int clippingErrors = CountClippingErrors();
+    std::cout << "clipping: " << (clippingErrors ? "FAILED (" + std::to_string(clippingErrors) + " pixels)" : "OK") << "\n";
+    failures += clippingErrors != 0;
+
+    // Rendering the scenarios concurrently into offscreen targets must not change them
+    const int batchMismatches = CountBatchMismatches();
+    std::cout << "offscreen batch: " << (batchMismatches ? "FAILED (" + std::to_string(batchMismatches) + " scenarios)" : "OK") << "\n";
+    failures += batchMismatches != 0;
+
+    // The damaged areas must contain every pixel that changed
+    for (const bool lazyClear : { false, true })
+    {
+        for (const int deferredThreads : { -1, 0 })
+        {
+            float ratio = 0;
+            const int changes = CountUndamagedChanges(lazyClear, deferredThreads, ratio);
+
+            std::cout << "damage [" << (lazyClear ? "lazy clear" : "clear") << (deferredThreads >= 0 ? ", deferred" : "") << "]: "
+                      << (changes ? "FAILED (" + std::to_string(changes) + " pixels)" : "OK")
+                      << " (" << int(ratio * 100 + 0.5f) << "% of the screen)\n";
+
+            failures += changes != 0;
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    const std::string filter = argc > 1 ? argv[1] : "";
+    const int frames = argc > 2 ? std::max(1, std::atoi(argv[2])) : 100;
+
+    if (filter == "verify")
+    {
+        return Verify();
+    }
+
+    const sr::SimdPath defaultPath = sr::GetSimdPath();
+
+    std::cout << std::fixed << std::setprecision(3);
+
+    for (const auto& scenario : scenarios)
+    {
+        if (!filter.empty() && filter != scenario.name) continue;
+
+        std::cout << scenario.name << " - " << scenario.description << "\n";
+
+        for (const auto& [path, name] : simdPaths)
+        {
+            if (!sr::SetSimdPath(path)) continue;
+            std::cout << "    " << std::setw(10) << std::left << name << RunScenario(scenario, frames, -1) << " ms/frame\n";
+        }
+
+        sr::SetSimdPath(defaultPath);
+        std::cout << "    " << std::setw(10) << std::left << "deferred" << RunScenario(scenario, frames, 0) << " ms/frame\n";
+        std::cout << "    " << std::setw(10) << std::left << "vertex_mt" << RunScenario(scenario, frames, -1, 0) << " ms/frame\n";
+        std::cout << "    " << std::setw(10) << std::left << "both_mt" << RunScenario(scenario, frames, 0, 0) << " ms/frame\n";
+
+        // Pixels of the blocks crossed by an edge are tested one by one, the others are skipped or filled directly
+        const sr::PipelineStats stats = RenderStats(scenario);
+        const Uint64 blocks = stats.blocksRejected + stats.blocksAccepted + stats.blocksPartial;
+
+        std::cout << "    pixels    " << stats.pixelsTested << " tested, " << stats.pixelsShaded << " shaded ("
+                  << std::setprecision(2) << (stats.pixelsShaded ? double(stats.pixelsTested) / stats.pixelsShaded : 0.0)
+                  << " tested per shaded pixel)" << std::setprecision(3) << "\n";
+
+        std::cout << "    triangles " << stats.trianglesCulled << " culled, " << stats.trianglesRejected << " rejected, "
+                  << stats.trianglesAccepted << " accepted, " << stats.trianglesClipped << " clipped, "
+                  << stats.trianglesOccluded << " occluded\n";
+
+        std::cout << "    blocks    " << stats.blocksRejected << " rejected, " << stats.blocksAccepted << " accepted, "
+                  << stats.blocksPartial << " partial (" << blocks << " in bounding boxes)\n";
+    }
+
+    return 0;
+}
@@ -201,6 +201,85 @@ namespace nexus { namespace core {
         }
     };
 
+    /**
+     * @brief Counter-based random number generator, whose values only depend on its seed and on a counter.
+     *
+     * Unlike `RandomGenerator`, it has no state to advance: the value for a given counter can be obtained
+     * in any order and from any thread, which makes it suitable for generating the pixels of an image in
+     * parallel while keeping the same result for a given seed.
+     */
+    class NEXUS_API CounterRandomGenerator
+    {
+      private:
+        Uint64 seed;        ///< Seed mixed with the counters.
+
+      public:
+        /**
+         * @brief Constructs a CounterRandomGenerator with an optional seed.
+         * @param seed The seed of the generator. If not provided or set to 0, it is generated from the current time.
+         */
+        CounterRandomGenerator(unsigned long seed = 0)
+        : seed(seed != 0 ? seed : RandomGenerator(0).GetSeed())
+        { }
+
+        /**
+         * @brief Gets the seed used by the generator.
+         * @return The seed.
+         */
+        Uint64 GetSeed() const
+        {
+            return seed;
+        }
+
+        /**
+         * @brief Generates the 32-bit random value associated with a counter.
+         * @param counter The counter, for example the index of a pixel.
+         * @return A random value, always the same for the same seed and counter.
+         */
+        constexpr Uint32 Get(Uint64 counter) const
+        {
+            // SplitMix64 finalizer applied to the counter offset by the seed
+            Uint64 z = seed * 0xBF58476D1CE4E5B9ull + counter * 0x9E3779B97F4A7C15ull;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return static_cast<Uint32>((z ^ (z >> 31)) >> 32);
+        }
+
+        /**
+         * @brief Generates the 32-bit random value associated with a pair of counters.
+         * @param x The first counter, for example the column of a pixel.
+         * @param y The second counter, for example the row of a pixel.
+         * @return A random value, always the same for the same seed and counters.
+         */
+        constexpr Uint32 Get(Uint32 x, Uint32 y) const
+        {
+            return Get((static_cast<Uint64>(y) << 32) | x);
+        }
+
+        /**
+         * @brief Generates the random floating-point value within [0, 1) associated with a counter.
+         * @param counter The counter.
+         * @return A random value, always the same for the same seed and counter.
+         */
+        constexpr float GetFloat(Uint64 counter) const
+        {
+            return (Get(counter) >> 8) * (1.0f / 16777216.0f);
+        }
+
+        /**
+         * @brief Generates the random integer within [min, max] associated with a counter.
+         * @param counter The counter.
+         * @param min The minimum value of the range.
+         * @param max The maximum value of the range.
+         * @return A random value, always the same for the same seed and counter.
+         */
+        constexpr int GetInt(Uint64 counter, int min, int max) const
+        {
+            const Uint64 range = static_cast<Uint64>(static_cast<Sint64>(max) - min) + 1;
+            return min + static_cast<int>((Get(counter) * range) >> 32);
+        }
+    };
+
 }}
 
 #endif //NEXUS_CORE_RANDOM_HPP
@@ -28,6 +28,7 @@
 #include <SDL_error.h>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace nexus { namespace core {
 
@@ -681,6 +682,17 @@ namespace nexus { namespace core {
          */
         void UpdateSurface();
 
+        /**
+         * @brief Update some areas of the window surface.
+         *
+         * This function only copies the given areas of the window surface to the screen,
+         * which is cheaper than `UpdateSurface()` when only a part of the surface has changed.
+         *
+         * @param rects The areas of the surface to update.
+         * @throws core::NexusException If there is an error updating the window surface.
+         */
+        void UpdateSurfaceRects(const std::vector<shape2D::Rectangle>& rects);
+
         /**
          * @brief Check if the window is ready.
          *
@@ -128,6 +128,10 @@ namespace _gapi_impl {
         std::vector<nexus::math::Vec3> animNormals;    ///< Animated normals (after bone transformations)
         std::vector<VertexBoneData> bones;             ///< Bone influences for each vertex
 
+      private:
+        mutable nexus::shape3D::AABB bounds;           ///< Cached bounding box of the current vertex positions
+        mutable bool boundsValid = false;              ///< Whether the cached bounding box matches the vertex positions
+
       public:
         /**
          * @brief Static generation functions.
@@ -202,6 +206,21 @@ namespace _gapi_impl {
          * @return True if one or more vertices have been updated.
          */
         bool UpdateAnimation(std::vector<BoneInfo>& boneInfos);
+
+        /**
+         * @brief Returns the bounding box of the current vertex positions, animated ones included.
+         *
+         * The box is computed on the first call then kept until the vertices are animated
+         * or `UpdateBoundingBox` is called, so that drawing the mesh does not scan its vertices.
+         *
+         * @return The cached bounding box, in model space.
+         */
+        const nexus::shape3D::AABB& GetBoundingBox() const;
+
+        /**
+         * @brief Recomputes the cached bounding box, to be called after modifying the vertex positions.
+         */
+        void UpdateBoundingBox();
     };
 
 
@@ -342,6 +361,8 @@ namespace _gapi_impl {
     , animPositions(std::move(other.animPositions))
     , animNormals(std::move(other.animNormals))
     , bones(std::move(other.bones))
+    , bounds(other.bounds)
+    , boundsValid(other.boundsValid)
     { }
 
     template <typename T_Context, typename T_Material>
@@ -361,6 +382,8 @@ namespace _gapi_impl {
             animPositions = std::move(other.animPositions);
             animNormals   = std::move(other.animNormals);
             bones         = std::move(other.bones);
+            bounds        = other.bounds;
+            boundsValid   = other.boundsValid;
         }
         return *this;
     }
@@ -381,6 +404,8 @@ namespace _gapi_impl {
         animPositions = std::move(other.animPositions);
         animNormals   = std::move(other.animNormals);
         bones         = std::move(other.bones);
+        bounds        = other.bounds;
+        boundsValid   = other.boundsValid;
     }
 
     template <typename T_Context, typename T_Material>
@@ -412,9 +437,43 @@ namespace _gapi_impl {
             }
         }
 
+        if (vertsUpdated)
+        {
+            boundsValid = false;
+        }
+
         return vertsUpdated;
     }
 
+    template <typename T_Context, typename T_Material>
+    const nexus::shape3D::AABB& Mesh<T_Context, T_Material>::GetBoundingBox() const
+    {
+        if (!boundsValid)
+        {
+            const auto &vertices = animPositions.empty() ? positions : animPositions;
+
+            bounds.min = vertices.empty() ? nexus::math::Vec3() : vertices.front();
+            bounds.max = bounds.min;
+
+            for (const auto &vertex : vertices)
+            {
+                bounds.min = bounds.min.Min(vertex);
+                bounds.max = bounds.max.Max(vertex);
+            }
+
+            boundsValid = true;
+        }
+
+        return bounds;
+    }
+
+    template <typename T_Context, typename T_Material>
+    void Mesh<T_Context, T_Material>::UpdateBoundingBox()
+    {
+        boundsValid = false;
+        GetBoundingBox();
+    }
+
 
     /* Public Implementation Mesh Generation */
 
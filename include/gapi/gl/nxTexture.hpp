@@ -81,7 +81,7 @@ namespace _gl_impl
         nexus::gl::TextureFormat format    = nexus::gl::TextureFormat(0);     ///< Pixel format of the texture.
 
       private:
-        void LoadFromMemory(const nexus::gfx::Surface& surface);
+        void LoadFromMemory(const nexus::gfx::Surface& surface, bool generateMipmaps);
         void Create(int w, int h, nexus::gl::TextureFormat format);
 
       public:
@@ -97,16 +97,19 @@ namespace _gl_impl
          * 
          * @param ctx The OpenGL context.
          * @param filePath The path to the image file.
+         * @param generateMipmaps Whether to upload the mip chain generated on the CPU by `gfx::Surface::GenerateMipChain`.
          */
-        Texture(nexus::gl::Context& ctx, const std::string& filePath);
+        Texture(nexus::gl::Context& ctx, const std::string& filePath, bool generateMipmaps = false);
 
         /**
          * @brief Constructs a texture object from an existing surface.
          * 
          * @param ctx The OpenGL context.
          * @param surface The surface containing pixel data.
+         * @param generateMipmaps Whether to upload the mip chain generated on the CPU by `gfx::Surface::GenerateMipChain`.
+         *        The texture is then in the RGBA8888 format, and its mipmaps do not depend on the support of `GenMipmaps`.
          */
-        Texture(nexus::gl::Context& ctx, const nexus::gfx::Surface& surface);
+        Texture(nexus::gl::Context& ctx, const nexus::gfx::Surface& surface, bool generateMipmaps = false);
 
         /**
          * @brief Constructs an empty texture object with the specified dimensions and format.
@@ -400,18 +403,20 @@ namespace nexus { namespace gl {
          * @brief Constructor that loads a texture from a file.
          * @param ctx The OpenGL context.
          * @param filePath The path to the texture file.
+         * @param generateMipmaps Whether to upload a mip chain generated on the CPU.
          */
-        Texture(gl::Context& ctx, const std::string& filePath)
-        : Container(ctx, filePath)
+        Texture(gl::Context& ctx, const std::string& filePath, bool generateMipmaps = false)
+        : Container(ctx, filePath, generateMipmaps)
         { }
 
         /**
          * @brief Constructor that loads a texture from an in-memory surface.
          * @param ctx The OpenGL context.
          * @param surface The in-memory surface.
+         * @param generateMipmaps Whether to upload a mip chain generated on the CPU.
          */
-        Texture(gl::Context& ctx, const gfx::Surface& surface)
-        : Container(ctx, surface)
+        Texture(gl::Context& ctx, const gfx::Surface& surface, bool generateMipmaps = false)
+        : Container(ctx, surface, generateMipmaps)
         { }
 
         /**
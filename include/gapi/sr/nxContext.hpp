@@ -68,6 +68,7 @@ namespace nexus { namespace sr {
             math::Vec2                  texcoord;                       ///< Current active texture coordinate
             gfx::Color                  color;                          ///< Current active color
             const gfx::Surface          *image;                         ///< Current active image for rendering
+            TextureSampler              sampler;                        ///< Sampling parameters and mipmaps of the current image
             Framebuffer                 &winFramebuffer;                ///< Window to which the rasterizer is linked
             Framebuffer                 *currentFramebuffer;
             math::Mat4                  *currentMatrix;                 ///< Current matrix pointer
@@ -79,6 +80,9 @@ namespace nexus { namespace sr {
             bool                        renderBeginned;                 ///< Indicates if `Begin()` has been called but not yet `End()`
             bool                        depthTesting;                   ///< Indicates if a depth test will be necessary for next vertices added to the batch
             bool                        wireMode;                       ///< Indicates whether the next rendered meshes should be rendered in wireframe
+            bool                        faceCulling;                    ///< Indicates whether the faces selected by `cullMode` are discarded
+            sr::CullMode                cullMode;                       ///< Faces discarded when face culling is enabled
+            bool                        occlusionCulling;               ///< Indicates whether geometry hidden by the framebuffer content is discarded
 
             /**
              * @brief Constructs a State object with the specified window, and dimensions.
@@ -108,6 +112,11 @@ namespace nexus { namespace sr {
                 renderBeginned = false;
                 depthTesting = false;
                 wireMode = false;
+
+                // Back faces are culled by default, like with the OpenGL context
+                faceCulling = true;
+                cullMode = CullMode::FaceBack;
+                occlusionCulling = false;
             }
         };
 
@@ -115,6 +124,20 @@ namespace nexus { namespace sr {
         State state;
         Pipeline pipeline;
 
+      private:
+        /**
+         * @brief Transforms, clips and rasterizes the vertices pending in the pipeline batch with the current state.
+         */
+        void RenderBatch();
+
+        /**
+         * @brief Gets the matrix transforming the vertices into clip space with the current matrices.
+         *
+         * With a `DepthFormat::ReversedFloat32` framebuffer, the projection is followed by the remapping
+         * of the depths sending the near plane to 1 and the far plane to 0.
+         */
+        math::Mat4 GetModelViewProjection() const;
+
       public:
         using DrawMode = sr::DrawMode;                  ///< Used by primitives drawing template functions
 
@@ -139,6 +162,55 @@ namespace nexus { namespace sr {
          */
         void DisableDepthTest() override;
 
+        /**
+         * @brief Enables face culling for subsequent rendering operations (enabled by default).
+         *
+         * Culled triangles are discarded before being clipped and rasterized.
+         */
+        void EnableBackfaceCulling();
+
+        /**
+         * @brief Disables face culling, both front and back faces are then rendered.
+         */
+        void DisableBackfaceCulling();
+
+        /**
+         * @brief Sets the faces discarded when face culling is enabled.
+         * @param mode The face culling mode to set (back faces by default).
+         */
+        void SetCullFace(CullMode mode);
+
+        /**
+         * @brief Enables occlusion culling for subsequent depth tested 3D rendering operations.
+         *
+         * Triangles are discarded before rasterization when they are entirely behind what the
+         * framebuffer already contains, and meshes drawn with `DrawVertexArray` are skipped when
+         * their bounding box is. This relies on a hierarchical depth buffer maintained by the
+         * framebuffer, so drawing the nearest geometry first culls the most.
+         *
+         * @warning: Meshes are tested by transforming their bounding box as the default vertex shader
+         *           does, which may be wrong with material shaders that move the vertices differently.
+         */
+        void EnableOcclusionCulling();
+
+        /**
+         * @brief Disables occlusion culling (disabled by default).
+         */
+        void DisableOcclusionCulling();
+
+        /**
+         * @brief Checks if a bounding box is hidden by the content of the current framebuffer.
+         *
+         * The box is expressed in the coordinates of the vertices given to the current matrices.
+         * The test is conservative, it may report occluded boxes as visible but never the opposite.
+         *
+         * @note: In deferred mode, only the primitives already flushed are taken into account.
+         *
+         * @param aabb The bounding box to test.
+         * @return True if anything inside the box would fail the depth test, false otherwise.
+         */
+        bool IsOccluded(const shape3D::AABB& aabb);
+
         /**
          * @brief Sets the current matrix mode for subsequent matrix operations.
          * @param mode The matrix mode to set.
@@ -313,6 +385,66 @@ namespace nexus { namespace sr {
          */
         void DisableWireMode() override;
 
+        /**
+         * @brief Enables deferred tile-based rendering.
+         *
+         * Primitives are no longer rasterized as soon as they are submitted, they are recorded
+         * into tiles of the current framebuffer which are rasterized in parallel on `Flush()`.
+         * The window flushes automatically in `sr::Window::End()`, as does switching framebuffer.
+         * The rendered result is identical to the immediate mode.
+         *
+         * @warning: Shaders must support being called from several threads at once, and the shaders
+         *           and images used must remain valid and unchanged until the primitives are flushed.
+         *
+         * @param numThreads Number of rendering threads, 0 to use all the hardware threads.
+         */
+        void EnableDeferredRendering(int numThreads = 0);
+
+        /**
+         * @brief Flushes the pending primitives and goes back to immediate rendering.
+         */
+        void DisableDeferredRendering();
+
+        /**
+         * @brief Enables the processing of the vertices of large batches and meshes on several threads.
+         *
+         * The transformation of the mesh vertices, the vertex shader, the culling and the clipping are
+         * split into chunks processed in parallel, each into its own buffer, then the triangles are
+         * rasterized (or recorded in deferred mode) in their original order, so blending and depth
+         * testing give the same result as the serial processing. Small batches are not affected.
+         *
+         * @warning: The vertex function of the shaders must support being called from several threads at once.
+         *
+         * @param numThreads Number of threads processing the vertices, 0 to use all the hardware threads.
+         */
+        void EnableParallelVertexProcessing(int numThreads = 0);
+
+        /**
+         * @brief Goes back to processing all the vertices on the calling thread (default).
+         */
+        void DisableParallelVertexProcessing();
+
+        /**
+         * @brief Rasterizes all the primitives recorded in deferred mode since the last flush.
+         *
+         * Must be called before reading or modifying the framebuffer content outside
+         * of the context. Does nothing in immediate mode.
+         */
+        void Flush();
+
+        /**
+         * @brief Gets the rasterization counters accumulated since the last call to `ResetStats()`.
+         *
+         * Useful to measure how many pixels the triangle rasterizers had to test for each pixel actually shaded.
+         * In deferred mode, primitives are only counted once they have been flushed.
+         */
+        const PipelineStats& GetStats() const;
+
+        /**
+         * @brief Resets the rasterization counters to zero.
+         */
+        void ResetStats();
+
         /**
          * @brief Draws a batch of vertices with the specified mesh, material and transformation.
          *
@@ -345,6 +477,13 @@ namespace nexus { namespace sr {
          */
         void SetTexture(const gfx::Surface* texture);
 
+        /**
+         * @brief Sets the texture for rendering with the given sampling parameters and mipmaps.
+         * @param texture The 'texture' surface pointer. You can provide nullptr to unset the texture.
+         * @param sampler The sampler, usually obtained with `sr::Texture::GetSampler()`.
+         */
+        void SetTexture(const gfx::Surface* texture, const TextureSampler& sampler);
+
         /**
          * @brief Sets the default texture, effectively unsetting the current texture.
          * @note: For this context, this will simply unset the texture.
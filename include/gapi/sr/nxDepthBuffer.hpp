@@ -21,6 +21,7 @@
 #define NEXUS_SR_DEPTH_BUFFER_HPP
 
 #include "../../platform/nxPlatform.hpp"
+#include "./nxEnums.hpp"
 
 #include <SDL_stdinc.h>
 #include <algorithm>
@@ -31,23 +32,63 @@ namespace nexus { namespace sr {
 
     /**
      * @brief Represents a depth buffer for 2D graphics rendering.
+     *
+     * The depth values are stored in the format given at construction (see `DepthFormat`).
+     * Functions taking or returning a depth do the conversions, the stored values themselves,
+     * used by the rasterization kernels and the occlusion queries, are called keys here.
+     * A depth passes the test if its key is lower than or equal to the stored one.
+     * The keys of reversed depths being their opposite, these pass if they are greater than or equal.
+     *
+     * With multisampling, each pixel stores one depth per sample. The values of a sample
+     * are stored in their own plane, of the size of the buffer, one plane after the other.
+     * Functions taking a linear index read the first sample and write all of them.
      */
     struct NEXUS_API DepthBuffer
     {
-        static constexpr float MaxDepth = std::numeric_limits<float>::max();
+        static constexpr float MaxDepth = std::numeric_limits<float>::max();    ///< Clear value of the 32-bit format
+        static constexpr Uint16 MaxDepth16 = 0xFFFF;                            ///< Clear value of the 16-bit format
+        static constexpr float FarKeyReversed = 0.0f;                           ///< Clear value of the reversed format, the key of the far plane
+        static constexpr float Unorm16Scale = 32767.5f;                         ///< Scale and offset from the depth to the 16-bit keys
 
-        std::vector<float> buffer;  ///< The depth buffer storing depth values for each pixel.
-        Uint32 width;               ///< Width of the depth buffer.
+        /**
+         * @brief Read/write access to the depth value of a pixel, converted from and to the stored key.
+         *
+         * Returned by the non-const `Get`, it reads the first sample and writes all of them, like `ForceDepth`.
+         */
+        class Reference
+        {
+          public:
+            Reference(DepthBuffer& depth, int i) : depth(depth), i(i) { }
+
+            operator float() const { return depth.Decode(depth.GetKey(i)); }
+
+            Reference& operator=(float z) { depth.ForceDepth(i, z); return *this; }
+            Reference& operator=(const Reference& other) { return *this = static_cast<float>(other); }
+
+          private:
+            DepthBuffer& depth;
+            int i;
+        };
+
+        std::vector<float> buffer;      ///< The depth buffer storing depth values for each pixel (32-bit formats, empty otherwise).
+        std::vector<Uint16> buffer16;   ///< The depth buffer storing depth values for each pixel (16-bit format, empty otherwise).
+        Uint32 width;                   ///< Width of the depth buffer.
+        DepthFormat format;             ///< Storage format of the depth values.
+        int sampleCount = 1;            ///< Number of depth values per pixel, one plane per sample.
 
         /**
          * @brief Constructor for DepthBuffer.
          * @param w Width of the depth buffer.
          * @param h Height of the depth buffer.
+         * @param format Storage format of the depth values.
          */
-        DepthBuffer(int w, int h)
-        : buffer(w * h, MaxDepth)
-        , width(w)
-        { }
+        DepthBuffer(int w, int h, DepthFormat format = DepthFormat::Float32)
+        : width(w)
+        , format(format)
+        {
+            if (format == DepthFormat::Unorm16) buffer16.resize(w * h, MaxDepth16);
+            else buffer.resize(w * h, GetClearKey());
+        }
 
         /**
          * @brief Resizes the depth buffer to the specified dimensions.
@@ -60,16 +101,211 @@ namespace nexus { namespace sr {
          */
         void Resize(int w, int h)
         {
-            buffer.resize(w * h, MaxDepth);
+            if (format == DepthFormat::Unorm16) buffer16.resize(w * h * sampleCount, MaxDepth16);
+            else buffer.resize(w * h * sampleCount, GetClearKey());
             width = w;
         }
 
         /**
-         * @brief Clears the depth buffer by setting all values to maximum float.
+         * @brief Changes the number of depth values stored per pixel, and clears the depth buffer.
+         * @param count The new number of samples per pixel.
+         */
+        void SetSampleCount(int count)
+        {
+            const size_t size = GetPlaneSize();
+            sampleCount = count;
+
+            if (format == DepthFormat::Unorm16) buffer16.assign(size * count, MaxDepth16);
+            else buffer.assign(size * count, GetClearKey());
+        }
+
+        /**
+         * @brief Gets the number of values of a plane, one per pixel.
+         * @return The number of pixels of the depth buffer.
+         */
+        size_t GetPlaneSize() const
+        {
+            return (buffer.size() + buffer16.size()) / sampleCount;
+        }
+
+        /**
+         * @brief Changes the storage format of the depth values, and clears the depth buffer.
+         * @param newFormat The new storage format.
+         */
+        void SetFormat(DepthFormat newFormat)
+        {
+            const size_t size = buffer.size() + buffer16.size();
+            format = newFormat;
+
+            buffer.clear(), buffer.shrink_to_fit();
+            buffer16.clear(), buffer16.shrink_to_fit();
+
+            if (format == DepthFormat::Unorm16) buffer16.resize(size, MaxDepth16);
+            else buffer.resize(size, GetClearKey());
+        }
+
+        /**
+         * @brief Gets the number of bytes used to store one depth value.
+         * @return 2 for the 16-bit format, 4 otherwise.
+         */
+        int GetBytesPerValue() const
+        {
+            return format == DepthFormat::Unorm16 ? 2 : 4;
+        }
+
+        /**
+         * @brief Gets a pointer to the first stored value of a sample, a float or a Uint16 depending on the format.
+         * @param sample The sample whose plane is returned.
+         * @return A pointer to the stored values.
+         */
+        void* GetData(int sample = 0)
+        {
+            const size_t offset = sample * GetPlaneSize();
+            return format == DepthFormat::Unorm16 ? static_cast<void*>(buffer16.data() + offset) : static_cast<void*>(buffer.data() + offset);
+        }
+
+        const void* GetData(int sample = 0) const
+        {
+            const size_t offset = sample * GetPlaneSize();
+            return format == DepthFormat::Unorm16 ? static_cast<const void*>(buffer16.data() + offset) : static_cast<const void*>(buffer.data() + offset);
+        }
+
+        /**
+         * @brief Gets the key the 32-bit formats are cleared to.
+         *
+         * Reversed depths are cleared to the far plane rather than beyond, their projection not clipping
+         * what lies beyond it, which then fails the depth test instead.
+         *
+         * @return The clear key of the format.
+         */
+        float GetClearKey() const
+        {
+            return format == DepthFormat::ReversedFloat32 ? FarKeyReversed : MaxDepth;
+        }
+
+        /**
+         * @brief Clears the depth buffer by setting all values to maximum depth.
          */
         void Clear()
         {
-            std::fill(buffer.begin(), buffer.end(), MaxDepth);
+            std::fill(buffer.begin(), buffer.end(), GetClearKey());
+            std::fill(buffer16.begin(), buffer16.end(), MaxDepth16);
+        }
+
+        /**
+         * @brief Clears `count` consecutive values starting at the given linear index, in every sample.
+         *
+         * @warning: Does not check buffer bounds.
+         *
+         * @param i Linear index of the first value.
+         * @param count Number of values.
+         */
+        void Clear(int i, int count)
+        {
+            const size_t planeSize = GetPlaneSize();
+
+            for (int s = 0; s < sampleCount; s++)
+            {
+                if (format == DepthFormat::Unorm16) std::fill_n(buffer16.data() + s * planeSize + i, count, MaxDepth16);
+                else std::fill_n(buffer.data() + s * planeSize + i, count, GetClearKey());
+            }
+        }
+
+        /**
+         * @brief Converts a depth into a 16-bit key, from its value scaled by `Unorm16Scale` and offset by the same amount.
+         *
+         * The rasterization kernels interpolate the scaled values, then round them the same way.
+         *
+         * @param scaled The scaled depth.
+         * @return The 16-bit key, clamped to the range of the format.
+         */
+        static Uint16 QuantizeUnorm16(float scaled)
+        {
+            return static_cast<Uint16>(std::min(std::max(scaled, 0.0f), 65535.0f) + 0.5f);
+        }
+
+        /**
+         * @brief Converts a depth into the key that would be stored for it.
+         * @param z The depth value.
+         * @return The key, as a float.
+         */
+        float Encode(float z) const
+        {
+            switch (format)
+            {
+                case DepthFormat::Unorm16:          return QuantizeUnorm16(z * Unorm16Scale + Unorm16Scale);
+                case DepthFormat::ReversedFloat32:  return -z;
+                default:                            return z;
+            }
+        }
+
+        /**
+         * @brief Converts a stored key back into a depth.
+         * @param key The stored key.
+         * @return The depth value.
+         */
+        float Decode(float key) const
+        {
+            switch (format)
+            {
+                case DepthFormat::Unorm16:          return key * (1.0f / Unorm16Scale) - 1.0f;
+                case DepthFormat::ReversedFloat32:  return -key;
+                default:                            return key;
+            }
+        }
+
+        /**
+         * @brief Gets the key stored at the specified position (using linear index).
+         *
+         * @warning: Does not check buffer bounds.
+         *
+         * @param i Linear index representing the position in the depth buffer.
+         *
+         * @return The stored key, as a float.
+         */
+        float GetKey(int i) const
+        {
+            return format == DepthFormat::Unorm16 ? buffer16[i] : buffer[i];
+        }
+
+        /**
+         * @brief Gets the highest key stored in the given area, among all the samples.
+         *
+         * @warning: Does not check buffer bounds.
+         *
+         * @param x0, y0 Top-left position of the area (inclusive).
+         * @param x1, y1 Bottom-right position of the area (exclusive).
+         *
+         * @return The highest key, as a float.
+         */
+        float GetMaxKey(int x0, int y0, int x1, int y1) const
+        {
+            const size_t planeSize = GetPlaneSize();
+
+            if (format == DepthFormat::Unorm16)
+            {
+                Uint16 max = 0;
+                for (int s = 0; s < sampleCount; s++)
+                {
+                    for (int y = y0; y < y1; y++)
+                    {
+                        const Uint16 *row = buffer16.data() + s * planeSize + y * width;
+                        for (int x = x0; x < x1; x++) max = std::max(max, row[x]);
+                    }
+                }
+                return max;
+            }
+
+            float max = buffer[y0 * width + x0];
+            for (int s = 0; s < sampleCount; s++)
+            {
+                for (int y = y0; y < y1; y++)
+                {
+                    const float *row = buffer.data() + s * planeSize + y * width;
+                    for (int x = x0; x < x1; x++) max = std::max(max, row[x]);
+                }
+            }
+            return max;
         }
 
         /**
@@ -80,11 +316,11 @@ namespace nexus { namespace sr {
          * @param x X-coordinate.
          * @param y Y-coordinate.
          *
-         * @return Reference to the depth value at the specified position.
+         * @return Reference to the depth value at the specified position, converting it from and to the stored key.
          */
-        float& Get(int x, int y)
+        Reference Get(int x, int y)
         {
-            return buffer[y * width + x];
+            return Reference(*this, y * width + x);
         }
 
         /**
@@ -94,11 +330,11 @@ namespace nexus { namespace sr {
          *
          * @param i Linear index representing the position in the depth buffer.
          *
-         * @return Reference to the depth value at the specified position.
+         * @return Reference to the depth value at the specified position, converting it from and to the stored key.
          */
-        float& Get(int i)
+        Reference Get(int i)
         {
-            return buffer[i];
+            return Reference(*this, i);
         }
 
         /**
@@ -113,7 +349,7 @@ namespace nexus { namespace sr {
          */
         float Get(int x, int y) const
         {
-            return buffer[y * width + x];
+            return Decode(GetKey(y * width + x));
         }
 
         /**
@@ -127,7 +363,7 @@ namespace nexus { namespace sr {
          */
         float Get(int i) const
         {
-            return buffer[i];
+            return Decode(GetKey(i));
         }
 
         /**
@@ -143,28 +379,37 @@ namespace nexus { namespace sr {
          */
         bool SetDepth(int x, int y, float z)
         {
-            float &zBufferPosition = buffer[y * width + x];
-            if (z > zBufferPosition) return false;
-            zBufferPosition = z;
-            return true;
+            return SetDepth(y * width + x, z);
         }
 
         /**
          * @brief Sets the depth value at the specified position if the given Z position is shallower.
          *
+         * With multisampling, each sample is tested and updated separately.
+         *
          * @warning: Does not check buffer bounds.
          *
          * @param i Linear index representing the position in the depth buffer.
          * @param z Z-coordinate (depth value).
          *
-         * @return True if the depth has changed, false otherwise.
+         * @return True if the depth of at least one sample has changed, false otherwise.
          */
         bool SetDepth(int i, float z)
         {
-            float &zBufferPosition = buffer[i];
-            if (z > zBufferPosition) return false;
-            zBufferPosition = z;
-            return true;
+            const float key = Encode(z);
+            const size_t planeSize = GetPlaneSize();
+
+            bool changed = false;
+
+            for (int s = 0; s < sampleCount; s++)
+            {
+                const size_t j = s * planeSize + i;
+                if (key > (format == DepthFormat::Unorm16 ? buffer16[j] : buffer[j])) continue;
+                StoreKey(j, key);
+                changed = true;
+            }
+
+            return changed;
         }
 
         /**
@@ -178,7 +423,7 @@ namespace nexus { namespace sr {
          */
         void ForceDepth(int x, int y, float z)
         {
-            buffer[y * width + x] = z;
+            ForceKey(y * width + x, Encode(z));
         }
 
         /**
@@ -191,7 +436,26 @@ namespace nexus { namespace sr {
          */
         void ForceDepth(int i, float z)
         {
-            buffer[i] = z;
+            ForceKey(i, Encode(z));
+        }
+
+      private:
+        /**
+         * @brief Stores a key, already converted for the format, at the specified position in all the samples (using linear index).
+         */
+        void ForceKey(int i, float key)
+        {
+            const size_t planeSize = GetPlaneSize();
+            for (int s = 0; s < sampleCount; s++) StoreKey(s * planeSize + i, key);
+        }
+
+        /**
+         * @brief Stores a key, already converted for the format, at the specified index of the underlying buffer.
+         */
+        void StoreKey(size_t j, float key)
+        {
+            if (format == DepthFormat::Unorm16) buffer16[j] = static_cast<Uint16>(key);
+            else buffer[j] = key;
         }
     };
 
@@ -30,6 +30,66 @@ namespace nexus { namespace sr {
     using MatrixMode = gapi::MatrixMode;
     using BlendMode = gfx::BlendMode;
 
+    /**
+     * @brief Faces discarded by the pipeline when face culling is enabled.
+     *
+     * Front faces are the triangles whose vertices appear counter-clockwise on screen.
+     */
+    enum class CullMode
+    {
+        FaceFront,
+        FaceBack
+    };
+
+    /**
+     * @brief Filtering used by the rasterizer to sample textures.
+     *
+     * The mipmap level is chosen for each triangle from the ratio between its area
+     * in the texture and on screen, when the texture has mipmaps.
+     */
+    enum class TextureFilter
+    {
+        Nearest,        ///< Nearest texel of the nearest mipmap level
+        Bilinear,       ///< Weighted average of the four nearest texels of the nearest mipmap level
+        Trilinear       ///< Bilinear sampling of the two nearest mipmap levels, blended together
+    };
+
+    /**
+     * @brief Behavior of texture sampling for texture coordinates outside the [0..1] range.
+     */
+    enum class TextureWrap
+    {
+        Clamp,          ///< Coordinates are clamped to the edges of the texture
+        Repeat          ///< The texture is repeated
+    };
+
+    /**
+     * @brief Storage layout of the texels used by the rasterizer to sample a texture.
+     *
+     * The tiled layout keeps the texels of small square areas contiguous in memory, so that
+     * rotated or vertical walks through the texture touch far fewer cache lines than with rows.
+     */
+    enum class TextureLayout
+    {
+        Linear,         ///< Texels read directly from the surface, row by row
+        Tiled           ///< Texels copied in tiles of 4x4 RGBA32 texels (one cache line per tile)
+    };
+
+    /**
+     * @brief Storage format of the depth values of a framebuffer.
+     *
+     * The depth values of the rasterized primitives are those of normalized device coordinates,
+     * between -1 (near plane) and 1 (far plane) for the primitives which have been clipped.
+     * For reversed depths, the context remaps them from 1 (near plane) to 0 (far plane) before
+     * transforming the vertices, the floats being the densest where the distant depths accumulate.
+     */
+    enum class DepthFormat
+    {
+        Float32,            ///< 32-bit floats storing the depth as is
+        Unorm16,            ///< 16-bit unsigned integers covering the [-1..1] range, halving the memory and its traffic
+        ReversedFloat32     ///< 32-bit floats storing reversed depths, the closest being the greatest, precise in the distance
+    };
+
 }}
 
 #endif //NEXUS_SF_ENUMS_HPP
@@ -25,18 +25,64 @@
 #include "../../gfx/nxPixel.hpp"
 #include "../../math/nxVec2.hpp"
 #include "./nxDepthBuffer.hpp"
+#include "./nxHiZBuffer.hpp"
 #include "./nxContextual.hpp"
 #include "./nxEnums.hpp"
 #include <SDL_stdinc.h>
 #include <algorithm>
+#include <vector>
 #include <limits>
 
 namespace nexus { namespace sr {
 
     class NEXUS_API Framebuffer : public gfx::Surface
     {
+      public:
+        static constexpr int TileSize = 32;     ///< Width and height in pixels of the tiles cleared lazily and tracked for damage
+        static constexpr int MaxSamples = 4;    ///< Number of samples per pixel when multisampling is enabled
+
       private:
         sr::DepthBuffer depth;
+        sr::HiZBuffer hiz;
+
+        std::vector<Uint8> tileStates;      ///< State of each tile regarding the last lazy clear (see `TileState`)
+        std::vector<Uint8> damagedTiles;    ///< Tiles whose pixels may have changed since the last call to `ResetDamage()`
+        std::vector<gfx::Color> sampleColors;   ///< Colors of the samples of each pixel, only valid for the split pixels (multisampling only)
+        std::vector<Uint8> splitPixels;         ///< Whether the samples of each pixel differ, the pixel being then resolved from `sampleColors`
+        int tilesPerRow = 0;                ///< Number of tiles per row of `tileStates` and `damagedTiles`
+        int sampleCount = 1;                ///< Number of samples per pixel, 1 or `MaxSamples`
+        Uint32 clearPixel = 0;              ///< Clear color converted to the pixel format of the surface
+        bool lazyClear = false;             ///< Whether `Clear()` defers its writes to the first access of each tile
+
+        /**
+         * @brief States of the tiles cleared lazily.
+         */
+        enum TileState : Uint8
+        {
+            TileDrawn,      ///< The tile may have been drawn since it was last cleared
+            TilePending,    ///< The clear values have not been written in the tile yet
+            TileCleared     ///< The tile holds the clear values and has not been drawn since
+        };
+
+        /**
+         * @brief Fills `count` pixels starting at `row` with the clear color.
+         */
+        void FillPixels(Uint8* row, int count) const;
+
+        /**
+         * @brief Writes the clear values in a tile.
+         */
+        void FillTile(int tx, int ty);
+
+        /**
+         * @brief Resizes the tile states to the dimensions of the surface, whose content is unknown and entirely damaged.
+         */
+        void ResetTiles();
+
+        /**
+         * @brief Resizes the sample storage to the dimensions of the surface, no pixel being split.
+         */
+        void ResetSamples();
 
       public:
         /**
@@ -47,11 +93,15 @@ namespace nexus { namespace sr {
          * @param w The width of the framebuffer.
          * @param h The height of the framebuffer.
          * @param format The pixel format of the framebuffer (default is RGBA32).
+         * @param depthFormat The storage format of the depth values (default is Float32).
          */
-        Framebuffer(int w, int h, gfx::PixelFormat format = gfx::PixelFormat::RGBA32)
+        Framebuffer(int w, int h, gfx::PixelFormat format = gfx::PixelFormat::RGBA32, DepthFormat depthFormat = DepthFormat::Float32)
         : gfx::Surface(w, h, gfx::Blank, format)
-        , depth(w, h)
-        { }
+        , depth(w, h, depthFormat)
+        , hiz(w, h)
+        {
+            ResetTiles();
+        }
 
         /**
          * @brief Constructor for Framebuffer class taking an existing surface.
@@ -64,20 +114,33 @@ namespace nexus { namespace sr {
         Framebuffer(gfx::Surface&& surface)
         : gfx::Surface(std::move(surface))
         , depth(this->surface->w, this->surface->h)
-        { }
+        , hiz(this->surface->w, this->surface->h)
+        {
+            ResetTiles();
+        }
 
         /**
          * @brief Sets a new surface for the framebuffer.
          *
          * Sets a new surface for the framebuffer, transferring ownership.
          * The depth buffer is resized to match the dimensions of the new surface.
+         * The state of the lazy clear is kept if the new surface shares the pixels of the previous
+         * one, as the surface of a window does from one frame to the next, and is discarded otherwise.
          *
          * @param surface An rvalue reference to the new surface.
          */
         void SetSurface(gfx::Surface&& surface)
         {
+            const void *prevPixels = this->surface ? this->surface->pixels : nullptr;
+            const math::IVec2 prevSize = GetSize();
+
             *static_cast<gfx::Surface*>(this) = std::move(surface);
+            if (prevPixels == this->surface->pixels && prevSize == GetSize()) return;
+
             depth.Resize(this->surface->w, this->surface->h);
+            hiz.Resize(this->surface->w, this->surface->h);
+            ResetTiles();
+            ResetSamples();
         }
 
         /**
@@ -94,34 +157,189 @@ namespace nexus { namespace sr {
          * @brief Unlocks the framebuffer after rendering.
          *
          * This function unlocks the framebuffer after rendering within a specific viewport.
+         * The clears still pending are applied first and the samples are resolved, so that the surface can be read as is.
          */
         void End()
         {
+            ApplyPendingClear();
+            ResolveSamples();
             if (this->MustLock()) this->Unlock();
         }
 
         /**
-         * @brief Clears the framebuffer by setting the pixel at (0, 0) to a blank color and resetting the depth buffer.
+         * @brief Sets the number of samples per pixel used to antialias the edges of the triangles.
+         *
+         * With `MaxSamples` samples, the triangles are tested for coverage and depth at each sample of a pixel,
+         * the depth buffer storing one depth per sample, but are shaded once per pixel. The pixels partially
+         * covered keep one color per sample until they are resolved, by `ResolveSamples()` or `End()`, to the
+         * average of their samples. The other pixels are written directly, so the cost of the fill is mostly
+         * unchanged away from the edges. Lines and points are not antialiased.
+         *
+         * The depth buffer is cleared and the pixels lose their samples, after being resolved.
+         *
+         * @throws core::NexusException if the count is neither 1 nor `MaxSamples`.
          *
-         * This function clears the framebuffer by setting the pixel at (0, 0) to a blank color and resetting the depth buffer.
+         * @param count 1 to disable multisampling (default), or `MaxSamples`.
          */
-        void Clear(const gfx::Color& color)
+        void SetSampleCount(int count);
+
+        /**
+         * @brief Gets the number of samples per pixel.
+         * @return 1 if multisampling is disabled, `MaxSamples` otherwise.
+         */
+        int GetSampleCount() const
         {
-            static_cast<gfx::Surface*>(this)->SetPixelUnsafe(0, 0, color);
-            depth.ForceDepth(0, 0, depth.MaxDepth);
+            return sampleCount;
+        }
 
-            Uint8 *pTex = static_cast<Uint8*>(surface->pixels) + surface->format->BytesPerPixel;
-            float *pDepth = depth.buffer.data() + 1;
+        /**
+         * @brief Writes the average color of the samples of each split pixel into the surface.
+         *
+         * The samples are kept, so that rendering can go on over the resolved pixels.
+         */
+        void ResolveSamples();
+
+        /**
+         * @brief Blends colors into the samples of `count` consecutive pixels of a row.
+         *
+         * The color of the pixel `i` is blended into each sample `s` for which the bit `i` of `sampleMasks[s]`
+         * is set. The pixels whose samples are all covered and do not differ are not written, their mask being returned so that the
+         * caller writes them directly into the surface. A pixel partially covered is split first, its samples
+         * taking the color of the surface, and a split pixel whose samples become identical is merged back.
+         *
+         * @warning: This function is not safe and does not check if the given coordinates are out of bounds.
+         *
+         * @param x, y Coordinates of the first pixel.
+         * @param colors The color of each pixel.
+         * @param sampleMasks For each of the `MaxSamples` samples, the bit mask of the pixels covering it.
+         * @param count Number of pixels.
+         * @return Bit mask of the pixels to write into the surface (bit `i` for the pixel `i`).
+         */
+        Uint32 BlendSamplesUnsafe(int x, int y, const gfx::Color* colors, const Uint32* sampleMasks, int count);
 
-            const Uint8 *pTexEnd = pTex + surface->w * surface->h * surface->format->BytesPerPixel;
+        /**
+         * @brief Enables or disables the lazy clear of the framebuffer.
+         *
+         * When enabled, `Clear()` only records the clear color and tags the tiles of `TileSize` x
+         * `TileSize` pixels as pending. The clear values are written in a tile the first time the
+         * rasterizers access it, or by `ApplyPendingClear()` which `End()` calls for the remaining ones.
+         * The tiles not drawn since they were cleared with the same color are not written again, so
+         * frames which only draw over a part of the framebuffer only pay for the tiles they touch.
+         *
+         * @warning: While enabled, the pixels and depth values must not be written outside the pipeline,
+         * and not be read before `ApplyPendingClear()` or `End()` is called after a clear.
+         *
+         * @param enabled True to clear lazily, false to clear immediately (default).
+         */
+        void SetLazyClear(bool enabled);
 
-            for (; pTex < pTexEnd; pTex += surface->format->BytesPerPixel, pDepth++)
+        /**
+         * @brief Checks if the lazy clear of the framebuffer is enabled.
+         * @return True if `Clear()` defers its writes, false otherwise.
+         */
+        bool IsLazyClear() const
+        {
+            return lazyClear;
+        }
+
+        /**
+         * @brief Clears the color of all the pixels and resets the depth buffer.
+         *
+         * The rows are filled at once rather than pixel by pixel. With lazy clear enabled,
+         * the writes are deferred to the first access of each tile (see `SetLazyClear()`).
+         *
+         * @param color The color to clear the framebuffer with.
+         */
+        void Clear(const gfx::Color& color);
+
+        /**
+         * @brief Writes the clear values in all the tiles still pending since the last lazy clear.
+         */
+        void ApplyPendingClear();
+
+        /**
+         * @brief Prepares the given area to be drawn by the rasterizers.
+         *
+         * The pending clear values of the tiles overlapping the area are written if lazy clear is enabled,
+         * and the tiles are marked as drawn and damaged. Areas of different rendering tiles never share
+         * a tile of the framebuffer, so they can be prepared concurrently.
+         *
+         * @warning: This function is not safe and does not check if the given coordinates are out of bounds.
+         *
+         * @param xMin, yMin Top-left pixel of the area (inclusive).
+         * @param xMax, yMax Bottom-right pixel of the area (inclusive).
+         */
+        void MarkDrawn(int xMin, int yMin, int xMax, int yMax)
+        {
+            for (int ty = yMin / TileSize; ty <= yMax / TileSize; ty++)
             {
-                std::memcpy(pTex, surface->pixels, surface->format->BytesPerPixel);
-                std::memcpy(pDepth, depth.buffer.data(), sizeof(float));
+                for (int tx = xMin / TileSize; tx <= xMax / TileSize; tx++)
+                {
+                    // Tiles are only pending while lazy clear is enabled
+                    const int tile = ty * tilesPerRow + tx;
+                    if (tileStates[tile] == TilePending) FillTile(tx, ty);
+                    tileStates[tile] = TileDrawn;
+                    damagedTiles[tile] = 1;
+                }
             }
         }
 
+        /**
+         * @brief Gets the areas whose pixels may have changed since the last call to `ResetDamage()`.
+         *
+         * The damage is tracked by tiles of `TileSize` x `TileSize` pixels, from the areas drawn by the
+         * rasterizers and the clears. With lazy clear enabled, clearing a tile which still holds the clear
+         * values does not damage it. Adjacent damaged tiles are merged into as few rectangles as possible.
+         *
+         * @warning: Pixels written outside the pipeline are not tracked.
+         *
+         * @param rects Receives the damaged rectangles, clipped to the framebuffer (cleared first).
+         */
+        void GetDamagedRects(std::vector<shape2D::Rectangle>& rects) const;
+
+        /**
+         * @brief Checks if any pixel may have changed since the last call to `ResetDamage()`.
+         * @return True if at least one tile is damaged, false otherwise.
+         */
+        bool IsDamaged() const
+        {
+            return std::find(damagedTiles.begin(), damagedTiles.end(), 1) != damagedTiles.end();
+        }
+
+        /**
+         * @brief Marks all the tiles as undamaged, typically once the framebuffer has been presented.
+         */
+        void ResetDamage()
+        {
+            std::fill(damagedTiles.begin(), damagedTiles.end(), 0);
+        }
+
+        /**
+         * @brief Changes the storage format of the depth values, and clears the depth buffer.
+         *
+         * 16-bit values halve the memory used by the depth buffer and the traffic of the depth tests,
+         * at the cost of precision. Reversed floats concentrate their precision near the far plane,
+         * where the depth values of a perspective projection accumulate, the context then remapping
+         * the depths from 1 (near plane) to 0 (far plane) as they are projected.
+         *
+         * @param format The new storage format.
+         */
+        void SetDepthFormat(DepthFormat format)
+        {
+            if (format == depth.format) return;
+            depth.SetFormat(format);
+            hiz.Clear();
+        }
+
+        /**
+         * @brief Gets the storage format of the depth values.
+         * @return The depth format of the framebuffer.
+         */
+        DepthFormat GetDepthFormat() const
+        {
+            return depth.format;
+        }
+
         /**
          * @brief Gets the depth value at the specified coordinates.
          *
@@ -153,10 +371,70 @@ namespace nexus { namespace sr {
             return depth.Get(i);
         }
 
+        /**
+         * @brief Retrieves a pointer to the raw depth values of a sample.
+         *
+         * The values are stored row by row, with the same width as the framebuffer, as floats or as
+         * Uint16 depending on the depth format (see `DepthBuffer` for their representation).
+         * Used by the rasterization kernels to test and write depth values in blocks.
+         *
+         * @param sample The sample whose depth values are returned, lower than `GetSampleCount()`.
+         * @return A pointer to the first depth value.
+         */
+        void* GetDepthData(int sample = 0)
+        {
+            return depth.GetData(sample);
+        }
+
+        const void* GetDepthData(int sample = 0) const
+        {
+            return depth.GetData(sample);
+        }
+
+        /**
+         * @brief Gets the number of bytes of a raw depth value.
+         * @return 2 for the 16-bit depth format, 4 otherwise.
+         */
+        int GetDepthBytesPerPixel() const
+        {
+            return depth.GetBytesPerValue();
+        }
+
+        /**
+         * @brief Indicates that depth values have been written in the given area through `GetDepthData()`.
+         *
+         * This lets the occlusion queries tighten their bounds for this area from the new depth values.
+         * @warning: This function is not safe and does not check if the given coordinates are out of bounds.
+         *
+         * @param xMin, yMin Top-left pixel of the area (inclusive).
+         * @param xMax, yMax Bottom-right pixel of the area (inclusive).
+         */
+        void MarkDepthWritten(int xMin, int yMin, int xMax, int yMax)
+        {
+            hiz.MarkDirty(xMin, yMin, xMax, yMax);
+        }
+
+        /**
+         * @brief Checks if anything drawn in the given area with a depth of at least `z` would fail the depth test.
+         *
+         * The test is conservative: it may miss some occluded areas but never reports a visible one.
+         * It relies on a hierarchical max-depth buffer maintained alongside the depth buffer.
+         *
+         * @param xMin, yMin Top-left pixel of the area (inclusive).
+         * @param xMax, yMax Bottom-right pixel of the area (inclusive).
+         * @param z The minimum depth of what would be drawn in the area.
+         * @return True if the area is entirely occluded, false otherwise.
+         */
+        bool IsOccluded(int xMin, int yMin, int xMax, int yMax, float z)
+        {
+            return hiz.IsOccluded(depth, xMin, yMin, xMax, yMax, depth.Encode(z));
+        }
+
         /**
          * @brief Sets the color of the pixel at the specified coordinates, considering the provided depth.
          *
          * This function sets the color of the pixel at the specified coordinates, considering the provided depth.
+         * With multisampling, the samples of the pixel are discarded, the color being written in the surface only.
          * @warning: This function is not safe and does not check if the given coordinates are out of bounds.
          *
          * @param x The x-coordinate of the pixel.
@@ -167,6 +445,7 @@ namespace nexus { namespace sr {
         void SetPixelDepthUnsafe(int x, int y, float z, const gfx::Color& color)
         {
             if (!depth.SetDepth(x, y, z)) return;
+            if (sampleCount > 1) splitPixels[y * surface->w + x] = 0;
             static_cast<gfx::Surface*>(this)->SetPixelUnsafe(x, y, color);
         }
 
@@ -174,6 +453,7 @@ namespace nexus { namespace sr {
          * @brief Sets the color of the pixel at the specified index, considering the provided depth.
          *
          * Sets the color of the pixel at the specified index, considering the provided depth.
+         * With multisampling, the samples of the pixel are discarded, the color being written in the surface only.
          * @warning: This function is not safe and does not check if the given coordinates are out of bounds.
          *
          * @param i The index of the pixel.
@@ -183,6 +463,7 @@ namespace nexus { namespace sr {
         void SetPixelDepthUnsafe(int i, float z, const gfx::Color& color)
         {
             if (!depth.SetDepth(i, z)) return;
+            if (sampleCount > 1) splitPixels[i] = 0;
             static_cast<gfx::Surface*>(this)->SetPixelUnsafe(i, color);
         }
 
@@ -190,6 +471,7 @@ namespace nexus { namespace sr {
          * @brief Sets the color of the pixel at the specified coordinates, considering the provided depth if depth testing is enabled.
          *
          * This function sets the color of the pixel at the specified coordinates, considering the provided depth if depth testing is enabled.
+         * With multisampling, the samples of the pixel are discarded, the color being written in the surface only.
          * @warning: This function is not safe and does not check if the given coordinates are out of bounds.
          *
          * @param x The x-coordinate of the pixel.
@@ -201,6 +483,7 @@ namespace nexus { namespace sr {
         void SetPixelDepthUnsafe(int x, int y, float z, const gfx::Color& color, bool depthTest)
         {
             if (depthTest && !depth.SetDepth(x, y, z)) return;
+            if (sampleCount > 1) splitPixels[y * surface->w + x] = 0;
             static_cast<gfx::Surface*>(this)->SetPixelUnsafe(x, y, color);
         }
 
@@ -208,6 +491,7 @@ namespace nexus { namespace sr {
          * @brief Sets the color of the pixel at the specified index, considering the provided depth if depth testing is enabled.
          *
          * Sets the color of the pixel at the specified index, considering the provided depth if depth testing is enabled.
+         * With multisampling, the samples of the pixel are discarded, the color being written in the surface only.
          * @warning: This function is not safe and does not check if the given coordinates are out of bounds.
          *
          * @param i The index of the pixel.
@@ -218,6 +502,7 @@ namespace nexus { namespace sr {
         void SetPixelDepthUnsafe(int i, float z, const gfx::Color& color, bool depthTest)
         {
             if (depthTest && !depth.SetDepth(i, z)) return;
+            if (sampleCount > 1) splitPixels[i] = 0;
             static_cast<gfx::Surface*>(this)->SetPixelUnsafe(i, color);
         }
 
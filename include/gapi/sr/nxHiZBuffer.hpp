@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+
+#ifndef NEXUS_SR_HIZ_BUFFER_HPP
+#define NEXUS_SR_HIZ_BUFFER_HPP
+
+#include "../../platform/nxPlatform.hpp"
+#include "./nxDepthBuffer.hpp"
+
+#include <SDL_stdinc.h>
+#include <vector>
+#include <array>
+
+namespace nexus { namespace sr {
+
+    /**
+     * @brief Hierarchical max-depth buffer used to reject occluded geometry before rasterization.
+     *
+     * Each level stores, for each cell, an upper bound of the depth keys of the pixels it covers
+     * (the values as stored by the depth buffer, see `DepthBuffer::Encode()`).
+     * The cells of the first level cover `BlockSize` x `BlockSize` pixels and each following level
+     * halves the resolution, up to cells of 64x64 pixels.
+     *
+     * Since depth tests can only lower the values of the depth buffer, the bounds stay valid when
+     * depth values are written. The rasterizers only mark the blocks they wrote as dirty, their bounds
+     * are tightened lazily from the depth buffer when a query needs them.
+     */
+    struct NEXUS_API HiZBuffer
+    {
+        static constexpr int BlockSize = 8;     ///< Width and height in pixels of the cells of the first level
+        static constexpr int NumLevels = 4;     ///< Number of levels, the cells of the last one cover 64x64 pixels
+
+        std::array<std::vector<float>, NumLevels> levels;   ///< Upper bound of the depth of each cell, level by level
+        std::array<int, NumLevels> widths;                  ///< Number of cells per row of each level
+        std::array<int, NumLevels> heights;                 ///< Number of cells per column of each level
+        std::vector<Uint8> dirty;                           ///< Blocks of the first level written since their bound was computed
+        int width, height;                                  ///< Dimensions in pixels of the depth buffer
+
+        /**
+         * @brief Constructor for HiZBuffer.
+         * @param w Width in pixels of the depth buffer.
+         * @param h Height in pixels of the depth buffer.
+         */
+        HiZBuffer(int w, int h)
+        {
+            Resize(w, h);
+        }
+
+        /**
+         * @brief Resizes the buffer to match a depth buffer of the specified dimensions, and clears it.
+         * @param w Width in pixels of the depth buffer.
+         * @param h Height in pixels of the depth buffer.
+         */
+        void Resize(int w, int h);
+
+        /**
+         * @brief Resets all the bounds to the maximum depth, as after a clear of the depth buffer.
+         */
+        void Clear();
+
+        /**
+         * @brief Indicates that depth values have been written in the given pixel area.
+         *
+         * The bounds of the blocks concerned will be recomputed the next time a query needs them.
+         * Areas of different rendering tiles never share a block, so they can be marked concurrently.
+         *
+         * @warning: Does not check buffer bounds.
+         *
+         * @param xMin, yMin Top-left pixel of the area (inclusive).
+         * @param xMax, yMax Bottom-right pixel of the area (inclusive).
+         */
+        void MarkDirty(int xMin, int yMin, int xMax, int yMax)
+        {
+            for (int y = yMin / BlockSize; y <= yMax / BlockSize; y++)
+            {
+                for (int x = xMin / BlockSize; x <= xMax / BlockSize; x++)
+                {
+                    dirty[y * widths[0] + x] = 1;
+                }
+            }
+        }
+
+        /**
+         * @brief Checks if everything drawn in the given area at a depth of at least `z` would fail the depth test.
+         *
+         * The area is clamped to the buffer dimensions.
+         *
+         * @param depth The depth buffer this buffer is associated with.
+         * @param xMin, yMin Top-left pixel of the area (inclusive).
+         * @param xMax, yMax Bottom-right pixel of the area (inclusive).
+         * @param z The key of the minimum depth of what would be drawn in the area.
+         *
+         * @return True if the area is entirely occluded, false otherwise.
+         */
+        bool IsOccluded(const DepthBuffer& depth, int xMin, int yMin, int xMax, int yMax, float z);
+
+      private:
+        /**
+         * @brief Checks a cell and, if needed, its children overlapping the area, tightening their bounds on the way.
+         */
+        bool IsCellOccluded(const DepthBuffer& depth, int level, int cx, int cy, int xMin, int yMin, int xMax, int yMax, float z);
+    };
+
+}}
+
+#endif //NEXUS_SR_HIZ_BUFFER_HPP
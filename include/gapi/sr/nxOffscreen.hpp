@@ -0,0 +1,180 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef NEXUS_SR_OFFSCREEN_HPP
+#define NEXUS_SR_OFFSCREEN_HPP
+
+#include "../../utils/nxThreadPool.hpp"
+#include "../../gfx/nxPixel.hpp"
+#include "../../gfx/nxColor.hpp"
+#include "./nxFramebuffer.hpp"
+#include "./nxContext.hpp"
+#include "./nxEnums.hpp"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace nexus { namespace sr {
+
+    /**
+     * @brief A rendering target with its own sr::Context which requires neither a window nor the SDL video subsystem.
+     *
+     * It is used like `sr::Window`, its framebuffer being read back by the application once `End()` has been
+     * called, to save it or copy it somewhere else. `sr::TargetTexture` objects can be created from its context.
+     */
+    class NEXUS_API Offscreen
+    {
+      public:
+        using CtxType = Context;                    ///< Used by template functions for drawing primitives, as with sr::Window
+
+      private:
+        std::unique_ptr<Framebuffer> ownFramebuffer;    ///< Framebuffer allocated by the offscreen target, null if it renders into an external one
+        Framebuffer *framebuffer;                       ///< Framebuffer rendered to
+        std::unique_ptr<Context> ctx;                   ///< Context linked to the framebuffer
+
+      public:
+        /**
+         * @brief Creates an offscreen target along with its framebuffer and its context.
+         * @param width The width of the framebuffer.
+         * @param height The height of the framebuffer.
+         * @param format The pixel format of the framebuffer.
+         * @param depthFormat The storage format of the depth buffer.
+         */
+        Offscreen(int width, int height, gfx::PixelFormat format = gfx::PixelFormat::RGBA32, DepthFormat depthFormat = DepthFormat::Float32);
+
+        /**
+         * @brief Creates an offscreen target rendering into an existing framebuffer.
+         * @param target The framebuffer to render into, which must outlive the offscreen target.
+         */
+        explicit Offscreen(Framebuffer& target);
+
+        Offscreen(const Offscreen&) = delete;
+        Offscreen& operator=(const Offscreen&) = delete;
+
+        operator Context*() { return ctx.get(); }
+        operator Context&() { return *ctx; }
+
+        operator gapi::Context*() { return static_cast<gapi::Context*>(ctx.get()); }
+        operator gapi::Context&() { return *ctx; }
+
+        /**
+         * @brief Gets the context rendering into the offscreen framebuffer.
+         */
+        Context& GetContext()
+        {
+            return *ctx;
+        }
+
+        /**
+         * @brief Gets the framebuffer rendered to.
+         * @note: Its content is only complete once `End()` has been called.
+         */
+        Framebuffer& GetFramebuffer()
+        {
+            return *framebuffer;
+        }
+
+        /**
+         * @brief Gets the framebuffer rendered to.
+         * @note: Its content is only complete once `End()` has been called.
+         */
+        const Framebuffer& GetFramebuffer() const
+        {
+            return *framebuffer;
+        }
+
+        /**
+         * @brief Clears the color and the depth of the framebuffer.
+         * @param color The color to clear the framebuffer with.
+         */
+        void Clear(const gfx::Color& color = gfx::Black);
+
+        /**
+         * @brief Begins rendering into the framebuffer.
+         */
+        Offscreen& Begin();
+
+        /**
+         * @brief Ends rendering, the pending primitives are rasterized and the samples resolved.
+         */
+        Offscreen& End();
+    };
+
+    /**
+     * @brief Renders many scenes in parallel into offscreen targets of the same size, one per thread.
+     *
+     * Each thread owns its target, context and pipeline, so the scenes share no state with
+     * each other as long as the callbacks do not. The targets are reused from one scene to
+     * the next, the scene callback being responsible for clearing them.
+     */
+    class NEXUS_API OffscreenBatch
+    {
+      public:
+        using SceneFunc = std::function<void(Offscreen& target, int index)>;            ///< Draws the scene `index` between `Begin()` and `End()`
+        using OutputFunc = std::function<void(const Framebuffer& result, int index)>;   ///< Receives the rendered scene `index`
+
+      private:
+        std::vector<std::unique_ptr<Offscreen>> targets;    ///< Offscreen target of each thread
+        std::unique_ptr<utils::ThreadPool> workers;         ///< Threads rendering the scenes with the calling thread, null if there is only one target
+
+      public:
+        /**
+         * @brief Creates the offscreen targets and the rendering threads.
+         * @param width The width of the targets.
+         * @param height The height of the targets.
+         * @param numThreads Number of scenes rendered at once, 0 to use all the hardware threads.
+         * @param format The pixel format of the targets.
+         * @param depthFormat The storage format of the depth buffers.
+         */
+        OffscreenBatch(int width, int height, int numThreads = 0,
+            gfx::PixelFormat format = gfx::PixelFormat::RGBA32, DepthFormat depthFormat = DepthFormat::Float32);
+
+        /**
+         * @brief Gets the number of scenes rendered at once.
+         */
+        int GetTargetCount() const
+        {
+            return static_cast<int>(targets.size());
+        }
+
+        /**
+         * @brief Gets an offscreen target, to configure its context or framebuffer before rendering.
+         */
+        Offscreen& GetTarget(int index)
+        {
+            return *targets[index];
+        }
+
+        /**
+         * @brief Renders `count` scenes and passes each result to `output`, blocking until all are done.
+         *
+         * The scenes are handed out one at a time to the first free target, so the callbacks are
+         * called from several threads at once, and in no particular order. The first exception
+         * thrown by a callback is rethrown once all the threads have stopped.
+         *
+         * @param count Number of scenes to render.
+         * @param scene Draws a scene into the target it is given.
+         * @param output Reads the result, before the target is reused for another scene.
+         */
+        void Render(int count, const SceneFunc& scene, const OutputFunc& output);
+    };
+
+}}
+
+#endif //NEXUS_SR_OFFSCREEN_HPP
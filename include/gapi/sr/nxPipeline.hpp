@@ -21,15 +21,21 @@
 #define NEXUS_SR_PIPELINE_HPP
 
 #include "../../shape/2D/nxRectangle.hpp"
+#include "../../shape/3D/nxAABB.hpp"
 #include "../../gfx/nxSurface.hpp"
 #include "../../gfx/nxColor.hpp"
 #include "../../math/nxVec4.hpp"
 #include "../../math/nxVec3.hpp"
 #include "../../math/nxVec2.hpp"
 #include "./nxFramebuffer.hpp"
+#include "./nxTextureSampler.hpp"
 #include "./nxShader.hpp"
 #include "./nxEnums.hpp"
+#include "../../utils/nxThreadPool.hpp"
+#include <memory>
+#include <vector>
 #include <array>
+#include <deque>
 
 namespace _sr_impl {
 
@@ -41,25 +47,209 @@ namespace _sr_impl {
         nexus::gfx::Color color;
     };
 
+    /**
+     * @brief Growable structure-of-arrays storage of the vertices submitted to the pipeline.
+     *
+     * Keeping each attribute contiguous allows the whole batch
+     * to be transformed in a single tight pass over the positions.
+     */
+    struct VertexBatch
+    {
+        std::vector<nexus::math::Vec4> positions;
+        std::vector<nexus::math::Vec3> normals;
+        std::vector<nexus::math::Vec2> texcoords;
+        std::vector<nexus::gfx::Color> colors;
+        std::vector<Uint32> indices;            ///< Vertices forming the primitives, the vertices are used in order if empty
+
+        /**
+         * @brief Returns the number of vertices in the batch.
+         */
+        size_t GetSize() const
+        {
+            return positions.size();
+        }
+
+        /**
+         * @brief Sets the number of vertices, the new vertices are left to be written by the caller.
+         */
+        void Resize(size_t count)
+        {
+            positions.resize(count);
+            normals.resize(count);
+            texcoords.resize(count);
+            colors.resize(count);
+        }
+
+        /**
+         * @brief Reserves storage for the given total number of vertices.
+         */
+        void Reserve(size_t count)
+        {
+            positions.reserve(count);
+            normals.reserve(count);
+            texcoords.reserve(count);
+            colors.reserve(count);
+        }
+
+        /**
+         * @brief Removes all the vertices, the allocated storage is kept.
+         */
+        void Clear()
+        {
+            positions.clear();
+            normals.clear();
+            texcoords.clear();
+            colors.clear();
+            indices.clear();
+        }
+
+        /**
+         * @brief Appends a vertex to the batch.
+         */
+        void Push(const nexus::math::Vec3& position, const nexus::math::Vec3& normal, const nexus::math::Vec2& texcoord, const nexus::gfx::Color& color)
+        {
+            positions.emplace_back(position.x, position.y, position.z, 1.0f);
+            normals.push_back(normal);
+            texcoords.push_back(texcoord);
+            colors.push_back(color);
+        }
+    };
+
+    /**
+     * @brief Inclusive pixel area a rasterizer is allowed to write to.
+     */
+    struct RasterBounds
+    {
+        int xMin, yMin;
+        int xMax, yMax;
+    };
+
+    /**
+     * @brief Polygon resulting from the clipping and the projection of a triangle of the batch.
+     */
+    struct ClippedPolygon
+    {
+        Uint32 first;           ///< Index of the first vertex of the polygon in its chunk
+        Uint8 count;            ///< Number of vertices of the polygon
+        bool frontFacing;       ///< Facing of the triangle, determined before clipping
+        bool is2D;              ///< Indicates if the triangle comes from the 2D (unclipped) path
+    };
+
+    /**
+     * @brief Triangles of a chunk of the batch processed by one of the vertex processing threads.
+     */
+    struct ClippedChunk
+    {
+        std::vector<Vertex> vertices;           ///< Screen-space vertices of the polygons, one polygon after the other
+        std::vector<ClippedPolygon> polygons;   ///< Polygons of the triangles which have not been culled, in batch order
+    };
+
+    /**
+     * @brief Screen-space primitive recorded by the pipeline in deferred mode.
+     */
+    struct Primitive
+    {
+        enum class Type : Uint8
+        {
+            Line,
+            TriangleColor2D,
+            TriangleImage2D,
+            TriangleColor3D,
+            TriangleImage3D
+        };
+
+        std::array<Vertex, 3> vertices;         ///< Vertices already transformed into screen coordinates (only two are used by lines)
+        nexus::shape2D::Rectangle viewport;     ///< Viewport (position and size in pixels), used by 2D triangles
+        nexus::sr::Shader *shader;              ///< Shader used to render the primitive
+        const nexus::gfx::Surface *image;       ///< Image used to render the primitive, can be null
+        nexus::sr::TextureSampler sampler;      ///< Sampling parameters and mipmaps of the image
+        Type type;                              ///< Rasterizer to use for this primitive
+        bool depthTest;                         ///< Indicates if depth testing should be applied
+    };
+
 }
 
 namespace nexus { namespace sr {
 
+    /**
+     * @brief Counters of the work done by the pipeline, accumulated until they are reset.
+     *
+     * Before clipping, triangles are culled according to their facing, then classified against the
+     * view frustum: triangles entirely outside one of its planes are rejected, those entirely inside
+     * skip the clipping passes and only the remaining ones are clipped.
+     *
+     * Triangles are rasterized by blocks of 8x8 pixels. Blocks entirely outside the triangle are skipped,
+     * blocks entirely inside are filled without testing their pixels and only the blocks crossed by an
+     * edge have their pixels tested one by one.
+     */
+    struct PipelineStats
+    {
+        Uint64 trianglesCulled = 0;     ///< Triangles discarded by face culling, or because they are degenerate
+        Uint64 trianglesRejected = 0;   ///< 3D triangles entirely outside the view frustum, discarded before clipping
+        Uint64 trianglesAccepted = 0;   ///< 3D triangles entirely inside the view frustum, which skipped clipping
+        Uint64 trianglesClipped = 0;    ///< 3D triangles crossing the view frustum, which went through clipping
+        Uint64 trianglesOccluded = 0;   ///< 3D triangles discarded by occlusion culling, behind what is already drawn
+        Uint64 drawsOccluded = 0;       ///< Mesh draws discarded by occlusion culling, their bounding box being occluded
+        Uint64 blocksRejected = 0;      ///< Blocks skipped because they are entirely outside the triangle
+        Uint64 blocksAccepted = 0;      ///< Blocks entirely inside the triangle, filled without edge tests
+        Uint64 blocksPartial = 0;       ///< Blocks crossed by an edge of the triangle, tested pixel by pixel
+        Uint64 pixelsTested = 0;        ///< Pixels whose coverage has been tested individually
+        Uint64 pixelsShaded = 0;        ///< Pixels that passed the coverage and depth tests and were shaded
+
+        PipelineStats& operator+=(const PipelineStats& other)
+        {
+            trianglesCulled += other.trianglesCulled;
+            trianglesRejected += other.trianglesRejected;
+            trianglesAccepted += other.trianglesAccepted;
+            trianglesClipped += other.trianglesClipped;
+            trianglesOccluded += other.trianglesOccluded;
+            drawsOccluded += other.drawsOccluded;
+            blocksRejected += other.blocksRejected;
+            blocksAccepted += other.blocksAccepted;
+            blocksPartial += other.blocksPartial;
+            pixelsTested += other.pixelsTested;
+            pixelsShaded += other.pixelsShaded;
+            return *this;
+        }
+    };
+
     class NEXUS_API Pipeline
     {
       private:
-        std::array<_sr_impl::Vertex, 4> vertices{};
-        Uint8 vertexCounter{};
-        DrawMode mode;
+        _sr_impl::VertexBatch batch;                            ///< Vertices submitted since the last call to ProcessAndRender
+        std::vector<math::Vec4> projected;                      ///< Clip-space positions of the batch returned by the vertex shader
+        DrawMode mode{};
+        PipelineStats stats;                                    ///< Rasterization counters since the last call to ResetStats
+
+      public:
+        static constexpr int TileSize = 64;                    ///< Width and height in pixels of the tiles used in deferred mode
+        static constexpr size_t VertexChunkSize = 4096;        ///< Number of vertices transformed by each task of the parallel vertex processing
+        static constexpr size_t TriangleChunkSize = 1024;      ///< Number of triangles clipped by each task of the parallel vertex processing
+
+        // Tiles rasterized concurrently must never share a tile of the framebuffer
+        static_assert(TileSize % Framebuffer::TileSize == 0, "Rendering tiles must be aligned with the tiles of the framebuffer");
+
+      private:
+        std::unique_ptr<utils::ThreadPool> workers;             ///< Rendering threads used in deferred mode (the flushing thread also takes part)
+        std::vector<_sr_impl::Primitive> primitives;            ///< Primitives recorded since the last flush
+        std::vector<std::vector<Uint32>> tileBins;              ///< Indices of the recorded primitives overlapping each tile, in submission order
+        std::vector<Uint32> activeTiles;                        ///< Tiles having at least one primitive to rasterize during the flush
+        std::vector<PipelineStats> tileStats;                   ///< Rasterization counters of each active tile during the flush
+        std::deque<gfx::Surface> images;                        ///< Non-owning views of the images used by the recorded primitives
+        Framebuffer *binnedFramebuffer = nullptr;               ///< Framebuffer targeted by the recorded primitives
+        int tilesX = 0, tilesY = 0;                             ///< Dimensions of the tile grid of the binned framebuffer
+        bool deferred = false;                                  ///< Indicates if primitives are recorded instead of being rasterized immediately
+
+        std::unique_ptr<utils::ThreadPool> vertexWorkers;       ///< Threads processing the vertices of large batches, null if disabled (the submitting thread also takes part)
+        std::vector<_sr_impl::ClippedChunk> clippedChunks;      ///< Triangles processed by each chunk of the batch, submitted in chunk order
+        std::vector<PipelineStats> chunkStats;                  ///< Culling and clipping counters of each chunk of the batch
 
       private:
         /**
          * @brief Converts normalized homogeneous coordinates to screen coordinates.
          *
          * This function takes homogeneous coordinates that are normalized and converts them into screen coordinates.
-         * The transformation includes adjustments for viewport dimensions.
-         *
-         * @note: The function takes the viewport from which 1 has been subtracted from the width and height.
+         * The normalized coordinates [-1..1] are mapped onto [x..x+w] x [y..y+h], the position and size of the viewport.
          *
          * @param homogeneous The vertex with normalized homogeneous coordinates to be converted.
          * @param viewport The 2D rectangle representing the viewport.
@@ -87,7 +277,7 @@ namespace nexus { namespace sr {
          *
          * @param v0 The first vertex of the line segment.
          * @param v1 The second vertex of the line segment.
-         * @param viewport The 2D rectangle representing the viewport. (NOTE: Width and height should have 1 subtracted.)
+         * @param viewport The 2D rectangle representing the viewport, the lines stopping at its last column and row.
          * @return True if the line segment is visible after clipping, false otherwise.
          */
         static bool ClipLine2D(_sr_impl::Vertex& v0, _sr_impl::Vertex& v1, const shape2D::Rectangle& viewport);
@@ -131,39 +321,43 @@ namespace nexus { namespace sr {
          *
          * @param polygon The input and output polygon, which may be clipped against the view frustum.
          *                The function modifies this polygon in place.
+         * @param axisCount Number of axes to clip against, 2 to leave the depth unclipped.
          *
          * @return True if the resulting clipped polygon is not empty, false otherwise.
          */
-        static bool ClipPolygonXYZ(std::array<_sr_impl::Vertex, 12>& polygon, Uint8& vertexCounter);
+        static bool ClipPolygonXYZ(std::array<_sr_impl::Vertex, 12>& polygon, Uint8& vertexCounter, Uint8 axisCount = 3);
 
         /**
-         * @brief Projects and clips vertices to screen space.
+         * @brief Clips vertices already transformed by the vertex shader and projects them to screen space.
          *
-         * This function projects vertices onto the screen and clips them against the viewport.
+         * This function clips the line against the viewport (2D) or the view frustum (3D),
+         * then converts its vertices into screen coordinates.
          * The viewport dimensions are adjusted to account for the framebuffer dimensions.
          *
-         * @param line The array of vertices representing the line segment.
+         * @param line The array of vertices representing the line segment, in clip space.
          * @param vertexCounter The counter for vertices.
-         * @param mvp The model-view-projection matrix.
          * @param viewport The viewport dimensions adjusted for the framebuffer.
-         * @param shader The shader to be used.
          */
-        static void ProjectAndClipLine(std::array<_sr_impl::Vertex, 2>& line, Uint8& vertexCounter, const math::Mat4& mvp, const shape2D::Rectangle& viewport, Shader* shader);
+        static void ClipAndProjectLine(std::array<_sr_impl::Vertex, 2>& line, Uint8& vertexCounter, const shape2D::Rectangle& viewport);
 
         /**
-         * @brief Projects and clips vertices of a polygon to screen space.
+         * @brief Clips the vertices of a polygon already transformed by the vertex shader and projects them to screen space.
          *
-         * This function projects vertices of a polygon onto the screen and clips them against the viewport.
+         * This function clips the polygon against the view frustum (3D only, 2D triangles are
+         * clamped during rasterization), then converts its vertices into screen coordinates.
          * The viewport dimensions are adjusted to account for the framebuffer dimensions.
          *
-         * @param polygon The array of vertices representing the polygon.
+         * The outcodes of the vertices are checked first: polygons entirely outside one of the
+         * clipping planes are rejected and those entirely inside are projected without clipping.
+         * The w of the projected 3D vertices is replaced by its inverse, needed for perspective correct interpolation.
+         *
+         * @param polygon The array of vertices representing the polygon, in clip space.
          * @param vertexCounter The counter for vertices.
-         * @param mvp The model-view-projection matrix.
          * @param viewport The viewport dimensions adjusted for the framebuffer.
-         * @param shader The shader to be used.
          * @param is2D Flag indicating whether the rendering is in 2D.
+         * @param counters Counters of the rejected, accepted and clipped triangles.
          */
-        static void ProjectAndClipTriangle(std::array<_sr_impl::Vertex, 12>& polygon, Uint8& vertexCounter, const math::Mat4& mvp, const shape2D::Rectangle& viewport, nexus::sr::Shader* shader, bool& is2D);
+        static void ClipAndProjectTriangle(std::array<_sr_impl::Vertex, 12>& polygon, Uint8& vertexCounter, const shape2D::Rectangle& viewport, bool& is2D, PipelineStats& counters);
 
       private:
         /**
@@ -172,8 +366,9 @@ namespace nexus { namespace sr {
          * @param v0 The first vertex of the line.
          * @param v1 The second vertex of the line.
          * @param depthTest Flag indicating whether depth testing should be applied.
+         * @param bounds Pixel area outside of which nothing will be written.
          */
-        static void RasterizeLine(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, bool depthTest);
+        static void RasterizeLine(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, bool depthTest, const _sr_impl::RasterBounds& bounds);
 
         /**
          * @brief Rasterizes a triangle on the screen with vertices already transformed into screen coordinates.
@@ -187,9 +382,10 @@ namespace nexus { namespace sr {
          * @param v2 The third vertex of the triangle.
          * @param shader The shader to be used for rendering the triangle.
          * @param depthTest Flag indicating whether depth testing should be applied.
-         * @param vieport Viewport in (1,1) will have been subtracted from the dimensions. (necessary for the calculation of the boundings boxes, given that the triangles will not have been clipped)
+         * @param viewport The viewport, outside of which nothing is written since the triangles will not have been clipped.
+         * @param bounds Pixel area outside of which nothing will be written.
          */
-        static void RasterizeTriangleColor2D(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, sr::Shader* shader, bool depthTest, const shape2D::Rectangle& viewport);
+        static void RasterizeTriangleColor2D(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, sr::Shader* shader, bool depthTest, const shape2D::Rectangle& viewport, const _sr_impl::RasterBounds& bounds);
 
         /**
          * @brief Rasterizes a triangle on the screen with vertices already transformed into screen coordinates.
@@ -203,10 +399,12 @@ namespace nexus { namespace sr {
          * @param v2 The third vertex of the triangle.
          * @param shader The shader to be used for rendering the triangle.
          * @param image The image to be used for rendering the triangle.
+         * @param sampler The sampling parameters and mipmaps of the image.
          * @param depthTest Flag indicating whether depth testing should be applied.
-         * @param vieport Viewport in (1,1) will have been subtracted from the dimensions. (necessary for the calculation of the boundings boxes, given that the triangles will not have been clipped)
+         * @param viewport The viewport, outside of which nothing is written since the triangles will not have been clipped.
+         * @param bounds Pixel area outside of which nothing will be written.
          */
-        static void RasterizeTriangleImage2D(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, sr::Shader* shader, const gfx::Surface* image, bool depthTest, const shape2D::Rectangle& viewport);
+        static void RasterizeTriangleImage2D(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, sr::Shader* shader, const gfx::Surface* image, const TextureSampler& sampler, bool depthTest, const shape2D::Rectangle& viewport, const _sr_impl::RasterBounds& bounds);
 
         /**
          * @brief Rasterizes a triangle on the screen with vertices already transformed into screen coordinates.
@@ -219,8 +417,9 @@ namespace nexus { namespace sr {
          * @param v2 The third vertex of the triangle.
          * @param shader The shader to be used for rendering the triangle.
          * @param depthTest Flag indicating whether depth testing should be applied.
+         * @param bounds Pixel area outside of which nothing will be written.
          */
-        static void RasterizeTriangleColor3D(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, sr::Shader* shader, bool depthTest);
+        static void RasterizeTriangleColor3D(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, sr::Shader* shader, bool depthTest, const _sr_impl::RasterBounds& bounds);
 
         /**
          * @brief Rasterizes a triangle on the screen with vertices already transformed into screen coordinates.
@@ -233,45 +432,325 @@ namespace nexus { namespace sr {
          * @param v2 The third vertex of the triangle.
          * @param shader The shader to be used for rendering the triangle.
          * @param image The image to be used for rendering the triangle.
+         * @param sampler The sampling parameters and mipmaps of the image.
+         * @param depthTest Flag indicating whether depth testing should be applied.
+         * @param bounds Pixel area outside of which nothing will be written.
+         */
+        static void RasterizeTriangleImage3D(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, sr::Shader* shader, const gfx::Surface* image, const TextureSampler& sampler, bool depthTest, const _sr_impl::RasterBounds& bounds);
+
+        /**
+         * @brief Rasterizes a recorded primitive with the rasterizer matching its type.
+         *
+         * @param framebuffer The framebuffer we should render to.
+         * @param primitive The primitive to rasterize.
+         * @param bounds Pixel area outside of which nothing will be written.
+         */
+        static void RasterizePrimitive(Framebuffer& framebuffer, const _sr_impl::Primitive& primitive, const _sr_impl::RasterBounds& bounds);
+
+      private:
+        /**
+         * @brief Culls, clips and projects a triangle of the batch.
+         *
+         * The facing of the triangle is determined before clipping. Only reads the batch and
+         * the projected positions, so the triangles can be processed by several threads at once.
+         *
+         * @param i0 Index in the batch of the first vertex.
+         * @param i1 Index in the batch of the second vertex.
+         * @param i2 Index in the batch of the third vertex.
+         * @param viewport The viewport dimensions adjusted for the framebuffer.
+         * @param faceCulling Flag indicating whether the faces selected by `cullMode` should be discarded.
+         * @param cullMode The faces to discard when face culling is enabled.
+         * @param polygon Receives the screen-space vertices of the clipped triangle.
+         * @param vertexCounter Receives the number of vertices of the polygon.
+         * @param frontFacing Receives the facing of the triangle.
+         * @param is2D Receives whether the triangle comes from the 2D (unclipped) path.
+         * @param counters Counters of the culled, rejected, accepted and clipped triangles.
+         * @return True if the polygon has to be submitted, false if the triangle has been culled or rejected.
+         */
+        bool ClipTriangle(size_t i0, size_t i1, size_t i2, const shape2D::Rectangle& viewport, bool faceCulling, CullMode cullMode,
+                          std::array<_sr_impl::Vertex, 12>& polygon, Uint8& vertexCounter, bool& frontFacing, bool& is2D, PipelineStats& counters) const;
+
+        /**
+         * @brief Submits the triangles of a clipped polygon, unless occlusion culling discards it.
+         *
+         * The vertices of the back faces to render are submitted in reverse order,
+         * so that the rasterizers always receive counter-clockwise triangles.
+         *
+         * @param framebuffer The framebuffer we should render to.
+         * @param polygon The screen-space vertices of the polygon.
+         * @param vertexCounter The number of vertices of the polygon.
+         * @param frontFacing The facing of the triangle the polygon comes from.
+         * @param is2D Flag indicating whether the polygon comes from the 2D (unclipped) path.
+         * @param viewport The viewport dimensions adjusted for the framebuffer.
+         * @param shader The shader to be used.
+         * @param image The image to be used, can be null.
+         * @param sampler The sampling parameters and mipmaps of the image.
+         * @param depthTest Flag indicating whether depth testing should be applied.
+         * @param occlusionCulling Flag indicating whether depth tested 3D triangles hidden by the framebuffer content should be discarded.
+         */
+        void SubmitPolygon(Framebuffer& framebuffer, const _sr_impl::Vertex* polygon, Uint8 vertexCounter, bool frontFacing, bool is2D, const shape2D::Rectangle& viewport, Shader* shader, const gfx::Surface* image, const TextureSampler& sampler, bool depthTest, bool occlusionCulling);
+
+        /**
+         * @brief Culls, clips, projects and submits a triangle of the batch.
+         *
+         * @param framebuffer The framebuffer we should render to.
+         * @param i0 Index in the batch of the first vertex.
+         * @param i1 Index in the batch of the second vertex.
+         * @param i2 Index in the batch of the third vertex.
+         * @param viewport The viewport dimensions adjusted for the framebuffer.
+         * @param shader The shader to be used.
+         * @param image The image to be used, can be null.
+         * @param sampler The sampling parameters and mipmaps of the image.
+         * @param depthTest Flag indicating whether depth testing should be applied.
+         * @param faceCulling Flag indicating whether the faces selected by `cullMode` should be discarded.
+         * @param cullMode The faces to discard when face culling is enabled.
+         * @param occlusionCulling Flag indicating whether depth tested 3D triangles hidden by the framebuffer content should be discarded.
+         */
+        void ProcessTriangle(Framebuffer& framebuffer, size_t i0, size_t i1, size_t i2, const shape2D::Rectangle& viewport, Shader* shader, const gfx::Surface* image, const TextureSampler& sampler, bool depthTest, bool faceCulling, CullMode cullMode, bool occlusionCulling);
+
+        /**
+         * @brief Culls, clips and projects the triangles of the batch by chunks on the vertex processing threads, then submits them.
+         *
+         * Each chunk stores its polygons in its own buffer, the polygons are then submitted
+         * chunk after chunk by the calling thread, so the triangles keep the order of the batch.
+         *
+         * @param framebuffer The framebuffer we should render to.
+         * @param numTriangles The number of triangles of the batch, quads counting as two triangles.
+         * @param indexed Flag indicating whether the primitives are assembled from the indices of the batch.
+         * @param viewport The viewport dimensions adjusted for the framebuffer.
+         * @param shader The shader to be used.
+         * @param image The image to be used, can be null.
+         * @param sampler The sampling parameters and mipmaps of the image.
+         * @param depthTest Flag indicating whether depth testing should be applied.
+         * @param faceCulling Flag indicating whether the faces selected by `cullMode` should be discarded.
+         * @param cullMode The faces to discard when face culling is enabled.
+         * @param occlusionCulling Flag indicating whether depth tested 3D triangles hidden by the framebuffer content should be discarded.
+         */
+        void ProcessTrianglesParallel(Framebuffer& framebuffer, size_t numTriangles, bool indexed, const shape2D::Rectangle& viewport, Shader* shader, const gfx::Surface* image, const TextureSampler& sampler, bool depthTest, bool faceCulling, CullMode cullMode, bool occlusionCulling);
+
+        /**
+         * @brief Rasterizes a screen-space line immediately, or records it in deferred mode.
+         *
+         * @param framebuffer The framebuffer we should render to.
+         * @param v0 The first vertex of the line.
+         * @param v1 The second vertex of the line.
+         * @param shader The shader to be used.
+         * @param depthTest Flag indicating whether depth testing should be applied.
+         */
+        void SubmitLine(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, Shader* shader, bool depthTest);
+
+        /**
+         * @brief Rasterizes a screen-space triangle immediately, or records it in deferred mode.
+         *
+         * @param framebuffer The framebuffer we should render to.
+         * @param v0 The first vertex of the triangle.
+         * @param v1 The second vertex of the triangle.
+         * @param v2 The third vertex of the triangle.
+         * @param shader The shader to be used.
+         * @param image The image to be used, can be null.
+         * @param sampler The sampling parameters and mipmaps of the image.
          * @param depthTest Flag indicating whether depth testing should be applied.
+         * @param viewport The viewport dimensions adjusted for the framebuffer.
+         * @param is2D Flag indicating whether the triangle comes from the 2D (unclipped) path.
+         */
+        void SubmitTriangle(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, Shader* shader, const gfx::Surface* image, const TextureSampler& sampler, bool depthTest, const shape2D::Rectangle& viewport, bool is2D);
+
+        /**
+         * @brief Records a primitive and adds it to the bins of the tiles overlapping the given area.
+         *
+         * @param framebuffer The framebuffer targeted by the primitive.
+         * @param primitive The primitive to record.
+         * @param area Conservative pixel area covered by the primitive.
          */
-        static void RasterizeTriangleImage3D(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, sr::Shader* shader, const gfx::Surface* image, bool depthTest);
+        void RecordPrimitive(Framebuffer& framebuffer, _sr_impl::Primitive&& primitive, _sr_impl::RasterBounds area);
+
+        /**
+         * @brief Sets the draw mode of the vertices added to the batch.
+         *
+         * @param mode The draw mode.
+         * @throws core::NexusException if the draw mode changes while vertices are pending in the batch.
+         */
+        void SetDrawMode(DrawMode mode);
 
       public:
         /**
-         * @brief Resets the vertex counter.
+         * @brief Resets the vertex batch.
          *
-         * This function resets the vertex counter to zero.
+         * This function removes all the pending vertices, keeping the allocated storage.
          */
         void Reset();
 
         /**
-         * @brief Adds a vertex to the buffer.
+         * @brief Reserves storage in the batch for the given number of additional vertices.
          *
-         * This function adds a vertex to the buffer based on the specified draw mode.
+         * @param count The number of vertices about to be added.
+         */
+        void Reserve(size_t count);
+
+        /**
+         * @brief Adds a vertex to the batch.
+         *
+         * This function adds a vertex to the batch based on the specified draw mode.
+         * The draw mode can only change once the batch has been rendered or reset.
          *
          * @param mode The draw mode.
          * @param position The position of the vertex.
          * @param normal The normal vector of the vertex.
          * @param texcoord The texture coordinates of the vertex.
          * @param color The color of the vertex.
-         * @return True if the vertex buffer is full according to the draw mode, false otherwise.
+         * @return True if the batch only contains complete primitives according to the draw mode, false otherwise.
+         * @throws core::NexusException if the draw mode changes while vertices are pending in the batch.
          */
         bool AddVertex(DrawMode mode, const math::Vec3& position, const math::Vec3& normal, const math::Vec2& texcoord, const gfx::Color& color);
 
         /**
-         * @brief Processes and renders the vertices.
+         * @brief Sets the indices of the batch vertices forming the primitives.
+         *
+         * Vertices shared by several primitives then only have to be added and transformed once.
+         * The indices replace any previous ones and are discarded along with the batch.
+         *
+         * @param indices The vertex indices, relative to the first vertex of the batch.
+         * @param count The number of indices.
+         */
+        void SetIndices(const Uint16* indices, size_t count);
+
+        /**
+         * @brief Adds an array of vertices to the batch, transforming their positions.
          *
-         * This function processes and renders the vertices to the framebuffer using the specified shader and image.
+         * Equivalent to calling `AddVertex` for each vertex with its position transformed by `transform`
+         * and its color multiplied by `tint`. With the parallel vertex processing enabled, large arrays
+         * are written by chunks on the vertex processing threads.
+         *
+         * @param mode The draw mode.
+         * @param count The number of vertices.
+         * @param positions The positions of the vertices.
+         * @param normals The normal vectors of the vertices.
+         * @param texcoords The texture coordinates of the vertices, null to use (0, 0).
+         * @param colors The colors of the vertices, null to use white.
+         * @param tint The color by which the colors of the vertices are multiplied.
+         * @param transform The transformation applied to the positions.
+         * @throws core::NexusException if the draw mode changes while vertices are pending in the batch.
+         */
+        void AddVertices(DrawMode mode, size_t count, const math::Vec3* positions, const math::Vec3* normals, const math::Vec2* texcoords, const gfx::Color* colors, const gfx::Color& tint, const math::Mat4& transform);
+
+        /**
+         * @brief Processes and renders the vertex batch.
+         *
+         * This function transforms all the vertices of the batch in one pass, then clips and renders
+         * each complete primitive to the framebuffer using the specified shader and image.
+         * If indices have been set, the primitives are assembled from them instead of the vertex order.
+         * The batch is reset afterwards, an incomplete trailing primitive is discarded.
          *
          * @param framebuffer The framebuffer to render to.
          * @param mvp The model-view-projection matrix.
          * @param viewport The viewport dimensions adjusted for the framebuffer.
          * @param shader The shader to be used.
          * @param image The image to be used for rendering.
+         * @param sampler The sampling parameters and mipmaps of the image.
          * @param depthTest Flag indicating whether depth testing should be applied.
+         * @param faceCulling Flag indicating whether the faces selected by `cullMode` should be discarded.
+         * @param cullMode The faces to discard when face culling is enabled.
+         * @param occlusionCulling Flag indicating whether depth tested 3D triangles hidden by the framebuffer content should be discarded.
+         */
+        void ProcessAndRender(Framebuffer& framebuffer, const math::Mat4& mvp, const shape2D::Rectangle& viewport, Shader* shader, const gfx::Surface* image, const TextureSampler& sampler, bool depthTest, bool faceCulling, CullMode cullMode, bool occlusionCulling);
+
+        /**
+         * @brief Checks if a bounding box is hidden by the content of the framebuffer.
+         *
+         * The corners of the box are transformed by the given matrix, as done by the default vertex shader,
+         * then the screen area and the minimum depth they cover are checked against the hierarchical depth
+         * buffer of the framebuffer. Boxes crossing the near plane are always considered visible.
+         *
+         * @note: In deferred mode, only the primitives already flushed are taken into account.
+         *
+         * @param framebuffer The framebuffer to test against.
+         * @param mvp The model-view-projection matrix.
+         * @param viewport The viewport dimensions adjusted for the framebuffer.
+         * @param aabb The bounding box to test.
+         * @return True if anything inside the box would fail the depth test, false otherwise.
+         */
+        bool IsOccluded(Framebuffer& framebuffer, const math::Mat4& mvp, const shape2D::Rectangle& viewport, const shape3D::AABB& aabb) const;
+
+        /**
+         * @brief Checks if a draw can be skipped because its bounding box is occluded, and counts it if so.
+         *
+         * @param framebuffer The framebuffer targeted by the draw.
+         * @param mvp The model-view-projection matrix.
+         * @param viewport The viewport dimensions adjusted for the framebuffer.
+         * @param aabb The bounding box of the vertices of the draw.
+         * @return True if the draw must be skipped, false otherwise.
+         */
+        bool CullOccludedDraw(Framebuffer& framebuffer, const math::Mat4& mvp, const shape2D::Rectangle& viewport, const shape3D::AABB& aabb);
+
+        /**
+         * @brief Enables the deferred mode.
+         *
+         * In deferred mode the processed primitives are not rasterized immediately, they are
+         * recorded into bins of `TileSize` x `TileSize` pixels, then each tile is rasterized
+         * independently by the rendering threads when `Flush()` is called.
+         * Since each tile only writes to its own pixels and depth values, and rasterizes its
+         * primitives in submission order, the result is identical to the immediate mode.
+         *
+         * @param numThreads Number of threads rasterizing the tiles, 0 to use all the hardware threads.
+         */
+        void EnableDeferred(int numThreads = 0);
+
+        /**
+         * @brief Flushes the recorded primitives and goes back to the immediate mode.
+         */
+        void DisableDeferred();
+
+        /**
+         * @brief Indicates if the pipeline is in deferred mode.
+         */
+        bool IsDeferred() const
+        {
+            return deferred;
+        }
+
+        /**
+         * @brief Enables the parallel processing of the vertices of large batches.
+         *
+         * The batches of more than `VertexChunkSize` vertices run the vertex shader by chunks on a pool
+         * of threads, and the batches of more than `TriangleChunkSize` triangles are culled, clipped and
+         * projected by chunks too, each chunk into its own buffer. The triangles are then submitted to
+         * the rasterizers in the order of the batch, so the result is identical to the serial processing.
+         *
+         * @warning: The vertex function of the shaders must support being called from several threads at once.
+         *
+         * @param numThreads Number of threads processing the vertices, 0 to use all the hardware threads.
+         */
+        void EnableParallelVertexProcessing(int numThreads = 0);
+
+        /**
+         * @brief Goes back to processing all the vertices on the submitting thread.
+         */
+        void DisableParallelVertexProcessing();
+
+        /**
+         * @brief Rasterizes all the primitives recorded since the last flush.
+         *
+         * Does nothing if there is nothing pending, or if the pipeline is in immediate mode.
+         */
+        void Flush();
+
+        /**
+         * @brief Gets the rasterization counters accumulated since the last reset.
+         *
+         * In deferred mode, the primitives are only counted once they have been flushed.
+         */
+        const PipelineStats& GetStats() const
+        {
+            return stats;
+        }
+
+        /**
+         * @brief Resets the rasterization counters to zero.
          */
-        void ProcessAndRender(Framebuffer& framebuffer, const math::Mat4& mvp, const shape2D::Rectangle& viewport, Shader* shader, const gfx::Surface* image, bool depthTest);
+        void ResetStats()
+        {
+            stats = PipelineStats();
+        }
     };
 
 }}
@@ -0,0 +1,173 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+
+#ifndef NEXUS_SR_RASTER_KERNELS_HPP
+#define NEXUS_SR_RASTER_KERNELS_HPP
+
+#include "../../platform/nxPlatform.hpp"
+#include "../../gfx/nxColor.hpp"
+#include "../../math/nxVec4.hpp"
+#include "./nxEnums.hpp"
+#include <SDL_stdinc.h>
+
+namespace nexus { namespace sr {
+
+    /**
+     * @brief Instruction sets that can be used by the triangle rasterization kernels.
+     */
+    enum class SimdPath : Uint8
+    {
+        Scalar,     ///< Portable reference implementation, one pixel at a time
+        SSE2,       ///< x86 implementation, 4 pixels per instruction
+        AVX2,       ///< x86 implementation, 8 pixels per instruction
+        NEON        ///< ARM64 implementation, 4 pixels per instruction
+    };
+
+    /**
+     * @brief Checks if the given rasterization path is compiled in and supported by the CPU.
+     * @param path The path to check.
+     * @return True if the path can be used, false otherwise.
+     */
+    NEXUS_API bool IsSimdPathSupported(SimdPath path);
+
+    /**
+     * @brief Gets the path currently used by the triangle rasterizers.
+     *
+     * By default, the widest path supported by the CPU is selected on first use.
+     *
+     * @return The current rasterization path.
+     */
+    NEXUS_API SimdPath GetSimdPath();
+
+    /**
+     * @brief Forces the path used by the triangle rasterizers.
+     *
+     * All the paths produce exactly the same pixels, forcing `SimdPath::Scalar`
+     * is mainly useful to compare the results or the performances against the reference.
+     *
+     * @warning This must not be called while primitives are being rendered (e.g. by deferred rendering workers).
+     *
+     * @param path The path to use.
+     * @return True if the path has been selected, false if it is not supported.
+     */
+    NEXUS_API bool SetSimdPath(SimdPath path);
+
+}}
+
+namespace _sr_impl {
+
+    /**
+     * @brief Per-triangle constants shared by all the blocks of pixels of a triangle.
+     */
+    struct TriangleSetup
+    {
+        int stepW0, stepW1, stepW2;                     ///< Horizontal increments of the edge functions
+        int bias0, bias1, bias2;                        ///< Amounts subtracted from the edge functions by the fill rule
+        float invArea;                                  ///< Inverse of the sum of the unbiased edge functions (twice the area)
+        float z0, z1, z2;                               ///< Depth key of each vertex, before rounding for the 16-bit format
+        float zScale, zOffset;                          ///< Conversion from the interpolated keys to the depths
+        nexus::sr::DepthFormat depthFormat;             ///< Format of the depth buffer
+        float invW0, invW1, invW2;                      ///< Inverse of the clip-space w of each vertex, 1 for 2D triangles
+        bool perspective;                               ///< Indicates if the weights must be corrected, the w of the vertices being different
+        nexus::math::Vec4 color0, color1, color2;       ///< Normalized color of each vertex
+    };
+
+    /**
+     * @brief Interpolated values of a horizontal block of pixels, written by the rasterization kernels.
+     */
+    struct FragmentBlock
+    {
+        static constexpr int Size = 8;                  ///< Number of pixels processed by a kernel call
+
+        alignas(32) float aW0[Size];                    ///< Barycentric weights of the first vertex, perspective corrected
+        alignas(32) float aW1[Size];                    ///< Barycentric weights of the second vertex, perspective corrected
+        alignas(32) float aW2[Size];                    ///< Barycentric weights of the third vertex, perspective corrected
+        alignas(32) float z[Size];                      ///< Interpolated depths
+        alignas(32) nexus::gfx::Color colors[Size];     ///< Interpolated vertex colors
+    };
+
+    /**
+     * @brief Set of rasterization kernels implemented for one instruction set.
+     */
+    struct RasterKernels
+    {
+        /**
+         * @brief Evaluates the edge functions of up to `FragmentBlock::Size` consecutive pixels,
+         *        performs the depth test and interpolates the depth and the vertex colors.
+         *
+         * A pixel is inside the triangle if its three (biased) edge functions are positive or zero.
+         * The barycentric weights are obtained by adding the biases back and multiplying by `invArea`.
+         * The depth keys are interpolated and tested as they are stored, the 16-bit ones being rounded with
+         * `sr::DepthBuffer::QuantizeUnorm16()`, then converted back to depths with `zScale` and `zOffset`.
+         * For perspective triangles, the weights are then multiplied by the `invW` of their vertex and divided
+         * by their sum, the interpolated 1/w, so that the colors and the attributes interpolated by the
+         * rasterizers from the weights are perspective correct. The depth, already linear on screen, is not.
+         *
+         * @param triangle The triangle constants.
+         * @param w0, w1, w2 Edge function values of the first pixel of the block.
+         * @param count Number of pixels in the block.
+         * @param covered True if all the pixels are known to be inside the triangle, the edge tests are then skipped.
+         * @param depth Depth values of the first pixel of the block, in the format of the triangle,
+         *              or nullptr to disable the depth test. The depth of the pixels which pass the test is updated.
+         * @param block Receives the interpolated values of the pixels to shade.
+         *
+         * @return Bit mask of the pixels to shade (bit `i` for the pixel `i` of the block).
+         */
+        Uint32 (*ProcessBlock)(const TriangleSetup& triangle, int w0, int w1, int w2, int count, bool covered, void* depth, FragmentBlock& block);
+
+        /**
+         * @brief Evaluates the edge functions of up to `FragmentBlock::Size` consecutive pixels and performs the depth test,
+         *        without interpolating anything else.
+         *
+         * Used for the samples of multisampled framebuffers, the edge functions then being those of one sample of each
+         * pixel and `depth` pointing into the depth values of this sample. The tests are the same as `ProcessBlock()`.
+         *
+         * @param triangle The triangle constants.
+         * @param w0, w1, w2 Edge function values of the first pixel of the block.
+         * @param count Number of pixels in the block.
+         * @param covered True if all the pixels are known to be inside the triangle, the edge tests are then skipped.
+         * @param depth Depth values of the first pixel of the block, in the format of the triangle,
+         *              or nullptr to disable the depth test. The depth of the pixels which pass the test is updated.
+         *
+         * @return Bit mask of the pixels which pass the tests (bit `i` for the pixel `i` of the block).
+         */
+        Uint32 (*CoverBlock)(const TriangleSetup& triangle, int w0, int w1, int w2, int count, bool covered, void* depth);
+
+        /**
+         * @brief Alpha blends up to `FragmentBlock::Size` colors into consecutive RGBA32 pixels.
+         *
+         * Fully transparent colors are discarded and fully opaque ones replace the destination.
+         *
+         * @param dst The first destination pixel.
+         * @param src The colors to write.
+         * @param mask Bit mask of the colors to write.
+         * @param count Number of pixels in the block.
+         */
+        void (*WriteBlock)(nexus::gfx::Color* dst, const nexus::gfx::Color* src, Uint32 mask, int count);
+    };
+
+    /**
+     * @brief Gets the kernels of the rasterization path currently selected.
+     */
+    NEXUS_API const RasterKernels& GetRasterKernels();
+
+}
+
+#endif //NEXUS_SR_RASTER_KERNELS_HPP
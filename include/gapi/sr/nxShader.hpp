@@ -21,9 +21,33 @@
 #define NEXUS_SR_SHADER_HPP
 
 #include "../../gfx/nxSurface.hpp"
+#include "./nxTextureSampler.hpp"
+#include "../../math/nxVec3.hpp"
+#include "../../math/nxVec2.hpp"
 
 namespace nexus { namespace sr {
 
+    /**
+     * @brief Row of consecutive fragments of a triangle, shaded in a single call.
+     *
+     * Only the fragments whose bit is set in `mask` are covered by the triangle and
+     * passed the depth test, the values of the others are undefined.
+     */
+    struct FragmentSpan
+    {
+        static constexpr int MaxSize = 8;       ///< Maximum number of fragments in a span
+
+        const gfx::Surface *image;              ///< Texture image, or nullptr if the triangle is not textured
+        const TextureSampler *sampler;          ///< Sampling parameters and mipmaps of the image, to filter the texels with `Sample`
+        float lod;                              ///< Mipmap level of the triangle, to pass to `sampler->Sample`
+        math::IVec2 fragCoord;                  ///< Coordinates of the first fragment, the others follow on the same row
+        int count;                              ///< Number of fragments in the span
+        Uint32 mask;                            ///< Bit `i` set if fragment `i` must be shaded
+        math::Vec2 texCoords[MaxSize];          ///< Texture coordinates (only set if `image` is not nullptr)
+        math::Vec3 fragNormals[MaxSize];        ///< Normal vectors
+        gfx::Color fragColors[MaxSize];         ///< Interpolated vertex colors
+    };
+
     /**
      * @brief Base class for shaders used in the rasterizer.
      *
@@ -87,6 +111,23 @@ namespace nexus { namespace sr {
             return image->GetFragUnsafe(texCoord) * fragColor;
         }
 
+        /**
+         * @brief Performs fragment processing for a whole span of fragments.
+         *
+         * This is called by the rasterizer once per row of fragments, overriding it allows a shader
+         * to process several fragments at once instead of paying for a call per fragment.
+         * The default implementation calls the per-fragment `Fragment` overloads above.
+         *
+         * @note The per-fragment overloads receive the level 0 of the textures and sample their nearest texel,
+         *       filtering and mipmaps are only available to overrides of this function through `span.sampler`.
+         *
+         * @note The default shader itself is never called, the rasterizer inlines what it does.
+         *
+         * @param span The fragments to process.
+         * @param out The processed fragment colors, only those of the fragments in `span.mask` are used.
+         */
+        virtual void Fragment(const FragmentSpan& span, gfx::Color* out);
+
         /**
          * @brief Begins shader processing.
          */
@@ -26,8 +26,11 @@
 #include "../../gfx/nxColor.hpp"
 #include "../../gfx/nxPixel.hpp"
 
+#include "./nxTextureSampler.hpp"
 #include "./nxContextual.hpp"
 #include "./nxCamera3D.hpp"
+#include "./nxEnums.hpp"
+#include <vector>
 
 namespace nexus { namespace sr {
     using NinePatchInfo = _ext_gfx_gapi_impl::NinePatchInfo;
@@ -37,6 +40,20 @@ namespace _sr_impl {
 
     class Texture : public nexus::sr::Contextual, public nexus::gfx::Surface
     {
+      private:
+        std::vector<nexus::gfx::Surface> mipmaps;                               ///< Levels 1 to n of the mip chain, empty if not generated
+        nexus::sr::TextureFilter filter = nexus::sr::TextureFilter::Nearest;   ///< Filtering used when the texture is drawn
+        nexus::sr::TextureWrap wrap = nexus::sr::TextureWrap::Clamp;           ///< Wrapping used when the texture is drawn
+        nexus::sr::TextureLayout layout = nexus::sr::TextureLayout::Linear;    ///< Storage of the texels sampled when the texture is drawn
+        std::vector<nexus::gfx::Color> tiledTexels;                             ///< Texels of all the levels in the tiled layout, empty if linear
+        std::vector<nexus::sr::TextureSampler::TiledLevel> tiledLevels;        ///< Location of each level in `tiledTexels`
+
+      private:
+        /**
+         * @brief Copies the texture and its mipmaps into `tiledTexels`, or releases them for the linear layout.
+         */
+        void UpdateTiles();
+
       public:
         Texture(nexus::sr::Context& ctx)
         : nexus::sr::Contextual(ctx)
@@ -53,6 +70,11 @@ namespace _sr_impl {
         , Surface(width, height, color, format)
         { }
 
+        Texture(nexus::sr::Context& ctx, int width, int height, void* pixels, int pitch, nexus::gfx::PixelFormat format)
+        : nexus::sr::Contextual(ctx)
+        , Surface(width, height, pixels, pitch, format)
+        { }
+
         Texture(nexus::sr::Context& ctx, const std::string& filePath)
         : nexus::sr::Contextual(ctx)
         , Surface(filePath)
@@ -78,6 +100,86 @@ namespace _sr_impl {
         , Surface(data, size, format)
         { }
 
+        /**
+         * @brief Generates the mip chain of the texture, down to 1x1 pixel.
+         *
+         * Each level is an RGBA32 surface half the size of the previous one, box filtered from the
+         * previous level by `gfx::Surface::GenerateMipChain`. The mipmaps are used by the rasterizer
+         * to sample minified textures, they must be generated again if the texture is modified.
+         * With the tiled layout, the tiles are updated too.
+         */
+        void GenerateMipmaps();
+
+        /**
+         * @brief Releases the mip chain of the texture.
+         */
+        void ClearMipmaps()
+        {
+            mipmaps.clear();
+            UpdateTiles();
+        }
+
+        /**
+         * @brief Gets the number of mipmap levels generated, not counting the texture itself.
+         */
+        int GetMipmapCount() const
+        {
+            return static_cast<int>(mipmaps.size());
+        }
+
+        /**
+         * @brief Sets the filtering used to sample the texture when it is drawn.
+         * @param filter The texture filter, `Nearest` by default.
+         */
+        void SetFilter(nexus::sr::TextureFilter filter)
+        {
+            this->filter = filter;
+        }
+
+        /**
+         * @brief Sets how the texture coordinates outside [0..1] are handled when the texture is drawn.
+         * @param wrap The texture wrap, `Clamp` by default.
+         */
+        void SetWrap(nexus::sr::TextureWrap wrap)
+        {
+            this->wrap = wrap;
+        }
+
+        /**
+         * @brief Sets the storage layout of the texels sampled when the texture is drawn.
+         *
+         * The tiled layout copies the texture and its mipmaps into tiles, which speeds up the
+         * sampling of rotated or vertically stretched textures. Like the mipmaps, the copy
+         * is not updated automatically: set the layout again if the texture is modified.
+         *
+         * @param layout The texture layout, `Linear` by default.
+         */
+        void SetLayout(nexus::sr::TextureLayout layout)
+        {
+            this->layout = layout;
+            UpdateTiles();
+        }
+
+        /**
+         * @brief Gets the storage layout of the texels sampled when the texture is drawn.
+         */
+        nexus::sr::TextureLayout GetLayout() const
+        {
+            return layout;
+        }
+
+        /**
+         * @brief Gets the sampler describing how to sample this texture, to pass to `sr::Context::SetTexture`.
+         * @return The sampler, which refers to the mipmaps and the tiles of the texture.
+         */
+        nexus::sr::TextureSampler GetSampler() const
+        {
+            return {
+                mipmaps.data(), static_cast<int>(mipmaps.size()), filter, wrap,
+                tiledTexels.empty() ? nullptr : tiledTexels.data(), tiledLevels.data()
+            };
+        }
+
         /**
          * @brief Draw the texture onto another texture or screen, specifying source and destination rectangles.
          * 
@@ -241,6 +343,24 @@ namespace nexus { namespace sr {
         : Container(ctx, width, height, color, format)
         { }
 
+        /**
+         * @brief Constructor to create a Texture over a pixel buffer owned by the caller.
+         *
+         * The pixels are used in place, without copy, and are never freed by the Texture,
+         * so the buffer must outlive it. It can be filled with `gfx::Surface::DecodeInto`.
+         *
+         * @param ctx The software rasterizer context to link the Texture to.
+         * @param width The width of the texture.
+         * @param height The height of the texture.
+         * @param pixels The pixel buffer, aligned on the size of a pixel.
+         * @param pitch The number of bytes between two rows of the buffer.
+         * @param format Optional pixel format of the buffer (default is PixelFormat::RGBA32).
+         * @throws core::NexusException if the buffer does not fit the size and format.
+         */
+        Texture(sr::Context& ctx, int width, int height, void* pixels, int pitch, gfx::PixelFormat format = gfx::PixelFormat::RGBA32)
+        : Container(ctx, width, height, pixels, pitch, format)
+        { }
+
         /**
          * @brief Constructor to create a Surface object by loading an image from a file.
          *
@@ -0,0 +1,211 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef NEXUS_SR_TEXTURE_SAMPLER_HPP
+#define NEXUS_SR_TEXTURE_SAMPLER_HPP
+
+#include "../../gfx/nxPixelAccess.hpp"
+#include "../../gfx/nxSurface.hpp"
+#include "../../gfx/nxColor.hpp"
+#include "../../math/nxVec2.hpp"
+#include "./nxEnums.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace nexus { namespace sr {
+
+    /**
+     * @brief Sampling parameters and mipmaps of a texture, used by the rasterizer to read its texels.
+     *
+     * The level 0 is the texture itself, which is given separately to the sampling functions,
+     * so that a default constructed sampler samples any texture with the nearest texel.
+     *
+     * @note The sampler does not own the mipmaps nor the tiles, they must outlive the rendering (up to `Flush` in deferred mode).
+     */
+    struct NEXUS_API TextureSampler
+    {
+        /**
+         * @brief Location of a mipmap level in the tiled texels (see `TextureLayout::Tiled`).
+         *
+         * The tiles of a level are stored row by row, and the texels of each tile too. The last tiles
+         * of a row or a column can be partially outside the level, these texels are never read.
+         */
+        struct TiledLevel
+        {
+            static constexpr int TileShift = 2;                 ///< Log2 of the size of a tile
+            static constexpr int TileSize = 1 << TileShift;     ///< Width and height of a tile, in texels
+            static constexpr int TileMask = TileSize - 1;
+
+            int offset;                 ///< Index of the first texel of the level
+            int tilesPerRow;            ///< Number of tiles in a row of the level
+
+            /**
+             * @brief Gets the index of the texel at the given coordinates, which must be within the level.
+             */
+            int Index(int x, int y) const
+            {
+                const int tile = (y >> TileShift) * tilesPerRow + (x >> TileShift);
+                return offset + (tile << (2 * TileShift)) + ((y & TileMask) << TileShift) + (x & TileMask);
+            }
+        };
+
+        const gfx::Surface *mipmaps = nullptr;              ///< Levels 1 to `mipmapCount` of the texture, each half the size of the previous one
+        int mipmapCount = 0;                                ///< Number of levels in `mipmaps`
+        TextureFilter filter = TextureFilter::Nearest;      ///< Filtering of the texels
+        TextureWrap wrap = TextureWrap::Clamp;              ///< Handling of the texture coordinates outside [0..1]
+        const gfx::Color *tiledTexels = nullptr;            ///< RGBA32 texels of all the levels in the tiled layout, null to read the surfaces
+        const TiledLevel *tiledLevels = nullptr;            ///< Location of the levels 0 to `mipmapCount` in `tiledTexels`
+
+        /**
+         * @brief Computes the mipmap level to use for a triangle.
+         *
+         * The level of detail is obtained from the ratio between the area covered by the triangle
+         * in the texture and its area on screen, which is constant over the triangle in 2D and an
+         * approximation of the UV derivatives at each pixel in 3D.
+         *
+         * @param image The texture (level 0).
+         * @param uv0, uv1, uv2 Texture coordinates of the vertices.
+         * @param p0, p1, p2 Screen positions of the vertices.
+         * @return The level of detail, between 0 and `mipmapCount`.
+         */
+        float ComputeLod(const gfx::Surface* image, const math::Vec2& uv0, const math::Vec2& uv1, const math::Vec2& uv2,
+                         const math::Vec2& p0, const math::Vec2& p1, const math::Vec2& p2) const
+        {
+            if (mipmapCount == 0) return 0.0f;
+
+            const math::Vec2 duv1 = uv1 - uv0, duv2 = uv2 - uv0;
+            const math::Vec2 dp1 = p1 - p0, dp2 = p2 - p0;
+
+            const float texelArea = std::abs(duv1.x * duv2.y - duv2.x * duv1.y) * image->GetWidth() * image->GetHeight();
+            const float pixelArea = std::abs(dp1.x * dp2.y - dp2.x * dp1.y);
+
+            if (pixelArea <= 0.0f || texelArea <= pixelArea) return 0.0f;
+
+            return std::min(0.5f * std::log2(texelArea / pixelArea), static_cast<float>(mipmapCount));
+        }
+
+        /**
+         * @brief Samples the texture at the given coordinates.
+         *
+         * @param image The texture (level 0).
+         * @param uv The texture coordinates.
+         * @param lod The level of detail returned by `ComputeLod`.
+         * @return The filtered color of the texture.
+         */
+        gfx::Color Sample(const gfx::Surface* image, const math::Vec2& uv, float lod) const
+        {
+            const int nearestLevel = std::min(static_cast<int>(lod + 0.5f), mipmapCount);
+
+            switch (filter)
+            {
+                case TextureFilter::Nearest:
+                    return SampleNearest(image, nearestLevel, uv);
+
+                case TextureFilter::Bilinear:
+                    return SampleBilinear(image, nearestLevel, uv);
+
+                case TextureFilter::Trilinear:
+                {
+                    const int level = std::min(static_cast<int>(lod), mipmapCount);
+                    const int weight = static_cast<int>((lod - level) * 256.0f);
+
+                    const gfx::Color c0 = SampleBilinear(image, level, uv);
+                    if (weight == 0 || level >= mipmapCount) return c0;
+
+                    return Mix(c0, SampleBilinear(image, level + 1, uv), weight);
+                }
+            }
+
+            return SampleNearest(image, 0, uv);
+        }
+
+      private:
+        const gfx::Surface* GetLevel(const gfx::Surface* image, int level) const
+        {
+            return level > 0 ? mipmaps + level - 1 : image;
+        }
+
+        gfx::Color Fetch(const gfx::Surface* surface, int level, int x, int y) const
+        {
+            if (tiledTexels)
+            {
+                return tiledTexels[tiledLevels[level].Index(x, y)];
+            }
+
+            return surface->GetPixelFormat() == gfx::PixelFormat::RGBA32
+                ? surface->GetPixelUnsafe<gfx::PixelFormat::RGBA32>(x, y)
+                : surface->GetPixelUnsafe(x, y);
+        }
+
+        static gfx::Color Mix(const gfx::Color& c0, const gfx::Color& c1, int weight)
+        {
+            const int inv = 256 - weight;
+
+            return gfx::Color(
+                static_cast<Uint8>((c0.r * inv + c1.r * weight) >> 8),
+                static_cast<Uint8>((c0.g * inv + c1.g * weight) >> 8),
+                static_cast<Uint8>((c0.b * inv + c1.b * weight) >> 8),
+                static_cast<Uint8>((c0.a * inv + c1.a * weight) >> 8));
+        }
+
+        int WrapTexel(int i, int size) const
+        {
+            if (wrap == TextureWrap::Repeat) return ((i % size) + size) % size;
+            return std::clamp(i, 0, size - 1);
+        }
+
+        gfx::Color SampleNearest(const gfx::Surface* image, int level, math::Vec2 uv) const
+        {
+            const gfx::Surface *surface = GetLevel(image, level);
+
+            if (wrap == TextureWrap::Repeat)
+            {
+                uv.x -= std::floor(uv.x), uv.y -= std::floor(uv.y);
+            }
+            else
+            {
+                uv.x = std::clamp(uv.x, 0.0f, 1.0f), uv.y = std::clamp(uv.y, 0.0f, 1.0f);
+            }
+
+            return Fetch(surface, level, uv.x * (surface->GetWidth() - 1), uv.y * (surface->GetHeight() - 1));
+        }
+
+        gfx::Color SampleBilinear(const gfx::Surface* image, int level, const math::Vec2& uv) const
+        {
+            const gfx::Surface *surface = GetLevel(image, level);
+            const int w = surface->GetWidth(), h = surface->GetHeight();
+
+            // Texel coordinates relative to the centers of the texels
+            const float x = uv.x * w - 0.5f, y = uv.y * h - 0.5f;
+            const float xFloor = std::floor(x), yFloor = std::floor(y);
+
+            const int x0 = WrapTexel(static_cast<int>(xFloor), w), x1 = WrapTexel(static_cast<int>(xFloor) + 1, w);
+            const int y0 = WrapTexel(static_cast<int>(yFloor), h), y1 = WrapTexel(static_cast<int>(yFloor) + 1, h);
+
+            const int fx = static_cast<int>((x - xFloor) * 256.0f);
+            const int fy = static_cast<int>((y - yFloor) * 256.0f);
+
+            return Mix(Mix(Fetch(surface, level, x0, y0), Fetch(surface, level, x1, y0), fx),
+                       Mix(Fetch(surface, level, x0, y1), Fetch(surface, level, x1, y1), fx), fy);
+        }
+    };
+
+}}
+
+#endif //NEXUS_SR_TEXTURE_SAMPLER_HPP
@@ -27,6 +27,7 @@
 #include "gfx/nxColor.hpp"
 #include <SDL_video.h>
 #include <memory>
+#include <vector>
 
 namespace nexus { namespace sr {
 
@@ -46,6 +47,11 @@ namespace nexus { namespace sr {
         std::unique_ptr<Context> ctx = nullptr;     ///< A unique pointer to the sr::Context.
         std::unique_ptr<Framebuffer> framebuffer;   ///< Window framebuffer.
 
+      private:
+        std::vector<shape2D::Rectangle> damagedRects;   ///< Areas of the framebuffer updated by the last call to `End()`
+        bool damagedRectsOnly = false;                  ///< Whether `End()` only updates the damaged areas of the window
+        bool skipUnchangedFrames = false;               ///< Whether `End()` skips the update of the frames without damage
+
       public:
         /**
          * @brief Create an instance of an inactive window where no allocation or context creation will be made.
@@ -120,6 +126,56 @@ namespace nexus { namespace sr {
          * updating and drawing the internal render batch.
          */
         sr::Window& End();
+
+        /**
+         * @brief Makes `End()` only update the areas of the window drawn or cleared during the frame.
+         *
+         * The damaged areas are tracked by the framebuffer (see `Framebuffer::GetDamagedRects()`). Combined
+         * with the lazy clear of the framebuffer, the areas cleared without having been drawn are not updated.
+         *
+         * @warning: Pixels written in the framebuffer outside the pipeline are not tracked.
+         */
+        void EnableDamagedRectsOnly()
+        {
+            damagedRectsOnly = true;
+        }
+
+        /**
+         * @brief Makes `End()` update the whole window again (default).
+         */
+        void DisableDamagedRectsOnly()
+        {
+            damagedRectsOnly = false;
+        }
+
+        /**
+         * @brief Makes `End()` skip the update of the window when nothing has been drawn or cleared during the frame.
+         *
+         * @warning: Pixels written in the framebuffer outside the pipeline are not tracked.
+         */
+        void EnableSkipUnchangedFrames()
+        {
+            skipUnchangedFrames = true;
+        }
+
+        /**
+         * @brief Makes `End()` update the window even when nothing has changed (default).
+         */
+        void DisableSkipUnchangedFrames()
+        {
+            skipUnchangedFrames = false;
+        }
+
+        /**
+         * @brief Gets the areas of the window updated by the last call to `End()`.
+         *
+         * @return The updated rectangles, empty if the frame was skipped, or if the whole window was
+         *         updated without tracking the damaged areas.
+         */
+        const std::vector<shape2D::Rectangle>& GetUpdatedRects() const
+        {
+            return damagedRects;
+        }
     };
 
 }}
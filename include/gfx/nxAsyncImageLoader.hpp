@@ -0,0 +1,175 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef NEXUS_GFX_ASYNC_IMAGE_LOADER_HPP
+#define NEXUS_GFX_ASYNC_IMAGE_LOADER_HPP
+
+#include "../platform/nxPlatform.hpp"
+#include "../utils/nxThreadPool.hpp"
+#include "./nxSurface.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <deque>
+
+namespace nexus { namespace gfx {
+
+    /**
+     * @brief Decodes images into Surfaces on a pool of worker threads.
+     *
+     * Each load first reads the size of the image from its header, then waits until its decoded
+     * pixels fit in the memory budget before being decoded. The budget covers the images being
+     * decoded and the decoded images not yet handed over, an image larger than the whole budget
+     * being decoded alone. A load returns a future of the Surface, which also reports decoding errors.
+     *
+     * A load can be given a completion callback, for example to upload the image to a texture.
+     * These callbacks are run by `Poll` or `Flush`, on the thread calling them, and the future
+     * of such a load is only fulfilled after its callback.
+     */
+    class NEXUS_API AsyncImageLoader
+    {
+      public:
+        using Callback = std::function<void(Surface&)>;     ///< Completion callback, can modify the Surface before it is handed over.
+
+      private:
+        struct Request
+        {
+            std::string filePath;                           ///< Path of the image, if loaded from a file.
+            const void *data = nullptr;                     ///< Encoded image, if loaded from memory.
+            size_t size = 0;                                ///< Size of the encoded image in memory.
+            Callback onLoaded;                              ///< Optional completion callback.
+            std::promise<Surface> promise;                  ///< Promise of the decoded Surface.
+            Surface surface;                                ///< Decoded Surface waiting for its callback.
+            size_t cost = 0;                                ///< Estimated size of the decoded pixels in bytes.
+        };
+
+        using RequestPtr = std::shared_ptr<Request>;
+
+      private:
+        std::deque<RequestPtr> waiting;                     ///< Measured loads waiting for the memory budget.
+        std::deque<RequestPtr> completed;                   ///< Decoded loads waiting for their callback.
+        mutable std::mutex mutex;                           ///< Mutex protecting the state of the loads.
+        std::condition_variable cvCompleted;                ///< Signaled when a load is completed or handed over.
+        size_t memoryBudget;                                ///< Maximum size in bytes of the pixels held by the loader, 0 for no limit.
+        size_t memoryUsage = 0;                             ///< Size in bytes of the pixels currently held by the loader.
+        size_t pendingCount = 0;                            ///< Number of loads not yet handed over.
+        utils::ThreadPool pool;                             ///< Worker threads, destroyed first so that no task outlives the loader.
+
+      private:
+        std::future<Surface> Submit(RequestPtr request);
+        void Measure(const RequestPtr& request);
+        void Decode(const RequestPtr& request);
+        void Release(size_t cost);
+        void Dispatch(std::unique_lock<std::mutex>& lock);
+
+      public:
+        /**
+         * @brief Creates the loader and starts its worker threads.
+         *
+         * @param numThreads Number of worker threads, if 0 the number of hardware threads is used.
+         * @param memoryBudget Maximum size in bytes of the decoded pixels held by the loader, 0 for no limit.
+         */
+        explicit AsyncImageLoader(size_t numThreads = 0, size_t memoryBudget = 0);
+
+        AsyncImageLoader(const AsyncImageLoader&) = delete;
+        AsyncImageLoader& operator=(const AsyncImageLoader&) = delete;
+
+        /**
+         * @brief Finishes every load, running the remaining callbacks on the calling thread.
+         */
+        ~AsyncImageLoader();
+
+        /**
+         * @brief Queues the loading of an image file.
+         *
+         * @param filePath The path to the image file.
+         * @param onLoaded Optional callback run by `Poll` or `Flush` once the image is decoded.
+         * @return A future of the loaded Surface, holding the exception of the load if it failed.
+         */
+        std::future<Surface> Load(const std::string& filePath, Callback onLoaded = nullptr);
+
+        /**
+         * @brief Queues the loading of an image stored in memory.
+         *
+         * @param data A pointer to the start of the memory block containing the image data,
+         *             which must stay valid until the future is fulfilled.
+         * @param size The size of the memory block.
+         * @param onLoaded Optional callback run by `Poll` or `Flush` once the image is decoded.
+         * @return A future of the loaded Surface, holding the exception of the load if it failed.
+         */
+        std::future<Surface> Load(const void* data, size_t size, Callback onLoaded = nullptr);
+
+        /**
+         * @brief Queues the loading of a list of image files.
+         *
+         * @param filePaths The paths to the image files.
+         * @param onLoaded Optional callback run by `Poll` or `Flush` once an image is decoded,
+         *                 receiving the index of its path in the list.
+         * @return The futures of the loaded Surfaces, in the order of the paths.
+         */
+        std::vector<std::future<Surface>> Load(const std::vector<std::string>& filePaths,
+            const std::function<void(size_t, Surface&)>& onLoaded = nullptr);
+
+        /**
+         * @brief Runs the callbacks of the images decoded so far and hands them over.
+         *
+         * @return The number of callbacks run.
+         */
+        size_t Poll();
+
+        /**
+         * @brief Waits for every queued load, running their callbacks as the images are decoded.
+         */
+        void Flush();
+
+        /**
+         * @brief Returns the number of loads queued and not yet handed over.
+         */
+        size_t GetPendingCount() const;
+
+        /**
+         * @brief Returns the size in bytes of the decoded pixels currently held by the loader.
+         */
+        size_t GetMemoryUsage() const;
+
+        /**
+         * @brief Returns the maximum size in bytes of the decoded pixels held by the loader, 0 for no limit.
+         */
+        size_t GetMemoryBudget() const
+        {
+            return memoryBudget;
+        }
+
+        /**
+         * @brief Returns the number of worker threads decoding the images.
+         */
+        size_t GetThreadCount() const
+        {
+            return pool.GetThreadCount();
+        }
+    };
+
+}}
+
+#endif //NEXUS_GFX_ASYNC_IMAGE_LOADER_HPP
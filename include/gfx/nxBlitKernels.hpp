@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef NEXUS_GFX_BLIT_KERNELS_HPP
+#define NEXUS_GFX_BLIT_KERNELS_HPP
+
+#include "../platform/nxPlatform.hpp"
+#include "./nxColor.hpp"
+#include <SDL_stdinc.h>
+
+namespace _gfx_impl {
+
+    /**
+     * @brief Row functions used by `gfx::Surface` to draw RGBA32 surfaces onto each other without going through SDL.
+     *
+     * The colors are stored in the memory order of `gfx::Color`. All the implementations produce exactly
+     * the same pixels, the divisions by 255 being rounded to the nearest integer.
+     */
+    struct BlitKernels
+    {
+        /**
+         * @brief Alpha blends colors with straight alpha over consecutive pixels.
+         *
+         * dstRGB = (srcRGB * srcA + dstRGB * (255 - srcA)) / 255
+         * dstA = srcA + dstA * (255 - srcA) / 255
+         *
+         * @param dst The first destination pixel.
+         * @param src The colors to blend.
+         * @param count Number of pixels.
+         */
+        void (*BlendRow)(nexus::gfx::Color* dst, const nexus::gfx::Color* src, int count);
+
+        /**
+         * @brief Alpha blends colors with premultiplied alpha over consecutive pixels.
+         *
+         * dstRGBA = srcRGBA + dstRGBA * (255 - srcA) / 255, saturated to 255.
+         *
+         * @param dst The first destination pixel.
+         * @param src The colors to blend.
+         * @param count Number of pixels.
+         */
+        void (*BlendRowPremultiplied)(nexus::gfx::Color* dst, const nexus::gfx::Color* src, int count);
+
+        /**
+         * @brief Samples consecutive pixels between two rows of an image with bilinear filtering.
+         *
+         * The horizontal coordinates are in 16.16 fixed-point, the pixel `i` being sampled at `u + i * du`.
+         * Each of the four texels is premultiplied by its alpha first if requested, so that transparent
+         * texels do not bleed their color into the result.
+         *
+         * @param dst The sampled colors.
+         * @param row0, row1 The rows above and below the sampled position, which may be the same.
+         * @param width Number of pixels in the rows, at least 2.
+         * @param u Horizontal position of the first sample, within [0, (width - 1) << 16].
+         * @param du Distance between two samples, positive, so that the last sample stays within the row.
+         * @param fy Weight of `row1`, within [0, 256].
+         * @param count Number of pixels to sample.
+         * @param premultiply Whether the texels are premultiplied by their alpha before being filtered.
+         */
+        void (*ScaleRowBilinear)(nexus::gfx::Color* dst, const nexus::gfx::Color* row0, const nexus::gfx::Color* row1,
+                                 int width, Sint32 u, Sint32 du, int fy, int count, bool premultiply);
+    };
+
+    /**
+     * @brief Gets the blit kernels.
+     * @param simd True for the widest implementation supported by the CPU, false for the portable reference.
+     */
+    NEXUS_API const BlitKernels& GetBlitKernels(bool simd = true);
+
+}
+
+#endif //NEXUS_GFX_BLIT_KERNELS_HPP
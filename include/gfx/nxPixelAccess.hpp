@@ -0,0 +1,218 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef NEXUS_GFX_PIXEL_ACCESS_HPP
+#define NEXUS_GFX_PIXEL_ACCESS_HPP
+
+#include "./nxPixel.hpp"
+#include "./nxColor.hpp"
+#include <SDL_stdinc.h>
+#include <type_traits>
+#include <cstring>
+
+namespace _gfx_impl {
+
+    /**
+     * @brief Reads and writes pixels stored as 32-bit integers, the channels being at the given bit shifts.
+     *
+     * A negative `AShift` means that the format has no alpha channel, which then reads as opaque.
+     */
+    template <int RShift, int GShift, int BShift, int AShift>
+    struct PackedPixel32
+    {
+        static nexus::gfx::Color Load(const void* pixel)
+        {
+            Uint32 value;
+            std::memcpy(&value, pixel, sizeof(Uint32));
+
+            return nexus::gfx::Color(
+                static_cast<Uint8>(value >> RShift),
+                static_cast<Uint8>(value >> GShift),
+                static_cast<Uint8>(value >> BShift),
+                AShift < 0 ? 255 : static_cast<Uint8>(value >> (AShift & 31)));
+        }
+
+        static void Store(void* pixel, const nexus::gfx::Color& color)
+        {
+            Uint32 value = (static_cast<Uint32>(color.r) << RShift)
+                         | (static_cast<Uint32>(color.g) << GShift)
+                         | (static_cast<Uint32>(color.b) << BShift);
+
+            if (AShift >= 0) value |= static_cast<Uint32>(color.a) << (AShift & 31);
+
+            std::memcpy(pixel, &value, sizeof(Uint32));
+        }
+    };
+
+}
+
+namespace nexus { namespace gfx {
+
+    /**
+     * @brief Direct access to the pixels of a given format, without going through SDL's generic conversions.
+     *
+     * Only the 32-bit formats with 8-bit channels are specialized, `IsDirectPixelFormat()`
+     * tells if a format is one of them. The other formats have to use the methods of `gfx::Surface`.
+     *
+     * Each specialization provides:
+     *   - `static Color Load(const void* pixel)`
+     *   - `static void Store(void* pixel, const Color& color)`
+     */
+    template <PixelFormat Format>
+    struct PixelAccess;
+
+    template <> struct PixelAccess<PixelFormat::ARGB8888> : _gfx_impl::PackedPixel32<16, 8, 0, 24> { };
+    template <> struct PixelAccess<PixelFormat::RGBA8888> : _gfx_impl::PackedPixel32<24, 16, 8, 0> { };
+    template <> struct PixelAccess<PixelFormat::ABGR8888> : _gfx_impl::PackedPixel32<0, 8, 16, 24> { };
+    template <> struct PixelAccess<PixelFormat::BGRA8888> : _gfx_impl::PackedPixel32<8, 16, 24, 0> { };
+    template <> struct PixelAccess<PixelFormat::XRGB8888> : _gfx_impl::PackedPixel32<16, 8, 0, -1> { };
+    template <> struct PixelAccess<PixelFormat::RGBX8888> : _gfx_impl::PackedPixel32<24, 16, 8, -1> { };
+    template <> struct PixelAccess<PixelFormat::XBGR8888> : _gfx_impl::PackedPixel32<0, 8, 16, -1> { };
+    template <> struct PixelAccess<PixelFormat::BGRX8888> : _gfx_impl::PackedPixel32<8, 16, 24, -1> { };
+
+    /**
+     * @brief Calls `func` with the pixel format as a compile-time constant if it has a `PixelAccess` specialization.
+     *
+     * `func` receives a `std::integral_constant<PixelFormat, Format>`, so that the code using
+     * the pixels is instantiated once per format instead of testing the format for each pixel.
+     *
+     * @param format The pixel format to dispatch.
+     * @param func The generic callable to invoke.
+     * @return True if `func` has been called, false if the format has no direct access.
+     */
+    template <typename F>
+    bool VisitDirectPixelFormat(PixelFormat format, F&& func)
+    {
+        switch (format)
+        {
+            case PixelFormat::ARGB8888: func(std::integral_constant<PixelFormat, PixelFormat::ARGB8888>()); return true;
+            case PixelFormat::RGBA8888: func(std::integral_constant<PixelFormat, PixelFormat::RGBA8888>()); return true;
+            case PixelFormat::ABGR8888: func(std::integral_constant<PixelFormat, PixelFormat::ABGR8888>()); return true;
+            case PixelFormat::BGRA8888: func(std::integral_constant<PixelFormat, PixelFormat::BGRA8888>()); return true;
+            case PixelFormat::XRGB8888: func(std::integral_constant<PixelFormat, PixelFormat::XRGB8888>()); return true;
+            case PixelFormat::RGBX8888: func(std::integral_constant<PixelFormat, PixelFormat::RGBX8888>()); return true;
+            case PixelFormat::XBGR8888: func(std::integral_constant<PixelFormat, PixelFormat::XBGR8888>()); return true;
+            case PixelFormat::BGRX8888: func(std::integral_constant<PixelFormat, PixelFormat::BGRX8888>()); return true;
+            default: return false;
+        }
+    }
+
+    /**
+     * @brief Checks if pixels of the given format can be accessed through `PixelAccess`.
+     */
+    inline bool IsDirectPixelFormat(PixelFormat format)
+    {
+        return VisitDirectPixelFormat(format, [](auto) { });
+    }
+
+    /**
+     * @brief Alpha blends a color over a pixel, with the formula shared by the drawing functions and the rasterizers.
+     *
+     * Colors with an alpha of zero leave the pixel untouched and opaque colors replace it.
+     *
+     * @param dst The color of the pixel.
+     * @param src The color to blend over it.
+     * @return The blended color.
+     */
+    inline Color BlendPixel(const Color& dst, Color src)
+    {
+        if (src.a == 0) return dst;
+        if (src.a == 255) return src;
+
+        const Uint16 alpha = static_cast<Uint16>(src.a) + 1;
+        const Uint16 invAlpha = 256 - alpha;
+
+        src.a = static_cast<Uint8>((alpha * 256 + dst.a * invAlpha) >> 8);
+        src.r = static_cast<Uint8>((src.r * alpha + dst.r * invAlpha) >> 8);
+        src.g = static_cast<Uint8>((src.g * alpha + dst.g * invAlpha) >> 8);
+        src.b = static_cast<Uint8>((src.b * alpha + dst.b * invAlpha) >> 8);
+
+        return src;
+    }
+
+    /**
+     * @brief Reads `count` consecutive pixels of the given format.
+     *
+     * @param dst The colors read.
+     * @param src Address of the first pixel.
+     * @param count Number of pixels.
+     */
+    template <PixelFormat Format>
+    void LoadPixelSpan(Color* dst, const void* src, int count)
+    {
+        if constexpr (Format == PixelFormat::RGBA32)
+        {
+            std::memcpy(dst, src, count * sizeof(Color));  // Same memory layout as gfx::Color
+        }
+        else
+        {
+            const Uint8 *pixels = static_cast<const Uint8*>(src);
+            for (int i = 0; i < count; i++) dst[i] = PixelAccess<Format>::Load(pixels + i * 4);
+        }
+    }
+
+    /**
+     * @brief Writes `count` consecutive pixels of the given format.
+     *
+     * @param dst Address of the first pixel.
+     * @param src The colors to write.
+     * @param count Number of pixels.
+     */
+    template <PixelFormat Format>
+    void StorePixelSpan(void* dst, const Color* src, int count)
+    {
+        if constexpr (Format == PixelFormat::RGBA32)
+        {
+            std::memcpy(dst, src, count * sizeof(Color));
+        }
+        else
+        {
+            Uint8 *pixels = static_cast<Uint8*>(dst);
+            for (int i = 0; i < count; i++) PixelAccess<Format>::Store(pixels + i * 4, src[i]);
+        }
+    }
+
+    /**
+     * @brief Blends `count` colors over consecutive pixels of the given format.
+     *
+     * Colors with an alpha of zero leave their pixel untouched, opaque colors replace it without
+     * reading it and the others are mixed with it by `BlendPixel`.
+     *
+     * @param dst Address of the first pixel.
+     * @param src The colors to blend.
+     * @param count Number of pixels.
+     */
+    template <PixelFormat Format>
+    void BlendPixelSpan(void* dst, const Color* src, int count)
+    {
+        Uint8 *pixels = static_cast<Uint8*>(dst);
+
+        for (int i = 0; i < count; i++)
+        {
+            const Color& color = src[i];
+            if (color.a == 0) continue;
+
+            void *pixel = pixels + i * 4;
+            PixelAccess<Format>::Store(pixel, color.a == 255 ? color : BlendPixel(PixelAccess<Format>::Load(pixel), color));
+        }
+    }
+
+}}
+
+#endif //NEXUS_GFX_PIXEL_ACCESS_HPP
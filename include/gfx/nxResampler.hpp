@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef NEXUS_GFX_RESAMPLER_HPP
+#define NEXUS_GFX_RESAMPLER_HPP
+
+#include "../platform/nxPlatform.hpp"
+#include "../utils/nxThreadPool.hpp"
+#include "./nxColor.hpp"
+#include <SDL_stdinc.h>
+#include <vector>
+
+namespace nexus { namespace gfx {
+
+    /**
+     * @brief Filters used to resample a Surface to another size.
+     *
+     * When shrinking, the filters are widened by the reduction factor so that every source pixel contributes.
+     */
+    enum class ResizeFilter : Uint8
+    {
+        Box,        ///< Average of the pixels covered by each destination pixel, nearest neighbor when enlarging.
+        Bilinear,   ///< Triangle filter, linear interpolation when enlarging.
+        Bicubic,    ///< Catmull-Rom cubic filter, sharper than bilinear.
+        Lanczos     ///< Lanczos filter with three lobes, the sharpest but also the slowest.
+    };
+
+}}
+
+namespace _gfx_impl {
+
+    /**
+     * @brief Separable image resampler used by `gfx::Surface::Resize` and `gfx::Surface::GenerateMipChain`.
+     *
+     * The weights of each destination column and row are computed once, in fixed-point with `WeightBits`
+     * fractional bits. The destination rows are split into bands shared across a thread pool, each band
+     * filtering horizontally the source rows it needs into intermediate rows, then filtering these vertically.
+     * The colors are filtered with premultiplied alpha, so that transparent pixels do not bleed into their neighbors.
+     *
+     * The SIMD and portable implementations produce exactly the same pixels.
+     */
+    class NEXUS_API Resampler
+    {
+      public:
+        static constexpr int WeightBits = 14;       ///< Fractional bits of the weights, whose sum is `1 << WeightBits` for each pixel.
+
+      private:
+        /**
+         * @brief Contributions of the source pixels to the destination pixels along one axis.
+         */
+        struct Axis
+        {
+            std::vector<int> starts;            ///< First source pixel contributing to each destination pixel.
+            std::vector<Sint16> weights;        ///< `taps` weights per destination pixel, from its first source pixel.
+            int taps;                           ///< Number of weights per destination pixel, always even.
+        };
+
+        Axis horizontal, vertical;
+        int srcWidth, srcHeight;
+        int dstWidth, dstHeight;
+
+      public:
+        /**
+         * @brief Computes the weights resampling an image of srcWidth x srcHeight to dstWidth x dstHeight.
+         * @param srcWidth, srcHeight Size of the source image, greater than zero.
+         * @param dstWidth, dstHeight Size of the destination image, greater than zero.
+         * @param filter The filter to use.
+         */
+        Resampler(int srcWidth, int srcHeight, int dstWidth, int dstHeight, nexus::gfx::ResizeFilter filter);
+
+        /**
+         * @brief Resamples an image of RGBA32 colors.
+         *
+         * @param src The first source pixel.
+         * @param srcStride Number of pixels between two source rows.
+         * @param dst The first destination pixel, which must not overlap the source.
+         * @param dstStride Number of pixels between two destination rows.
+         * @param premultiplied Whether the colors are already premultiplied by their alpha, they are then kept premultiplied.
+         * @param pool Optional pool sharing the rows between its workers.
+         * @param simd True to use the widest implementation supported by the CPU, false for the portable reference.
+         */
+        void Resample(const nexus::gfx::Color* src, int srcStride, nexus::gfx::Color* dst, int dstStride,
+                      bool premultiplied = false, nexus::utils::ThreadPool* pool = nullptr, bool simd = true) const;
+
+      private:
+        static Axis ComputeAxis(int srcSize, int dstSize, nexus::gfx::ResizeFilter filter);
+    };
+
+}
+
+#endif //NEXUS_GFX_RESAMPLER_HPP
@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef NEXUS_GFX_SCANLINE_RASTERIZER_HPP
+#define NEXUS_GFX_SCANLINE_RASTERIZER_HPP
+
+#include "../platform/nxPlatform.hpp"
+#include "../math/nxVec2.hpp"
+#include <SDL_stdinc.h>
+#include <functional>
+#include <vector>
+
+namespace nexus { namespace gfx {
+
+    /**
+     * @brief Rules deciding which points are inside a filled shape whose edges cross each other.
+     */
+    enum class FillRule : Uint8
+    {
+        EvenOdd,    ///< A point is inside if a ray cast from it crosses the edges an odd number of times.
+        NonZero     ///< A point is inside if the edges do not wind around it as many times in each direction.
+    };
+
+}}
+
+namespace _gfx_impl {
+
+    /**
+     * @brief Scanline polygon rasterizer with an active edge table, used by the filling functions of `gfx::Surface`.
+     *
+     * The edges are sorted once by their first row, then each row only visits the edges crossing it,
+     * so that filling a shape costs O(rows * crossed edges + pixels) instead of testing every pixel
+     * of its bounding box against every edge. The inside of each row is reported as whole spans.
+     *
+     * The pixel (x, y) is sampled at the point (x, y), and covers the unit square centered on it.
+     * A pixel is filled if its sample point is inside the shape or on a left or top edge.
+     */
+    class NEXUS_API ScanlineRasterizer
+    {
+      public:
+        static constexpr int SubScanlines = 16;     ///< Number of rows sampled per pixel to compute the anti-aliased coverage.
+
+        /**
+         * @brief Callback receiving the filled pixels [x0, x1) of the row y, the spans of a row being sorted and disjoint.
+         */
+        using SpanFunc = std::function<void(int y, int x0, int x1)>;
+
+        /**
+         * @brief Callback receiving the coverage of the pixels [x0, x1) of the row y, within [0, 1].
+         */
+        using CoverageFunc = std::function<void(int y, int x0, int x1, const float* coverage)>;
+
+      private:
+        struct Edge
+        {
+            float x0, y0;   ///< Upper end of the edge.
+            float dxdy;     ///< Horizontal step for a vertical step of one.
+            float y1;       ///< Vertical position of the lower end of the edge.
+            int winding;    ///< +1 if the edge goes down, -1 if it goes up.
+            int rowBegin;   ///< First row crossed by the edge during the current scan.
+            int rowEnd;     ///< Row following the last one crossed by the edge during the current scan.
+        };
+
+        struct ActiveEdge
+        {
+            float x;        ///< Intersection with the current row.
+            int index;      ///< Index of the edge.
+        };
+
+        std::vector<Edge> edges;
+        std::vector<int> order;             ///< Indices of the edges crossing at least one row, sorted by their first row.
+        std::vector<ActiveEdge> active;     ///< Edges crossing the current row, sorted by their intersection.
+        std::vector<float> accumulation;    ///< Coverage differences of the current row, accumulated over its sub-scanlines.
+        int width, height;
+
+      public:
+        /**
+         * @brief Creates a rasterizer clipping the shapes to [0, width) x [0, height).
+         * @param width Width of the clipping area.
+         * @param height Height of the clipping area.
+         */
+        ScanlineRasterizer(int width, int height);
+
+        /**
+         * @brief Removes all the edges, keeping the allocated memory for the next shape.
+         */
+        void Clear();
+
+        /**
+         * @brief Adds an edge to the shape, the horizontal edges being ignored.
+         * @param a Start of the edge.
+         * @param b End of the edge.
+         */
+        void AddEdge(const nexus::math::Vec2& a, const nexus::math::Vec2& b);
+
+        /**
+         * @brief Adds the closed outline of a polygon to the shape.
+         * @param vertices The vertices of the polygon.
+         * @param count Number of vertices.
+         */
+        void AddPolygon(const nexus::math::Vec2* vertices, size_t count);
+
+        /**
+         * @brief Reports the spans of pixels whose sample point is inside the shape.
+         * @param rule Rule deciding which points are inside.
+         * @param func Callback receiving the spans, row by row from the top.
+         */
+        void Rasterize(nexus::gfx::FillRule rule, const SpanFunc& func);
+
+        /**
+         * @brief Reports the area of each pixel covered by the shape.
+         *
+         * The coverage is exact horizontally and sampled over `SubScanlines` rows vertically.
+         * Only the pixels between the leftmost and rightmost edges of each row are reported.
+         *
+         * @param rule Rule deciding which points are inside.
+         * @param func Callback receiving the coverage of each row, from the top.
+         */
+        void RasterizeCoverage(nexus::gfx::FillRule rule, const CoverageFunc& func);
+
+      private:
+        /**
+         * @brief Walks the edge table over `rowCount` rows sampled at `firstY + r * rowStep`.
+         * @param func Callback receiving the inside intervals [xa, xb) of each row, not clipped horizontally.
+         */
+        void Scan(nexus::gfx::FillRule rule, float firstY, float rowStep, int rowCount,
+                  const std::function<void(int row, float xa, float xb)>& func);
+    };
+
+}
+
+#endif //NEXUS_GFX_SCANLINE_RASTERIZER_HPP
@@ -26,9 +26,13 @@
 #include "../core/nxFileSystem.hpp"
 #include "../core/nxFileFormat.hpp"
 #include "../core/nxException.hpp"
+#include "../utils/nxThreadPool.hpp"
 #include "../math/nxMath.hpp"
 #include "../math/nxVec2.hpp"
+#include "./nxScanlineRasterizer.hpp"
+#include "./nxResampler.hpp"
 #include "./nxBlendMode.hpp"
+#include "./nxPixelAccess.hpp"
 #include "./nxPixel.hpp"
 #include "./nxColor.hpp"
 
@@ -47,6 +51,25 @@ namespace nexus { namespace gfx {
 
     using Image = class Surface;
 
+    /**
+     * @brief Sets the pool sharing the rows of large surfaces between its workers.
+     *
+     * The pool is used by the `NewGradient*`, `NewWhiteNoise`, ... generators and their `Draw*` counterparts,
+     * by `Surface::Resize` and by `Surface::GenerateMipChain`. No pool is set by default,
+     * these functions then run on the calling thread.
+     *
+     * @warning The pool is not owned and must outlive its use, it must not be changed while these functions run.
+     *
+     * @param pool The pool to use, or nullptr to run on the calling thread.
+     */
+    NEXUS_API void SetWorkerPool(utils::ThreadPool* pool);
+
+    /**
+     * @brief Gets the pool set by `SetWorkerPool`.
+     * @return The pool, or nullptr if none is set.
+     */
+    NEXUS_API utils::ThreadPool* GetWorkerPool();
+
     /**
      * @brief The Surface class represents an SDL surface.
      */
@@ -55,6 +78,8 @@ namespace nexus { namespace gfx {
       protected:
         SDL_Surface* surface = nullptr;     ///< The SDL surface pointer.
         bool autoLifetimeManagement = true; ///< Automatic lifetime management (if true, the SDL_Surface will be deallocated in the destructor)
+        bool premultipliedAlpha = false;    ///< Whether the color channels are premultiplied by alpha when the surface is blended onto another
+        bool bilinearScaling = false;       ///< Whether the surface is filtered bilinearly when drawn scaled onto another
 
       public:
         /**
@@ -140,9 +165,10 @@ namespace nexus { namespace gfx {
          * @param width The width of the new Surface.
          * @param height The height of the new Surface.
          * @param factor The factor controlling the intensity of the white noise.
+         * @param seed The seed of the noise, the same seed always giving the same noise. If 0 (default), it is generated from the current time.
          * @return A new Surface with white noise.
          */
-        static Surface NewWhiteNoise(int width, int height, float factor);
+        static Surface NewWhiteNoise(int width, int height, float factor, unsigned long seed = 0);
 
         /**
          * @brief Generate a new Surface with a cellular pattern.
@@ -153,9 +179,68 @@ namespace nexus { namespace gfx {
          * @param width The width of the new Surface.
          * @param height The height of the new Surface.
          * @param tileSize The size of the cells in the cellular pattern.
+         * @param seed The seed of the pattern, the same seed always giving the same pattern. If 0 (default), it is generated from the current time.
          * @return A new Surface with a cellular pattern.
          */
-        static Surface NewCellular(int width, int height, int tileSize);
+        static Surface NewCellular(int width, int height, int tileSize, unsigned long seed = 0);
+
+        /**
+         * @brief Reads the size of an image file without decoding its pixels.
+         *
+         * The size is read from the header of PNG, JPEG, BMP, GIF, QOI and PNM images. The other
+         * formats supported by SDL_image are fully decoded to get their size.
+         *
+         * @param filePath The path to the image file.
+         * @return The width and height of the image.
+         * @throws core::NexusException if the file cannot be opened or the image cannot be read.
+         */
+        static math::IVec2 QueryImageSize(const std::string& filePath);
+
+        /**
+         * @brief Reads the size of an image stored in memory without decoding its pixels.
+         *
+         * The size is read from the header of PNG, JPEG, BMP, GIF, QOI and PNM images. The other
+         * formats supported by SDL_image are fully decoded to get their size.
+         *
+         * @param data A pointer to the start of the memory block containing the image data.
+         * @param size The size of the memory block.
+         * @return The width and height of the image.
+         * @throws core::NexusException if the image cannot be read.
+         */
+        static math::IVec2 QueryImageSize(const void* data, size_t size);
+
+        /**
+         * @brief Decodes an image file into a pixel buffer owned by the caller, in the RGBA32 format.
+         *
+         * The buffer can be sized beforehand with `QueryImageSize`, then wrapped by a Surface without
+         * copying the pixels, see the constructor taking a pixel buffer.
+         *
+         * @param filePath The path to the image file.
+         * @param pixels The first pixel of the buffer, aligned on 4 bytes.
+         * @param capacity Size of the buffer in bytes, at least `pitch * height`.
+         * @param pitch Number of bytes between two rows of the buffer, a multiple of 4 and at least `4 * width`.
+         *              If 0 (default), the rows are contiguous.
+         * @return The width and height of the decoded image.
+         * @throws core::NexusException if the image cannot be decoded or does not fit in the buffer.
+         */
+        static math::IVec2 DecodeInto(const std::string& filePath, void* pixels, size_t capacity, int pitch = 0);
+
+        /**
+         * @brief Decodes an image stored in memory into a pixel buffer owned by the caller, in the RGBA32 format.
+         *
+         * The buffer can be sized beforehand with `QueryImageSize`, then wrapped by a Surface without
+         * copying the pixels, see the constructor taking a pixel buffer.
+         *
+         * @param data A pointer to the start of the memory block containing the image data.
+         * @param size The size of the memory block.
+         * @param pixels The first pixel of the buffer, aligned on 4 bytes.
+         * @param capacity Size of the buffer in bytes, at least `pitch * height`.
+         * @param pitch Number of bytes between two rows of the buffer, a multiple of 4 and at least `4 * width`.
+         *              If 0 (default), the rows are contiguous.
+         * @return The width and height of the decoded image.
+         * @throws core::NexusException if the image cannot be decoded or does not fit in the buffer.
+         */
+        static math::IVec2 DecodeInto(const void* data, size_t size, void* pixels, size_t capacity, int pitch = 0);
 
       public:
         /**
@@ -196,6 +281,28 @@ namespace nexus { namespace gfx {
             Fill(color);
         }
 
+        /**
+         * @brief Constructor to create a Surface object over an existing pixel buffer.
+         *
+         * The pixels are read and written in place and are never freed by the Surface, so the buffer
+         * must outlive it. The `autoLifetimeManagement` flag only applies to the SDL surface describing
+         * the buffer. Along with `DecodeInto`, this allows images to be decoded into memory owned by
+         * the caller, such as an arena, and uploaded to textures without intermediate copies.
+         *
+         * @param width The width of the surface.
+         * @param height The height of the surface.
+         * @param pixels The first pixel of the buffer, aligned on the size of a pixel.
+         * @param pitch Number of bytes between two rows of the buffer, at least `width` times the size of a pixel.
+         * @param format Optional pixel format of the buffer (default is PixelFormat::RGBA32).
+         * @param autoLifetimeManagement Automatic surface deallocation in the destructor, the pixels being kept.
+         * @throws core::NexusException if the buffer is not valid or the surface creation fails.
+         */
+        Surface(int width, int height, void* pixels, int pitch, PixelFormat format = PixelFormat::RGBA32, bool autoLifetimeManagement = true)
+        : autoLifetimeManagement(autoLifetimeManagement)
+        {
+            CreateFrom(width, height, pixels, pitch, format);
+        }
+
         /**
          * @brief Constructor to create a Surface object by loading an image from a file.
          *
@@ -308,6 +415,8 @@ namespace nexus { namespace gfx {
          * @param other The Surface to copy from.
          */
         Surface(const Surface& other)
+        : premultipliedAlpha(other.premultipliedAlpha)
+        , bilinearScaling(other.bilinearScaling)
         {
             surface = other.Clone();
         }
@@ -326,6 +435,8 @@ namespace nexus { namespace gfx {
             if (this != &other)
             {
                 surface = other.Clone();
+                premultipliedAlpha = other.premultipliedAlpha;
+                bilinearScaling = other.bilinearScaling;
             }
             return *this;
         }
@@ -338,6 +449,8 @@ namespace nexus { namespace gfx {
         Surface(Surface&& other)
         : surface(std::exchange(other.surface, nullptr))
         , autoLifetimeManagement(std::exchange(other.autoLifetimeManagement, false))
+        , premultipliedAlpha(other.premultipliedAlpha)
+        , bilinearScaling(other.bilinearScaling)
         { }
 
         /**
@@ -352,6 +465,8 @@ namespace nexus { namespace gfx {
             {
                 surface = std::exchange(other.surface, nullptr);
                 autoLifetimeManagement = std::exchange(other.autoLifetimeManagement, false);
+                premultipliedAlpha = other.premultipliedAlpha;
+                bilinearScaling = other.bilinearScaling;
             }
             return *this;
         }
@@ -379,6 +494,20 @@ namespace nexus { namespace gfx {
          */
         void Create(int width, int height, PixelFormat format = PixelFormat::RGBA8888);
 
+        /**
+         * @brief Create an SDL surface over an existing pixel buffer.
+         *
+         * The SDL surface refers to the pixels without owning them, they are never freed by the Surface.
+         *
+         * @param width The width of the surface.
+         * @param height The height of the surface.
+         * @param pixels The first pixel of the buffer, aligned on the size of a pixel.
+         * @param pitch Number of bytes between two rows of the buffer, at least `width` times the size of a pixel.
+         * @param format The pixel format of the buffer.
+         * @throws core::NexusException if the buffer is not valid or the surface creation fails.
+         */
+        void CreateFrom(int width, int height, void* pixels, int pitch, PixelFormat format = PixelFormat::RGBA32);
+
         /**
          * @brief Load an image from a file and create an SDL surface.
          *
@@ -615,6 +744,50 @@ namespace nexus { namespace gfx {
          */
         Color GetFragUnsafe(const math::Vec2& uv) const;
 
+        /**
+         * @brief Get the color of the pixel at the specified coordinates, knowing the pixel format of the surface.
+         *
+         * The conversion is inlined for the given format instead of going through SDL.
+         * @warning: This function is not safe, it does not check the bounds nor if `Format` is the format of the surface.
+         *
+         * @tparam Format The pixel format of the surface, one of those supported by `PixelAccess`.
+         * @param x The x-coordinate of the pixel.
+         * @param y The y-coordinate of the pixel.
+         * @return The color of the pixel at the specified coordinates.
+         */
+        template <PixelFormat Format>
+        Color GetPixelUnsafe(int x, int y) const
+        {
+            return PixelAccess<Format>::Load(static_cast<const Uint8*>(surface->pixels) + y * surface->pitch + x * 4);
+        }
+
+        /**
+         * @brief Get the color of the pixel at the specified normalized texture coordinate, knowing the pixel format of the surface.
+         *
+         * @warning: This function is not safe, it does not check the bounds nor if `Format` is the format of the surface.
+         *
+         * @tparam Format The pixel format of the surface, one of those supported by `PixelAccess`.
+         * @param uv The normalized texture coordinate (Vec2) representing the position on the surface.
+         * @return The color of the pixel at the specified normalized texture coordinate.
+         */
+        template <PixelFormat Format>
+        Color GetFragUnsafe(const math::Vec2& uv) const
+        {
+            return GetPixelUnsafe<Format>(uv.x * (surface->w-1), uv.y * (surface->h-1));
+        }
+
+        /**
+         * @brief Get the colors of `count` consecutive pixels of a row without performing bounds checks.
+         *
+         * The pixel format is resolved once for the whole span, 32-bit formats bypassing the conversions of SDL.
+         *
+         * @param x The x-coordinate of the first pixel.
+         * @param y The y-coordinate of the pixels.
+         * @param colors The colors of the pixels (at least `count` elements).
+         * @param count The number of pixels.
+         */
+        void GetPixelsUnsafe(int x, int y, Color* colors, int count) const;
+
         /**
          * @brief Get the color of the pixel at the specified memory address, performing bounds checks.
          *
@@ -784,6 +957,51 @@ namespace nexus { namespace gfx {
          */
         void SetBlendMode(BlendMode blendMode) const;
 
+        /**
+         * @brief Indicates whether the color channels of the surface are premultiplied by its alpha.
+         * @return True if the alpha is premultiplied, false if it is straight (default).
+         */
+        bool IsAlphaPremultiplied() const
+        {
+            return premultipliedAlpha;
+        }
+
+        /**
+         * @brief Sets whether the color channels of the surface are premultiplied by its alpha.
+         *
+         * With the `BlendMode::Alpha` blend mode, a premultiplied surface drawn onto another RGBA32
+         * surface is blended as dstRGBA = srcRGBA + dstRGBA * (1 - srcA). The pixels are not modified.
+         *
+         * @param premultiplied True if the alpha is premultiplied, false if it is straight.
+         */
+        void SetAlphaPremultiplied(bool premultiplied)
+        {
+            premultipliedAlpha = premultiplied;
+        }
+
+        /**
+         * @brief Indicates whether the surface is filtered bilinearly when drawn scaled onto another.
+         * @return True for bilinear filtering, false for the nearest pixel (default).
+         */
+        bool IsBilinearScaling() const
+        {
+            return bilinearScaling;
+        }
+
+        /**
+         * @brief Sets whether the surface is filtered bilinearly when drawn scaled onto another.
+         *
+         * Bilinear filtering is only supported between RGBA32 surfaces, and only applies to the
+         * `BlendMode::None` and `BlendMode::Alpha` blend modes. The straight alpha colors are
+         * premultiplied before being filtered, so that transparent pixels do not darken the edges.
+         *
+         * @param bilinear True for bilinear filtering, false for the nearest pixel.
+         */
+        void SetBilinearScaling(bool bilinear)
+        {
+            bilinearScaling = bilinear;
+        }
+
         /**
          * @brief Copy the contents of another Surface to this Surface.
          *
@@ -820,15 +1038,32 @@ namespace nexus { namespace gfx {
         /**
          * @brief Resize the Surface to a new width and height.
          *
-         * This function resizes the Surface to the specified width and height, preserving the existing pixel data.
+         * This function scales the existing pixel data to the specified width and height with the given filter.
+         * The image is resampled in two separable passes with fixed-point weights, its rows being split
+         * between the workers of the pool set by `SetWorkerPool` for large surfaces. The pixel format of the Surface is kept.
          *
          * @param newWidth The new width of the Surface.
          * @param newHeight The new height of the Surface.
+         * @param filter The filter used to resample the pixels (default is ResizeFilter::Bilinear).
          * @return A reference to the modified Surface, allowing method chaining.
          *
-         * @throws core::NexusException if the Surface is not created yet, and therefore cannot be resized.
+         * @throws core::NexusException if the Surface is not created yet, and therefore cannot be resized,
+         *         or if the new size is not greater than zero.
+         */
+        Surface& Resize(int newWidth, int newHeight, ResizeFilter filter = ResizeFilter::Bilinear);
+
+        /**
+         * @brief Generates the mip chain of the Surface.
+         *
+         * Each level is half the size of the previous one, rounded down and at least one pixel,
+         * down to a 1x1 level. The levels are resampled from each other with the given filter.
+         *
+         * @param filter The filter used to reduce each level (default is ResizeFilter::Box).
+         * @return The RGBA32 levels 1 to n of the chain, the Surface itself being level 0.
+         *
+         * @throws core::NexusException if the Surface is not created yet.
          */
-        Surface& Resize(int newWidth, int newHeight);
+        std::vector<Surface> GenerateMipChain(ResizeFilter filter = ResizeFilter::Box) const;
 
         /**
          * @brief Resize the Surface's canvas to a new width and height with optional offset and background color.
@@ -984,6 +1219,48 @@ namespace nexus { namespace gfx {
          */
         void SetFragUnsafe(const math::Vec2 uv, const Color& color) const;
 
+        /**
+         * @brief Sets the pixel at the specified coordinates, knowing the pixel format of the surface.
+         *
+         * The conversion is inlined for the given format instead of going through SDL.
+         * @warning: This function is not safe, it does not check the bounds nor if `Format` is the format of the surface.
+         *
+         * @tparam Format The pixel format of the surface, one of those supported by `PixelAccess`.
+         * @param x The x-coordinate of the pixel.
+         * @param y The y-coordinate of the pixel.
+         * @param color The color to set the pixel to (in RGBA format).
+         */
+        template <PixelFormat Format>
+        void SetPixelUnsafe(int x, int y, const Color& color) const
+        {
+            PixelAccess<Format>::Store(static_cast<Uint8*>(surface->pixels) + y * surface->pitch + x * 4, color);
+        }
+
+        /**
+         * @brief Sets `count` consecutive pixels of a row without performing bounds checks.
+         *
+         * The pixel format is resolved once for the whole span, 32-bit formats bypassing the conversions of SDL.
+         *
+         * @param x The x-coordinate of the first pixel.
+         * @param y The y-coordinate of the pixels.
+         * @param colors The colors to set the pixels to (at least `count` elements).
+         * @param count The number of pixels.
+         */
+        void SetPixelsUnsafe(int x, int y, const Color* colors, int count) const;
+
+        /**
+         * @brief Blends colors over `count` consecutive pixels of a row without performing bounds checks.
+         *
+         * Colors with an alpha of zero are skipped, opaque colors replace the pixels and the others are
+         * mixed with them using their alpha, the same way as the drawing functions of this class do.
+         *
+         * @param x The x-coordinate of the first pixel.
+         * @param y The y-coordinate of the pixels.
+         * @param colors The colors to blend (at least `count` elements).
+         * @param count The number of pixels.
+         */
+        void BlendPixelsUnsafe(int x, int y, const Color* colors, int count) const;
+
         /**
          * @brief Sets the pixel at the specified memory address on the surface without performing bounds checks.
          *
@@ -1088,18 +1365,20 @@ namespace nexus { namespace gfx {
          *
          * @param dst The rectangle defining the area to fill with the noise.
          * @param factor The factor determining the density of the noise.
+         * @param seed The seed of the noise, the same seed always giving the same noise. If 0 (default), it is generated from the current time.
          * @return A const reference to the modified Surface, allowing method chaining.
          */
-        const Surface& DrawWhiteNoise(shape2D::Rectangle dst, float factor) const;
+        const Surface& DrawWhiteNoise(shape2D::Rectangle dst, float factor, unsigned long seed = 0) const;
 
         /**
          * @brief Draw a cellular pattern on the surface within the specified rectangle.
          *
          * @param dst The rectangle defining the area to fill with the pattern.
          * @param tileSize The size of the individual cells in the pattern.
+         * @param seed The seed of the pattern, the same seed always giving the same pattern. If 0 (default), it is generated from the current time.
          * @return A const reference to the modified Surface, allowing method chaining.
          */
-        const Surface& DrawCellular(shape2D::Rectangle dst, int tileSize) const;
+        const Surface& DrawCellular(shape2D::Rectangle dst, int tileSize, unsigned long seed = 0) const;
 
         /**
          * @brief Draw a line on the surface between two points with the specified color.
@@ -1249,14 +1528,20 @@ namespace nexus { namespace gfx {
 
         /**
          * @brief Draws a filled polygon on the surface.
-         * 
-         * @note: This function can also handle concave polygons but may be slow.
+         *
+         * The polygon may be concave or self-intersecting, the fill rule deciding which of its areas are inside.
+         * It is filled scanline by scanline, in a time proportional to its height and number of edges plus
+         * the number of pixels filled.
          *
          * @param poly The 2D polygon to be drawn.
          * @param color The fill color of the polygon (default is White).
+         * @param rule The rule deciding which areas of a self-intersecting polygon are filled (default is FillRule::EvenOdd).
+         * @param antiAliased If true, the pixels partially covered by the polygon are blended with the surface
+         *                    using their coverage as alpha, the others being set to the color (default is false).
          * @return A const reference to the modified Surface, allowing method chaining.
          */
-        const Surface& DrawPolygon(const shape2D::Polygon& poly, const Color& color = White) const;
+        const Surface& DrawPolygon(const shape2D::Polygon& poly, const Color& color = White,
+                                   FillRule rule = FillRule::EvenOdd, bool antiAliased = false) const;
 
         /**
          * @brief Draw the lines of a polygon on the surface with the specified color.
@@ -38,9 +38,14 @@
 #endif
 
 // gfx
+#include "gfx/nxPixelAccess.hpp"
 #include "gfx/nxPixel.hpp"
 #include "gfx/nxColor.hpp"
 #include "gfx/nxSurface.hpp"
+#include "gfx/nxBlitKernels.hpp"
+#include "gfx/nxScanlineRasterizer.hpp"
+#include "gfx/nxResampler.hpp"
+#include "gfx/nxAsyncImageLoader.hpp"
 #include "gfx/nxBasicFont.hpp"
 #if EXTENSION_GFX
 #   include "gfx/ext_gfx/nxApp.hpp"
@@ -104,10 +109,13 @@
 #   include "gapi/sr/nxCamera2D.hpp"
 #   include "gapi/sr/nxCamera3D.hpp"
 #   include "gapi/sr/nxPipeline.hpp"
+#   include "gapi/sr/nxOffscreen.hpp"
 #   include "gapi/sr/nxContextual.hpp"
 #   include "gapi/sr/nxPrimitives2D.hpp"
 #   include "gapi/sr/nxPrimitives3D.hpp"
 #   include "gapi/sr/nxTargetTexture.hpp"
+#   include "gapi/sr/nxTextureSampler.hpp"
+#   include "gapi/sr/nxRasterKernels.hpp"
 #   if SUPPORT_MODEL
 #       include "gapi/sr/sp_model/nxMaterial.hpp"
 #       include "gapi/sr/sp_model/nxModel.hpp"
@@ -190,5 +198,6 @@
 // utils
 #include "utils/nxContextual.hpp"
 #include "utils/nxThreadSafeQueue.hpp"
+#include "utils/nxThreadPool.hpp"
 
 #endif //NEXUS_HPP
\ No newline at end of file
@@ -0,0 +1,241 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef NEXUS_UTILS_THREAD_POOL_HPP
+#define NEXUS_UTILS_THREAD_POOL_HPP
+
+#include "../platform/nxPlatform.hpp"
+
+#include <condition_variable>
+#include <type_traits>
+#include <functional>
+#include <exception>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <deque>
+
+namespace nexus { namespace utils {
+
+    /**
+     * @brief Fixed-size pool of worker threads executing queued tasks.
+     *
+     * Tasks are executed in submission order by the first available worker.
+     * The pool can also split an index range across its workers with `ParallelFor`,
+     * in which case the calling thread takes part in the work as well.
+     */
+    class NEXUS_API ThreadPool
+    {
+      private:
+        std::vector<std::thread> workers;               ///< Worker threads owned by the pool.
+        std::deque<std::function<void()>> tasks;        ///< Pending tasks waiting for a worker.
+        std::mutex muxTasks;                            ///< Mutex protecting the task queue.
+        std::condition_variable cvTasks;                ///< Signaled when a task is queued or when the pool stops.
+        bool stopping = false;                          ///< Set by the destructor to make the workers exit.
+
+      private:
+        void WorkerLoop()
+        {
+            for (;;)
+            {
+                std::function<void()> task;
+
+                {
+                    std::unique_lock<std::mutex> lock(muxTasks);
+                    cvTasks.wait(lock, [this] { return stopping || !tasks.empty(); });
+                    if (stopping && tasks.empty()) return;
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+
+                task();
+            }
+        }
+
+      public:
+        /**
+         * @brief Creates the pool and starts its worker threads.
+         *
+         * @param numThreads Number of workers to start, if 0 the number of hardware threads is used.
+         */
+        explicit ThreadPool(size_t numThreads = 0)
+        {
+            if (numThreads == 0)
+            {
+                numThreads = std::max(1u, std::thread::hardware_concurrency());
+            }
+
+            workers.reserve(numThreads);
+
+            for (size_t i = 0; i < numThreads; i++)
+            {
+                workers.emplace_back(&ThreadPool::WorkerLoop, this);
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /**
+         * @brief Finishes the pending tasks then joins all the workers.
+         */
+        ~ThreadPool()
+        {
+            {
+                std::scoped_lock lock(muxTasks);
+                stopping = true;
+            }
+
+            cvTasks.notify_all();
+
+            for (auto& worker : workers)
+            {
+                worker.join();
+            }
+        }
+
+        /**
+         * @brief Returns the number of worker threads of the pool.
+         */
+        size_t GetThreadCount() const
+        {
+            return workers.size();
+        }
+
+        /**
+         * @brief Queues a task to be executed by a worker thread.
+         *
+         * @param fn Callable to execute.
+         * @param args Arguments passed to the callable.
+         * @return A future holding the result of the call, or the exception it threw.
+         */
+        template <typename F, typename... Args>
+        auto Enqueue(F&& fn, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>>
+        {
+            using R = std::invoke_result_t<F, Args...>;
+
+            auto task = std::make_shared<std::packaged_task<R()>>(
+                std::bind(std::forward<F>(fn), std::forward<Args>(args)...));
+
+            std::future<R> result = task->get_future();
+
+            {
+                std::scoped_lock lock(muxTasks);
+                tasks.emplace_back([task]() { (*task)(); });
+            }
+
+            cvTasks.notify_one();
+            return result;
+        }
+
+        /**
+         * @brief Calls `fn(i)` for every `i` in [0, count) using the workers and the calling thread.
+         *
+         * Indices are handed out one at a time so uneven work gets balanced between threads.
+         * The call blocks until every index has been processed; the first exception thrown
+         * by `fn` is rethrown on the calling thread once all of them are done.
+         *
+         * @note: Can be safely called from a task running in this same pool.
+         *
+         * @param count Number of indices to process.
+         * @param fn Callable taking a `size_t` index.
+         */
+        template <typename F>
+        void ParallelFor(size_t count, F&& fn)
+        {
+            if (count == 0) return;
+
+            if (count == 1 || workers.empty())
+            {
+                for (size_t i = 0; i < count; i++) fn(i);
+                return;
+            }
+
+            // NOTE: The state is shared because helpers that start after all
+            //       the indices have been consumed may outlive this call
+            struct Shared
+            {
+                std::atomic<size_t> next{0};
+                std::atomic<size_t> done{0};
+                std::exception_ptr error;
+                std::mutex muxDone;
+                std::condition_variable cvDone;
+                std::remove_reference_t<F>* fn;
+                size_t count;
+            };
+
+            auto shared = std::make_shared<Shared>();
+            shared->fn = &fn;
+            shared->count = count;
+
+            const auto run = [](Shared& s)
+            {
+                for (size_t i; (i = s.next.fetch_add(1)) < s.count;)
+                {
+                    try
+                    {
+                        (*s.fn)(i);
+                    }
+                    catch (...)
+                    {
+                        std::scoped_lock lock(s.muxDone);
+                        if (!s.error) s.error = std::current_exception();
+                    }
+
+                    if (s.done.fetch_add(1) + 1 == s.count)
+                    {
+                        std::scoped_lock lock(s.muxDone);
+                        s.cvDone.notify_all();
+                    }
+                }
+            };
+
+            const size_t numHelpers = std::min(workers.size(), count - 1);
+
+            {
+                std::scoped_lock lock(muxTasks);
+                for (size_t i = 0; i < numHelpers; i++)
+                {
+                    tasks.emplace_back([shared, run]() { run(*shared); });
+                }
+            }
+
+            cvTasks.notify_all();
+
+            run(*shared);
+
+            {
+                std::unique_lock<std::mutex> lock(shared->muxDone);
+                shared->cvDone.wait(lock, [&] { return shared->done.load() == count; });
+            }
+
+            if (shared->error)
+            {
+                std::rethrow_exception(shared->error);
+            }
+        }
+    };
+
+}}
+
+#endif //NEXUS_UTILS_THREAD_POOL_HPP
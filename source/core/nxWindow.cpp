@@ -193,6 +193,18 @@ void core::Window::UpdateSurface()
     }
 }
 
+void core::Window::UpdateSurfaceRects(const std::vector<shape2D::Rectangle>& rects)
+{
+    // shape2D::Rectangle is not layout compatible with an array of SDL_Rect
+    std::vector<SDL_Rect> sdlRects(rects.begin(), rects.end());
+
+    if (SDL_UpdateWindowSurfaceRects(window, sdlRects.data(), static_cast<int>(sdlRects.size())) < 0)
+    {
+        throw core::NexusException("core::Window", "Unable to update the window surface.",
+            "SDL", SDL_GetError());
+    }
+}
+
 bool core::Window::IsValid()
 {
     return (window != nullptr);
@@ -1110,21 +1110,21 @@ void _gapi_primitives_2d::DrawPolygon(gapi::Context& ctx, const math::Vec2& cent
 
         for (int i = 0; i < sides; i++)
         {
-            float nextAngle = rotation + angleStep;
+            // The angles are not accumulated so that the last side ends exactly on the first vertex
+            float angle = rotation + i * angleStep;
+            float nextAngle = rotation + ((i + 1) % sides) * angleStep;
 
             ctx.TexCoord(0, 0);
             ctx.Vertex(center.x, center.y);
 
             ctx.TexCoord(0, 1);
-            ctx.Vertex(center.x + std::cos(rotation) * radius, center.y + std::sin(rotation) * radius);
+            ctx.Vertex(center.x + std::cos(angle) * radius, center.y + std::sin(angle) * radius);
 
             ctx.TexCoord(1, 0);
             ctx.Vertex(center.x + std::cos(nextAngle) * radius, center.y + std::sin(nextAngle) * radius);
 
             ctx.TexCoord(1, 1);
-            ctx.Vertex(center.x + std::cos(rotation) * radius, center.y + std::sin(rotation) * radius);
-
-            rotation = nextAngle;
+            ctx.Vertex(center.x + std::cos(angle) * radius, center.y + std::sin(angle) * radius);
         }
 
     ctx.End();
@@ -89,18 +89,52 @@ gl::TextureFormat _gl_impl::ConvertPixelFormat(gfx::PixelFormat pf)
 
 /* Private Texture Implementation */
 
-void _gl_impl::Texture::LoadFromMemory(const gfx::Surface& surface)
+void _gl_impl::Texture::LoadFromMemory(const gfx::Surface& surface, bool generateMipmaps)
 {
     if (surface.GetWidth() == 0 || surface.GetHeight() == 0)
     {
         throw core::NexusException("gl::Texture", "Data is not valid to load texture");
     }
 
-    mipmaps = 1;
     width = surface.GetWidth();
     height = surface.GetHeight();
-    format = _gl_impl::ConvertPixelFormat(surface.GetPixelFormat());
-    id = ctx.LoadTexture(surface.GetPixels(), width, height, format, mipmaps);
+
+    if (!generateMipmaps)
+    {
+        mipmaps = 1;
+        format = _gl_impl::ConvertPixelFormat(surface.GetPixelFormat());
+        id = ctx.LoadTexture(surface.GetPixels(), width, height, format, mipmaps);
+        return;
+    }
+
+    // The levels are packed one after the other, as expected by gl::Context::LoadTexture
+    const gfx::Surface converted = surface.GetPixelFormat() == gfx::PixelFormat::RGBA32 ? gfx::Surface() : surface.Clone(gfx::PixelFormat::RGBA32);
+    const gfx::Surface &level0 = converted.IsValid() ? converted : surface;
+    const std::vector<gfx::Surface> chain = level0.GenerateMipChain();
+
+    size_t size = 4 * static_cast<size_t>(width) * height;
+    for (const auto& level : chain) size += 4 * static_cast<size_t>(level.GetWidth()) * level.GetHeight();
+
+    std::vector<Uint8> data;
+    data.reserve(size);
+
+    const auto append = [&data](const gfx::Surface& level)
+    {
+        const Uint8 *pixels = static_cast<const Uint8*>(level.GetPixels());
+        const size_t rowSize = 4 * static_cast<size_t>(level.GetWidth());
+
+        for (int y = 0; y < level.GetHeight(); y++)
+        {
+            data.insert(data.end(), pixels + y * level.GetPitch(), pixels + y * level.GetPitch() + rowSize);
+        }
+    };
+
+    append(level0);
+    for (const auto& level : chain) append(level);
+
+    mipmaps = 1 + static_cast<int>(chain.size());
+    format = gl::TextureFormat::RGBA8888;
+    id = ctx.LoadTexture(data.data(), width, height, format, mipmaps);
 }
 
 void _gl_impl::Texture::Create(int w, int h, gl::TextureFormat format)
@@ -115,16 +149,16 @@ _gl_impl::Texture::Texture(gl::Context& ctx)
 , mipmaps(1), format(gl::TextureFormat::RGBA8888)
 { }
 
-_gl_impl::Texture::Texture(gl::Context& ctx, const std::string& filePath)
+_gl_impl::Texture::Texture(gl::Context& ctx, const std::string& filePath, bool generateMipmaps)
 : gl::Contextual(ctx)
 {
-    LoadFromMemory(gfx::Surface(filePath));
+    LoadFromMemory(gfx::Surface(filePath), generateMipmaps);
 }
 
-_gl_impl::Texture::Texture(gl::Context& ctx, const gfx::Surface& surface)
+_gl_impl::Texture::Texture(gl::Context& ctx, const gfx::Surface& surface, bool generateMipmaps)
 : gl::Contextual(ctx)
 {
-    LoadFromMemory(surface);
+    LoadFromMemory(surface, generateMipmaps);
 }
 
 _gl_impl::Texture::Texture(gl::Context& ctx, int w, int h, gl::TextureFormat format)
@@ -30,6 +30,35 @@
 
 using namespace nexus;
 
+/* Private Implementation Context */
+
+void sr::Context::RenderBatch()
+{
+    // NOTE: The matrices and the viewport are only set up once for the whole batch
+    //       The pixels are sampled at their center, so the viewport spans [x..x+w] x [y..y+h] on screen
+    pipeline.ProcessAndRender(*state.currentFramebuffer, GetModelViewProjection(), state.viewport,
+        state.currentShader, state.image, state.sampler, state.depthTesting, state.faceCulling, state.cullMode, state.occlusionCulling);
+}
+
+math::Mat4 sr::Context::GetModelViewProjection() const
+{
+    if (state.currentFramebuffer->GetDepthFormat() != DepthFormat::ReversedFloat32)
+    {
+        return state.modelview * state.projection;
+    }
+
+    // z' = (w - z) / 2, applied to the projection before the vertices are transformed: the depths of distant
+    // vertices are then computed from small values, instead of being rounded as differences from 1
+    constexpr math::Mat4 reverseDepth(
+        1.0f, 0.0f,  0.0f, 0.0f,
+        0.0f, 1.0f,  0.0f, 0.0f,
+        0.0f, 0.0f, -0.5f, 0.5f,
+        0.0f, 0.0f,  0.0f, 1.0f
+    );
+
+    return state.modelview * (state.projection * reverseDepth);
+}
+
 /* Public Implementation Context */
 
 void sr::Context::EnableDepthTest()
@@ -42,6 +71,36 @@ void sr::Context::DisableDepthTest()
     state.depthTesting = false;
 }
 
+void sr::Context::EnableBackfaceCulling()
+{
+    state.faceCulling = true;
+}
+
+void sr::Context::DisableBackfaceCulling()
+{
+    state.faceCulling = false;
+}
+
+void sr::Context::SetCullFace(CullMode mode)
+{
+    state.cullMode = mode;
+}
+
+void sr::Context::EnableOcclusionCulling()
+{
+    state.occlusionCulling = true;
+}
+
+void sr::Context::DisableOcclusionCulling()
+{
+    state.occlusionCulling = false;
+}
+
+bool sr::Context::IsOccluded(const shape3D::AABB& aabb)
+{
+    return pipeline.IsOccluded(*state.currentFramebuffer, GetModelViewProjection(), state.viewport, aabb);
+}
+
 void sr::Context::MatrixMode(sr::MatrixMode mode)
 {
     switch (mode)
@@ -183,9 +242,9 @@ void sr::Context::SetViewport(const shape2D::Rectangle& vp)
     MatrixMode(sr::MatrixMode::Projection);     // Switch to projection matrix
     LoadIdentity();                             // Reset current matrix (projection)
 
-    // Set orthographic projection to the current framebuffer size
-    // NOTE: Configured top-left corner as (0, 0)
-    Ortho(vp.x, vp.w, vp.h, vp.y, 0.0f, 1.0f);
+    // Set orthographic projection to the area of the viewport, so that 2D coordinates are framebuffer pixels
+    // NOTE: Configured top-left corner as (vp.x, vp.y)
+    Ortho(vp.x, vp.x + vp.w, vp.y + vp.h, vp.y, 0.0f, 1.0f);
 
     MatrixMode(sr::MatrixMode::ModelView);      // Switch back to modelview matrix
     LoadIdentity();                             // Reset current matrix (modelview)
@@ -198,11 +257,13 @@ shape2D::Rectangle sr::Context::GetViewport() const
 
 void sr::Context::EnableFramebuffer(Framebuffer& framebuffer)
 {
+    pipeline.Flush();
     state.currentFramebuffer = &framebuffer;
 }
 
 void sr::Context::DisableFramebuffer()
 {
+    pipeline.Flush();
     state.currentFramebuffer = &state.winFramebuffer;
 }
 
@@ -216,81 +277,139 @@ void sr::Context::DisableWireMode()
     state.wireMode = false;
 }
 
+void sr::Context::EnableDeferredRendering(int numThreads)
+{
+    pipeline.EnableDeferred(numThreads);
+}
+
+void sr::Context::DisableDeferredRendering()
+{
+    pipeline.DisableDeferred();
+}
+
+void sr::Context::EnableParallelVertexProcessing(int numThreads)
+{
+    pipeline.EnableParallelVertexProcessing(numThreads);
+}
+
+void sr::Context::DisableParallelVertexProcessing()
+{
+    pipeline.DisableParallelVertexProcessing();
+}
+
+void sr::Context::Flush()
+{
+    pipeline.Flush();
+}
+
+const sr::PipelineStats& sr::Context::GetStats() const
+{
+    return pipeline.GetStats();
+}
+
+void sr::Context::ResetStats()
+{
+    pipeline.ResetStats();
+}
+
 void sr::Context::DrawVertexArray(const _sr_impl::Mesh& mesh, sr::Material& material, const math::Mat4& transform)
 {
 #   define GET_VERTEX_TEXCOORD(i) (mesh.texcoords.empty() ? math::Vec2() : mesh.texcoords[i])
 #   define GET_VERTEX_COLOR(i) (mesh.colors.empty() ? gfx::White : mesh.colors[i])
 
-    const math::Mat4 mvp = state.modelview * state.projection;
-    const shape2D::Rectangle viewport = { state.viewport.x, state.viewport.y, state.viewport.w - 1, state.viewport.h - 1 };
+    const math::Mat4 mvp = GetModelViewProjection();
+    const shape2D::Rectangle &viewport = state.viewport;
 
     const auto &positions = mesh.animPositions.empty() ? mesh.positions : mesh.animPositions;
     const auto &normals = mesh.animNormals.empty() ? mesh.normals : mesh.animNormals;
 
+    if (state.occlusionCulling && state.depthTesting && !positions.empty())
+    {
+        // Bounding box of the transformed corners of the cached mesh bounds, which contains the transformed mesh
+        const math::Vec3 &min = mesh.GetBoundingBox().min, &max = mesh.GetBoundingBox().max;
+        shape3D::AABB aabb(math::Vec3(std::numeric_limits<float>::max()), math::Vec3(std::numeric_limits<float>::lowest()));
+
+        for (int i = 0; i < 8; i++)
+        {
+            const math::Vec3 corner = math::Vec3((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z).Transformed(transform);
+            aabb.min = aabb.min.Min(corner);
+            aabb.max = aabb.max.Max(corner);
+        }
+
+        if (pipeline.CullOccludedDraw(*state.currentFramebuffer, mvp, viewport, aabb))
+        {
+            return;
+        }
+    }
+
     const gfx::Color colDiffuse = material->GetColor(Material::MapType::Diffuse);
     sr::Shader *matShader = &material->shader;
     const gfx::Surface *mapDiffuse = nullptr;
+    sr::TextureSampler sampler;
     {
         const sr::Texture *tmp = material->GetTexture(Material::MapType::Diffuse);
         mapDiffuse = tmp ? static_cast<const gfx::Surface*>(*tmp) : nullptr;
+        if (tmp) sampler = (*tmp)->GetSampler();
     }
 
     pipeline.Reset();
 
     if (state.wireMode)
     {
+        pipeline.Reserve(mesh.numVertices + 2);
+
         for (int i = 0; i < mesh.numVertices; i += 2)
         {
             pipeline.AddVertex(DrawMode::Lines, positions[i].Transformed(transform), normals[i], GET_VERTEX_TEXCOORD(i), GET_VERTEX_COLOR(i) * colDiffuse);
             pipeline.AddVertex(DrawMode::Lines, positions[i + 1].Transformed(transform), normals[i + 1], GET_VERTEX_TEXCOORD(i + 1), GET_VERTEX_COLOR(i + 1) * colDiffuse);
-            pipeline.ProcessAndRender(*state.currentFramebuffer, mvp, viewport, matShader, mapDiffuse, state.depthTesting);
         }
 
         pipeline.AddVertex(DrawMode::Lines, positions.back().Transformed(transform), normals.back(), GET_VERTEX_TEXCOORD(mesh.numVertices - 1), GET_VERTEX_COLOR(mesh.numVertices - 1) * colDiffuse);
         pipeline.AddVertex(DrawMode::Lines, positions.front().Transformed(transform), normals.front(), GET_VERTEX_TEXCOORD(0), GET_VERTEX_COLOR(0) * colDiffuse);
-        pipeline.ProcessAndRender(*state.currentFramebuffer, mvp, viewport, matShader, mapDiffuse, state.depthTesting);
-    }
-    else if (!mesh.indices.empty())
-    {
-        for (int i = 0; i < mesh.indices.size(); i += 3)
-        {
-            pipeline.AddVertex(DrawMode::Triangles, positions[mesh.indices[i]].Transformed(transform), normals[mesh.indices[i]], GET_VERTEX_TEXCOORD(mesh.indices[i]), GET_VERTEX_COLOR(mesh.indices[i]) * colDiffuse);
-            pipeline.AddVertex(DrawMode::Triangles, positions[mesh.indices[i + 1]].Transformed(transform), normals[mesh.indices[i + 1]], GET_VERTEX_TEXCOORD(mesh.indices[i + 1]), GET_VERTEX_COLOR(mesh.indices[i + 1]) * colDiffuse);
-            pipeline.AddVertex(DrawMode::Triangles, positions[mesh.indices[i + 2]].Transformed(transform), normals[mesh.indices[i + 2]], GET_VERTEX_TEXCOORD(mesh.indices[i + 2]), GET_VERTEX_COLOR(mesh.indices[i + 2]) * colDiffuse);
-            pipeline.ProcessAndRender(*state.currentFramebuffer, mvp, viewport, matShader, mapDiffuse, state.depthTesting);
-        }
     }
     else
     {
-        for (int i = 0; i < mesh.numVertices; i += 3)
+        // With indices, each vertex is transformed only once and the triangles are assembled from the indices
+        pipeline.AddVertices(DrawMode::Triangles, mesh.numVertices, positions.data(), normals.data(),
+            mesh.texcoords.empty() ? nullptr : mesh.texcoords.data(), mesh.colors.empty() ? nullptr : mesh.colors.data(), colDiffuse, transform);
+
+        if (!mesh.indices.empty())
         {
-            pipeline.AddVertex(DrawMode::Triangles, positions[i].Transformed(transform), normals[i], GET_VERTEX_TEXCOORD(i), GET_VERTEX_COLOR(i) * colDiffuse);
-            pipeline.AddVertex(DrawMode::Triangles, positions[i + 1].Transformed(transform), normals[i + 1], GET_VERTEX_TEXCOORD(i + 1), GET_VERTEX_COLOR(i + 1) * colDiffuse);
-            pipeline.AddVertex(DrawMode::Triangles, positions[i + 2].Transformed(transform), normals[i + 2], GET_VERTEX_TEXCOORD(i + 2), GET_VERTEX_COLOR(i + 2) * colDiffuse);
-            pipeline.ProcessAndRender(*state.currentFramebuffer, mvp, viewport, matShader, mapDiffuse, state.depthTesting);
+            pipeline.SetIndices(mesh.indices.data(), mesh.indices.size());
         }
     }
+
+    // The whole mesh is transformed, clipped and rasterized as a single batch
+    pipeline.ProcessAndRender(*state.currentFramebuffer, mvp, viewport, matShader, mapDiffuse, sampler, state.depthTesting, state.faceCulling, state.cullMode, state.occlusionCulling);
 }
 
 void sr::Context::Begin(DrawMode mode)
 {
+    pipeline.Reset();   // Discards any incomplete primitive left by the previous batch
     state.currentDrawMode = mode;
     state.renderBeginned = true;
 }
 
 void sr::Context::End()
 {
+    this->RenderBatch();
     state.renderBeginned = false;
 }
 
 void sr::Context::SetTexture(const gfx::Surface& texture)
 {
-    state.image = &texture;
+    this->SetTexture(&texture, TextureSampler());
 }
 
 void sr::Context::SetTexture(const gfx::Surface* texture)
+{
+    this->SetTexture(texture, TextureSampler());
+}
+
+void sr::Context::SetTexture(const gfx::Surface* texture, const TextureSampler& sampler)
 {
     state.image = texture;
+    state.sampler = sampler;
 }
 
 void sr::Context::SetDefaultTexture()
@@ -326,9 +445,11 @@ void sr::Context::Vertex(const math::Vec3& vertex)
         readyToRender = pipeline.AddVertex(state.currentDrawMode, vertex, state.normal, state.texcoord, state.color);
     }
 
-    if (readyToRender)
+    // NOTE: Between Begin() and End() the vertices are accumulated and the whole
+    //       batch is rendered by End(), otherwise each primitive is rendered once complete
+    if (readyToRender && !state.renderBeginned)
     {
-        pipeline.ProcessAndRender(*state.currentFramebuffer, state.modelview * state.projection, { state.viewport.x, state.viewport.y, state.viewport.w - 1, state.viewport.h -1  }, state.currentShader, state.image, state.depthTesting);
+        this->RenderBatch();
     }
 }
 
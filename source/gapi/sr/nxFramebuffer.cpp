@@ -0,0 +1,301 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "gapi/sr/nxFramebuffer.hpp"
+#include "core/nxException.hpp"
+#include "core/nxText.hpp"
+#include <cstring>
+
+using namespace nexus;
+
+void sr::Framebuffer::FillPixels(Uint8* row, int count) const
+{
+    switch (surface->format->BytesPerPixel)
+    {
+        case 4:
+            std::fill_n(reinterpret_cast<Uint32*>(row), count, clearPixel);
+            break;
+
+        case 2:
+            std::fill_n(reinterpret_cast<Uint16*>(row), count, static_cast<Uint16>(clearPixel));
+            break;
+
+        case 1:
+            std::memset(row, static_cast<Uint8>(clearPixel), count);
+            break;
+
+        default:
+        {
+            // The first pixel is written then the filled part is copied over the rest, doubling each time
+            const int bpp = surface->format->BytesPerPixel, size = count * bpp;
+            std::memcpy(row, &clearPixel, bpp);
+
+            for (int filled = bpp; filled < size; filled *= 2)
+            {
+                std::memcpy(row + filled, row, std::min(filled, size - filled));
+            }
+        }
+    }
+}
+
+void sr::Framebuffer::FillTile(int tx, int ty)
+{
+    const int bpp = surface->format->BytesPerPixel;
+
+    const int x = tx * TileSize, y = ty * TileSize;
+    const int w = std::min(TileSize, surface->w - x);
+    const int h = std::min(TileSize, surface->h - y);
+
+    for (int row = y; row < y + h; row++)
+    {
+        FillPixels(static_cast<Uint8*>(surface->pixels) + row * surface->pitch + x * bpp, w);
+        depth.Clear(row * surface->w + x, w);
+        if (sampleCount > 1) std::fill_n(splitPixels.data() + row * surface->w + x, w, 0);
+    }
+}
+
+void sr::Framebuffer::ResetTiles()
+{
+    tilesPerRow = (surface->w + TileSize - 1) / TileSize;
+    tileStates.assign(tilesPerRow * ((surface->h + TileSize - 1) / TileSize), TileDrawn);
+    damagedTiles.assign(tileStates.size(), 1);
+}
+
+void sr::Framebuffer::ResetSamples()
+{
+    const size_t size = sampleCount > 1 ? surface->w * surface->h : 0;
+
+    sampleColors.clear(), sampleColors.shrink_to_fit();
+    sampleColors.resize(size * MaxSamples);
+    splitPixels.assign(size, 0);
+}
+
+void sr::Framebuffer::SetSampleCount(int count)
+{
+    if (count != 1 && count != MaxSamples)
+    {
+        throw core::NexusException("sr::Framebuffer::SetSampleCount", core::TextFormat("Unsupported number of samples (%i), must be 1 or %i", count, MaxSamples));
+    }
+
+    if (count == sampleCount) return;
+
+    // The pixels get the color of their samples before losing them
+    ApplyPendingClear();
+    ResolveSamples();
+
+    sampleCount = count;
+    depth.SetSampleCount(count);
+    hiz.Clear();
+
+    ResetSamples();
+}
+
+void sr::Framebuffer::ResolveSamples()
+{
+    if (sampleCount == 1) return;
+
+    const bool direct = GetPixelFormat() == gfx::PixelFormat::RGBA32;
+
+    for (int y = 0, i = 0; y < surface->h; y++)
+    {
+        for (int x = 0; x < surface->w; x++, i++)
+        {
+            if (!splitPixels[i]) continue;
+
+            // Average of the samples, rounded to the nearest
+            const gfx::Color *samples = sampleColors.data() + i * MaxSamples;
+            int sum[4] = { 2, 2, 2, 2 };
+
+            for (int s = 0; s < MaxSamples; s++)
+            {
+                sum[0] += samples[s].r, sum[1] += samples[s].g;
+                sum[2] += samples[s].b, sum[3] += samples[s].a;
+            }
+
+            const gfx::Color color(sum[0] >> 2, sum[1] >> 2, sum[2] >> 2, sum[3] >> 2);
+
+            if (direct) reinterpret_cast<gfx::Color*>(static_cast<Uint8*>(surface->pixels) + y * surface->pitch)[x] = color;
+            else SetPixelUnsafe(x, y, color);
+        }
+    }
+}
+
+Uint32 sr::Framebuffer::BlendSamplesUnsafe(int x, int y, const gfx::Color* colors, const Uint32* sampleMasks, int count)
+{
+    const int first = y * surface->w + x;
+    const Uint8 *split = splitPixels.data() + first;
+
+    // Pixels covered by all the samples are written directly, unless they are split
+    Uint32 covered = sampleMasks[0], full = sampleMasks[0];
+
+    for (int s = 1; s < MaxSamples; s++)
+    {
+        covered |= sampleMasks[s];
+        full &= sampleMasks[s];
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (split[i]) full &= ~(1u << i);
+    }
+
+    const bool direct = GetPixelFormat() == gfx::PixelFormat::RGBA32;
+    gfx::Color *row = reinterpret_cast<gfx::Color*>(static_cast<Uint8*>(surface->pixels) + y * surface->pitch) + x;
+
+    const Uint32 partial = covered & ~full;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (!(partial & (1u << i))) continue;
+
+        gfx::Color *samples = sampleColors.data() + (first + i) * MaxSamples;
+
+        if (!splitPixels[first + i])
+        {
+            std::fill_n(samples, MaxSamples, direct ? row[i] : GetPixelUnsafe(x + i, y));
+            splitPixels[first + i] = 1;
+        }
+
+        for (int s = 0; s < MaxSamples; s++)
+        {
+            if (sampleMasks[s] & (1u << i)) samples[s] = gfx::BlendPixel(samples[s], colors[i]);
+        }
+
+        // Typically once both sides of an edge have been drawn with the same color
+        if (std::all_of(samples + 1, samples + MaxSamples, [samples](const gfx::Color& c) { return c == samples[0]; }))
+        {
+            if (direct) row[i] = samples[0];
+            else SetPixelUnsafe(x + i, y, samples[0]);
+            splitPixels[first + i] = 0;
+        }
+    }
+
+    return full;
+}
+
+void sr::Framebuffer::SetLazyClear(bool enabled)
+{
+    if (enabled == lazyClear) return;
+
+    // The tiles are only tracked while enabled, their content is unknown when it gets enabled again
+    ApplyPendingClear();
+    std::fill(tileStates.begin(), tileStates.end(), TileDrawn);
+
+    lazyClear = enabled;
+}
+
+void sr::Framebuffer::ApplyPendingClear()
+{
+    if (!lazyClear) return;
+
+    for (int i = 0; i < static_cast<int>(tileStates.size()); i++)
+    {
+        if (tileStates[i] != TilePending) continue;
+        FillTile(i % tilesPerRow, i / tilesPerRow);
+        tileStates[i] = TileCleared;
+    }
+}
+
+void sr::Framebuffer::Clear(const gfx::Color& color)
+{
+    // The color is converted once, only the bytes of a pixel being used for the narrower formats
+    Uint32 pixel = 0;
+    SetPixelUnsafe(&pixel, color);
+
+    hiz.Clear();
+
+    if (lazyClear)
+    {
+        // The tiles still holding the same clear values are left as they are, and are not damaged
+        for (size_t i = 0; i < tileStates.size(); i++)
+        {
+            if (tileStates[i] == TileCleared && pixel == clearPixel) continue;
+            tileStates[i] = TilePending;
+            damagedTiles[i] = 1;
+        }
+
+        clearPixel = pixel;
+        return;
+    }
+
+    clearPixel = pixel;
+
+    // Rows without padding are filled at once
+    const int bpp = surface->format->BytesPerPixel;
+
+    if (surface->pitch == surface->w * bpp)
+    {
+        FillPixels(static_cast<Uint8*>(surface->pixels), surface->w * surface->h);
+    }
+    else for (int y = 0; y < surface->h; y++)
+    {
+        FillPixels(static_cast<Uint8*>(surface->pixels) + y * surface->pitch, surface->w);
+    }
+
+    depth.Clear();
+    std::fill(splitPixels.begin(), splitPixels.end(), 0);
+
+    std::fill(damagedTiles.begin(), damagedTiles.end(), 1);
+}
+
+void sr::Framebuffer::GetDamagedRects(std::vector<shape2D::Rectangle>& rects) const
+{
+    rects.clear();
+
+    // Each row of tiles is split into runs of damaged tiles, which extend the rectangles
+    // reaching the previous row if they cover exactly the same columns
+    std::vector<size_t> prevRow, currentRow;     // Indices of the rectangles reaching a row, sorted by column
+
+    for (int ty = 0, tileRows = static_cast<int>(damagedTiles.size()) / tilesPerRow; ty < tileRows; ty++)
+    {
+        const Uint8 *row = damagedTiles.data() + ty * tilesPerRow;
+
+        const int y = ty * TileSize;
+        const int h = std::min(TileSize, surface->h - y);
+
+        size_t prev = 0;
+        currentRow.clear();
+
+        for (int tx = 0; tx < tilesPerRow; tx++)
+        {
+            if (!row[tx]) continue;
+
+            const int first = tx;
+            while (tx + 1 < tilesPerRow && row[tx + 1]) tx++;
+
+            const int x = first * TileSize;
+            const int w = std::min((tx + 1) * TileSize, surface->w) - x;
+
+            while (prev < prevRow.size() && rects[prevRow[prev]].x < x) prev++;
+
+            if (prev < prevRow.size() && rects[prevRow[prev]].x == x && rects[prevRow[prev]].w == w)
+            {
+                rects[prevRow[prev]].h += h;
+                currentRow.push_back(prevRow[prev]);
+            }
+            else
+            {
+                rects.emplace_back(x, y, w, h);
+                currentRow.push_back(rects.size() - 1);
+            }
+        }
+
+        std::swap(prevRow, currentRow);
+    }
+}
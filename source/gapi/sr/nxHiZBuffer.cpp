@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+
+#include "gapi/sr/nxHiZBuffer.hpp"
+
+using namespace nexus;
+
+void sr::HiZBuffer::Resize(int w, int h)
+{
+    width = w, height = h;
+
+    for (int i = 0, size = BlockSize; i < NumLevels; i++, size *= 2)
+    {
+        widths[i] = (w + size - 1) / size;
+        heights[i] = (h + size - 1) / size;
+        levels[i].resize(widths[i] * heights[i]);
+    }
+
+    dirty.resize(widths[0] * heights[0]);
+
+    Clear();
+}
+
+void sr::HiZBuffer::Clear()
+{
+    for (auto &level : levels)
+    {
+        std::fill(level.begin(), level.end(), DepthBuffer::MaxDepth);
+    }
+
+    std::fill(dirty.begin(), dirty.end(), 0);
+}
+
+bool sr::HiZBuffer::IsOccluded(const DepthBuffer& depth, int xMin, int yMin, int xMax, int yMax, float z)
+{
+    xMin = std::max(xMin, 0), xMax = std::min(xMax, width - 1);
+    yMin = std::max(yMin, 0), yMax = std::min(yMax, height - 1);
+
+    if (xMin > xMax || yMin > yMax)
+    {
+        return false;
+    }
+
+    // The area is checked from the cells of the last level, only descending where they cannot conclude
+    constexpr int top = NumLevels - 1;
+    constexpr int topSize = BlockSize << top;
+
+    for (int cy = yMin / topSize; cy <= yMax / topSize; cy++)
+    {
+        for (int cx = xMin / topSize; cx <= xMax / topSize; cx++)
+        {
+            if (!IsCellOccluded(depth, top, cx, cy, xMin, yMin, xMax, yMax, z)) return false;
+        }
+    }
+
+    return true;
+}
+
+bool sr::HiZBuffer::IsCellOccluded(const DepthBuffer& depth, int level, int cx, int cy, int xMin, int yMin, int xMax, int yMax, float z)
+{
+    float &bound = levels[level][cy * widths[level] + cx];
+
+    if (z > bound) return true;
+
+    if (level == 0)
+    {
+        Uint8 &blockDirty = dirty[cy * widths[0] + cx];
+        if (!blockDirty) return false;
+
+        // Recompute the bound of the block from its depth values
+        const int x0 = cx * BlockSize, x1 = std::min(x0 + BlockSize, width);
+        const int y0 = cy * BlockSize, y1 = std::min(y0 + BlockSize, height);
+
+        bound = depth.GetMaxKey(x0, y0, x1, y1);
+        blockDirty = 0;
+
+        return z > bound;
+    }
+
+    const int childLevel = level - 1;
+    const int childSize = BlockSize << childLevel;
+
+    bool occluded = true;
+
+    for (int y = cy * 2; y < std::min(cy * 2 + 2, heights[childLevel]) && occluded; y++)
+    {
+        for (int x = cx * 2; x < std::min(cx * 2 + 2, widths[childLevel]) && occluded; x++)
+        {
+            // Children outside the area are not checked
+            if (x * childSize > xMax || (x + 1) * childSize <= xMin) continue;
+            if (y * childSize > yMax || (y + 1) * childSize <= yMin) continue;
+
+            occluded = IsCellOccluded(depth, childLevel, x, y, xMin, yMin, xMax, yMax, z);
+        }
+    }
+
+    // The bounds of the children never exceed the one of their parent, and may have just been tightened
+    float max = levels[childLevel][cy * 2 * widths[childLevel] + cx * 2];
+
+    for (int y = cy * 2; y < std::min(cy * 2 + 2, heights[childLevel]); y++)
+    {
+        for (int x = cx * 2; x < std::min(cx * 2 + 2, widths[childLevel]); x++)
+        {
+            max = std::max(max, levels[childLevel][y * widths[childLevel] + x]);
+        }
+    }
+
+    bound = max;
+
+    return occluded;
+}
@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "gapi/sr/nxOffscreen.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace nexus;
+
+/* Public Implementation Offscreen */
+
+sr::Offscreen::Offscreen(int width, int height, gfx::PixelFormat format, DepthFormat depthFormat)
+: ownFramebuffer(std::make_unique<Framebuffer>(width, height, format, depthFormat))
+, framebuffer(ownFramebuffer.get())
+, ctx(std::make_unique<Context>(*framebuffer))
+{
+    ctx->SetViewport(0, 0, width, height);
+}
+
+sr::Offscreen::Offscreen(Framebuffer& target)
+: framebuffer(&target)
+, ctx(std::make_unique<Context>(target))
+{
+    ctx->SetViewport(0, 0, target.GetWidth(), target.GetHeight());
+}
+
+void sr::Offscreen::Clear(const gfx::Color& color)
+{
+    // Pending primitives must be rendered before being overwritten
+    ctx->Flush();
+    framebuffer->Clear(color);
+}
+
+sr::Offscreen& sr::Offscreen::Begin()
+{
+    framebuffer->Begin();
+    ctx->LoadIdentity();
+    return *this;
+}
+
+sr::Offscreen& sr::Offscreen::End()
+{
+    ctx->Flush();
+    framebuffer->End();
+    return *this;
+}
+
+/* Public Implementation OffscreenBatch */
+
+sr::OffscreenBatch::OffscreenBatch(int width, int height, int numThreads, gfx::PixelFormat format, DepthFormat depthFormat)
+{
+    if (numThreads <= 0)
+    {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    targets.reserve(numThreads);
+
+    for (int i = 0; i < numThreads; i++)
+    {
+        targets.push_back(std::make_unique<Offscreen>(width, height, format, depthFormat));
+    }
+
+    workers = (numThreads > 1) ? std::make_unique<utils::ThreadPool>(numThreads - 1) : nullptr;
+}
+
+void sr::OffscreenBatch::Render(int count, const SceneFunc& scene, const OutputFunc& output)
+{
+    std::atomic<int> next{0};
+
+    // Each target renders the next scene not taken yet until there is none left
+    const auto run = [&](size_t t)
+    {
+        Offscreen &target = *targets[t];
+
+        for (int i; (i = next.fetch_add(1)) < count;)
+        {
+            target.Begin();
+            scene(target, i);
+            target.End();
+
+            output(target.GetFramebuffer(), i);
+        }
+    };
+
+    if (workers) workers->ParallelFor(targets.size(), run);
+    else run(0);
+}
@@ -18,16 +18,40 @@
  */
 
 #include "gapi/sr/nxPipeline.hpp"
+#include "gapi/sr/nxRasterKernels.hpp"
+#include "core/nxException.hpp"
+#include <algorithm>
+#include <typeinfo>
+#include <cmath>
 
 using namespace nexus;
 
 
 /* Private Implementation Pipeline (Projection and Clipping) */
 
+namespace {
+
+    // Minimum w of the vertices kept by the clipping against the plane of the eye
+    constexpr float ClipEpsilon = 1e-5f;
+
+    // Largest extent in pixels of the 2D triangles rasterized without clipping, beyond which
+    // the edge functions of the fixed-point rasterizers could overflow 32 bits
+    constexpr float MaxUnclippedExtent2D = 8192.0f;
+
+    // Closest depth interpolated between vertices whose depths are within [zMin..zMax], the interpolation
+    // may round a few ulps beyond them, reversed depths being the closest when the greatest
+    float ConservativeDepth(float zMin, float zMax, bool reversed)
+    {
+        const float margin = 8 * std::numeric_limits<float>::epsilon() * std::max(std::abs(zMin), std::abs(zMax));
+        return reversed ? zMax + margin : zMin - margin;
+    }
+
+}
+
 void sr::Pipeline::HomogeneousToScreen(math::Vec4& homogeneous, const nexus::shape2D::Rectangle& viewport)
 {
-    homogeneous.x = (homogeneous.x + 1.0f) * 0.5f * viewport.w;
-    homogeneous.y = (1.0f - homogeneous.y) * 0.5f * viewport.h;
+    homogeneous.x = viewport.x + (homogeneous.x + 1.0f) * 0.5f * viewport.w;
+    homogeneous.y = viewport.y + (1.0f - homogeneous.y) * 0.5f * viewport.h;
 }
 
 _sr_impl::Vertex sr::Pipeline::VertexInterpolation(const _sr_impl::Vertex& start, const _sr_impl::Vertex& end, float t)
@@ -54,13 +78,17 @@ bool sr::Pipeline::ClipLine2D(_sr_impl::Vertex& v0, _sr_impl::Vertex& v1, const
         v0 = v1, v1 = t;
     };
 
-    constexpr auto encode = [](const math::Vec4& v, const shape2D::Rectangle& viewport) -> Uint8
+    // Last column and row of pixels of the viewport, the lines being clipped to its inclusive bounds
+    const float xMax = viewport.x + viewport.w - 1;
+    const float yMax = viewport.y + viewport.h - 1;
+
+    const auto encode = [&](const math::Vec4& v) -> Uint8
     {
         Uint8 code = INSIDE;
         if (v.x < viewport.x) code |= LEFT;
-        if (v.x > viewport.w) code |= RIGHT;
+        if (v.x > xMax) code |= RIGHT;
         if (v.y < viewport.y) code |= BOTTOM;
-        if (v.y > viewport.h) code |= TOP;
+        if (v.y > yMax) code |= TOP;
         return code;
     };
 
@@ -75,8 +103,8 @@ bool sr::Pipeline::ClipLine2D(_sr_impl::Vertex& v0, _sr_impl::Vertex& v1, const
 
     for (;;)
     {
-        code0 = encode(v0.position, viewport);
-        code1 = encode(v1.position, viewport);
+        code0 = encode(v0.position);
+        code1 = encode(v1.position);
 
         // Accepted if both endpoints lie within rectangle
         if ((code0 | code1) == 0)
@@ -101,8 +129,8 @@ bool sr::Pipeline::ClipLine2D(_sr_impl::Vertex& v0, _sr_impl::Vertex& v1, const
         }
         else if (code0 & RIGHT)
         {
-            v0.position.y += (viewport.w - v0.position.x) * m;
-            v0.position.x = viewport.w;
+            v0.position.y += (xMax - v0.position.x) * m;
+            v0.position.x = xMax;
         }
         else if (code0 & BOTTOM)
         {
@@ -111,8 +139,8 @@ bool sr::Pipeline::ClipLine2D(_sr_impl::Vertex& v0, _sr_impl::Vertex& v1, const
         }
         else if (code0 & TOP)
         {
-            if (m) v0.position.x += (viewport.h - v0.position.y) / m;
-            v0.position.y = viewport.h;
+            if (m) v0.position.x += (yMax - v0.position.y) / m;
+            v0.position.y = yMax;
         }
     }
 
@@ -165,8 +193,6 @@ bool sr::Pipeline::ClipLine3D(_sr_impl::Vertex& v0, _sr_impl::Vertex& v1)
 
 bool sr::Pipeline::ClipPolygonW(std::array<_sr_impl::Vertex, 12>& polygon, Uint8& vertexCounter)
 {
-    constexpr float ClipEpsilon = 1e-5f;
-
     std::array<_sr_impl::Vertex, 12> input = polygon;
     Uint8 inputCounter = vertexCounter;
     vertexCounter = 0;
@@ -198,9 +224,9 @@ bool sr::Pipeline::ClipPolygonW(std::array<_sr_impl::Vertex, 12>& polygon, Uint8
     return vertexCounter > 0;
 }
 
-bool sr::Pipeline::ClipPolygonXYZ(std::array<_sr_impl::Vertex, 12>& polygon, Uint8& vertexCounter)
+bool sr::Pipeline::ClipPolygonXYZ(std::array<_sr_impl::Vertex, 12>& polygon, Uint8& vertexCounter, Uint8 axisCount)
 {
-    for (Uint8 iAxis = 0; iAxis < 3; iAxis++)
+    for (Uint8 iAxis = 0; iAxis < axisCount; iAxis++)
     {
         if (vertexCounter == 0) return false;
 
@@ -219,13 +245,26 @@ bool sr::Pipeline::ClipPolygonXYZ(std::array<_sr_impl::Vertex, 12>& polygon, Uin
             const Sint8 currDotHigh = (inVertex.position[iAxis] <= inVertex.position.w) ? 1 : -1;
             const Sint8 currDotLow = (-inVertex.position[iAxis] <= inVertex.position.w) ? 1 : -1;
 
-            if (prevDotHigh * currDotHigh < 0)
+            const bool crossHigh = prevDotHigh * currDotHigh < 0;
+            const bool crossLow = prevDotLow * currDotLow < 0;
+
+            // An edge spanning the whole axis crosses both planes, the intersections
+            // must then be emitted in the order the edge meets them
+            const bool lowFirst = crossLow && prevDotLow < 0;
+
+            if (lowFirst)
+            {
+                polygon[vertexCounter++] = VertexInterpolation(*prevVt, inVertex, 
+                    (prevVt->position.w + prevVt->position[iAxis]) / ((prevVt->position.w + prevVt->position[iAxis]) - (inVertex.position.w + inVertex.position[iAxis])));
+            }
+
+            if (crossHigh)
             {
                 polygon[vertexCounter++] = VertexInterpolation(*prevVt, inVertex, 
                     (prevVt->position.w - prevVt->position[iAxis]) / ((prevVt->position.w - prevVt->position[iAxis]) - (inVertex.position.w - inVertex.position[iAxis])));
             }
 
-            if (prevDotLow * currDotLow < 0)
+            if (crossLow && !lowFirst)
             {
                 polygon[vertexCounter++] = VertexInterpolation(*prevVt, inVertex, 
                     (prevVt->position.w + prevVt->position[iAxis]) / ((prevVt->position.w + prevVt->position[iAxis]) - (inVertex.position.w + inVertex.position[iAxis])));
@@ -245,11 +284,8 @@ bool sr::Pipeline::ClipPolygonXYZ(std::array<_sr_impl::Vertex, 12>& polygon, Uin
     return vertexCounter > 0;
 }
 
-void sr::Pipeline::ProjectAndClipLine(std::array<_sr_impl::Vertex, 2>& line, Uint8& vertexCounter, const math::Mat4& mvp, const shape2D::Rectangle& viewport, Shader* shader)
+void sr::Pipeline::ClipAndProjectLine(std::array<_sr_impl::Vertex, 2>& line, Uint8& vertexCounter, const shape2D::Rectangle& viewport)
 {
-    line[0].position = shader->Vertex(mvp, line[0].position);
-    line[1].position = shader->Vertex(mvp, line[1].position);
-
     if (line[0].position.w == 1.0f && line[1].position.w == 1.0f)
     {
         HomogeneousToScreen(line[0].position, viewport);
@@ -277,28 +313,77 @@ void sr::Pipeline::ProjectAndClipLine(std::array<_sr_impl::Vertex, 2>& line, Uin
     }
 }
 
-void sr::Pipeline::ProjectAndClipTriangle(std::array<_sr_impl::Vertex, 12>& polygon, Uint8& vertexCounter, const math::Mat4& mvp, const shape2D::Rectangle& viewport, nexus::sr::Shader* shader, bool& is2D)
+void sr::Pipeline::ClipAndProjectTriangle(std::array<_sr_impl::Vertex, 12>& polygon, Uint8& vertexCounter, const shape2D::Rectangle& viewport, bool& is2D, PipelineStats& counters)
 {
-    for (int i = 0; i < vertexCounter; i++)
-    {
-        polygon[i].position = shader->Vertex(mvp, polygon[i].position);
-    }
-
     if (polygon[0].position.w == 1.0f && polygon[1].position.w == 1.0f && polygon[2].position.w == 1.0f)
     {
+        is2D = true;
+
+        // 2D triangles are only clipped to the viewport when they are too large for the rasterizers,
+        // so that the edges shared by the others are rasterized from the same vertices
+        const math::Vec4 &p0 = polygon[0].position, &p1 = polygon[1].position, &p2 = polygon[2].position;
+
+        const float extent = std::max(
+            (std::max({ p0.x, p1.x, p2.x }) - std::min({ p0.x, p1.x, p2.x })) * 0.5f * viewport.w,
+            (std::max({ p0.y, p1.y, p2.y }) - std::min({ p0.y, p1.y, p2.y })) * 0.5f * viewport.h);
+
+        if (extent > MaxUnclippedExtent2D)
+        {
+            counters.trianglesClipped++;
+
+            if (!ClipPolygonXYZ(polygon, vertexCounter, 2))
+            {
+                vertexCounter = 0;
+                return;
+            }
+        }
+
         for (int i = 0; i < vertexCounter; i++)
         {
             HomogeneousToScreen(polygon[i].position, viewport);
         }
-        is2D = true;
     }
     else
     {
-        if (ClipPolygonW(polygon, vertexCounter) && ClipPolygonXYZ(polygon, vertexCounter))
+        // Outcodes of the vertices against the clipping planes, using the same tests as the clipping passes
+        const auto outcode = [](const math::Vec4& p) -> Uint8
+        {
+            return (p.w < ClipEpsilon)
+                | (p.x > p.w) << 1 | (-p.x > p.w) << 2
+                | (p.y > p.w) << 3 | (-p.y > p.w) << 4
+                | (p.z > p.w) << 5 | (-p.z > p.w) << 6;
+        };
+
+        const Uint8 code0 = outcode(polygon[0].position);
+        const Uint8 code1 = outcode(polygon[1].position);
+        const Uint8 code2 = outcode(polygon[2].position);
+
+        bool visible = true;
+
+        if (code0 & code1 & code2)
+        {
+            counters.trianglesRejected++;
+            vertexCounter = 0;
+            visible = false;
+        }
+        else if (code0 | code1 | code2)
+        {
+            counters.trianglesClipped++;
+            visible = ClipPolygonW(polygon, vertexCounter) && ClipPolygonXYZ(polygon, vertexCounter);
+        }
+        else
+        {
+            counters.trianglesAccepted++;
+        }
+
+        if (visible)
         {
+            // The inverse of w is kept for the perspective correction of the interpolated attributes
             for (int i = 0; i < vertexCounter; i++)
             {
-                polygon[i].position /= polygon[i].position.w;
+                const float w = polygon[i].position.w;
+                polygon[i].position /= w;
+                polygon[i].position.w = 1.0f / w;
                 HomogeneousToScreen(polygon[i].position, viewport);
             }
         }
@@ -309,14 +394,407 @@ void sr::Pipeline::ProjectAndClipTriangle(std::array<_sr_impl::Vertex, 12>& poly
 
 /* Private Implementation Pipeline (Rasterization) */
 
-void sr::Pipeline::RasterizeLine(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, bool depthTest)
+namespace {
+
+    // Counters of the triangles rasterized by the current thread, collected by the pipeline after each triangle or tile
+    thread_local sr::PipelineStats threadStats;
+
+    sr::PipelineStats TakeThreadStats()
+    {
+        const sr::PipelineStats result = threadStats;
+        threadStats = sr::PipelineStats();
+        return result;
+    }
+
+    /**
+     * @brief Restricts a pixel area to the columns and rows of the viewport, the same ones 2D lines are clipped to.
+     */
+    _sr_impl::RasterBounds ClampToViewport(const _sr_impl::RasterBounds& bounds, const shape2D::Rectangle& viewport)
+    {
+        return {
+            std::max<int>(bounds.xMin, viewport.x), std::max<int>(bounds.yMin, viewport.y),
+            std::min<int>(bounds.xMax, viewport.x + viewport.w - 1), std::min<int>(bounds.yMax, viewport.y + viewport.h - 1)
+        };
+    }
+
+    /**
+     * @brief Checks if an edge function is negative at the four corners of a block.
+     *
+     * Edge functions being linear, the block is then entirely on the outer side of the edge.
+     */
+    bool IsBlockOutside(int w00, int w10, int w01, int w11)
+    {
+        return (w00 & w10 & w01 & w11) < 0;
+    }
+
+    /**
+     * @brief Checks if an edge function is positive or zero at the four corners of a block.
+     *
+     * The block is then entirely on the inner side of the edge.
+     */
+    bool IsBlockInside(int w00, int w10, int w01, int w11)
+    {
+        return (w00 | w10 | w01 | w11) >= 0;
+    }
+
+    /**
+     * @brief Checks if a shader is an instance of the default shader, which overrides nothing.
+     *
+     * The rasterizers then inline what the default fragment shader does instead of calling it.
+     */
+    bool IsDefaultShader(const sr::Shader* shader)
+    {
+        return typeid(*shader) == typeid(sr::Shader);
+    }
+
+    /**
+     * @brief Sets the coordinates, the mask and the vertex colors of a span from a row of fragments.
+     */
+    void SetupFragmentSpan(sr::FragmentSpan& span, const gfx::Surface* image, int x, int y,
+                           const _sr_impl::FragmentBlock& block, Uint32 mask, int count)
+    {
+        span.image = image;
+        span.sampler = nullptr;
+        span.lod = 0.0f;
+        span.fragCoord = math::IVec2(x, y);
+        span.count = count;
+        span.mask = mask;
+        std::copy_n(block.colors, count, span.fragColors);
+    }
+
+    // Number of fractional bits of the fixed-point vertex positions used by the triangle rasterizers (28.4)
+    constexpr int SubPixelBits = 4;
+
+    // Largest extent of a triangle in fixed-point units, beyond which the precision is lowered
+    // so that the edge functions, at most twice the square of the extent, fit in 32 bits
+    constexpr float MaxFixedExtent = 1 << 14;
+
+    // Positions of the samples of multisampled framebuffers relative to the center of the pixels,
+    // in 1/16th of a pixel (rotated grid, so that no two samples share a row or a column)
+    constexpr int SampleOffsets[sr::Framebuffer::MaxSamples][2] = { { -2, -6 }, { 6, -2 }, { -6, 2 }, { 2, 6 } };
+
+    /**
+     * @brief Edge functions of a triangle over the area of pixels to fill.
+     */
+    struct TriangleEdges
+    {
+        int xMin, yMin, xMax, yMax;                 ///< Area to fill (inclusive)
+        int w0Row, w1Row, w2Row;                    ///< Biased edge functions at the center of the top-left pixel of the area
+        math::IVec2 sW0, sW1, sW2;                  ///< Increments of the edge functions from one pixel to the next on each axis
+    };
+
+    /**
+     * @brief Sets up the edge functions and the interpolation constants of a counter-clockwise triangle.
+     *
+     * The vertices are snapped to 1/16th of a pixel (28.4 fixed-point, less for huge triangles) and
+     * the pixels are sampled at their center. The edge functions which are not on the top or left side
+     * of the triangle are biased by one so that their zero is excluded: pixels centered exactly on an
+     * edge shared by two triangles are covered by one of them only (top-left fill rule).
+     * The w of the vertices holds the inverse of their clip-space w, from which the kernels
+     * correct the perspective of the weights used to interpolate the colors and the attributes.
+     * When multisampling, the area to fill includes every pixel touched by the bounding box of the triangle.
+     *
+     * @return False if the triangle is clockwise or degenerate, or if it covers no pixel of the area.
+     */
+    bool SetupTriangle(TriangleEdges& edges, _sr_impl::TriangleSetup& triangle,
+                       const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2,
+                       const _sr_impl::RasterBounds& bounds, sr::DepthFormat depthFormat, bool multisample)
+    {
+        const math::Vec4 &p0 = v0.position, &p1 = v1.position, &p2 = v2.position;
+
+        const float extent = std::max(
+            std::max({ p0.x, p1.x, p2.x }) - std::min({ p0.x, p1.x, p2.x }),
+            std::max({ p0.y, p1.y, p2.y }) - std::min({ p0.y, p1.y, p2.y }));
+
+        // At least one fractional bit is kept to represent the centers of the pixels
+        int bits = SubPixelBits;
+        while (bits > 1 && extent * (1 << bits) > MaxFixedExtent) bits--;
+
+        const float scale = static_cast<float>(1 << bits);
+        const int half = 1 << (bits - 1);
+
+        const auto snap = [scale](float v) { return static_cast<int>(std::floor(v * scale + 0.5f)); };
+        const math::IVec2 f0(snap(p0.x), snap(p0.y)), f1(snap(p1.x), snap(p1.y)), f2(snap(p2.x), snap(p2.y));
+
+        // Twice the signed area, negative for the triangles that can be rendered
+        const Sint64 area = static_cast<Sint64>(f1.x - f0.x) * (f2.y - f0.y) - static_cast<Sint64>(f2.x - f0.x) * (f1.y - f0.y);
+        if (area >= 0) return false;
+
+        // Pixels whose center is within the bounding box of the triangle, restricted to the given bounds
+        // When multisampling, any pixel touched by the bounding box may have some of its samples covered
+        if (multisample)
+        {
+            edges.xMin = std::max(bounds.xMin, std::min({ f0.x, f1.x, f2.x }) >> bits);
+            edges.yMin = std::max(bounds.yMin, std::min({ f0.y, f1.y, f2.y }) >> bits);
+            edges.xMax = std::min(bounds.xMax, std::max({ f0.x, f1.x, f2.x }) >> bits);
+            edges.yMax = std::min(bounds.yMax, std::max({ f0.y, f1.y, f2.y }) >> bits);
+        }
+        else
+        {
+            edges.xMin = std::max(bounds.xMin, (std::min({ f0.x, f1.x, f2.x }) - half + (1 << bits) - 1) >> bits);
+            edges.yMin = std::max(bounds.yMin, (std::min({ f0.y, f1.y, f2.y }) - half + (1 << bits) - 1) >> bits);
+            edges.xMax = std::min(bounds.xMax, (std::max({ f0.x, f1.x, f2.x }) - half) >> bits);
+            edges.yMax = std::min(bounds.yMax, (std::max({ f0.y, f1.y, f2.y }) - half) >> bits);
+        }
+
+        if (edges.xMin > edges.xMax || edges.yMin > edges.yMax) return false;
+
+        // Edge functions at the center of the first pixel of the area, each one being positive
+        // on the inner side of the edge opposite to its vertex, and their steps from pixel to pixel
+        const Sint64 x = (static_cast<Sint64>(edges.xMin) << bits) + half;
+        const Sint64 y = (static_cast<Sint64>(edges.yMin) << bits) + half;
+
+        const Sint64 w0 = (x - f1.x) * (f2.y - f1.y) - static_cast<Sint64>(f2.x - f1.x) * (y - f1.y);
+        const Sint64 w1 = (x - f2.x) * (f0.y - f2.y) - static_cast<Sint64>(f0.x - f2.x) * (y - f2.y);
+        const Sint64 w2 = (x - f0.x) * (f1.y - f0.y) - static_cast<Sint64>(f1.x - f0.x) * (y - f0.y);
+
+        edges.sW0 = math::IVec2((f2.y - f1.y) << bits, (f1.x - f2.x) << bits);
+        edges.sW1 = math::IVec2((f0.y - f2.y) << bits, (f2.x - f0.x) << bits);
+        edges.sW2 = math::IVec2((f1.y - f0.y) << bits, (f0.x - f1.x) << bits);
+
+        // The increments point towards the inside: left edges increase to the right, top edges downwards
+        const auto isTopLeft = [](const math::IVec2& step) { return step.x > 0 || (step.x == 0 && step.y > 0); };
+
+        triangle.bias0 = isTopLeft(edges.sW0) ? 0 : 1;
+        triangle.bias1 = isTopLeft(edges.sW1) ? 0 : 1;
+        triangle.bias2 = isTopLeft(edges.sW2) ? 0 : 1;
+
+        edges.w0Row = static_cast<int>(w0 - triangle.bias0);
+        edges.w1Row = static_cast<int>(w1 - triangle.bias1);
+        edges.w2Row = static_cast<int>(w2 - triangle.bias2);
+
+        triangle.stepW0 = edges.sW0.x, triangle.stepW1 = edges.sW1.x, triangle.stepW2 = edges.sW2.x;
+        triangle.invArea = 1.0f / static_cast<float>(-area);
+
+        // The depths are interpolated in the representation of the depth buffer, which keeps
+        // the precision of the reversed floats, and converted back for the fragments
+        switch (depthFormat)
+        {
+            case sr::DepthFormat::Unorm16:
+            {
+                constexpr float scale = sr::DepthBuffer::Unorm16Scale;
+                triangle.z0 = p0.z * scale + scale, triangle.z1 = p1.z * scale + scale, triangle.z2 = p2.z * scale + scale;
+                triangle.zScale = 1.0f / scale, triangle.zOffset = -1.0f;
+                break;
+            }
+
+            case sr::DepthFormat::ReversedFloat32:
+                triangle.z0 = -p0.z, triangle.z1 = -p1.z, triangle.z2 = -p2.z;
+                triangle.zScale = -1.0f, triangle.zOffset = 0.0f;
+                break;
+
+            default:
+                triangle.z0 = p0.z, triangle.z1 = p1.z, triangle.z2 = p2.z;
+                triangle.zScale = 1.0f, triangle.zOffset = 0.0f;
+                break;
+        }
+
+        triangle.depthFormat = depthFormat;
+
+        // Screen-space weights are perspective corrected with the plane of 1/w, unless it is constant (2D and orthographic triangles)
+        triangle.invW0 = p0.w, triangle.invW1 = p1.w, triangle.invW2 = p2.w;
+        triangle.perspective = p0.w != p1.w || p1.w != p2.w;
+
+        triangle.color0 = v0.color.Normalized(), triangle.color1 = v1.color.Normalized(), triangle.color2 = v2.color.Normalized();
+
+        return true;
+    }
+
+    /**
+     * @brief Fills the given area of a triangle by blocks of pixels.
+     *
+     * The area is traversed in blocks of `FragmentBlock::Size` x `FragmentBlock::Size` pixels, classified
+     * from the edge functions at their corners: blocks outside the triangle are skipped, blocks inside
+     * are filled without edge tests and the others are tested pixel by pixel.
+     *
+     * The edge tests, the depth test and the interpolation of the depth and the colors
+     * are done by the rasterization kernels selected for the CPU, `shade(x, y, block, mask, count, out)`
+     * then writes in `out` the color of each pixel of the row starting at (x, y) whose bit is set in `mask`.
+     *
+     * With a multisampled framebuffer, the edge and depth tests are done for each sample, but the pixels
+     * with at least one sample covered are shaded once, from the values interpolated at their center.
+     */
+    template <typename F>
+    void FillTriangle(sr::Framebuffer& framebuffer, const _sr_impl::TriangleSetup& triangle,
+                      const TriangleEdges& edges, bool depthTest, F&& shade)
+    {
+        constexpr int blockSize = _sr_impl::FragmentBlock::Size;
+
+        const int xMin = edges.xMin, yMin = edges.yMin, xMax = edges.xMax, yMax = edges.yMax;
+        const math::IVec2 &sW0 = edges.sW0, &sW1 = edges.sW1, &sW2 = edges.sW2;
+        int w0Row = edges.w0Row, w1Row = edges.w1Row, w2Row = edges.w2Row;
+
+        const _sr_impl::RasterKernels &kernels = _sr_impl::GetRasterKernels();
+
+        // Pixels of RGBA32 framebuffers are blended and written by the kernels as well
+        const bool directWrite = framebuffer.GetPixelFormat() == gfx::PixelFormat::RGBA32;
+        gfx::Color *pixels = static_cast<gfx::Color*>(framebuffer.GetPixels());
+        Uint8 *depth = depthTest ? static_cast<Uint8*>(framebuffer.GetDepthData()) : nullptr;
+        const int depthSize = framebuffer.GetDepthBytesPerPixel();
+
+        // Offsets of the edge functions from the center of the pixels to their samples, and their range
+        // NOTE: They are exact with the full sub-pixel precision, huge triangles get them rounded
+        const int samples = framebuffer.GetSampleCount();
+
+        int sampleW0[sr::Framebuffer::MaxSamples] = {}, sampleW1[sr::Framebuffer::MaxSamples] = {}, sampleW2[sr::Framebuffer::MaxSamples] = {};
+        Uint8 *sampleDepth[sr::Framebuffer::MaxSamples] = { depth };
+
+        if (samples > 1)
+        {
+            for (int s = 0; s < samples; s++)
+            {
+                const int ox = SampleOffsets[s][0], oy = SampleOffsets[s][1];
+                sampleW0[s] = (ox * sW0.x + oy * sW0.y) >> SubPixelBits;
+                sampleW1[s] = (ox * sW1.x + oy * sW1.y) >> SubPixelBits;
+                sampleW2[s] = (ox * sW2.x + oy * sW2.y) >> SubPixelBits;
+                sampleDepth[s] = depthTest ? static_cast<Uint8*>(framebuffer.GetDepthData(s)) : nullptr;
+            }
+        }
+
+        const auto [minW0, maxW0] = std::minmax_element(sampleW0, sampleW0 + samples);
+        const auto [minW1, maxW1] = std::minmax_element(sampleW1, sampleW1 + samples);
+        const auto [minW2, maxW2] = std::minmax_element(sampleW2, sampleW2 + samples);
+
+        _sr_impl::FragmentBlock block;
+        gfx::Color out[blockSize];
+        Uint32 sampleMasks[sr::Framebuffer::MaxSamples];
+
+        sr::PipelineStats stats;
+
+        for (int yBlock = yMin; yBlock <= yMax; yBlock += blockSize)
+        {
+            const int rows = std::min(blockSize, yMax - yBlock + 1);
+            int w0Block = w0Row, w1Block = w1Row, w2Block = w2Row;
+
+            for (int xBlock = xMin; xBlock <= xMax; xBlock += blockSize)
+            {
+                const int count = std::min(blockSize, xMax - xBlock + 1);
+
+                // Edge functions at the top-left pixel of the block, and offsets to the other corners
+                const int w0 = w0Block, w1 = w1Block, w2 = w2Block;
+                const int dx0 = (count - 1) * sW0.x, dx1 = (count - 1) * sW1.x, dx2 = (count - 1) * sW2.x;
+                const int dy0 = (rows - 1) * sW0.y, dy1 = (rows - 1) * sW1.y, dy2 = (rows - 1) * sW2.y;
+
+                w0Block += blockSize * sW0.x, w1Block += blockSize * sW1.x, w2Block += blockSize * sW2.x;
+
+                // The corners of the block are moved to the farthest samples on each side of the edges
+                const int o0 = *maxW0, o1 = *maxW1, o2 = *maxW2;
+                const int i0 = *minW0, i1 = *minW1, i2 = *minW2;
+
+                if (IsBlockOutside(w0 + o0, w0 + o0 + dx0, w0 + o0 + dy0, w0 + o0 + dx0 + dy0)
+                 || IsBlockOutside(w1 + o1, w1 + o1 + dx1, w1 + o1 + dy1, w1 + o1 + dx1 + dy1)
+                 || IsBlockOutside(w2 + o2, w2 + o2 + dx2, w2 + o2 + dy2, w2 + o2 + dx2 + dy2))
+                {
+                    stats.blocksRejected++;
+                    continue;
+                }
+
+                const bool covered = IsBlockInside(w0 + i0, w0 + i0 + dx0, w0 + i0 + dy0, w0 + i0 + dx0 + dy0)
+                                  && IsBlockInside(w1 + i1, w1 + i1 + dx1, w1 + i1 + dy1, w1 + i1 + dx1 + dy1)
+                                  && IsBlockInside(w2 + i2, w2 + i2 + dx2, w2 + i2 + dy2, w2 + i2 + dx2 + dy2);
+
+                if (covered) stats.blocksAccepted++;
+                else stats.blocksPartial++, stats.pixelsTested += rows * count;
+
+                // The tiles cleared lazily are only written once a block of the triangle reaches them, which also damages them
+                framebuffer.MarkDrawn(xBlock, yBlock, xBlock + count - 1, yBlock + rows - 1);
+
+                bool written = false;
+
+                for (int row = 0; row < rows; row++)
+                {
+                    const int y = yBlock + row;
+                    const Uint32 xyOffset = y * framebuffer.GetWidth() + xBlock;
+                    const int w0Pixel = w0 + row * sW0.y, w1Pixel = w1 + row * sW1.y, w2Pixel = w2 + row * sW2.y;
+
+                    Uint32 mask = 0;
+
+                    if (samples == 1)
+                    {
+                        mask = kernels.ProcessBlock(triangle, w0Pixel, w1Pixel, w2Pixel,
+                            count, covered, depth ? depth + xyOffset * depthSize : nullptr, block);
+                    }
+                    else
+                    {
+                        for (int s = 0; s < samples; s++)
+                        {
+                            // Without depth test, the samples of a covered block need no test at all
+                            sampleMasks[s] = (covered && !depth) ? (1u << count) - 1 : kernels.CoverBlock(triangle,
+                                w0Pixel + sampleW0[s], w1Pixel + sampleW1[s], w2Pixel + sampleW2[s],
+                                count, covered, depth ? sampleDepth[s] + xyOffset * depthSize : nullptr);
+
+                            mask |= sampleMasks[s];
+                        }
+
+                        // The values are interpolated at the center of all the pixels, even those it does not cover
+                        if (mask != 0)
+                        {
+                            kernels.ProcessBlock(triangle, w0Pixel, w1Pixel, w2Pixel, count, true, nullptr, block);
+                        }
+                    }
+
+                    if (mask == 0) continue;
+
+                    written = true;
+
+                    for (int i = 0; i < count; i++)
+                    {
+                        stats.pixelsShaded += (mask >> i) & 1;
+                    }
+
+                    shade(xBlock, y, block, mask, count, out);
+
+                    // The partially covered pixels are blended into their samples, the others are written as usual
+                    if (samples > 1)
+                    {
+                        mask = framebuffer.BlendSamplesUnsafe(xBlock, y, out, sampleMasks, count);
+                        if (mask == 0) continue;
+                    }
+
+                    if (directWrite)
+                    {
+                        kernels.WriteBlock(pixels + xyOffset, out, mask, count);
+                        continue;
+                    }
+
+                    // Other formats are blended by the surface, the pixels outside the mask being made fully transparent
+                    for (int i = 0; i < count; i++)
+                    {
+                        if (!(mask & (1u << i))) out[i].a = 0;
+                    }
+
+                    framebuffer.BlendPixelsUnsafe(xBlock, y, out, count);
+                }
+
+                if (depth && written)
+                {
+                    framebuffer.MarkDepthWritten(xBlock, yBlock, xBlock + count - 1, yBlock + rows - 1);
+                }
+            }
+
+            w0Row += blockSize * sW0.y, w1Row += blockSize * sW1.y, w2Row += blockSize * sW2.y;
+        }
+
+        threadStats += stats;
+    }
+
+}
+
+void sr::Pipeline::RasterizeLine(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, bool depthTest, const _sr_impl::RasterBounds& bounds)
 {
     const float dx = v1.position.x - v0.position.x;
     const float dy = v1.position.y - v0.position.y;
 
     if (dx == 0 && dy == 0)
     {
-        framebuffer.SetPixelDepthUnsafe(v0.position.x, v0.position.y, v0.position.z, v0.color, depthTest);
+        const int x = v0.position.x, y = v0.position.y;
+
+        if (x >= bounds.xMin && x <= bounds.xMax && y >= bounds.yMin && y <= bounds.yMax)
+        {
+            framebuffer.MarkDrawn(x, y, x, y);
+            framebuffer.SetPixelDepthUnsafe(x, y, v0.position.z, v0.color, depthTest);
+        }
+
         return;
     }
 
@@ -341,15 +819,18 @@ void sr::Pipeline::RasterizeLine(Framebuffer& framebuffer, const _sr_impl::Verte
             zMin = v1.position.z, zMax = v0.position.z;
         }
 
-        for (int x = xMin; x <= xMax; x++)
+        // Only iterate over the columns within the bounds, the interpolation still starts from xMin
+        const int xEnd = std::min(xMax, bounds.xMax);
+
+        for (int x = std::max(xMin, bounds.xMin); x <= xEnd; x++)
         {
             const float t = (x - xMin) * invAdx;
             const int y = v0.position.y + (x - v0.position.x) * slope;
 
-            if (!depthTest || framebuffer.SetDepthUnsafe(x, y, zMin + t * (zMax - zMin)))
-            {
-                framebuffer.SetPixelUnsafe(x, y, math::Lerp(v0.color, v1.color, t));
-            }
+            if (y < bounds.yMin || y > bounds.yMax) continue;
+
+            framebuffer.MarkDrawn(x, y, x, y);
+            framebuffer.SetPixelDepthUnsafe(x, y, zMin + t * (zMax - zMin), math::Lerp(v0.color, v1.color, t), depthTest);
         }
     }
     else
@@ -370,440 +851,767 @@ void sr::Pipeline::RasterizeLine(Framebuffer& framebuffer, const _sr_impl::Verte
             zMin = v1.position.z, zMax = v0.position.z;
         }
 
-        for (int y = yMin; y <= yMax; y++)
+        // Only iterate over the rows within the bounds, the interpolation still starts from yMin
+        const int yEnd = std::min(yMax, bounds.yMax);
+
+        for (int y = std::max(yMin, bounds.yMin); y <= yEnd; y++)
         {
             const float t = (y - yMin) * invAdy;
             const int x = v0.position.x + (y - v0.position.y) * slope;
 
-            if (!depthTest || framebuffer.SetDepthUnsafe(x, y, zMin + t * (zMax - zMin)))
-            {
-                framebuffer.SetPixelUnsafe(x, y, math::Lerp(v0.color, v1.color, t));
-            }
+            if (x < bounds.xMin || x > bounds.xMax) continue;
+
+            framebuffer.MarkDrawn(x, y, x, y);
+            framebuffer.SetPixelDepthUnsafe(x, y, zMin + t * (zMax - zMin), math::Lerp(v0.color, v1.color, t), depthTest);
         }
     }
 }
 
-void sr::Pipeline::RasterizeTriangleColor2D(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, sr::Shader* shader, bool depthTest, const shape2D::Rectangle& viewport)
+void sr::Pipeline::RasterizeTriangleColor2D(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, sr::Shader* shader, bool depthTest, const shape2D::Rectangle& viewport, const _sr_impl::RasterBounds& bounds)
 {
-    // Get integer 2D position coordinates
-    const math::Vector2<int> iV0(v0.position.x, v0.position.y);
-    const math::Vector2<int> iV1(v1.position.x, v1.position.y);
-    const math::Vector2<int> iV2(v2.position.x, v2.position.y);
+    // Restrict the area to fill to the viewport, the 2D triangles not being clipped
+    const _sr_impl::RasterBounds area = ClampToViewport(bounds, viewport);
 
-    // Check if vertices are in clockwise order or degenerate, in which case the triangle cannot be rendered
-    if ((iV1.x - iV0.x) * (iV2.y - iV0.y) - (iV2.x - iV0.x) * (iV1.y - iV0.y) >= 0.0f) return;
+    // Fixed-point edge functions and constants used by the kernels to interpolate the depth and the normalized colors
+    TriangleEdges edges;
+    _sr_impl::TriangleSetup triangle;
 
-    // Calculate the 2D bounding box of the triangle clamped to the viewport dimensions
-    const math::Vector2<Uint16> min = iV0.Min(iV1.Min(iV2)).Clamp(
-        viewport.GetPosition(), viewport.GetSize());
+    if (!SetupTriangle(edges, triangle, v0, v1, v2, area, framebuffer.GetDepthFormat(), framebuffer.GetSampleCount() > 1)) return;
 
-    const math::Vector2<Uint16> max = iV0.Max(iV1.Max(iV2)).Clamp(
-        viewport.GetPosition(), viewport.GetSize());
+    // Fill the triangle by blocks of pixels, the default shader being inlined and the others called once per row
+    // The default shader returns the interpolated colors as they are
+    if (IsDefaultShader(shader))
+    {
+        FillTriangle(framebuffer, triangle, edges, depthTest,
+            [](int, int, const _sr_impl::FragmentBlock& block, Uint32, int count, gfx::Color* out)
+            {
+                std::copy_n(block.colors, count, out);
+            });
 
-    // If triangle is entirely outside the viewport we can stop now
-    if (min == max) return;
+        return;
+    }
 
-    // Calculate original edge weights relative to bounds.min
-    // Will be used to obtain barycentric coordinates by incrementing then averaging them
-    int w0Row = (min.x - iV1.x) * (iV2.y - iV1.y) - (iV2.x - iV1.x) * (min.y - iV1.y);
-    int w1Row = (min.x - iV2.x) * (iV0.y - iV2.y) - (iV0.x - iV2.x) * (min.y - iV2.y);
-    int w2Row = (min.x - iV0.x) * (iV1.y - iV0.y) - (iV1.x - iV0.x) * (min.y - iV0.y);
+    FillTriangle(framebuffer, triangle, edges, depthTest,
+        [&](int x, int y, const _sr_impl::FragmentBlock& block, Uint32 mask, int count, gfx::Color* out)
+        {
+            sr::FragmentSpan span;
+            SetupFragmentSpan(span, nullptr, x, y, block, mask, count);
+            std::fill_n(span.fragNormals, count, math::Vec3(0, 0, 1));
+            shader->Fragment(span, out);
+        });
+}
+
+void sr::Pipeline::RasterizeTriangleImage2D(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, sr::Shader* shader, const gfx::Surface* image, const TextureSampler& sampler, bool depthTest, const shape2D::Rectangle& viewport, const _sr_impl::RasterBounds& bounds)
+{
+    // Restrict the area to fill to the viewport, the 2D triangles not being clipped
+    const _sr_impl::RasterBounds area = ClampToViewport(bounds, viewport);
+
+    // Fixed-point edge functions and constants used by the kernels to interpolate the depth and the normalized colors
+    TriangleEdges edges;
+    _sr_impl::TriangleSetup triangle;
 
-    // Calculate weight increment steps for each edge
-    const math::IVec2 sW0(iV2.y - iV1.y, iV1.x - iV2.x);
-    const math::IVec2 sW1(iV0.y - iV2.y, iV2.x - iV0.x);
-    const math::IVec2 sW2(iV1.y - iV0.y, iV0.x - iV1.x);
+    if (!SetupTriangle(edges, triangle, v0, v1, v2, area, framebuffer.GetDepthFormat(), framebuffer.GetSampleCount() > 1)) return;
 
-    // Normalize colors for barycentric interpolation
-    const math::Vec4 nColV0 = v0.color.Normalized();
-    const math::Vec4 nColV1 = v1.color.Normalized();
-    const math::Vec4 nColV2 = v2.color.Normalized();
+    // Mipmap level of the triangle, from the ratio between its area in the texture and on screen
+    const float lod = sampler.ComputeLod(image, v0.texcoord, v1.texcoord, v2.texcoord,
+        { v0.position.x, v0.position.y }, { v1.position.x, v1.position.y }, { v2.position.x, v2.position.y });
 
-    // Fill the triangle with either color or image based on the provided parameters
-    for (Uint16 y = min.y; y <= max.y; y++)
+    // Fill the triangle by blocks of pixels, the default shader being inlined and the others called once per row
+    // The default shader modulates the texels by the interpolated colors
+    if (IsDefaultShader(shader))
     {
-        const Uint32 yOffset = y * framebuffer.GetWidth();
-        int w0 = w0Row, w1 = w1Row, w2 = w2Row;
+        FillTriangle(framebuffer, triangle, edges, depthTest,
+            [&](int, int, const _sr_impl::FragmentBlock& block, Uint32 mask, int count, gfx::Color* out)
+            {
+                for (int i = 0; i < count; i++)
+                {
+                    if (!(mask & (1u << i))) continue;
+                    const math::Vec2 uv = v0.texcoord * block.aW0[i] + v1.texcoord * block.aW1[i] + v2.texcoord * block.aW2[i];
+                    out[i] = sampler.Sample(image, uv, lod) * block.colors[i];
+                }
+            });
 
-        for (Uint16 x = min.x; x <= max.x; x++)
+        return;
+    }
+
+    FillTriangle(framebuffer, triangle, edges, depthTest,
+        [&](int x, int y, const _sr_impl::FragmentBlock& block, Uint32 mask, int count, gfx::Color* out)
         {
-            if ((w0 | w1 | w2) >= 0)
+            sr::FragmentSpan span;
+            SetupFragmentSpan(span, image, x, y, block, mask, count);
+            span.sampler = &sampler, span.lod = lod;
+
+            for (int i = 0; i < count; i++)
             {
-                const Uint32 xyOffset = yOffset + x;
-                const float invSum = 1.0f / (w0 + w1 + w2);
-                const float aW0 = w0 * invSum, aW1 = w1 * invSum, aW2 = w2 * invSum;
+                span.texCoords[i] = v0.texcoord * block.aW0[i] + v1.texcoord * block.aW1[i] + v2.texcoord * block.aW2[i];
+                span.fragNormals[i] = math::Vec3(0, 0, 1);
+            }
 
-                if (!depthTest || framebuffer.SetDepthUnsafe(xyOffset, v0.position.z * aW0 + v1.position.z * aW1 + v2.position.z * aW2))
-                {
-                    const Uint32 byteOffset = xyOffset * framebuffer.GetBytesPerPixel();
+            shader->Fragment(span, out);
+        });
+}
 
-                    gfx::Color out = shader->Fragment(math::IVec2(x, y),
-                        { 0, 0, 1 }, nColV0 * aW0 + nColV1 * aW1 + nColV2 * aW2);
+void sr::Pipeline::RasterizeTriangleColor3D(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, sr::Shader* shader, bool depthTest, const _sr_impl::RasterBounds& bounds)
+{
+    // Fixed-point edge functions and constants used by the kernels to interpolate the depth and the normalized colors
+    TriangleEdges edges;
+    _sr_impl::TriangleSetup triangle;
 
-                    if (out.a && out.a != 255)
-                    {
-                        const gfx::Color dst = framebuffer.GetPixelUnsafe(byteOffset);
-                        const Uint16 alpha = static_cast<Uint16>(out.a) + 1;
-                        const Uint16 invAlpha = 256 - alpha;
-
-                        out.a = static_cast<Uint8>((alpha * 256 + dst.a * invAlpha) >> 8);
-                        out.r = static_cast<Uint8>((out.r * alpha + dst.r * invAlpha) >> 8);
-                        out.g = static_cast<Uint8>((out.g * alpha + dst.g * invAlpha) >> 8);
-                        out.b = static_cast<Uint8>((out.b * alpha + dst.b * invAlpha) >> 8);
-                    }
+    if (!SetupTriangle(edges, triangle, v0, v1, v2, bounds, framebuffer.GetDepthFormat(), framebuffer.GetSampleCount() > 1)) return;
 
-                    if (out.a)
-                    {
-                        framebuffer.SetPixelUnsafe(byteOffset, out);
-                    }
-                }
+    // Fill the triangle by blocks of pixels, the default shader being inlined and the others called once per row
+    // The default shader returns the interpolated colors as they are, the normals are not needed
+    if (IsDefaultShader(shader))
+    {
+        FillTriangle(framebuffer, triangle, edges, depthTest,
+            [](int, int, const _sr_impl::FragmentBlock& block, Uint32, int count, gfx::Color* out)
+            {
+                std::copy_n(block.colors, count, out);
+            });
+
+        return;
+    }
+
+    FillTriangle(framebuffer, triangle, edges, depthTest,
+        [&](int x, int y, const _sr_impl::FragmentBlock& block, Uint32 mask, int count, gfx::Color* out)
+        {
+            sr::FragmentSpan span;
+            SetupFragmentSpan(span, nullptr, x, y, block, mask, count);
+
+            for (int i = 0; i < count; i++)
+            {
+                span.fragNormals[i] = v0.normal * block.aW0[i] + v1.normal * block.aW1[i] + v2.normal * block.aW2[i];
             }
 
-            w0 += sW0.x, w1 += sW1.x, w2 += sW2.x;
-        }
+            shader->Fragment(span, out);
+        });
+}
+
+void sr::Pipeline::RasterizeTriangleImage3D(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, sr::Shader* shader, const gfx::Surface* image, const TextureSampler& sampler, bool depthTest, const _sr_impl::RasterBounds& bounds)
+{
+    // Fixed-point edge functions and constants used by the kernels to interpolate the depth and the normalized colors
+    TriangleEdges edges;
+    _sr_impl::TriangleSetup triangle;
+
+    if (!SetupTriangle(edges, triangle, v0, v1, v2, bounds, framebuffer.GetDepthFormat(), framebuffer.GetSampleCount() > 1)) return;
+
+    // Texture coordinates of a pixel of a block, the weights given by the kernels being perspective corrected
+    const auto texCoord = [&](const _sr_impl::FragmentBlock& block, int i) -> math::Vec2
+    {
+        return v0.texcoord * block.aW0[i] + v1.texcoord * block.aW1[i] + v2.texcoord * block.aW2[i];
+    };
 
-        w0Row += sW0.y, w1Row += sW1.y, w2Row += sW2.y;
+    // Mipmap level of the triangle, from the ratio between its area in the texture and on screen
+    const float lod = sampler.ComputeLod(image, v0.texcoord, v1.texcoord, v2.texcoord,
+        { v0.position.x, v0.position.y }, { v1.position.x, v1.position.y }, { v2.position.x, v2.position.y });
+
+    // Fill the triangle by blocks of pixels, the default shader being inlined and the others called once per row
+    // The default shader modulates the texels by the interpolated colors, the normals are not needed
+    if (IsDefaultShader(shader))
+    {
+        FillTriangle(framebuffer, triangle, edges, depthTest,
+            [&](int, int, const _sr_impl::FragmentBlock& block, Uint32 mask, int count, gfx::Color* out)
+            {
+                for (int i = 0; i < count; i++)
+                {
+                    if (mask & (1u << i)) out[i] = sampler.Sample(image, texCoord(block, i), lod) * block.colors[i];
+                }
+            });
+
+        return;
     }
+
+    FillTriangle(framebuffer, triangle, edges, depthTest,
+        [&](int x, int y, const _sr_impl::FragmentBlock& block, Uint32 mask, int count, gfx::Color* out)
+        {
+            sr::FragmentSpan span;
+            SetupFragmentSpan(span, image, x, y, block, mask, count);
+            span.sampler = &sampler, span.lod = lod;
+
+            for (int i = 0; i < count; i++)
+            {
+                if (!(mask & (1u << i))) continue;
+                span.texCoords[i] = texCoord(block, i);
+                span.fragNormals[i] = v0.normal * block.aW0[i] + v1.normal * block.aW1[i] + v2.normal * block.aW2[i];
+            }
+
+            shader->Fragment(span, out);
+        });
 }
 
-void sr::Pipeline::RasterizeTriangleImage2D(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, sr::Shader* shader, const gfx::Surface* image, bool depthTest, const shape2D::Rectangle& viewport)
+void sr::Pipeline::RasterizePrimitive(Framebuffer& framebuffer, const _sr_impl::Primitive& primitive, const _sr_impl::RasterBounds& bounds)
 {
-    // Get integer 2D position coordinates
-    const math::Vector2<int> iV0(v0.position.x, v0.position.y);
-    const math::Vector2<int> iV1(v1.position.x, v1.position.y);
-    const math::Vector2<int> iV2(v2.position.x, v2.position.y);
+    const auto &v = primitive.vertices;
+
+    switch (primitive.type)
+    {
+        case _sr_impl::Primitive::Type::Line:
+            RasterizeLine(framebuffer, v[0], v[1], primitive.depthTest, bounds);
+            break;
 
-    // Check if vertices are in clockwise order or degenerate, in which case the triangle cannot be rendered
-    if ((iV1.x - iV0.x) * (iV2.y - iV0.y) - (iV2.x - iV0.x) * (iV1.y - iV0.y) >= 0.0f) return;
+        case _sr_impl::Primitive::Type::TriangleColor2D:
+            RasterizeTriangleColor2D(framebuffer, v[0], v[1], v[2], primitive.shader, primitive.depthTest, primitive.viewport, bounds);
+            break;
 
-    // Calculate the 2D bounding box of the triangle clamped to the viewport dimensions
-    const math::Vector2<Uint16> min = iV0.Min(iV1.Min(iV2)).Clamp(
-        viewport.GetPosition(), viewport.GetSize());
+        case _sr_impl::Primitive::Type::TriangleImage2D:
+            RasterizeTriangleImage2D(framebuffer, v[0], v[1], v[2], primitive.shader, primitive.image, primitive.sampler, primitive.depthTest, primitive.viewport, bounds);
+            break;
 
-    const math::Vector2<Uint16> max = iV0.Max(iV1.Max(iV2)).Clamp(
-        viewport.GetPosition(), viewport.GetSize());
+        case _sr_impl::Primitive::Type::TriangleColor3D:
+            RasterizeTriangleColor3D(framebuffer, v[0], v[1], v[2], primitive.shader, primitive.depthTest, bounds);
+            break;
 
-    // If triangle is entirely outside the viewport we can stop now
-    if (min == max) return;
+        case _sr_impl::Primitive::Type::TriangleImage3D:
+            RasterizeTriangleImage3D(framebuffer, v[0], v[1], v[2], primitive.shader, primitive.image, primitive.sampler, primitive.depthTest, bounds);
+            break;
+    }
+}
 
-    // Calculate original edge weights relative to bounds.min
-    // Will be used to obtain barycentric coordinates by incrementing then averaging them
-    int w0Row = (min.x - iV1.x) * (iV2.y - iV1.y) - (iV2.x - iV1.x) * (min.y - iV1.y);
-    int w1Row = (min.x - iV2.x) * (iV0.y - iV2.y) - (iV0.x - iV2.x) * (min.y - iV2.y);
-    int w2Row = (min.x - iV0.x) * (iV1.y - iV0.y) - (iV1.x - iV0.x) * (min.y - iV0.y);
 
-    // Calculate weight increment steps for each edge
-    const math::IVec2 sW0(iV2.y - iV1.y, iV1.x - iV2.x);
-    const math::IVec2 sW1(iV0.y - iV2.y, iV2.x - iV0.x);
-    const math::IVec2 sW2(iV1.y - iV0.y, iV0.x - iV1.x);
+/* Private Implementation Pipeline (Submission) */
 
-    // Normalize colors for barycentric interpolation
-    const math::Vec4 nColV0 = v0.color.Normalized();
-    const math::Vec4 nColV1 = v1.color.Normalized();
-    const math::Vec4 nColV2 = v2.color.Normalized();
+bool sr::Pipeline::ClipTriangle(size_t i0, size_t i1, size_t i2, const shape2D::Rectangle& viewport, bool faceCulling, CullMode cullMode,
+                                std::array<_sr_impl::Vertex, 12>& polygon, Uint8& vertexCounter, bool& frontFacing, bool& is2D, PipelineStats& counters) const
+{
+    const math::Vec4 &p0 = projected[i0], &p1 = projected[i1], &p2 = projected[i2];
+
+    // The sign of the determinant of the homogeneous (x, y, w) coordinates gives the facing of the triangle,
+    // it is valid before clipping, including for the triangles crossing the plane of the eye
+    const float det = p0.x * (p1.y * p2.w - p2.y * p1.w)
+                    - p1.x * (p0.y * p2.w - p2.y * p0.w)
+                    + p2.x * (p0.y * p1.w - p1.y * p0.w);
 
-    // Fill the triangle with either color or image based on the provided parameters
-    for (Uint16 y = min.y; y <= max.y; y++)
+    frontFacing = det > 0;
+
+    if (det == 0 || (faceCulling && frontFacing == (cullMode == CullMode::FaceFront)))
     {
-        const Uint32 yOffset = y * framebuffer.GetWidth();
-        int w0 = w0Row, w1 = w1Row, w2 = w2Row;
+        counters.trianglesCulled++;
+        return false;
+    }
 
-        for (Uint16 x = min.x; x <= max.x; x++)
-        {
-            if ((w0 | w1 | w2) >= 0)
-            {
-                const Uint32 xyOffset = yOffset + x;
-                const float invSum = 1.0f / (w0 + w1 + w2);
-                const float aW0 = w0 * invSum, aW1 = w1 * invSum, aW2 = w2 * invSum;
+    vertexCounter = 3;
 
-                if (!depthTest || framebuffer.SetDepthUnsafe(xyOffset, v0.position.z * aW0 + v1.position.z * aW1 + v2.position.z * aW2))
-                {
-                    const Uint32 byteOffset = xyOffset * framebuffer.GetBytesPerPixel();
+    polygon[0] = _sr_impl::Vertex{ p0, batch.normals[i0], batch.texcoords[i0], batch.colors[i0] };
+    polygon[1] = _sr_impl::Vertex{ p1, batch.normals[i1], batch.texcoords[i1], batch.colors[i1] };
+    polygon[2] = _sr_impl::Vertex{ p2, batch.normals[i2], batch.texcoords[i2], batch.colors[i2] };
 
-                    gfx::Color out = shader->Fragment(image, math::IVec2(x, y),
-                        v0.texcoord * aW0 + v1.texcoord * aW1 + v2.texcoord * aW2,
-                        { 0, 0, 1 }, nColV0 * aW0 + nColV1 * aW1 + nColV2 * aW2);
+    ClipAndProjectTriangle(polygon, vertexCounter, viewport, is2D, counters);
 
-                    if (out.a && out.a != 255)
-                    {
-                        const gfx::Color dst = framebuffer.GetPixelUnsafe(byteOffset);
-                        const Uint16 alpha = static_cast<Uint16>(out.a) + 1;
-                        const Uint16 invAlpha = 256 - alpha;
-
-                        out.a = static_cast<Uint8>((alpha * 256 + dst.a * invAlpha) >> 8);
-                        out.r = static_cast<Uint8>((out.r * alpha + dst.r * invAlpha) >> 8);
-                        out.g = static_cast<Uint8>((out.g * alpha + dst.g * invAlpha) >> 8);
-                        out.b = static_cast<Uint8>((out.b * alpha + dst.b * invAlpha) >> 8);
-                    }
+    return vertexCounter >= 3;
+}
 
-                    if (out.a)
-                    {
-                        framebuffer.SetPixelUnsafe(byteOffset, out);
-                    }
-                }
-            }
+void sr::Pipeline::SubmitPolygon(Framebuffer& framebuffer, const _sr_impl::Vertex* polygon, Uint8 vertexCounter, bool frontFacing, bool is2D, const shape2D::Rectangle& viewport, Shader* shader, const gfx::Surface* image, const TextureSampler& sampler, bool depthTest, bool occlusionCulling)
+{
+    if (occlusionCulling && depthTest && !is2D)
+    {
+        float xMin = polygon[0].position.x, xMax = xMin;
+        float yMin = polygon[0].position.y, yMax = yMin;
+        float zMin = polygon[0].position.z, zMax = zMin;
+
+        for (int i = 0; i < vertexCounter; i++)
+        {
+            const math::Vec4 &p = polygon[i].position;
+            xMin = std::min(xMin, p.x), xMax = std::max(xMax, p.x);
+            yMin = std::min(yMin, p.y), yMax = std::max(yMax, p.y);
+            zMin = std::min(zMin, p.z), zMax = std::max(zMax, p.z);
+        }
+
+        const int x0 = static_cast<int>(xMin), y0 = static_cast<int>(yMin);
+        const int x1 = static_cast<int>(xMax), y1 = static_cast<int>(yMax);
+
+        const bool reversed = framebuffer.GetDepthFormat() == sr::DepthFormat::ReversedFloat32;
 
-            w0 += sW0.x, w1 += sW1.x, w2 += sW2.x;
+        if (framebuffer.IsOccluded(x0, y0, x1, y1, ConservativeDepth(zMin, zMax, reversed)))
+        {
+            stats.trianglesOccluded++;
+            return;
         }
+    }
 
-        w0Row += sW0.y, w1Row += sW1.y, w2Row += sW2.y;
+    for (Sint8 i = 0; i < vertexCounter - 2; i++)
+    {
+        // Front faces are counter-clockwise on screen, as expected by the rasterizers
+        if (frontFacing) SubmitTriangle(framebuffer, polygon[0], polygon[i + 1], polygon[i + 2], shader, image, sampler, depthTest, viewport, is2D);
+        else SubmitTriangle(framebuffer, polygon[0], polygon[i + 2], polygon[i + 1], shader, image, sampler, depthTest, viewport, is2D);
     }
 }
 
-void sr::Pipeline::RasterizeTriangleColor3D(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, sr::Shader* shader, bool depthTest)
+void sr::Pipeline::ProcessTriangle(Framebuffer& framebuffer, size_t i0, size_t i1, size_t i2, const shape2D::Rectangle& viewport, Shader* shader, const gfx::Surface* image, const TextureSampler& sampler, bool depthTest, bool faceCulling, CullMode cullMode, bool occlusionCulling)
 {
-    // Get integer 2D position coordinates
-    const math::Vector2<Uint16> iV0(v0.position.x, v0.position.y);
-    const math::Vector2<Uint16> iV1(v1.position.x, v1.position.y);
-    const math::Vector2<Uint16> iV2(v2.position.x, v2.position.y);
+    std::array<_sr_impl::Vertex, 12> polygon;
+    Uint8 vertexCounter = 0;
+    bool frontFacing = false, is2D = false;
 
-    // Check if vertices are in clockwise order or degenerate, in which case the triangle cannot be rendered
-    if ((iV1.x - iV0.x) * (iV2.y - iV0.y) - (iV2.x - iV0.x) * (iV1.y - iV0.y) >= 0.0f) return;
-
-    // Calculate the 2D bounding box of the triangle
-    const math::Vector2<Uint16> min = iV0.Min(iV1.Min(iV2));
-    const math::Vector2<Uint16> max = iV0.Max(iV1.Max(iV2));
+    if (ClipTriangle(i0, i1, i2, viewport, faceCulling, cullMode, polygon, vertexCounter, frontFacing, is2D, stats))
+    {
+        SubmitPolygon(framebuffer, polygon.data(), vertexCounter, frontFacing, is2D, viewport, shader, image, sampler, depthTest, occlusionCulling);
+    }
+}
 
-    // Calculate original edge weights relative to bounds.min
-    // Will be used to obtain barycentric coordinates by incrementing then averaging them
-    int w0Row = (min.x - iV1.x) * (iV2.y - iV1.y) - (iV2.x - iV1.x) * (min.y - iV1.y);
-    int w1Row = (min.x - iV2.x) * (iV0.y - iV2.y) - (iV0.x - iV2.x) * (min.y - iV2.y);
-    int w2Row = (min.x - iV0.x) * (iV1.y - iV0.y) - (iV1.x - iV0.x) * (min.y - iV0.y);
+void sr::Pipeline::ProcessTrianglesParallel(Framebuffer& framebuffer, size_t numTriangles, bool indexed, const shape2D::Rectangle& viewport, Shader* shader, const gfx::Surface* image, const TextureSampler& sampler, bool depthTest, bool faceCulling, CullMode cullMode, bool occlusionCulling)
+{
+    const size_t numChunks = (numTriangles + TriangleChunkSize - 1) / TriangleChunkSize;
 
-    // Calculate weight increment steps for each edge
-    const math::IVec2 sW0(iV2.y - iV1.y, iV1.x - iV2.x);
-    const math::IVec2 sW1(iV0.y - iV2.y, iV2.x - iV0.x);
-    const math::IVec2 sW2(iV1.y - iV0.y, iV0.x - iV1.x);
+    // Chunks keep their buffers from one batch to the next
+    if (clippedChunks.size() < numChunks) clippedChunks.resize(numChunks);
+    chunkStats.assign(numChunks, PipelineStats());
 
-    // Normalize colors for barycentric interpolation
-    const math::Vec4 nColV0 = v0.color.Normalized();
-    const math::Vec4 nColV1 = v1.color.Normalized();
-    const math::Vec4 nColV2 = v2.color.Normalized();
+    const auto vertex = [&](size_t i) -> size_t
+    {
+        return indexed ? batch.indices[i] : i;
+    };
 
-    // Fill the triangle with either color or image based on the provided parameters
-    for (Uint16 y = min.y; y <= max.y; y++)
+    const auto clipChunk = [&](size_t c)
     {
-        const Uint32 yOffset = y * framebuffer.GetWidth();
-        int w0 = w0Row, w1 = w1Row, w2 = w2Row;
+        _sr_impl::ClippedChunk &chunk = clippedChunks[c];
+        chunk.vertices.clear();
+        chunk.polygons.clear();
+
+        std::array<_sr_impl::Vertex, 12> polygon;
 
-        for (Uint16 x = min.x; x <= max.x; x++)
+        for (size_t t = c * TriangleChunkSize; t < std::min(numTriangles, (c + 1) * TriangleChunkSize); t++)
         {
-            if ((w0 | w1 | w2) >= 0)
+            size_t i0, i1, i2;
+
+            if (mode == DrawMode::Quads)
+            {
+                // The quad (0, 1, 2, 3) is split into the triangles (0, 1, 2) and (0, 2, 3)
+                const size_t first = (t / 2) * 4;
+                i0 = vertex(first), i1 = vertex(first + 1 + (t & 1)), i2 = vertex(first + 2 + (t & 1));
+            }
+            else
             {
-                const Uint32 xyOffset = yOffset + x;
-                const float invSum = 1.0f / (w0 + w1 + w2);
-                const float aW0 = w0 * invSum, aW1 = w1 * invSum, aW2 = w2 * invSum;
+                i0 = vertex(t * 3), i1 = vertex(t * 3 + 1), i2 = vertex(t * 3 + 2);
+            }
 
-                if (!depthTest || framebuffer.SetDepthUnsafe(xyOffset, v0.position.z * aW0 + v1.position.z * aW1 + v2.position.z * aW2))
-                {
-                    const Uint32 byteOffset = xyOffset * framebuffer.GetBytesPerPixel();
+            Uint8 vertexCounter = 0;
+            bool frontFacing = false, is2D = false;
 
-                    gfx::Color out = shader->Fragment(math::IVec2(x, y),
-                        v0.normal * aW0 + v1.normal * aW1 + v2.normal * aW2,
-                        nColV0 * aW0 + nColV1 * aW1 + nColV2 * aW2);
+            if (ClipTriangle(i0, i1, i2, viewport, faceCulling, cullMode, polygon, vertexCounter, frontFacing, is2D, chunkStats[c]))
+            {
+                chunk.polygons.push_back({ static_cast<Uint32>(chunk.vertices.size()), vertexCounter, frontFacing, is2D });
+                chunk.vertices.insert(chunk.vertices.end(), polygon.begin(), polygon.begin() + vertexCounter);
+            }
+        }
+    };
 
-                    if (out.a && out.a != 255)
-                    {
-                        const gfx::Color dst = framebuffer.GetPixelUnsafe(byteOffset);
-                        const Uint16 alpha = static_cast<Uint16>(out.a) + 1;
-                        const Uint16 invAlpha = 256 - alpha;
-
-                        out.a = static_cast<Uint8>((alpha * 256 + dst.a * invAlpha) >> 8);
-                        out.r = static_cast<Uint8>((out.r * alpha + dst.r * invAlpha) >> 8);
-                        out.g = static_cast<Uint8>((out.g * alpha + dst.g * invAlpha) >> 8);
-                        out.b = static_cast<Uint8>((out.b * alpha + dst.b * invAlpha) >> 8);
-                    }
+    vertexWorkers->ParallelFor(numChunks, clipChunk);
 
-                    if (out.a)
-                    {
-                        framebuffer.SetPixelUnsafe(byteOffset, out);
-                    }
-                }
-            }
+    // Occlusion culling and the rasterizers (or the binning) see the triangles in the order of the batch
+    for (size_t c = 0; c < numChunks; c++)
+    {
+        const _sr_impl::ClippedChunk &chunk = clippedChunks[c];
+        stats += chunkStats[c];
 
-            w0 += sW0.x, w1 += sW1.x, w2 += sW2.x;
+        for (const _sr_impl::ClippedPolygon &polygon : chunk.polygons)
+        {
+            SubmitPolygon(framebuffer, chunk.vertices.data() + polygon.first, polygon.count, polygon.frontFacing, polygon.is2D, viewport, shader, image, sampler, depthTest, occlusionCulling);
         }
+    }
+}
 
-        w0Row += sW0.y, w1Row += sW1.y, w2Row += sW2.y;
+void sr::Pipeline::SubmitLine(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, Shader* shader, bool depthTest)
+{
+    if (!deferred)
+    {
+        RasterizeLine(framebuffer, v0, v1, depthTest, { 0, 0, framebuffer.GetWidth() - 1, framebuffer.GetHeight() - 1 });
+        return;
     }
+
+    // NOTE: The rasterized 'y' (or 'x') can drift by one pixel from
+    //       the truncated end points, the area takes it into account
+    const int xMin = std::min(v0.position.x, v1.position.x), xMax = std::max(v0.position.x, v1.position.x);
+    const int yMin = std::min(v0.position.y, v1.position.y), yMax = std::max(v0.position.y, v1.position.y);
+
+    RecordPrimitive(framebuffer, { { v0, v1, v1 }, {}, shader, nullptr, {}, _sr_impl::Primitive::Type::Line, depthTest },
+        { xMin - 1, yMin - 1, xMax + 1, yMax + 1 });
 }
 
-void sr::Pipeline::RasterizeTriangleImage3D(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, sr::Shader* shader, const gfx::Surface* image, bool depthTest)
+void sr::Pipeline::SubmitTriangle(Framebuffer& framebuffer, const _sr_impl::Vertex& v0, const _sr_impl::Vertex& v1, const _sr_impl::Vertex& v2, Shader* shader, const gfx::Surface* image, const TextureSampler& sampler, bool depthTest, const shape2D::Rectangle& viewport, bool is2D)
 {
-    // Get integer 2D position coordinates
-    const math::Vector2<Uint16> iV0(v0.position.x, v0.position.y);
-    const math::Vector2<Uint16> iV1(v1.position.x, v1.position.y);
-    const math::Vector2<Uint16> iV2(v2.position.x, v2.position.y);
+    if (!deferred)
+    {
+        const _sr_impl::RasterBounds bounds = { 0, 0, framebuffer.GetWidth() - 1, framebuffer.GetHeight() - 1 };
+
+        if (!image)
+        {
+            if (is2D) RasterizeTriangleColor2D(framebuffer, v0, v1, v2, shader, depthTest, viewport, bounds);
+            else RasterizeTriangleColor3D(framebuffer, v0, v1, v2, shader, depthTest, bounds);
+        }
+        else
+        {
+            if (is2D) RasterizeTriangleImage2D(framebuffer, v0, v1, v2, shader, image, sampler, depthTest, viewport, bounds);
+            else RasterizeTriangleImage3D(framebuffer, v0, v1, v2, shader, image, sampler, depthTest, bounds);
+        }
+
+        stats += TakeThreadStats();
 
-    // Check if vertices are in clockwise order or degenerate, in which case the triangle cannot be rendered
-    if ((iV1.x - iV0.x) * (iV2.y - iV0.y) - (iV2.x - iV0.x) * (iV1.y - iV0.y) >= 0.0f) return;
+        return;
+    }
 
-    // Calculate the 2D bounding box of the triangle
-    const math::Vector2<Uint16> min = iV0.Min(iV1.Min(iV2));
-    const math::Vector2<Uint16> max = iV0.Max(iV1.Max(iV2));
+    using Type = _sr_impl::Primitive::Type;
 
-    // Calculate original edge weights relative to bounds.min
-    // Will be used to obtain barycentric coordinates by incrementing then averaging them
-    int w0Row = (min.x - iV1.x) * (iV2.y - iV1.y) - (iV2.x - iV1.x) * (min.y - iV1.y);
-    int w1Row = (min.x - iV2.x) * (iV0.y - iV2.y) - (iV0.x - iV2.x) * (min.y - iV2.y);
-    int w2Row = (min.x - iV0.x) * (iV1.y - iV0.y) - (iV1.x - iV0.x) * (min.y - iV0.y);
+    const Type type = is2D ? (image ? Type::TriangleImage2D : Type::TriangleColor2D)
+                           : (image ? Type::TriangleImage3D : Type::TriangleColor3D);
 
-    // Calculate weight increment steps for each edge
-    const math::IVec2 sW0(iV2.y - iV1.y, iV1.x - iV2.x);
-    const math::IVec2 sW1(iV0.y - iV2.y, iV2.x - iV0.x);
-    const math::IVec2 sW2(iV1.y - iV0.y, iV0.x - iV1.x);
+    const int xMin = std::min({ v0.position.x, v1.position.x, v2.position.x });
+    const int yMin = std::min({ v0.position.y, v1.position.y, v2.position.y });
+    const int xMax = std::max({ v0.position.x, v1.position.x, v2.position.x });
+    const int yMax = std::max({ v0.position.y, v1.position.y, v2.position.y });
 
-    // Normalize colors for barycentric interpolation
-    const math::Vec4 nColV0 = v0.color.Normalized();
-    const math::Vec4 nColV1 = v1.color.Normalized();
-    const math::Vec4 nColV2 = v2.color.Normalized();
+    RecordPrimitive(framebuffer, { { v0, v1, v2 }, viewport, shader, image, sampler, type, depthTest },
+        { xMin, yMin, xMax, yMax });
+}
 
-    // Fill the triangle with either color or image based on the provided parameters
-    for (Uint16 y = min.y; y <= max.y; y++)
+void sr::Pipeline::RecordPrimitive(Framebuffer& framebuffer, _sr_impl::Primitive&& primitive, _sr_impl::RasterBounds area)
+{
+    // Tiles are laid out over a single framebuffer, switching target requires a flush
+    if (binnedFramebuffer != &framebuffer)
     {
-        const Uint32 yOffset = y * framebuffer.GetWidth();
-        int w0 = w0Row, w1 = w1Row, w2 = w2Row;
+        Flush();
 
-        for (Uint16 x = min.x; x <= max.x; x++)
-        {
-            if ((w0 | w1 | w2) >= 0)
-            {
-                const Uint32 xyOffset = yOffset + x;
-                const float invSum = 1.0f / (w0 + w1 + w2);
-                const float aW0 = w0 * invSum, aW1 = w1 * invSum, aW2 = w2 * invSum;
-                const float z = v0.position.z * aW0 + v1.position.z * aW1 + v2.position.z * aW2;
+        binnedFramebuffer = &framebuffer;
+        tilesX = (framebuffer.GetWidth() + TileSize - 1) / TileSize;
+        tilesY = (framebuffer.GetHeight() + TileSize - 1) / TileSize;
+        tileBins.resize(tilesX * tilesY);
+    }
 
-                if (!depthTest || framebuffer.SetDepthUnsafe(xyOffset, z))
-                {
-                    const Uint32 byteOffset = xyOffset * framebuffer.GetBytesPerPixel();
+    area.xMin = std::max(area.xMin, 0);
+    area.yMin = std::max(area.yMin, 0);
+    area.xMax = std::min(area.xMax, framebuffer.GetWidth() - 1);
+    area.yMax = std::min(area.yMax, framebuffer.GetHeight() - 1);
 
-                    const math::Vec2 correctPerspectiveUV = (
-                        v0.texcoord / v0.position.z * aW0 +
-                        v1.texcoord / v1.position.z * aW1 +
-                        v2.texcoord / v0.position.z * aW2
-                    ) * (1.0f / z);
+    if (area.xMin > area.xMax || area.yMin > area.yMax) return;
 
-                    gfx::Color out = shader->Fragment(image,
-                        math::IVec2(x, y), correctPerspectiveUV,
-                        v0.normal * aW0 + v1.normal * aW1 + v2.normal * aW2,
-                        nColV0 * aW0 + nColV1 * aW1 + nColV2 * aW2);
+    // The image may be a temporary object (eg. TargetTexture::Draw),
+    // so we keep our own non-owning view of its SDL surface
+    if (primitive.image)
+    {
+        if (images.empty() || images.back().Get() != primitive.image->Get())
+        {
+            images.emplace_back(primitive.image->Get(), false);
+        }
 
-                    if (out.a && out.a != 255)
-                    {
-                        const gfx::Color dst = framebuffer.GetPixelUnsafe(byteOffset);
-                        const Uint16 alpha = static_cast<Uint16>(out.a) + 1;
-                        const Uint16 invAlpha = 256 - alpha;
-
-                        out.a = static_cast<Uint8>((alpha * 256 + dst.a * invAlpha) >> 8);
-                        out.r = static_cast<Uint8>((out.r * alpha + dst.r * invAlpha) >> 8);
-                        out.g = static_cast<Uint8>((out.g * alpha + dst.g * invAlpha) >> 8);
-                        out.b = static_cast<Uint8>((out.b * alpha + dst.b * invAlpha) >> 8);
-                    }
+        primitive.image = &images.back();
+    }
 
-                    if (out.a)
-                    {
-                        framebuffer.SetPixelUnsafe(byteOffset, out);
-                    }
-                }
-            }
+    const Uint32 index = primitives.size();
+    primitives.push_back(std::move(primitive));
 
-            w0 += sW0.x, w1 += sW1.x, w2 += sW2.x;
+    for (int ty = area.yMin / TileSize; ty <= area.yMax / TileSize; ty++)
+    {
+        for (int tx = area.xMin / TileSize; tx <= area.xMax / TileSize; tx++)
+        {
+            tileBins[ty * tilesX + tx].push_back(index);
         }
-
-        w0Row += sW0.y, w1Row += sW1.y, w2Row += sW2.y;
     }
 }
 
+
 /* Public Implementation Pipeline */
 
 void sr::Pipeline::Reset()
 {
-    vertexCounter = 0;
+    batch.Clear();
 }
 
-bool sr::Pipeline::AddVertex(DrawMode mode, const math::Vec3& position, const math::Vec3& normal, const math::Vec2& texcoord, const gfx::Color& color)
+void sr::Pipeline::SetDrawMode(DrawMode mode)
 {
-    if (mode != this->mode)
+    // NOTE: Nothing can be rendered from here (no framebuffer nor matrices), so the pending
+    //       vertices can neither be flushed nor silently dropped, the caller has to render them first
+    if (mode != this->mode && batch.GetSize() > 0)
     {
-        this->mode = mode;
-        this->Reset();
+        throw core::NexusException("sr::Pipeline::SetDrawMode", "The draw mode cannot change while vertices are pending in the batch");
     }
 
-    vertices[vertexCounter++] = {
-        position, normal, texcoord, color
+    this->mode = mode;
+}
+
+void sr::Pipeline::Reserve(size_t count)
+{
+    batch.Reserve(batch.GetSize() + count);
+}
+
+bool sr::Pipeline::AddVertex(DrawMode mode, const math::Vec3& position, const math::Vec3& normal, const math::Vec2& texcoord, const gfx::Color& color)
+{
+    this->SetDrawMode(mode);
+
+    batch.Push(position, normal, texcoord, color);
+
+    return batch.GetSize() % static_cast<int>(mode) == 0;
+}
+
+void sr::Pipeline::SetIndices(const Uint16* indices, size_t count)
+{
+    batch.indices.assign(indices, indices + count);
+}
+
+void sr::Pipeline::AddVertices(DrawMode mode, size_t count, const math::Vec3* positions, const math::Vec3* normals, const math::Vec2* texcoords, const gfx::Color* colors, const gfx::Color& tint, const math::Mat4& transform)
+{
+    this->SetDrawMode(mode);
+
+    const size_t first = batch.GetSize();
+    batch.Resize(first + count);
+
+    const auto writeChunk = [&](size_t c)
+    {
+        for (size_t i = c * VertexChunkSize; i < std::min(count, (c + 1) * VertexChunkSize); i++)
+        {
+            const math::Vec3 position = positions[i].Transformed(transform);
+
+            batch.positions[first + i] = math::Vec4(position.x, position.y, position.z, 1.0f);
+            batch.normals[first + i] = normals[i];
+            batch.texcoords[first + i] = texcoords ? texcoords[i] : math::Vec2();
+            batch.colors[first + i] = (colors ? colors[i] : gfx::White) * tint;
+        }
     };
 
-    return vertexCounter == static_cast<int>(mode);
+    const size_t numChunks = (count + VertexChunkSize - 1) / VertexChunkSize;
+
+    if (vertexWorkers) vertexWorkers->ParallelFor(numChunks, writeChunk);
+    else for (size_t c = 0; c < numChunks; c++) writeChunk(c);
 }
 
-void sr::Pipeline::ProcessAndRender(Framebuffer& framebuffer, const math::Mat4& mvp, const shape2D::Rectangle& viewport, Shader* shader, const gfx::Surface* image, bool depthTest)
+void sr::Pipeline::ProcessAndRender(Framebuffer& framebuffer, const math::Mat4& mvp, const shape2D::Rectangle& viewport, Shader* shader, const gfx::Surface* image, const TextureSampler& sampler, bool depthTest, bool faceCulling, CullMode cullMode, bool occlusionCulling)
 {
+    if (batch.GetSize() == 0)
+    {
+        return;
+    }
+
+    const bool indexed = !batch.indices.empty();
+
+    // Indexed primitives can reference any vertex of the batch, otherwise the vertices
+    // of an incomplete trailing primitive are ignored
+    const size_t numShaded = indexed ? batch.GetSize() : batch.GetSize() - batch.GetSize() % static_cast<int>(mode);
+    const size_t numVertices = indexed ? batch.indices.size() - batch.indices.size() % static_cast<int>(mode) : numShaded;
+
+    // Run the vertex shader once for each vertex of the batch, shared vertices included
+    projected.resize(numShaded);
+
+    const auto shadeChunk = [&](size_t c)
+    {
+        for (size_t i = c * VertexChunkSize; i < std::min(numShaded, (c + 1) * VertexChunkSize); i++)
+        {
+            projected[i] = shader->Vertex(mvp, batch.positions[i]);
+        }
+    };
+
+    const size_t numChunks = (numShaded + VertexChunkSize - 1) / VertexChunkSize;
+
+    if (vertexWorkers) vertexWorkers->ParallelFor(numChunks, shadeChunk);
+    else for (size_t c = 0; c < numChunks; c++) shadeChunk(c);
+
+    // Large batches of triangles are also clipped by chunks, the lines are left to the serial path
+    const size_t numTriangles = (mode == DrawMode::Quads) ? numVertices / 2 : numVertices / 3;
+
+    if (vertexWorkers && mode != DrawMode::Lines && numTriangles > TriangleChunkSize)
+    {
+        ProcessTrianglesParallel(framebuffer, numTriangles, indexed, viewport, shader, image, sampler, depthTest, faceCulling, cullMode, occlusionCulling);
+        this->Reset();
+        return;
+    }
+
+    // Index in the batch of the i-th vertex of the primitives
+    const auto vertex = [&](size_t i) -> size_t
+    {
+        return indexed ? batch.indices[i] : i;
+    };
+
     switch (mode)
     {
         case DrawMode::Lines:
         {
-            Uint8 processedCounter = 2;
-            std::array<_sr_impl::Vertex, 2> processed = { vertices[0], vertices[1] };
-            ProjectAndClipLine(processed, processedCounter, mvp, viewport, shader);
-
-            if (processedCounter == 2)
+            for (size_t i = 0; i < numVertices; i += 2)
             {
-                RasterizeLine(framebuffer, processed[0], processed[1], depthTest);
+                Uint8 processedCounter = 2;
+
+                const size_t i0 = vertex(i), i1 = vertex(i + 1);
+
+                std::array<_sr_impl::Vertex, 2> processed = {
+                    _sr_impl::Vertex{ projected[i0], batch.normals[i0], batch.texcoords[i0], batch.colors[i0] },
+                    _sr_impl::Vertex{ projected[i1], batch.normals[i1], batch.texcoords[i1], batch.colors[i1] }
+                };
+
+                ClipAndProjectLine(processed, processedCounter, viewport);
+
+                if (processedCounter == 2)
+                {
+                    SubmitLine(framebuffer, processed[0], processed[1], shader, depthTest);
+                }
             }
         }
         break;
 
         case DrawMode::Triangles:
         {
-            bool is2D = false;
-            Uint8 processedCounter = 3;
-            std::array<_sr_impl::Vertex, 12> processed = { vertices[0], vertices[1], vertices[2] };
-            ProjectAndClipTriangle(processed, processedCounter, mvp, viewport, shader, is2D);
-
-            if (!image)
-            {
-                if (is2D) for (Sint8 i = 0; i < processedCounter - 2; i++) RasterizeTriangleColor2D(framebuffer, processed[0], processed[i + 1], processed[i + 2], shader, depthTest, viewport);
-                else for (Sint8 i = 0; i < processedCounter - 2; i++) RasterizeTriangleColor3D(framebuffer, processed[0], processed[i + 1], processed[i + 2], shader, depthTest);
-            }
-            else
+            for (size_t i = 0; i < numVertices; i += 3)
             {
-                if (is2D) for (Sint8 i = 0; i < processedCounter - 2; i++) RasterizeTriangleImage2D(framebuffer, processed[0], processed[i + 1], processed[i + 2], shader, image, depthTest, viewport);
-                else for (Sint8 i = 0; i < processedCounter - 2; i++) RasterizeTriangleImage3D(framebuffer, processed[0], processed[i + 1], processed[i + 2], shader, image, depthTest);
+                ProcessTriangle(framebuffer, vertex(i), vertex(i + 1), vertex(i + 2), viewport, shader, image, sampler, depthTest, faceCulling, cullMode, occlusionCulling);
             }
         }
         break;
 
         case DrawMode::Quads:
         {
-            if (!image)
+            for (size_t i = 0; i < numVertices; i += 4)
             {
-                for (int i = 0; i < 2; i++)
-                {
-                    bool is2D = false;
-                    Uint8 processedCounter = 3;
-                    std::array<_sr_impl::Vertex, 12> processed = { vertices[0], vertices[i + 1], vertices[i + 2] };
-                    ProjectAndClipTriangle(processed, processedCounter, mvp, viewport, shader, is2D);
-
-                    if (is2D) for (Sint8 j = 0; j < processedCounter - 2; j++) RasterizeTriangleColor2D(framebuffer, processed[0], processed[j + 1], processed[j + 2], shader, depthTest, viewport);
-                    else for (Sint8 j = 0; j < processedCounter - 2; j++) RasterizeTriangleColor3D(framebuffer, processed[0], processed[j + 1], processed[j + 2], shader, depthTest);
-                }
-            }
-            else
-            {
-                for (int i = 0; i < 2; i++)
-                {
-                    bool is2D = false;
-                    Uint8 processedCounter = 3;
-                    std::array<_sr_impl::Vertex, 12> processed = { vertices[0], vertices[i + 1], vertices[i + 2] };
-                    ProjectAndClipTriangle(processed, processedCounter, mvp, viewport, shader, is2D);
-
-                    if (is2D) for (Sint8 j = 0; j < processedCounter - 2; j++) RasterizeTriangleImage2D(framebuffer, processed[0], processed[j + 1], processed[j + 2], shader, image, depthTest, viewport);
-                    else for (Sint8 j = 0; j < processedCounter - 2; j++) RasterizeTriangleImage3D(framebuffer, processed[0], processed[j + 1], processed[j + 2], shader, image, depthTest);
-                }
+                ProcessTriangle(framebuffer, vertex(i), vertex(i + 1), vertex(i + 2), viewport, shader, image, sampler, depthTest, faceCulling, cullMode, occlusionCulling);
+                ProcessTriangle(framebuffer, vertex(i), vertex(i + 2), vertex(i + 3), viewport, shader, image, sampler, depthTest, faceCulling, cullMode, occlusionCulling);
             }
         }
         break;
     }
 
-    vertexCounter = 0;
+    this->Reset();
+}
+
+bool sr::Pipeline::IsOccluded(Framebuffer& framebuffer, const math::Mat4& mvp, const shape2D::Rectangle& viewport, const shape3D::AABB& aabb) const
+{
+    float xMin = std::numeric_limits<float>::max(), xMax = std::numeric_limits<float>::lowest();
+    float yMin = std::numeric_limits<float>::max(), yMax = std::numeric_limits<float>::lowest();
+    float zMin = std::numeric_limits<float>::max(), zMax = std::numeric_limits<float>::lowest();
+
+    for (int i = 0; i < 8; i++)
+    {
+        math::Vec4 corner = mvp * math::Vec4(
+            (i & 1) ? aabb.max.x : aabb.min.x,
+            (i & 2) ? aabb.max.y : aabb.min.y,
+            (i & 4) ? aabb.max.z : aabb.min.z, 1.0f);
+
+        // The projection of boxes crossing the plane of the eye is unbounded
+        if (corner.w < ClipEpsilon) return false;
+
+        corner /= corner.w;
+        HomogeneousToScreen(corner, viewport);
+
+        xMin = std::min(xMin, corner.x), xMax = std::max(xMax, corner.x);
+        yMin = std::min(yMin, corner.y), yMax = std::max(yMax, corner.y);
+        zMin = std::min(zMin, corner.z), zMax = std::max(zMax, corner.z);
+    }
+
+    // Areas entirely outside the framebuffer are left to the frustum clipping
+    if (xMax < 0 || yMax < 0 || xMin >= framebuffer.GetWidth() || yMin >= framebuffer.GetHeight())
+    {
+        return false;
+    }
+
+    return framebuffer.IsOccluded(
+        static_cast<int>(std::max(xMin, 0.0f)), static_cast<int>(std::max(yMin, 0.0f)),
+        static_cast<int>(std::min(xMax, framebuffer.GetWidth() - 1.0f)), static_cast<int>(std::min(yMax, framebuffer.GetHeight() - 1.0f)),
+        ConservativeDepth(zMin, zMax, framebuffer.GetDepthFormat() == sr::DepthFormat::ReversedFloat32));
+}
+
+bool sr::Pipeline::CullOccludedDraw(Framebuffer& framebuffer, const math::Mat4& mvp, const shape2D::Rectangle& viewport, const shape3D::AABB& aabb)
+{
+    if (!IsOccluded(framebuffer, mvp, viewport, aabb))
+    {
+        return false;
+    }
+
+    stats.drawsOccluded++;
+    return true;
+}
+
+void sr::Pipeline::EnableDeferred(int numThreads)
+{
+    if (numThreads <= 0)
+    {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    Flush();
+
+    // NOTE: The flushing thread rasterizes tiles too, so one worker less is needed
+    workers = (numThreads > 1) ? std::make_unique<utils::ThreadPool>(numThreads - 1) : nullptr;
+    deferred = true;
+}
+
+void sr::Pipeline::DisableDeferred()
+{
+    Flush();
+
+    workers = nullptr;
+    deferred = false;
+}
+
+void sr::Pipeline::EnableParallelVertexProcessing(int numThreads)
+{
+    if (numThreads <= 0)
+    {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // NOTE: The submitting thread processes chunks too, so one worker less is needed
+    vertexWorkers = (numThreads > 1) ? std::make_unique<utils::ThreadPool>(numThreads - 1) : nullptr;
+}
+
+void sr::Pipeline::DisableParallelVertexProcessing()
+{
+    vertexWorkers = nullptr;
+    clippedChunks.clear();
+    chunkStats.clear();
+}
+
+void sr::Pipeline::Flush()
+{
+    if (primitives.empty())
+    {
+        return;
+    }
+
+    activeTiles.clear();
+
+    for (Uint32 i = 0; i < tileBins.size(); i++)
+    {
+        if (!tileBins[i].empty()) activeTiles.push_back(i);
+    }
+
+    const int width = binnedFramebuffer->GetWidth();
+    const int height = binnedFramebuffer->GetHeight();
+
+    // Each tile counts its work separately, the counters are summed once all the tiles are done
+    tileStats.assign(activeTiles.size(), PipelineStats());
+
+    const auto rasterizeTile = [&](size_t i)
+    {
+        const Uint32 tile = activeTiles[i];
+        const int x = (tile % tilesX) * TileSize;
+        const int y = (tile / tilesX) * TileSize;
+
+        const _sr_impl::RasterBounds bounds = {
+            x, y, std::min(x + TileSize, width) - 1, std::min(y + TileSize, height) - 1
+        };
+
+        for (Uint32 index : tileBins[tile])
+        {
+            RasterizePrimitive(*binnedFramebuffer, primitives[index], bounds);
+        }
+
+        tileStats[i] = TakeThreadStats();
+    };
+
+    if (workers)
+    {
+        workers->ParallelFor(activeTiles.size(), rasterizeTile);
+    }
+    else
+    {
+        for (size_t i = 0; i < activeTiles.size(); i++) rasterizeTile(i);
+    }
+
+    for (const PipelineStats& tile : tileStats)
+    {
+        stats += tile;
+    }
+
+    // Bins are cleared but keep their capacity for the next frame
+    for (Uint32 tile : activeTiles)
+    {
+        tileBins[tile].clear();
+    }
+
+    primitives.clear();
+    images.clear();
+    binnedFramebuffer = nullptr;
 }
@@ -0,0 +1,870 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+
+#include "gapi/sr/nxRasterKernels.hpp"
+#include "gapi/sr/nxDepthBuffer.hpp"
+#include "gfx/nxPixelAccess.hpp"
+
+#include <SDL_cpuinfo.h>
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#   define NEXUS_SR_SIMD_X86
+#   include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#   define NEXUS_SR_SIMD_NEON
+#   include <arm_neon.h>
+#endif
+
+// NOTE: The x86 kernels are compiled for their own instruction set only,
+//       the rest of the library keeps targeting the baseline of the platform.
+//       FMA is deliberately not enabled so that the results match the scalar path.
+#if defined(__GNUC__) || defined(__clang__)
+#   define NEXUS_SR_TARGET_SSE2 __attribute__((target("sse2")))
+#   define NEXUS_SR_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#   define NEXUS_SR_TARGET_SSE2
+#   define NEXUS_SR_TARGET_AVX2
+#endif
+
+using namespace nexus;
+
+/* Scalar Kernels (Reference) */
+
+namespace {
+
+    Uint32 ProcessBlockScalar(const _sr_impl::TriangleSetup& triangle, int w0, int w1, int w2, int count, bool covered, void* depth, _sr_impl::FragmentBlock& block)
+    {
+        Uint32 mask = 0;
+
+        for (int i = 0; i < count; i++, w0 += triangle.stepW0, w1 += triangle.stepW1, w2 += triangle.stepW2)
+        {
+            if (!covered && (w0 | w1 | w2) < 0) continue;
+
+            const float aW0 = static_cast<float>(w0 + triangle.bias0) * triangle.invArea;
+            const float aW1 = static_cast<float>(w1 + triangle.bias1) * triangle.invArea;
+            const float aW2 = static_cast<float>(w2 + triangle.bias2) * triangle.invArea;
+            const float z = triangle.z0 * aW0 + triangle.z1 * aW1 + triangle.z2 * aW2;
+
+            if (depth != nullptr && triangle.depthFormat == sr::DepthFormat::Unorm16)
+            {
+                const Uint16 key = sr::DepthBuffer::QuantizeUnorm16(z);
+                Uint16 &stored = static_cast<Uint16*>(depth)[i];
+                if (key > stored) continue;
+                stored = key;
+            }
+            else if (depth != nullptr)
+            {
+                float &stored = static_cast<float*>(depth)[i];
+                if (z > stored) continue;
+                stored = z;
+            }
+
+            float pW0 = aW0, pW1 = aW1, pW2 = aW2;
+
+            if (triangle.perspective)
+            {
+                const float q0 = aW0 * triangle.invW0, q1 = aW1 * triangle.invW1, q2 = aW2 * triangle.invW2;
+                const float w = 1.0f / (q0 + q1 + q2);
+                pW0 = q0 * w, pW1 = q1 * w, pW2 = q2 * w;
+            }
+
+            block.aW0[i] = pW0, block.aW1[i] = pW1, block.aW2[i] = pW2;
+            block.z[i] = z * triangle.zScale + triangle.zOffset;
+
+            block.colors[i] = triangle.color0 * pW0 + triangle.color1 * pW1 + triangle.color2 * pW2;
+
+            mask |= 1u << i;
+        }
+
+        return mask;
+    }
+
+    Uint32 CoverBlockScalar(const _sr_impl::TriangleSetup& triangle, int w0, int w1, int w2, int count, bool covered, void* depth)
+    {
+        Uint32 mask = 0;
+
+        for (int i = 0; i < count; i++, w0 += triangle.stepW0, w1 += triangle.stepW1, w2 += triangle.stepW2)
+        {
+            if (!covered && (w0 | w1 | w2) < 0) continue;
+
+            if (depth != nullptr)
+            {
+                const float aW0 = static_cast<float>(w0 + triangle.bias0) * triangle.invArea;
+                const float aW1 = static_cast<float>(w1 + triangle.bias1) * triangle.invArea;
+                const float aW2 = static_cast<float>(w2 + triangle.bias2) * triangle.invArea;
+                const float z = triangle.z0 * aW0 + triangle.z1 * aW1 + triangle.z2 * aW2;
+
+                if (triangle.depthFormat == sr::DepthFormat::Unorm16)
+                {
+                    const Uint16 key = sr::DepthBuffer::QuantizeUnorm16(z);
+                    Uint16 &stored = static_cast<Uint16*>(depth)[i];
+                    if (key > stored) continue;
+                    stored = key;
+                }
+                else
+                {
+                    float &stored = static_cast<float*>(depth)[i];
+                    if (z > stored) continue;
+                    stored = z;
+                }
+            }
+
+            mask |= 1u << i;
+        }
+
+        return mask;
+    }
+
+    void WriteBlockScalar(gfx::Color* dst, const gfx::Color* src, Uint32 mask, int count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if ((mask & (1u << i)) && src[i].a)
+            {
+                dst[i] = gfx::BlendPixel(dst[i], src[i]);
+            }
+        }
+    }
+
+    constexpr _sr_impl::RasterKernels KernelsScalar = { ProcessBlockScalar, CoverBlockScalar, WriteBlockScalar };
+
+}
+
+/* SSE2 Kernels */
+
+#ifdef NEXUS_SR_SIMD_X86
+
+namespace {
+
+    NEXUS_SR_TARGET_SSE2
+    Uint32 ProcessBlockSSE2(const _sr_impl::TriangleSetup& triangle, int w0, int w1, int w2, int count, bool covered, void* depth, _sr_impl::FragmentBlock& block)
+    {
+        if (count < _sr_impl::FragmentBlock::Size)
+        {
+            return ProcessBlockScalar(triangle, w0, w1, w2, count, covered, depth, block);
+        }
+
+        // SSE2 has no 32-bit integer multiplication, the lane offsets are computed once here
+        __m128i vW0 = _mm_setr_epi32(w0, w0 + triangle.stepW0, w0 + 2 * triangle.stepW0, w0 + 3 * triangle.stepW0);
+        __m128i vW1 = _mm_setr_epi32(w1, w1 + triangle.stepW1, w1 + 2 * triangle.stepW1, w1 + 3 * triangle.stepW1);
+        __m128i vW2 = _mm_setr_epi32(w2, w2 + triangle.stepW2, w2 + 2 * triangle.stepW2, w2 + 3 * triangle.stepW2);
+
+        const __m128i step0 = _mm_set1_epi32(4 * triangle.stepW0);
+        const __m128i step1 = _mm_set1_epi32(4 * triangle.stepW1);
+        const __m128i step2 = _mm_set1_epi32(4 * triangle.stepW2);
+
+        const __m128i bias0 = _mm_set1_epi32(triangle.bias0);
+        const __m128i bias1 = _mm_set1_epi32(triangle.bias1);
+        const __m128i bias2 = _mm_set1_epi32(triangle.bias2);
+        const __m128 invArea = _mm_set1_ps(triangle.invArea);
+
+        const __m128 z0 = _mm_set1_ps(triangle.z0), z1 = _mm_set1_ps(triangle.z1), z2 = _mm_set1_ps(triangle.z2);
+        const __m128 zScale = _mm_set1_ps(triangle.zScale), zOffset = _mm_set1_ps(triangle.zOffset);
+        const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), scale = _mm_set1_ps(255.0f);
+
+        Uint32 mask = 0;
+
+        for (int o = 0; o < _sr_impl::FragmentBlock::Size; o += 4)
+        {
+            const __m128i inside = covered ? _mm_set1_epi32(-1)
+                : _mm_cmpgt_epi32(_mm_or_si128(_mm_or_si128(vW0, vW1), vW2), _mm_set1_epi32(-1));
+            __m128 pass = _mm_castsi128_ps(inside);
+
+            if (_mm_movemask_ps(pass))
+            {
+                const __m128 aW0 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(vW0, bias0)), invArea);
+                const __m128 aW1 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(vW1, bias1)), invArea);
+                const __m128 aW2 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(vW2, bias2)), invArea);
+                const __m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(z0, aW0), _mm_mul_ps(z1, aW1)), _mm_mul_ps(z2, aW2));
+
+                if (depth != nullptr && triangle.depthFormat == sr::DepthFormat::Unorm16)
+                {
+                    // Keys are compared as 32-bit integers, then packed back with a signed saturation of the values shifted by 2^15
+                    Uint16 *depth16 = static_cast<Uint16*>(depth) + o;
+                    const __m128i key = _mm_cvttps_epi32(_mm_add_ps(_mm_min_ps(_mm_max_ps(z, zero), _mm_set1_ps(65535.0f)), _mm_set1_ps(0.5f)));
+                    const __m128i d = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(depth16)), _mm_setzero_si128());
+                    pass = _mm_andnot_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(key, d)), pass);
+
+                    const __m128i passMask = _mm_castps_si128(pass);
+                    const __m128i result = _mm_sub_epi32(_mm_or_si128(_mm_and_si128(passMask, key), _mm_andnot_si128(passMask, d)), _mm_set1_epi32(0x8000));
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(depth16), _mm_xor_si128(_mm_packs_epi32(result, result), _mm_set1_epi16(-0x8000)));
+                }
+                else if (depth != nullptr)
+                {
+                    float *depth32 = static_cast<float*>(depth) + o;
+                    const __m128 d = _mm_loadu_ps(depth32);
+                    pass = _mm_andnot_ps(_mm_cmpgt_ps(z, d), pass);
+                    _mm_storeu_ps(depth32, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, d)));
+                }
+
+                __m128 pW0 = aW0, pW1 = aW1, pW2 = aW2;
+
+                if (triangle.perspective)
+                {
+                    const __m128 q0 = _mm_mul_ps(aW0, _mm_set1_ps(triangle.invW0));
+                    const __m128 q1 = _mm_mul_ps(aW1, _mm_set1_ps(triangle.invW1));
+                    const __m128 q2 = _mm_mul_ps(aW2, _mm_set1_ps(triangle.invW2));
+                    const __m128 w = _mm_div_ps(one, _mm_add_ps(_mm_add_ps(q0, q1), q2));
+                    pW0 = _mm_mul_ps(q0, w), pW1 = _mm_mul_ps(q1, w), pW2 = _mm_mul_ps(q2, w);
+                }
+
+                _mm_store_ps(block.aW0 + o, pW0);
+                _mm_store_ps(block.aW1 + o, pW1);
+                _mm_store_ps(block.aW2 + o, pW2);
+                _mm_store_ps(block.z + o, _mm_add_ps(_mm_mul_ps(z, zScale), zOffset));
+
+                __m128i rgba = _mm_setzero_si128();
+
+                for (int c = 0; c < 4; c++)
+                {
+                    const __m128 v = _mm_add_ps(_mm_add_ps(
+                        _mm_mul_ps(_mm_set1_ps(triangle.color0[c]), pW0),
+                        _mm_mul_ps(_mm_set1_ps(triangle.color1[c]), pW1)),
+                        _mm_mul_ps(_mm_set1_ps(triangle.color2[c]), pW2));
+
+                    const __m128i channel = _mm_cvttps_epi32(_mm_mul_ps(scale, _mm_min_ps(_mm_max_ps(v, zero), one)));
+                    rgba = _mm_or_si128(rgba, _mm_sll_epi32(channel, _mm_cvtsi32_si128(8 * c)));
+                }
+
+                _mm_store_si128(reinterpret_cast<__m128i*>(block.colors + o), rgba);
+
+                mask |= static_cast<Uint32>(_mm_movemask_ps(pass)) << o;
+            }
+
+            vW0 = _mm_add_epi32(vW0, step0);
+            vW1 = _mm_add_epi32(vW1, step1);
+            vW2 = _mm_add_epi32(vW2, step2);
+        }
+
+        return mask;
+    }
+
+    NEXUS_SR_TARGET_SSE2
+    Uint32 CoverBlockSSE2(const _sr_impl::TriangleSetup& triangle, int w0, int w1, int w2, int count, bool covered, void* depth)
+    {
+        if (count < _sr_impl::FragmentBlock::Size)
+        {
+            return CoverBlockScalar(triangle, w0, w1, w2, count, covered, depth);
+        }
+
+        __m128i vW0 = _mm_setr_epi32(w0, w0 + triangle.stepW0, w0 + 2 * triangle.stepW0, w0 + 3 * triangle.stepW0);
+        __m128i vW1 = _mm_setr_epi32(w1, w1 + triangle.stepW1, w1 + 2 * triangle.stepW1, w1 + 3 * triangle.stepW1);
+        __m128i vW2 = _mm_setr_epi32(w2, w2 + triangle.stepW2, w2 + 2 * triangle.stepW2, w2 + 3 * triangle.stepW2);
+
+        const __m128i step0 = _mm_set1_epi32(4 * triangle.stepW0);
+        const __m128i step1 = _mm_set1_epi32(4 * triangle.stepW1);
+        const __m128i step2 = _mm_set1_epi32(4 * triangle.stepW2);
+
+        const __m128 invArea = _mm_set1_ps(triangle.invArea);
+        const __m128 z0 = _mm_set1_ps(triangle.z0), z1 = _mm_set1_ps(triangle.z1), z2 = _mm_set1_ps(triangle.z2);
+
+        Uint32 mask = 0;
+
+        for (int o = 0; o < _sr_impl::FragmentBlock::Size; o += 4)
+        {
+            const __m128i inside = covered ? _mm_set1_epi32(-1)
+                : _mm_cmpgt_epi32(_mm_or_si128(_mm_or_si128(vW0, vW1), vW2), _mm_set1_epi32(-1));
+            __m128 pass = _mm_castsi128_ps(inside);
+
+            if (depth != nullptr && _mm_movemask_ps(pass))
+            {
+                const __m128 aW0 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(vW0, _mm_set1_epi32(triangle.bias0))), invArea);
+                const __m128 aW1 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(vW1, _mm_set1_epi32(triangle.bias1))), invArea);
+                const __m128 aW2 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(vW2, _mm_set1_epi32(triangle.bias2))), invArea);
+                const __m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(z0, aW0), _mm_mul_ps(z1, aW1)), _mm_mul_ps(z2, aW2));
+
+                if (triangle.depthFormat == sr::DepthFormat::Unorm16)
+                {
+                    Uint16 *depth16 = static_cast<Uint16*>(depth) + o;
+                    const __m128i key = _mm_cvttps_epi32(_mm_add_ps(_mm_min_ps(_mm_max_ps(z, _mm_setzero_ps()), _mm_set1_ps(65535.0f)), _mm_set1_ps(0.5f)));
+                    const __m128i d = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(depth16)), _mm_setzero_si128());
+                    pass = _mm_andnot_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(key, d)), pass);
+
+                    const __m128i passMask = _mm_castps_si128(pass);
+                    const __m128i result = _mm_sub_epi32(_mm_or_si128(_mm_and_si128(passMask, key), _mm_andnot_si128(passMask, d)), _mm_set1_epi32(0x8000));
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(depth16), _mm_xor_si128(_mm_packs_epi32(result, result), _mm_set1_epi16(-0x8000)));
+                }
+                else
+                {
+                    float *depth32 = static_cast<float*>(depth) + o;
+                    const __m128 d = _mm_loadu_ps(depth32);
+                    pass = _mm_andnot_ps(_mm_cmpgt_ps(z, d), pass);
+                    _mm_storeu_ps(depth32, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, d)));
+                }
+            }
+
+            mask |= static_cast<Uint32>(_mm_movemask_ps(pass)) << o;
+
+            vW0 = _mm_add_epi32(vW0, step0);
+            vW1 = _mm_add_epi32(vW1, step1);
+            vW2 = _mm_add_epi32(vW2, step2);
+        }
+
+        return mask;
+    }
+
+    NEXUS_SR_TARGET_SSE2
+    __m128i BlendPixelsSSE2(__m128i src, __m128i dst)
+    {
+        // Works on two pixels, one 16-bit lane per channel
+        const __m128i alpha = _mm_add_epi16(_mm_shufflehi_epi16(_mm_shufflelo_epi16(src, 0xFF), 0xFF), _mm_set1_epi16(1));
+        const __m128i invAlpha = _mm_sub_epi16(_mm_set1_epi16(256), alpha);
+
+        // The source alpha is replaced by 256 to compute the destination alpha with the same formula
+        const __m128i alphaLanes = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+        src = _mm_or_si128(_mm_andnot_si128(alphaLanes, src), _mm_and_si128(alphaLanes, _mm_set1_epi16(256)));
+
+        return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, alpha), _mm_mullo_epi16(dst, invAlpha)), 8);
+    }
+
+    NEXUS_SR_TARGET_SSE2
+    void WriteBlockSSE2(gfx::Color* dst, const gfx::Color* src, Uint32 mask, int count)
+    {
+        // NOTE: The whole block is loaded and stored back, so this is only done if all its pixels belong to the caller
+        if (count < _sr_impl::FragmentBlock::Size)
+        {
+            WriteBlockScalar(dst, src, mask, count);
+            return;
+        }
+
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+        const __m128i laneBits = _mm_setr_epi32(1, 2, 4, 8);
+
+        for (int o = 0; o < _sr_impl::FragmentBlock::Size; o += 4, mask >>= 4)
+        {
+            if (!(mask & 0xF)) continue;
+
+            const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + o));
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + o));
+
+            const __m128i blended = _mm_packus_epi16(
+                BlendPixelsSSE2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero)),
+                BlendPixelsSSE2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero)));
+
+            const __m128i sAlpha = _mm_and_si128(s, alphaMask);
+            const __m128i opaque = _mm_cmpeq_epi32(sAlpha, alphaMask);
+            const __m128i selected = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(mask), laneBits), laneBits);
+            const __m128i write = _mm_andnot_si128(_mm_cmpeq_epi32(sAlpha, zero), selected);
+
+            const __m128i color = _mm_or_si128(_mm_and_si128(opaque, s), _mm_andnot_si128(opaque, blended));
+            const __m128i result = _mm_or_si128(_mm_and_si128(write, color), _mm_andnot_si128(write, d));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + o), result);
+        }
+    }
+
+    constexpr _sr_impl::RasterKernels KernelsSSE2 = { ProcessBlockSSE2, CoverBlockSSE2, WriteBlockSSE2 };
+
+}
+
+/* AVX2 Kernels */
+
+namespace {
+
+    NEXUS_SR_TARGET_AVX2
+    Uint32 ProcessBlockAVX2(const _sr_impl::TriangleSetup& triangle, int w0, int w1, int w2, int count, bool covered, void* depth, _sr_impl::FragmentBlock& block)
+    {
+        if (count < _sr_impl::FragmentBlock::Size)
+        {
+            return ProcessBlockScalar(triangle, w0, w1, w2, count, covered, depth, block);
+        }
+
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i vW0 = _mm256_add_epi32(_mm256_set1_epi32(w0), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(triangle.stepW0)));
+        const __m256i vW1 = _mm256_add_epi32(_mm256_set1_epi32(w1), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(triangle.stepW1)));
+        const __m256i vW2 = _mm256_add_epi32(_mm256_set1_epi32(w2), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(triangle.stepW2)));
+
+        const __m256i inside = covered ? _mm256_set1_epi32(-1)
+            : _mm256_cmpgt_epi32(_mm256_or_si256(_mm256_or_si256(vW0, vW1), vW2), _mm256_set1_epi32(-1));
+        __m256 pass = _mm256_castsi256_ps(inside);
+
+        if (!_mm256_movemask_ps(pass))
+        {
+            return 0;
+        }
+
+        const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), scale = _mm256_set1_ps(255.0f);
+
+        const __m256 invArea = _mm256_set1_ps(triangle.invArea);
+        const __m256 aW0 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(vW0, _mm256_set1_epi32(triangle.bias0))), invArea);
+        const __m256 aW1 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(vW1, _mm256_set1_epi32(triangle.bias1))), invArea);
+        const __m256 aW2 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(vW2, _mm256_set1_epi32(triangle.bias2))), invArea);
+
+        const __m256 z = _mm256_add_ps(_mm256_add_ps(
+            _mm256_mul_ps(_mm256_set1_ps(triangle.z0), aW0),
+            _mm256_mul_ps(_mm256_set1_ps(triangle.z1), aW1)),
+            _mm256_mul_ps(_mm256_set1_ps(triangle.z2), aW2));
+
+        if (depth != nullptr && triangle.depthFormat == sr::DepthFormat::Unorm16)
+        {
+            // Keys are compared as 32-bit integers, the eight 16-bit values being loaded and stored at once
+            Uint16 *depth16 = static_cast<Uint16*>(depth);
+            const __m256i key = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_min_ps(_mm256_max_ps(z, zero), _mm256_set1_ps(65535.0f)), _mm256_set1_ps(0.5f)));
+            const __m256i d = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(depth16)));
+            pass = _mm256_andnot_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(key, d)), pass);
+
+            const __m256i result = _mm256_blendv_epi8(d, key, _mm256_castps_si256(pass));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(depth16), _mm_packus_epi32(_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1)));
+        }
+        else if (depth != nullptr)
+        {
+            float *depth32 = static_cast<float*>(depth);
+            const __m256 d = _mm256_loadu_ps(depth32);
+            pass = _mm256_andnot_ps(_mm256_cmp_ps(z, d, _CMP_GT_OQ), pass);
+            _mm256_storeu_ps(depth32, _mm256_blendv_ps(d, z, pass));
+        }
+
+        __m256 pW0 = aW0, pW1 = aW1, pW2 = aW2;
+
+        if (triangle.perspective)
+        {
+            const __m256 q0 = _mm256_mul_ps(aW0, _mm256_set1_ps(triangle.invW0));
+            const __m256 q1 = _mm256_mul_ps(aW1, _mm256_set1_ps(triangle.invW1));
+            const __m256 q2 = _mm256_mul_ps(aW2, _mm256_set1_ps(triangle.invW2));
+            const __m256 w = _mm256_div_ps(one, _mm256_add_ps(_mm256_add_ps(q0, q1), q2));
+            pW0 = _mm256_mul_ps(q0, w), pW1 = _mm256_mul_ps(q1, w), pW2 = _mm256_mul_ps(q2, w);
+        }
+
+        _mm256_store_ps(block.aW0, pW0);
+        _mm256_store_ps(block.aW1, pW1);
+        _mm256_store_ps(block.aW2, pW2);
+        _mm256_store_ps(block.z, _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(triangle.zScale)), _mm256_set1_ps(triangle.zOffset)));
+
+        __m256i rgba = _mm256_setzero_si256();
+
+        for (int c = 0; c < 4; c++)
+        {
+            const __m256 v = _mm256_add_ps(_mm256_add_ps(
+                _mm256_mul_ps(_mm256_set1_ps(triangle.color0[c]), pW0),
+                _mm256_mul_ps(_mm256_set1_ps(triangle.color1[c]), pW1)),
+                _mm256_mul_ps(_mm256_set1_ps(triangle.color2[c]), pW2));
+
+            const __m256i channel = _mm256_cvttps_epi32(_mm256_mul_ps(scale, _mm256_min_ps(_mm256_max_ps(v, zero), one)));
+            rgba = _mm256_or_si256(rgba, _mm256_sllv_epi32(channel, _mm256_set1_epi32(8 * c)));
+        }
+
+        _mm256_store_si256(reinterpret_cast<__m256i*>(block.colors), rgba);
+
+        return static_cast<Uint32>(_mm256_movemask_ps(pass));
+    }
+
+    NEXUS_SR_TARGET_AVX2
+    Uint32 CoverBlockAVX2(const _sr_impl::TriangleSetup& triangle, int w0, int w1, int w2, int count, bool covered, void* depth)
+    {
+        if (count < _sr_impl::FragmentBlock::Size)
+        {
+            return CoverBlockScalar(triangle, w0, w1, w2, count, covered, depth);
+        }
+
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i vW0 = _mm256_add_epi32(_mm256_set1_epi32(w0), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(triangle.stepW0)));
+        const __m256i vW1 = _mm256_add_epi32(_mm256_set1_epi32(w1), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(triangle.stepW1)));
+        const __m256i vW2 = _mm256_add_epi32(_mm256_set1_epi32(w2), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(triangle.stepW2)));
+
+        const __m256i inside = covered ? _mm256_set1_epi32(-1)
+            : _mm256_cmpgt_epi32(_mm256_or_si256(_mm256_or_si256(vW0, vW1), vW2), _mm256_set1_epi32(-1));
+        __m256 pass = _mm256_castsi256_ps(inside);
+
+        if (depth == nullptr || !_mm256_movemask_ps(pass))
+        {
+            return static_cast<Uint32>(_mm256_movemask_ps(pass));
+        }
+
+        const __m256 invArea = _mm256_set1_ps(triangle.invArea);
+        const __m256 aW0 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(vW0, _mm256_set1_epi32(triangle.bias0))), invArea);
+        const __m256 aW1 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(vW1, _mm256_set1_epi32(triangle.bias1))), invArea);
+        const __m256 aW2 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(vW2, _mm256_set1_epi32(triangle.bias2))), invArea);
+
+        const __m256 z = _mm256_add_ps(_mm256_add_ps(
+            _mm256_mul_ps(_mm256_set1_ps(triangle.z0), aW0),
+            _mm256_mul_ps(_mm256_set1_ps(triangle.z1), aW1)),
+            _mm256_mul_ps(_mm256_set1_ps(triangle.z2), aW2));
+
+        if (triangle.depthFormat == sr::DepthFormat::Unorm16)
+        {
+            Uint16 *depth16 = static_cast<Uint16*>(depth);
+            const __m256i key = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_min_ps(_mm256_max_ps(z, _mm256_setzero_ps()), _mm256_set1_ps(65535.0f)), _mm256_set1_ps(0.5f)));
+            const __m256i d = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(depth16)));
+            pass = _mm256_andnot_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(key, d)), pass);
+
+            const __m256i result = _mm256_blendv_epi8(d, key, _mm256_castps_si256(pass));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(depth16), _mm_packus_epi32(_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1)));
+        }
+        else
+        {
+            float *depth32 = static_cast<float*>(depth);
+            const __m256 d = _mm256_loadu_ps(depth32);
+            pass = _mm256_andnot_ps(_mm256_cmp_ps(z, d, _CMP_GT_OQ), pass);
+            _mm256_storeu_ps(depth32, _mm256_blendv_ps(d, z, pass));
+        }
+
+        return static_cast<Uint32>(_mm256_movemask_ps(pass));
+    }
+
+    NEXUS_SR_TARGET_AVX2
+    __m256i BlendPixelsAVX2(__m256i src, __m256i dst)
+    {
+        // Works on four pixels, one 16-bit lane per channel
+        const __m256i alpha = _mm256_add_epi16(_mm256_shufflehi_epi16(_mm256_shufflelo_epi16(src, 0xFF), 0xFF), _mm256_set1_epi16(1));
+        const __m256i invAlpha = _mm256_sub_epi16(_mm256_set1_epi16(256), alpha);
+
+        // The source alpha is replaced by 256 to compute the destination alpha with the same formula
+        const __m256i alphaLanes = _mm256_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1);
+        src = _mm256_blendv_epi8(src, _mm256_set1_epi16(256), alphaLanes);
+
+        return _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(src, alpha), _mm256_mullo_epi16(dst, invAlpha)), 8);
+    }
+
+    NEXUS_SR_TARGET_AVX2
+    void WriteBlockAVX2(gfx::Color* dst, const gfx::Color* src, Uint32 mask, int count)
+    {
+        // NOTE: The whole block is loaded and stored back, so this is only done if all its pixels belong to the caller
+        if (count < _sr_impl::FragmentBlock::Size)
+        {
+            WriteBlockScalar(dst, src, mask, count);
+            return;
+        }
+
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+        const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst));
+
+        // NOTE: Unpacking and packing both work within 128-bit lanes, so the pixel order is preserved
+        const __m256i blended = _mm256_packus_epi16(
+            BlendPixelsAVX2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero)),
+            BlendPixelsAVX2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero)));
+
+        const __m256i sAlpha = _mm256_and_si256(s, alphaMask);
+        const __m256i opaque = _mm256_cmpeq_epi32(sAlpha, alphaMask);
+        const __m256i selected = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(mask), laneBits), laneBits);
+        const __m256i write = _mm256_andnot_si256(_mm256_cmpeq_epi32(sAlpha, zero), selected);
+
+        const __m256i color = _mm256_blendv_epi8(blended, s, opaque);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_blendv_epi8(d, color, write));
+    }
+
+    constexpr _sr_impl::RasterKernels KernelsAVX2 = { ProcessBlockAVX2, CoverBlockAVX2, WriteBlockAVX2 };
+
+}
+
+#endif //NEXUS_SR_SIMD_X86
+
+/* NEON Kernels */
+
+#ifdef NEXUS_SR_SIMD_NEON
+
+namespace {
+
+    Uint32 ProcessBlockNEON(const _sr_impl::TriangleSetup& triangle, int w0, int w1, int w2, int count, bool covered, void* depth, _sr_impl::FragmentBlock& block)
+    {
+        if (count < _sr_impl::FragmentBlock::Size)
+        {
+            return ProcessBlockScalar(triangle, w0, w1, w2, count, covered, depth, block);
+        }
+
+        const int32x4_t lanes = { 0, 1, 2, 3 };
+        int32x4_t vW0 = vmlaq_n_s32(vdupq_n_s32(w0), lanes, triangle.stepW0);
+        int32x4_t vW1 = vmlaq_n_s32(vdupq_n_s32(w1), lanes, triangle.stepW1);
+        int32x4_t vW2 = vmlaq_n_s32(vdupq_n_s32(w2), lanes, triangle.stepW2);
+
+        const int32x4_t step0 = vdupq_n_s32(4 * triangle.stepW0);
+        const int32x4_t step1 = vdupq_n_s32(4 * triangle.stepW1);
+        const int32x4_t step2 = vdupq_n_s32(4 * triangle.stepW2);
+
+        const float32x4_t zero = vdupq_n_f32(0.0f), one = vdupq_n_f32(1.0f), scale = vdupq_n_f32(255.0f);
+        const uint32x4_t laneBits = { 1, 2, 4, 8 };
+
+        Uint32 mask = 0;
+
+        for (int o = 0; o < _sr_impl::FragmentBlock::Size; o += 4)
+        {
+            uint32x4_t pass = covered ? vdupq_n_u32(0xFFFFFFFF)
+                : vcgeq_s32(vorrq_s32(vorrq_s32(vW0, vW1), vW2), vdupq_n_s32(0));
+
+            if (vmaxvq_u32(pass))
+            {
+                const float32x4_t aW0 = vmulq_n_f32(vcvtq_f32_s32(vaddq_s32(vW0, vdupq_n_s32(triangle.bias0))), triangle.invArea);
+                const float32x4_t aW1 = vmulq_n_f32(vcvtq_f32_s32(vaddq_s32(vW1, vdupq_n_s32(triangle.bias1))), triangle.invArea);
+                const float32x4_t aW2 = vmulq_n_f32(vcvtq_f32_s32(vaddq_s32(vW2, vdupq_n_s32(triangle.bias2))), triangle.invArea);
+
+                const float32x4_t z = vaddq_f32(vaddq_f32(
+                    vmulq_n_f32(aW0, triangle.z0),
+                    vmulq_n_f32(aW1, triangle.z1)),
+                    vmulq_n_f32(aW2, triangle.z2));
+
+                if (depth != nullptr && triangle.depthFormat == sr::DepthFormat::Unorm16)
+                {
+                    Uint16 *depth16 = static_cast<Uint16*>(depth) + o;
+                    const uint32x4_t key = vcvtq_u32_f32(vaddq_f32(vminq_f32(vmaxq_f32(z, zero), vdupq_n_f32(65535.0f)), vdupq_n_f32(0.5f)));
+                    const uint32x4_t d = vmovl_u16(vld1_u16(depth16));
+                    pass = vbicq_u32(pass, vcgtq_u32(key, d));
+                    vst1_u16(depth16, vmovn_u32(vbslq_u32(pass, key, d)));
+                }
+                else if (depth != nullptr)
+                {
+                    float *depth32 = static_cast<float*>(depth) + o;
+                    const float32x4_t d = vld1q_f32(depth32);
+                    pass = vbicq_u32(pass, vcgtq_f32(z, d));
+                    vst1q_f32(depth32, vbslq_f32(pass, z, d));
+                }
+
+                float32x4_t pW0 = aW0, pW1 = aW1, pW2 = aW2;
+
+                if (triangle.perspective)
+                {
+                    const float32x4_t q0 = vmulq_n_f32(aW0, triangle.invW0);
+                    const float32x4_t q1 = vmulq_n_f32(aW1, triangle.invW1);
+                    const float32x4_t q2 = vmulq_n_f32(aW2, triangle.invW2);
+                    const float32x4_t w = vdivq_f32(one, vaddq_f32(vaddq_f32(q0, q1), q2));
+                    pW0 = vmulq_f32(q0, w), pW1 = vmulq_f32(q1, w), pW2 = vmulq_f32(q2, w);
+                }
+
+                vst1q_f32(block.aW0 + o, pW0);
+                vst1q_f32(block.aW1 + o, pW1);
+                vst1q_f32(block.aW2 + o, pW2);
+                vst1q_f32(block.z + o, vaddq_f32(vmulq_n_f32(z, triangle.zScale), vdupq_n_f32(triangle.zOffset)));
+
+                uint32x4_t rgba = vdupq_n_u32(0);
+
+                for (int c = 0; c < 4; c++)
+                {
+                    const float32x4_t v = vaddq_f32(vaddq_f32(
+                        vmulq_n_f32(pW0, triangle.color0[c]),
+                        vmulq_n_f32(pW1, triangle.color1[c])),
+                        vmulq_n_f32(pW2, triangle.color2[c]));
+
+                    const uint32x4_t channel = vcvtq_u32_f32(vmulq_f32(scale, vminq_f32(vmaxq_f32(v, zero), one)));
+                    rgba = vorrq_u32(rgba, vshlq_u32(channel, vdupq_n_s32(8 * c)));
+                }
+
+                vst1q_u32(reinterpret_cast<uint32_t*>(block.colors + o), rgba);
+
+                mask |= vaddvq_u32(vandq_u32(pass, laneBits)) << o;
+            }
+
+            vW0 = vaddq_s32(vW0, step0);
+            vW1 = vaddq_s32(vW1, step1);
+            vW2 = vaddq_s32(vW2, step2);
+        }
+
+        return mask;
+    }
+
+    Uint32 CoverBlockNEON(const _sr_impl::TriangleSetup& triangle, int w0, int w1, int w2, int count, bool covered, void* depth)
+    {
+        if (count < _sr_impl::FragmentBlock::Size)
+        {
+            return CoverBlockScalar(triangle, w0, w1, w2, count, covered, depth);
+        }
+
+        const int32x4_t lanes = { 0, 1, 2, 3 };
+        int32x4_t vW0 = vmlaq_n_s32(vdupq_n_s32(w0), lanes, triangle.stepW0);
+        int32x4_t vW1 = vmlaq_n_s32(vdupq_n_s32(w1), lanes, triangle.stepW1);
+        int32x4_t vW2 = vmlaq_n_s32(vdupq_n_s32(w2), lanes, triangle.stepW2);
+
+        const int32x4_t step0 = vdupq_n_s32(4 * triangle.stepW0);
+        const int32x4_t step1 = vdupq_n_s32(4 * triangle.stepW1);
+        const int32x4_t step2 = vdupq_n_s32(4 * triangle.stepW2);
+
+        const uint32x4_t laneBits = { 1, 2, 4, 8 };
+
+        Uint32 mask = 0;
+
+        for (int o = 0; o < _sr_impl::FragmentBlock::Size; o += 4)
+        {
+            uint32x4_t pass = covered ? vdupq_n_u32(0xFFFFFFFF)
+                : vcgeq_s32(vorrq_s32(vorrq_s32(vW0, vW1), vW2), vdupq_n_s32(0));
+
+            if (depth != nullptr && vmaxvq_u32(pass))
+            {
+                const float32x4_t aW0 = vmulq_n_f32(vcvtq_f32_s32(vaddq_s32(vW0, vdupq_n_s32(triangle.bias0))), triangle.invArea);
+                const float32x4_t aW1 = vmulq_n_f32(vcvtq_f32_s32(vaddq_s32(vW1, vdupq_n_s32(triangle.bias1))), triangle.invArea);
+                const float32x4_t aW2 = vmulq_n_f32(vcvtq_f32_s32(vaddq_s32(vW2, vdupq_n_s32(triangle.bias2))), triangle.invArea);
+
+                const float32x4_t z = vaddq_f32(vaddq_f32(
+                    vmulq_n_f32(aW0, triangle.z0),
+                    vmulq_n_f32(aW1, triangle.z1)),
+                    vmulq_n_f32(aW2, triangle.z2));
+
+                if (triangle.depthFormat == sr::DepthFormat::Unorm16)
+                {
+                    Uint16 *depth16 = static_cast<Uint16*>(depth) + o;
+                    const uint32x4_t key = vcvtq_u32_f32(vaddq_f32(vminq_f32(vmaxq_f32(z, vdupq_n_f32(0.0f)), vdupq_n_f32(65535.0f)), vdupq_n_f32(0.5f)));
+                    const uint32x4_t d = vmovl_u16(vld1_u16(depth16));
+                    pass = vbicq_u32(pass, vcgtq_u32(key, d));
+                    vst1_u16(depth16, vmovn_u32(vbslq_u32(pass, key, d)));
+                }
+                else
+                {
+                    float *depth32 = static_cast<float*>(depth) + o;
+                    const float32x4_t d = vld1q_f32(depth32);
+                    pass = vbicq_u32(pass, vcgtq_f32(z, d));
+                    vst1q_f32(depth32, vbslq_f32(pass, z, d));
+                }
+            }
+
+            mask |= vaddvq_u32(vandq_u32(pass, laneBits)) << o;
+
+            vW0 = vaddq_s32(vW0, step0);
+            vW1 = vaddq_s32(vW1, step1);
+            vW2 = vaddq_s32(vW2, step2);
+        }
+
+        return mask;
+    }
+
+    uint8x8_t BlendChannelNEON(uint8x8_t src, uint8x8_t dst, uint16x8_t alpha, uint16x8_t invAlpha)
+    {
+        return vshrn_n_u16(vaddq_u16(vmulq_u16(vmovl_u8(src), alpha), vmulq_u16(vmovl_u8(dst), invAlpha)), 8);
+    }
+
+    void WriteBlockNEON(gfx::Color* dst, const gfx::Color* src, Uint32 mask, int count)
+    {
+        // NOTE: The whole block is loaded and stored back, so this is only done if all its pixels belong to the caller
+        if (count < _sr_impl::FragmentBlock::Size)
+        {
+            WriteBlockScalar(dst, src, mask, count);
+            return;
+        }
+
+        // Loads the eight pixels with one register per channel
+        const uint8x8x4_t s = vld4_u8(reinterpret_cast<const uint8_t*>(src));
+        const uint8x8x4_t d = vld4_u8(reinterpret_cast<const uint8_t*>(dst));
+
+        const uint16x8_t alpha = vaddq_u16(vmovl_u8(s.val[3]), vdupq_n_u16(1));
+        const uint16x8_t invAlpha = vsubq_u16(vdupq_n_u16(256), alpha);
+
+        uint8x8x4_t blended;
+        blended.val[0] = BlendChannelNEON(s.val[0], d.val[0], alpha, invAlpha);
+        blended.val[1] = BlendChannelNEON(s.val[1], d.val[1], alpha, invAlpha);
+        blended.val[2] = BlendChannelNEON(s.val[2], d.val[2], alpha, invAlpha);
+        blended.val[3] = vshrn_n_u16(vaddq_u16(vshlq_n_u16(alpha, 8), vmulq_u16(vmovl_u8(d.val[3]), invAlpha)), 8);
+
+        const uint8x8_t laneBits = { 1, 2, 4, 8, 16, 32, 64, 128 };
+        const uint8x8_t opaque = vceq_u8(s.val[3], vdup_n_u8(255));
+        const uint8x8_t write = vand_u8(vtst_u8(vdup_n_u8(static_cast<Uint8>(mask)), laneBits), vtst_u8(s.val[3], s.val[3]));
+
+        uint8x8x4_t result;
+
+        for (int c = 0; c < 4; c++)
+        {
+            result.val[c] = vbsl_u8(write, vbsl_u8(opaque, s.val[c], blended.val[c]), d.val[c]);
+        }
+
+        vst4_u8(reinterpret_cast<uint8_t*>(dst), result);
+    }
+
+    constexpr _sr_impl::RasterKernels KernelsNEON = { ProcessBlockNEON, CoverBlockNEON, WriteBlockNEON };
+
+}
+
+#endif //NEXUS_SR_SIMD_NEON
+
+/* Kernels Selection */
+
+namespace {
+
+    const _sr_impl::RasterKernels* GetKernels(sr::SimdPath path)
+    {
+        switch (path)
+        {
+            case sr::SimdPath::Scalar:
+                return &KernelsScalar;
+
+#       ifdef NEXUS_SR_SIMD_X86
+            case sr::SimdPath::SSE2:
+                return SDL_HasSSE2() ? &KernelsSSE2 : nullptr;
+
+            case sr::SimdPath::AVX2:
+                return SDL_HasAVX2() ? &KernelsAVX2 : nullptr;
+#       endif
+
+#       ifdef NEXUS_SR_SIMD_NEON
+            case sr::SimdPath::NEON:
+                return SDL_HasNEON() ? &KernelsNEON : nullptr;
+#       endif
+
+            default:
+                return nullptr;
+        }
+    }
+
+    sr::SimdPath DetectSimdPath()
+    {
+        for (sr::SimdPath path : { sr::SimdPath::AVX2, sr::SimdPath::NEON, sr::SimdPath::SSE2 })
+        {
+            if (GetKernels(path) != nullptr) return path;
+        }
+
+        return sr::SimdPath::Scalar;
+    }
+
+    struct KernelsSelection
+    {
+        std::atomic<sr::SimdPath> path;
+        std::atomic<const _sr_impl::RasterKernels*> kernels;
+
+        KernelsSelection()
+        : path(DetectSimdPath())
+        , kernels(GetKernels(path))
+        { }
+    };
+
+    KernelsSelection& GetSelection()
+    {
+        // NOTE: Selected on first use, the CPU detection does not require SDL to be initialized
+        static KernelsSelection selection;
+        return selection;
+    }
+
+}
+
+bool sr::IsSimdPathSupported(SimdPath path)
+{
+    return GetKernels(path) != nullptr;
+}
+
+sr::SimdPath sr::GetSimdPath()
+{
+    return GetSelection().path.load(std::memory_order_relaxed);
+}
+
+bool sr::SetSimdPath(SimdPath path)
+{
+    const _sr_impl::RasterKernels *kernels = GetKernels(path);
+    if (kernels == nullptr) return false;
+
+    KernelsSelection &selection = GetSelection();
+    selection.kernels.store(kernels, std::memory_order_relaxed);
+    selection.path.store(path, std::memory_order_relaxed);
+
+    return true;
+}
+
+const _sr_impl::RasterKernels& _sr_impl::GetRasterKernels()
+{
+    return *GetSelection().kernels.load(std::memory_order_relaxed);
+}
@@ -22,6 +22,20 @@
 
 using namespace nexus;
 
+void sr::Shader::Fragment(const FragmentSpan& span, gfx::Color* out)
+{
+    for (int i = 0; i < span.count; i++)
+    {
+        if (!(span.mask & (1u << i))) continue;
+
+        const math::IVec2 fragCoord(span.fragCoord.x + i, span.fragCoord.y);
+
+        out[i] = span.image
+            ? Fragment(span.image, fragCoord, span.texCoords[i], span.fragNormals[i], span.fragColors[i])
+            : Fragment(fragCoord, span.fragNormals[i], span.fragColors[i]);
+    }
+}
+
 void sr::Shader::Begin()
 {
     ctx->SetShader(this);
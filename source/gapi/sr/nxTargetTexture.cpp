@@ -47,6 +47,8 @@ _sr_impl::TargetTexture& _sr_impl::TargetTexture::End()
 
 void _sr_impl::TargetTexture::Clear(const gfx::Color& color)
 {
+    ctx.Flush();    // Pending primitives must be rendered before being overwritten
+
     if (!active)
     {
         framebuffer.Begin();
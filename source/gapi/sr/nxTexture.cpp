@@ -19,9 +19,69 @@
 
 #include "gapi/sr/nxTexture.hpp"
 #include "math/nxMath.hpp"
+#include <algorithm>
 
 using namespace nexus;
 
+void _sr_impl::Texture::GenerateMipmaps()
+{
+    // NOTE: Moving the chain keeps its surfaces in place, they must not move once referenced by a sampler
+    mipmaps = GenerateMipChain(gfx::ResizeFilter::Box);
+    UpdateTiles();
+}
+
+void _sr_impl::Texture::UpdateTiles()
+{
+    using TiledLevel = nexus::sr::TextureSampler::TiledLevel;
+
+    tiledTexels.clear();
+    tiledLevels.clear();
+
+    if (layout != nexus::sr::TextureLayout::Tiled) return;
+
+    // Locate each level, the partial tiles of the edges being stored entirely
+
+    int texelCount = 0;
+
+    for (int i = 0; i <= static_cast<int>(mipmaps.size()); i++)
+    {
+        const gfx::Surface &level = (i == 0) ? *this : mipmaps[i - 1];
+
+        const int tilesPerRow = (level.GetWidth() + TiledLevel::TileMask) >> TiledLevel::TileShift;
+        const int tilesPerColumn = (level.GetHeight() + TiledLevel::TileMask) >> TiledLevel::TileShift;
+
+        tiledLevels.push_back({ texelCount, tilesPerRow });
+        texelCount += (tilesPerRow * tilesPerColumn) << (2 * TiledLevel::TileShift);
+    }
+
+    tiledTexels.resize(texelCount);
+
+    // Copy the texels, converted to RGBA32, row by row from the surfaces
+
+    for (int i = 0; i <= static_cast<int>(mipmaps.size()); i++)
+    {
+        const gfx::Surface &level = (i == 0) ? *this : mipmaps[i - 1];
+        const int w = level.GetWidth(), h = level.GetHeight();
+
+        constexpr int SpanSize = 64;
+        gfx::Color span[SpanSize];
+
+        for (int y = 0; y < h; y++)
+        {
+            for (int x = 0; x < w; x += SpanSize)
+            {
+                const int count = std::min(w - x, SpanSize);
+                level.GetPixelsUnsafe(x, y, span, count);
+
+                for (int j = 0; j < count; j++)
+                {
+                    tiledTexels[tiledLevels[i].Index(x + j, y)] = span[j];
+                }
+            }
+        }
+    }
+}
+
 void _sr_impl::Texture::Draw(shape2D::RectangleF src, const shape2D::RectangleF& dst, const math::Vec2& origin, float rotation, const gfx::Color& tint)  const
 {
     bool flipX = false;
@@ -66,7 +126,7 @@ void _sr_impl::Texture::Draw(shape2D::RectangleF src, const shape2D::RectangleF&
         bottomRight.y = y + (dx + dst.w) * s + (dy + dst.h) * c;
     }
 
-    ctx.SetTexture(this);
+    ctx.SetTexture(this, GetSampler());
     ctx.Begin(sr::DrawMode::Quads);
 
         ctx.Color(tint.r, tint.g, tint.b, tint.a);
@@ -192,7 +252,7 @@ void _sr_impl::Texture::DrawNinePatch(sr::NinePatchInfo ninePatchInfo, const sha
     coordD.x = static_cast<float>(ninePatchInfo.source.x + ninePatchInfo.source.w) / surface->w;
     coordD.y = static_cast<float>(ninePatchInfo.source.y + ninePatchInfo.source.h) / surface->h;
 
-    ctx.SetTexture(this);
+    ctx.SetTexture(this, GetSampler());
     ctx.PushMatrix();
 
         ctx.Translate(dest.x, dest.y, 0.0f);
@@ -404,7 +464,7 @@ void _sr_impl::Texture::DrawBillboard(const sr::Camera3D& camera, shape2D::Recta
     bottomRight = bottomRight + position;
     bottomLeft = bottomLeft + position;
 
-    ctx.SetTexture(this);
+    ctx.SetTexture(this, GetSampler());
     ctx.Begin(sr::DrawMode::Quads);
 
         ctx.Color(tint.r, tint.g, tint.b, tint.a);
@@ -64,6 +64,9 @@ void sr::Window::Clear(const gfx::Color& color)
 {
     bool lockedHere = false;
 
+    // Pending primitives must be rendered before being overwritten
+    ctx->Flush();
+
     if (framebuffer->MustLock() && !framebuffer->IsLocked())
     {
         framebuffer->Lock();
@@ -88,7 +91,27 @@ sr::Window& sr::Window::Begin()
 
 sr::Window& sr::Window::End()
 {
+    ctx->Flush();
     framebuffer->End();
-    UpdateSurface();
+
+    damagedRects.clear();
+
+    if (skipUnchangedFrames && !framebuffer->IsDamaged())
+    {
+        return *this;
+    }
+
+    if (damagedRectsOnly)
+    {
+        framebuffer->GetDamagedRects(damagedRects);
+        UpdateSurfaceRects(damagedRects);
+    }
+    else
+    {
+        UpdateSurface();
+    }
+
+    framebuffer->ResetDamage();
+
     return *this;
 }
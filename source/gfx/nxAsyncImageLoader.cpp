@@ -0,0 +1,234 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "gfx/nxAsyncImageLoader.hpp"
+
+#include <exception>
+#include <utility>
+
+using namespace nexus;
+
+/* Private Implementation AsyncImageLoader */
+
+std::future<gfx::Surface> gfx::AsyncImageLoader::Submit(RequestPtr request)
+{
+    std::future<Surface> result = request->promise.get_future();
+
+    {
+        std::scoped_lock lock(mutex);
+        pendingCount++;
+    }
+
+    pool.Enqueue([this, request] { Measure(request); });
+
+    return result;
+}
+
+void gfx::AsyncImageLoader::Measure(const RequestPtr& request)
+{
+    // NOTE: An image whose size cannot be read costs nothing,
+    //       its decoding will fail and report the error
+    try
+    {
+        const math::IVec2 size = request->data
+            ? Surface::QueryImageSize(request->data, request->size)
+            : Surface::QueryImageSize(request->filePath);
+
+        request->cost = 4 * static_cast<size_t>(size.x) * static_cast<size_t>(size.y);
+    }
+    catch (const core::NexusException&)
+    {
+        request->cost = 0;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    waiting.push_back(request);
+    Dispatch(lock);
+}
+
+void gfx::AsyncImageLoader::Decode(const RequestPtr& request)
+{
+    try
+    {
+        Surface surface = request->data
+            ? Surface(request->data, request->size)
+            : Surface(request->filePath);
+
+        if (!surface.IsValid())
+        {
+            throw core::NexusException("AsyncImageLoader", "The image could not be decoded.");
+        }
+
+        if (request->onLoaded)
+        {
+            request->surface = std::move(surface);
+
+            {
+                std::scoped_lock lock(mutex);
+                completed.push_back(request);
+            }
+
+            cvCompleted.notify_all();
+            return;
+        }
+
+        request->promise.set_value(std::move(surface));
+    }
+    catch (...)
+    {
+        request->promise.set_exception(std::current_exception());
+    }
+
+    Release(request->cost);
+}
+
+void gfx::AsyncImageLoader::Release(size_t cost)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        memoryUsage -= cost;
+        pendingCount--;
+        Dispatch(lock);
+    }
+
+    cvCompleted.notify_all();
+}
+
+void gfx::AsyncImageLoader::Dispatch(std::unique_lock<std::mutex>& lock)
+{
+    std::vector<RequestPtr> admitted;
+
+    // The loads are admitted in order, an image larger than the budget once nothing else is held
+    while (!waiting.empty())
+    {
+        const size_t cost = waiting.front()->cost;
+        if (memoryBudget > 0 && memoryUsage > 0 && memoryUsage + cost > memoryBudget) break;
+
+        memoryUsage += cost;
+        admitted.push_back(std::move(waiting.front()));
+        waiting.pop_front();
+    }
+
+    lock.unlock();
+
+    for (RequestPtr& request : admitted)
+    {
+        pool.Enqueue([this, request = std::move(request)] { Decode(request); });
+    }
+}
+
+/* Public Implementation AsyncImageLoader */
+
+gfx::AsyncImageLoader::AsyncImageLoader(size_t numThreads, size_t memoryBudget)
+: memoryBudget(memoryBudget)
+, pool(numThreads)
+{ }
+
+gfx::AsyncImageLoader::~AsyncImageLoader()
+{
+    Flush();
+}
+
+std::future<gfx::Surface> gfx::AsyncImageLoader::Load(const std::string& filePath, Callback onLoaded)
+{
+    auto request = std::make_shared<Request>();
+    request->filePath = filePath;
+    request->onLoaded = std::move(onLoaded);
+
+    return Submit(std::move(request));
+}
+
+std::future<gfx::Surface> gfx::AsyncImageLoader::Load(const void* data, size_t size, Callback onLoaded)
+{
+    auto request = std::make_shared<Request>();
+    request->data = data;
+    request->size = size;
+    request->onLoaded = std::move(onLoaded);
+
+    return Submit(std::move(request));
+}
+
+std::vector<std::future<gfx::Surface>> gfx::AsyncImageLoader::Load(const std::vector<std::string>& filePaths,
+    const std::function<void(size_t, Surface&)>& onLoaded)
+{
+    std::vector<std::future<Surface>> results;
+    results.reserve(filePaths.size());
+
+    for (size_t i = 0; i < filePaths.size(); i++)
+    {
+        results.push_back(Load(filePaths[i], onLoaded
+            ? Callback([onLoaded, i](Surface& surface) { onLoaded(i, surface); })
+            : Callback()));
+    }
+
+    return results;
+}
+
+size_t gfx::AsyncImageLoader::Poll()
+{
+    std::deque<RequestPtr> ready;
+
+    {
+        std::scoped_lock lock(mutex);
+        ready.swap(completed);
+    }
+
+    for (const RequestPtr& request : ready)
+    {
+        try
+        {
+            request->onLoaded(request->surface);
+            request->promise.set_value(std::move(request->surface));
+        }
+        catch (...)
+        {
+            request->promise.set_exception(std::current_exception());
+        }
+
+        Release(request->cost);
+    }
+
+    return ready.size();
+}
+
+void gfx::AsyncImageLoader::Flush()
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cvCompleted.wait(lock, [this] { return pendingCount == 0 || !completed.empty(); });
+            if (completed.empty()) return;
+        }
+
+        Poll();
+    }
+}
+
+size_t gfx::AsyncImageLoader::GetPendingCount() const
+{
+    std::scoped_lock lock(mutex);
+    return pendingCount;
+}
+
+size_t gfx::AsyncImageLoader::GetMemoryUsage() const
+{
+    std::scoped_lock lock(mutex);
+    return memoryUsage;
+}
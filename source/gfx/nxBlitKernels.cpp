@@ -0,0 +1,444 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "gfx/nxBlitKernels.hpp"
+
+#include <SDL_cpuinfo.h>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#   define NEXUS_GFX_SIMD_X86
+#   include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#   define NEXUS_GFX_SIMD_NEON
+#   include <arm_neon.h>
+#endif
+
+// NOTE: The SSE2 kernels are compiled for their own instruction set only,
+//       which is already the baseline of x86_64 but not of 32-bit x86.
+#if defined(__GNUC__) || defined(__clang__)
+#   define NEXUS_GFX_TARGET_SSE2 __attribute__((target("sse2")))
+#else
+#   define NEXUS_GFX_TARGET_SSE2
+#endif
+
+using namespace nexus;
+
+/* Scalar Kernels (Reference) */
+
+namespace {
+
+    /**
+     * @brief Divides a value within [0, 255 * 256] by 255, rounded to the nearest integer.
+     */
+    constexpr Uint32 Div255(Uint32 x)
+    {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+
+    gfx::Color Premultiply(gfx::Color c)
+    {
+        return gfx::Color(Div255(c.r * c.a), Div255(c.g * c.a), Div255(c.b * c.a), c.a);
+    }
+
+    void BlendRowScalar(gfx::Color* dst, const gfx::Color* src, int count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            const gfx::Color s = src[i];
+
+            if (s.a == 0) continue;
+            if (s.a == 255) { dst[i] = s; continue; }
+
+            gfx::Color &d = dst[i];
+            const Uint32 inv = 255 - s.a;
+
+            d.r = Div255(s.r * s.a + d.r * inv);
+            d.g = Div255(s.g * s.a + d.g * inv);
+            d.b = Div255(s.b * s.a + d.b * inv);
+            d.a = s.a + Div255(d.a * inv);
+        }
+    }
+
+    void BlendRowPremultipliedScalar(gfx::Color* dst, const gfx::Color* src, int count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            const gfx::Color s = src[i];
+
+            if (s.a == 255) { dst[i] = s; continue; }
+
+            gfx::Color &d = dst[i];
+            const Uint32 inv = 255 - s.a;
+
+            d.r = std::min<Uint32>(255, s.r + Div255(d.r * inv));
+            d.g = std::min<Uint32>(255, s.g + Div255(d.g * inv));
+            d.b = std::min<Uint32>(255, s.b + Div255(d.b * inv));
+            d.a = std::min<Uint32>(255, s.a + Div255(d.a * inv));
+        }
+    }
+
+    void ScaleRowBilinearScalar(gfx::Color* dst, const gfx::Color* row0, const gfx::Color* row1,
+                                int width, Sint32 u, Sint32 du, int fy, int count, bool premultiply)
+    {
+        for (int i = 0; i < count; i++, u += du)
+        {
+            int x = u >> 16, fx = (u >> 8) & 0xFF;
+
+            // The last column is sampled as the right texel of the previous pair
+            if (x >= width - 1) x = width - 2, fx = 256;
+
+            gfx::Color c00 = row0[x], c01 = row0[x + 1];
+            gfx::Color c10 = row1[x], c11 = row1[x + 1];
+
+            if (premultiply)
+            {
+                c00 = Premultiply(c00), c01 = Premultiply(c01);
+                c10 = Premultiply(c10), c11 = Premultiply(c11);
+            }
+
+            // Vertical then horizontal interpolation, each rounded to 8 bits
+            const auto filter = [fx, fy](int v00, int v01, int v10, int v11)
+            {
+                const int v0 = (v00 * (256 - fy) + v10 * fy + 128) >> 8;
+                const int v1 = (v01 * (256 - fy) + v11 * fy + 128) >> 8;
+                return static_cast<Uint8>((v0 * (256 - fx) + v1 * fx + 128) >> 8);
+            };
+
+            dst[i].r = filter(c00.r, c01.r, c10.r, c11.r);
+            dst[i].g = filter(c00.g, c01.g, c10.g, c11.g);
+            dst[i].b = filter(c00.b, c01.b, c10.b, c11.b);
+            dst[i].a = filter(c00.a, c01.a, c10.a, c11.a);
+        }
+    }
+
+    constexpr _gfx_impl::BlitKernels KernelsScalar = { BlendRowScalar, BlendRowPremultipliedScalar, ScaleRowBilinearScalar };
+
+}
+
+/* SSE2 Kernels */
+
+#ifdef NEXUS_GFX_SIMD_X86
+
+namespace {
+
+    NEXUS_GFX_TARGET_SSE2
+    __m128i Div255SSE2(__m128i x)
+    {
+        x = _mm_add_epi16(x, _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    }
+
+    NEXUS_GFX_TARGET_SSE2
+    __m128i BroadcastAlphaSSE2(__m128i c16)
+    {
+        return _mm_shufflehi_epi16(_mm_shufflelo_epi16(c16, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    }
+
+    /**
+     * @brief Multiplies the color channels of two pixels unpacked to 16 bits by their alpha, which is kept.
+     */
+    NEXUS_GFX_TARGET_SSE2
+    __m128i PremultiplySSE2(__m128i c16)
+    {
+        const __m128i alphaLanes = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+        const __m128i weights = _mm_or_si128(_mm_andnot_si128(alphaLanes, BroadcastAlphaSSE2(c16)), _mm_and_si128(alphaLanes, _mm_set1_epi16(255)));
+        return Div255SSE2(_mm_mullo_epi16(c16, weights));
+    }
+
+    /**
+     * @brief Blends two source pixels unpacked to 16 bits over two destination pixels, with straight alpha.
+     */
+    NEXUS_GFX_TARGET_SSE2
+    __m128i BlendStraightSSE2(__m128i s16, __m128i d16)
+    {
+        const __m128i alphaLanes = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+        const __m128i alpha = BroadcastAlphaSSE2(s16);
+
+        // The alpha of the source is weighted by 255 instead of itself, giving srcA + dstA * (255 - srcA) / 255
+        const __m128i weights = _mm_or_si128(_mm_andnot_si128(alphaLanes, alpha), _mm_and_si128(alphaLanes, _mm_set1_epi16(255)));
+        const __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+
+        return Div255SSE2(_mm_add_epi16(_mm_mullo_epi16(s16, weights), _mm_mullo_epi16(d16, inv)));
+    }
+
+    NEXUS_GFX_TARGET_SSE2
+    void BlendRowSSE2(gfx::Color* dst, const gfx::Color* src, int count)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+        int i = 0;
+
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i sAlpha = _mm_and_si128(s, alphaMask);
+
+            // Runs of transparent or opaque pixels are frequent in sprites
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(sAlpha, zero)) == 0xFFFF) continue;
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(sAlpha, alphaMask)) == 0xFFFF)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+                continue;
+            }
+
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+
+            const __m128i blended = _mm_packus_epi16(
+                BlendStraightSSE2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero)),
+                BlendStraightSSE2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero)));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), blended);
+        }
+
+        BlendRowScalar(dst + i, src + i, count - i);
+    }
+
+    NEXUS_GFX_TARGET_SSE2
+    void BlendRowPremultipliedSSE2(gfx::Color* dst, const gfx::Color* src, int count)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+        int i = 0;
+
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xFFFF) continue;
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, alphaMask), alphaMask)) == 0xFFFF)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+                continue;
+            }
+
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            const __m128i s16lo = _mm_unpacklo_epi8(s, zero), s16hi = _mm_unpackhi_epi8(s, zero);
+            const __m128i inv = _mm_set1_epi16(255);
+
+            const __m128i scaled = _mm_packus_epi16(
+                Div255SSE2(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(inv, BroadcastAlphaSSE2(s16lo)))),
+                Div255SSE2(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(inv, BroadcastAlphaSSE2(s16hi)))));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_adds_epu8(s, scaled));
+        }
+
+        BlendRowPremultipliedScalar(dst + i, src + i, count - i);
+    }
+
+    NEXUS_GFX_TARGET_SSE2
+    void ScaleRowBilinearSSE2(gfx::Color* dst, const gfx::Color* row0, const gfx::Color* row1,
+                              int width, Sint32 u, Sint32 du, int fy, int count, bool premultiply)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi16(128);
+        const __m128i wy0 = _mm_set1_epi16(static_cast<short>(256 - fy)), wy1 = _mm_set1_epi16(static_cast<short>(fy));
+
+        for (int i = 0; i < count; i++, u += du)
+        {
+            int x = u >> 16, fx = (u >> 8) & 0xFF;
+            if (x >= width - 1) x = width - 2, fx = 256;
+
+            // The two texels of each row, unpacked to 16 bits in the low and high halves
+            __m128i p0 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row0 + x)), zero);
+            __m128i p1 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row1 + x)), zero);
+
+            if (premultiply)
+            {
+                p0 = PremultiplySSE2(p0);
+                p1 = PremultiplySSE2(p1);
+            }
+
+            const __m128i v = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(p0, wy0), _mm_mullo_epi16(p1, wy1)), round), 8);
+
+            const short wx0 = static_cast<short>(256 - fx), wx1 = static_cast<short>(fx);
+            __m128i h = _mm_mullo_epi16(v, _mm_setr_epi16(wx0, wx0, wx0, wx0, wx1, wx1, wx1, wx1));
+            h = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(h, _mm_srli_si128(h, 8)), round), 8);
+
+            const int color = _mm_cvtsi128_si32(_mm_packus_epi16(h, h));
+            std::memcpy(static_cast<void*>(dst + i), &color, sizeof(color));
+        }
+    }
+
+    constexpr _gfx_impl::BlitKernels KernelsSSE2 = { BlendRowSSE2, BlendRowPremultipliedSSE2, ScaleRowBilinearSSE2 };
+
+}
+
+#endif //NEXUS_GFX_SIMD_X86
+
+/* NEON Kernels */
+
+#ifdef NEXUS_GFX_SIMD_NEON
+
+namespace {
+
+    uint16x8_t Div255NEON(uint16x8_t x)
+    {
+        x = vaddq_u16(x, vdupq_n_u16(128));
+        return vshrq_n_u16(vaddq_u16(x, vshrq_n_u16(x, 8)), 8);
+    }
+
+    /**
+     * @brief Broadcasts the alpha of two pixels to their four channels.
+     */
+    uint8x8_t BroadcastAlphaNEON(uint8x8_t c)
+    {
+        const uint8x8_t index = { 3, 3, 3, 3, 7, 7, 7, 7 };
+        return vtbl1_u8(c, index);
+    }
+
+    /**
+     * @brief Gets the weights of the channels of two pixels, their alpha for the colors and 255 for the alpha.
+     */
+    uint8x8_t AlphaWeightsNEON(uint8x8_t c)
+    {
+        const uint8x8_t alphaLanes = { 0, 0, 0, 255, 0, 0, 0, 255 };
+        return vorr_u8(BroadcastAlphaNEON(c), alphaLanes);
+    }
+
+    uint8x8_t BlendStraightNEON(uint8x8_t s, uint8x8_t d)
+    {
+        const uint8x8_t inv = vsub_u8(vdup_n_u8(255), BroadcastAlphaNEON(s));
+        return vmovn_u16(Div255NEON(vmlal_u8(vmull_u8(s, AlphaWeightsNEON(s)), d, inv)));
+    }
+
+    uint8x8_t BlendPremultipliedNEON(uint8x8_t s, uint8x8_t d)
+    {
+        const uint8x8_t inv = vsub_u8(vdup_n_u8(255), BroadcastAlphaNEON(s));
+        return vqadd_u8(s, vmovn_u16(Div255NEON(vmull_u8(d, inv))));
+    }
+
+    void BlendRowNEON(gfx::Color* dst, const gfx::Color* src, int count)
+    {
+        int i = 0;
+
+        for (; i + 4 <= count; i += 4)
+        {
+            const uint8x16_t s = vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+            const uint32x4_t sAlpha = vshrq_n_u32(vreinterpretq_u32_u8(s), 24);
+
+            // Runs of transparent or opaque pixels are frequent in sprites
+            if (vmaxvq_u32(sAlpha) == 0) continue;
+
+            if (vminvq_u32(sAlpha) == 255)
+            {
+                vst1q_u8(reinterpret_cast<uint8_t*>(dst + i), s);
+                continue;
+            }
+
+            const uint8x16_t d = vld1q_u8(reinterpret_cast<const uint8_t*>(dst + i));
+
+            vst1q_u8(reinterpret_cast<uint8_t*>(dst + i), vcombine_u8(
+                BlendStraightNEON(vget_low_u8(s), vget_low_u8(d)),
+                BlendStraightNEON(vget_high_u8(s), vget_high_u8(d))));
+        }
+
+        BlendRowScalar(dst + i, src + i, count - i);
+    }
+
+    void BlendRowPremultipliedNEON(gfx::Color* dst, const gfx::Color* src, int count)
+    {
+        int i = 0;
+
+        for (; i + 4 <= count; i += 4)
+        {
+            const uint8x16_t s = vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+
+            if (vmaxvq_u32(vreinterpretq_u32_u8(s)) == 0) continue;
+
+            if (vminvq_u32(vshrq_n_u32(vreinterpretq_u32_u8(s), 24)) == 255)
+            {
+                vst1q_u8(reinterpret_cast<uint8_t*>(dst + i), s);
+                continue;
+            }
+
+            const uint8x16_t d = vld1q_u8(reinterpret_cast<const uint8_t*>(dst + i));
+
+            vst1q_u8(reinterpret_cast<uint8_t*>(dst + i), vcombine_u8(
+                BlendPremultipliedNEON(vget_low_u8(s), vget_low_u8(d)),
+                BlendPremultipliedNEON(vget_high_u8(s), vget_high_u8(d))));
+        }
+
+        BlendRowPremultipliedScalar(dst + i, src + i, count - i);
+    }
+
+    void ScaleRowBilinearNEON(gfx::Color* dst, const gfx::Color* row0, const gfx::Color* row1,
+                              int width, Sint32 u, Sint32 du, int fy, int count, bool premultiply)
+    {
+        for (int i = 0; i < count; i++, u += du)
+        {
+            int x = u >> 16, fx = (u >> 8) & 0xFF;
+            if (x >= width - 1) x = width - 2, fx = 256;
+
+            // The two texels of each row, widened to 16 bits in the low and high halves
+            const uint8x8_t t0 = vld1_u8(reinterpret_cast<const uint8_t*>(row0 + x));
+            const uint8x8_t t1 = vld1_u8(reinterpret_cast<const uint8_t*>(row1 + x));
+
+            const uint16x8_t p0 = premultiply ? Div255NEON(vmull_u8(t0, AlphaWeightsNEON(t0))) : vmovl_u8(t0);
+            const uint16x8_t p1 = premultiply ? Div255NEON(vmull_u8(t1, AlphaWeightsNEON(t1))) : vmovl_u8(t1);
+
+            uint16x8_t v = vmlaq_n_u16(vmulq_n_u16(p0, static_cast<uint16_t>(256 - fy)), p1, static_cast<uint16_t>(fy));
+            v = vshrq_n_u16(vaddq_u16(v, vdupq_n_u16(128)), 8);
+
+            const uint16x4_t h = vshr_n_u16(vadd_u16(vadd_u16(
+                vmul_n_u16(vget_low_u16(v), static_cast<uint16_t>(256 - fx)),
+                vmul_n_u16(vget_high_u16(v), static_cast<uint16_t>(fx))), vdup_n_u16(128)), 8);
+
+            const uint32_t color = vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(h, h))), 0);
+            std::memcpy(static_cast<void*>(dst + i), &color, sizeof(color));
+        }
+    }
+
+    constexpr _gfx_impl::BlitKernels KernelsNEON = { BlendRowNEON, BlendRowPremultipliedNEON, ScaleRowBilinearNEON };
+
+}
+
+#endif //NEXUS_GFX_SIMD_NEON
+
+/* Kernels Selection */
+
+namespace {
+
+    const _gfx_impl::BlitKernels& DetectKernels()
+    {
+#   ifdef NEXUS_GFX_SIMD_X86
+        if (SDL_HasSSE2()) return KernelsSSE2;
+#   endif
+
+#   ifdef NEXUS_GFX_SIMD_NEON
+        if (SDL_HasNEON()) return KernelsNEON;
+#   endif
+
+        return KernelsScalar;
+    }
+
+}
+
+const _gfx_impl::BlitKernels& _gfx_impl::GetBlitKernels(bool simd)
+{
+    // NOTE: Selected on first use, the CPU detection does not require SDL to be initialized
+    static const BlitKernels &detected = DetectKernels();
+    return simd ? detected : KernelsScalar;
+}
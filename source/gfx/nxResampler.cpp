@@ -0,0 +1,646 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "gfx/nxResampler.hpp"
+
+#include <SDL_cpuinfo.h>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#   define NEXUS_GFX_SIMD_X86
+#   include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#   define NEXUS_GFX_SIMD_NEON
+#   include <arm_neon.h>
+#endif
+
+// NOTE: The SSE2 kernels are compiled for their own instruction set only,
+//       which is already the baseline of x86_64 but not of 32-bit x86.
+#if defined(__GNUC__) || defined(__clang__)
+#   define NEXUS_GFX_TARGET_SSE2 __attribute__((target("sse2")))
+#else
+#   define NEXUS_GFX_TARGET_SSE2
+#endif
+
+using namespace nexus;
+
+/* Filters */
+
+namespace {
+
+    constexpr double Pi = 3.14159265358979323846;
+
+    struct Filter
+    {
+        double (*func)(double x);   ///< Weight of a source pixel at the distance x from the sampled position.
+        double support;             ///< Distance beyond which the weight is zero.
+    };
+
+    double BoxFilter(double x)
+    {
+        return (x >= -0.5 && x < 0.5) ? 1.0 : 0.0;
+    }
+
+    double TriangleFilter(double x)
+    {
+        x = std::abs(x);
+        return x < 1.0 ? 1.0 - x : 0.0;
+    }
+
+    double CatmullRomFilter(double x)
+    {
+        x = std::abs(x);
+        if (x < 1.0) return (1.5 * x - 2.5) * x * x + 1.0;
+        if (x < 2.0) return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+        return 0.0;
+    }
+
+    double Sinc(double x)
+    {
+        if (x == 0.0) return 1.0;
+        x *= Pi;
+        return std::sin(x) / x;
+    }
+
+    double LanczosFilter(double x)
+    {
+        return (x > -3.0 && x < 3.0) ? Sinc(x) * Sinc(x / 3.0) : 0.0;
+    }
+
+    Filter GetFilter(gfx::ResizeFilter filter)
+    {
+        switch (filter)
+        {
+            case gfx::ResizeFilter::Box:        return { BoxFilter, 0.5 };
+            case gfx::ResizeFilter::Bilinear:   return { TriangleFilter, 1.0 };
+            case gfx::ResizeFilter::Bicubic:    return { CatmullRomFilter, 2.0 };
+            case gfx::ResizeFilter::Lanczos:    return { LanczosFilter, 3.0 };
+        }
+
+        return { TriangleFilter, 1.0 };
+    }
+
+}
+
+/* Scalar Kernels (Reference) */
+
+namespace {
+
+    // The intermediate rows keep 6 fractional bits, leaving room in 16 bits for the overshoot of the negative lobes
+    constexpr int IntermediateBits = 6;
+    constexpr int HorizontalShift = _gfx_impl::Resampler::WeightBits - IntermediateBits;
+    constexpr int VerticalShift = _gfx_impl::Resampler::WeightBits + IntermediateBits;
+
+    /**
+     * @brief Row functions of the two passes, every implementation producing exactly the same values.
+     */
+    struct ResampleKernels
+    {
+        /**
+         * @brief Multiplies the color channels of consecutive pixels by their alpha, divided by 255 and rounded.
+         */
+        void (*PremultiplyRow)(gfx::Color* dst, const gfx::Color* src, int count);
+
+        /**
+         * @brief Filters a source row horizontally, `dst` receiving 4 channels per destination pixel.
+         * The source must be readable up to `starts[i] + taps` for every pixel.
+         */
+        void (*FilterRow)(Sint16* dst, const gfx::Color* src, const int* starts, const Sint16* weights, int taps, int count);
+
+        /**
+         * @brief Filters `taps` intermediate rows vertically into a destination row.
+         */
+        void (*FilterColumn)(gfx::Color* dst, const Sint16* const* rows, const Sint16* weights, int taps, int count);
+    };
+
+    constexpr Uint32 Div255(Uint32 x)
+    {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+
+    void PremultiplyRowScalar(gfx::Color* dst, const gfx::Color* src, int count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            const gfx::Color c = src[i];
+            dst[i] = c.a == 255 ? c : gfx::Color(Div255(c.r * c.a), Div255(c.g * c.a), Div255(c.b * c.a), c.a);
+        }
+    }
+
+    Sint16 SaturateInt16(int x)
+    {
+        return static_cast<Sint16>(std::clamp(x, -32768, 32767));
+    }
+
+    void FilterRowScalar(Sint16* dst, const gfx::Color* src, const int* starts, const Sint16* weights, int taps, int count)
+    {
+        for (int i = 0; i < count; i++, weights += taps)
+        {
+            const gfx::Color *s = src + starts[i];
+            int r = 0, g = 0, b = 0, a = 0;
+
+            for (int k = 0; k < taps; k++)
+            {
+                r += weights[k] * s[k].r;
+                g += weights[k] * s[k].g;
+                b += weights[k] * s[k].b;
+                a += weights[k] * s[k].a;
+            }
+
+            constexpr int round = 1 << (HorizontalShift - 1);
+
+            dst[4 * i + 0] = SaturateInt16((r + round) >> HorizontalShift);
+            dst[4 * i + 1] = SaturateInt16((g + round) >> HorizontalShift);
+            dst[4 * i + 2] = SaturateInt16((b + round) >> HorizontalShift);
+            dst[4 * i + 3] = SaturateInt16((a + round) >> HorizontalShift);
+        }
+    }
+
+    /**
+     * @brief Filters the pixels [begin, count) of a column pass, used for the remainders of the SIMD kernels.
+     */
+    void FilterColumnRange(gfx::Color* dst, const Sint16* const* rows, const Sint16* weights, int taps, int begin, int count)
+    {
+        Uint8 *channels = reinterpret_cast<Uint8*>(dst);
+
+        for (int i = 4 * begin; i < 4 * count; i++)
+        {
+            int v = 0;
+
+            for (int k = 0; k < taps; k++)
+            {
+                v += weights[k] * rows[k][i];
+            }
+
+            channels[i] = static_cast<Uint8>(std::clamp((v + (1 << (VerticalShift - 1))) >> VerticalShift, 0, 255));
+        }
+    }
+
+    void FilterColumnScalar(gfx::Color* dst, const Sint16* const* rows, const Sint16* weights, int taps, int count)
+    {
+        FilterColumnRange(dst, rows, weights, taps, 0, count);
+    }
+
+    constexpr ResampleKernels KernelsScalar = { PremultiplyRowScalar, FilterRowScalar, FilterColumnScalar };
+
+}
+
+/* SSE2 Kernels */
+
+#ifdef NEXUS_GFX_SIMD_X86
+
+namespace {
+
+    /**
+     * @brief Broadcasts two consecutive weights, multiplied with `_mm_madd_epi16` by two interleaved values.
+     */
+    NEXUS_GFX_TARGET_SSE2
+    __m128i WeightPairSSE2(const Sint16* weights)
+    {
+        return _mm_set1_epi32(static_cast<int>(static_cast<Uint16>(weights[0]) | (static_cast<Uint32>(static_cast<Uint16>(weights[1])) << 16)));
+    }
+
+    NEXUS_GFX_TARGET_SSE2
+    __m128i PremultiplySSE2(__m128i c16)
+    {
+        // Alpha broadcast over the color channels and replaced by 255 in its own channel
+        const __m128i alphaLanes = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+        const __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c16, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        const __m128i weights = _mm_or_si128(_mm_andnot_si128(alphaLanes, alpha), _mm_and_si128(alphaLanes, _mm_set1_epi16(255)));
+
+        __m128i x = _mm_add_epi16(_mm_mullo_epi16(c16, weights), _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    }
+
+    NEXUS_GFX_TARGET_SSE2
+    void PremultiplyRowSSE2(gfx::Color* dst, const gfx::Color* src, int count)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+        int i = 0;
+
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+            // Opaque runs are kept as is
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(c, alphaMask), alphaMask)) == 0xFFFF)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), c);
+                continue;
+            }
+
+            const __m128i lo = PremultiplySSE2(_mm_unpacklo_epi8(c, zero));
+            const __m128i hi = PremultiplySSE2(_mm_unpackhi_epi8(c, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+        }
+
+        PremultiplyRowScalar(dst + i, src + i, count - i);
+    }
+
+    NEXUS_GFX_TARGET_SSE2
+    void FilterRowSSE2(Sint16* dst, const gfx::Color* src, const int* starts, const Sint16* weights, int taps, int count)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi32(1 << (HorizontalShift - 1));
+
+        for (int i = 0; i < count; i++, weights += taps)
+        {
+            const gfx::Color *s = src + starts[i];
+            __m128i acc = zero;
+
+            for (int k = 0; k < taps; k += 2)
+            {
+                // Two pixels unpacked to 16 bits, then interleaved channel by channel: r0 r1 g0 g1 b0 b1 a0 a1
+                const __m128i p = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(s + k)), zero);
+                const __m128i pairs = _mm_unpacklo_epi16(p, _mm_srli_si128(p, 8));
+                acc = _mm_add_epi32(acc, _mm_madd_epi16(pairs, WeightPairSSE2(weights + k)));
+            }
+
+            acc = _mm_srai_epi32(_mm_add_epi32(acc, round), HorizontalShift);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 4 * i), _mm_packs_epi32(acc, acc));
+        }
+    }
+
+    NEXUS_GFX_TARGET_SSE2
+    void FilterColumnSSE2(gfx::Color* dst, const Sint16* const* rows, const Sint16* weights, int taps, int count)
+    {
+        const __m128i round = _mm_set1_epi32(1 << (VerticalShift - 1));
+
+        int i = 0;
+
+        for (; i + 2 <= count; i += 2)
+        {
+            __m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+
+            for (int k = 0; k < taps; k += 2)
+            {
+                // Two pixels of two rows, interleaved so that each product pair belongs to the same channel
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + 4 * i));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k + 1] + 4 * i));
+                const __m128i w = WeightPairSSE2(weights + k);
+
+                lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+                hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+            }
+
+            lo = _mm_srai_epi32(_mm_add_epi32(lo, round), VerticalShift);
+            hi = _mm_srai_epi32(_mm_add_epi32(hi, round), VerticalShift);
+
+            const __m128i packed = _mm_packs_epi32(lo, hi);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(packed, packed));
+        }
+
+        FilterColumnRange(dst, rows, weights, taps, i, count);
+    }
+
+    constexpr ResampleKernels KernelsSSE2 = { PremultiplyRowSSE2, FilterRowSSE2, FilterColumnSSE2 };
+
+}
+
+#endif //NEXUS_GFX_SIMD_X86
+
+/* NEON Kernels */
+
+#ifdef NEXUS_GFX_SIMD_NEON
+
+namespace {
+
+    uint8x8_t Div255NEON(uint16x8_t x)
+    {
+        x = vaddq_u16(x, vdupq_n_u16(128));
+        return vshrn_n_u16(vaddq_u16(x, vshrq_n_u16(x, 8)), 8);
+    }
+
+    void PremultiplyRowNEON(gfx::Color* dst, const gfx::Color* src, int count)
+    {
+        int i = 0;
+
+        for (; i + 8 <= count; i += 8)
+        {
+            // Eight pixels split into one vector per channel
+            uint8x8x4_t c = vld4_u8(reinterpret_cast<const uint8_t*>(src + i));
+
+            c.val[0] = Div255NEON(vmull_u8(c.val[0], c.val[3]));
+            c.val[1] = Div255NEON(vmull_u8(c.val[1], c.val[3]));
+            c.val[2] = Div255NEON(vmull_u8(c.val[2], c.val[3]));
+
+            vst4_u8(reinterpret_cast<uint8_t*>(dst + i), c);
+        }
+
+        PremultiplyRowScalar(dst + i, src + i, count - i);
+    }
+
+    void FilterRowNEON(Sint16* dst, const gfx::Color* src, const int* starts, const Sint16* weights, int taps, int count)
+    {
+        for (int i = 0; i < count; i++, weights += taps)
+        {
+            const gfx::Color *s = src + starts[i];
+            int32x4_t acc = vdupq_n_s32(0);
+
+            for (int k = 0; k < taps; k += 2)
+            {
+                // Two pixels widened to 16 bits, the first in the low half and the second in the high half
+                const int16x8_t p = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(reinterpret_cast<const uint8_t*>(s + k))));
+                acc = vmlal_n_s16(acc, vget_low_s16(p), weights[k]);
+                acc = vmlal_n_s16(acc, vget_high_s16(p), weights[k + 1]);
+            }
+
+            vst1_s16(dst + 4 * i, vqmovn_s32(vrshrq_n_s32(acc, HorizontalShift)));
+        }
+    }
+
+    void FilterColumnNEON(gfx::Color* dst, const Sint16* const* rows, const Sint16* weights, int taps, int count)
+    {
+        int i = 0;
+
+        for (; i + 2 <= count; i += 2)
+        {
+            int32x4_t lo = vdupq_n_s32(0), hi = vdupq_n_s32(0);
+
+            for (int k = 0; k < taps; k++)
+            {
+                const int16x8_t v = vld1q_s16(rows[k] + 4 * i);
+                lo = vmlal_n_s16(lo, vget_low_s16(v), weights[k]);
+                hi = vmlal_n_s16(hi, vget_high_s16(v), weights[k]);
+            }
+
+            const int16x8_t packed = vcombine_s16(vqmovn_s32(vrshrq_n_s32(lo, VerticalShift)), vqmovn_s32(vrshrq_n_s32(hi, VerticalShift)));
+            vst1_u8(reinterpret_cast<uint8_t*>(dst + i), vqmovun_s16(packed));
+        }
+
+        FilterColumnRange(dst, rows, weights, taps, i, count);
+    }
+
+    constexpr ResampleKernels KernelsNEON = { PremultiplyRowNEON, FilterRowNEON, FilterColumnNEON };
+
+}
+
+#endif //NEXUS_GFX_SIMD_NEON
+
+/* Kernels Selection */
+
+namespace {
+
+    const ResampleKernels& DetectKernels()
+    {
+#   ifdef NEXUS_GFX_SIMD_X86
+        if (SDL_HasSSE2()) return KernelsSSE2;
+#   endif
+
+#   ifdef NEXUS_GFX_SIMD_NEON
+        if (SDL_HasNEON()) return KernelsNEON;
+#   endif
+
+        return KernelsScalar;
+    }
+
+    const ResampleKernels& GetKernels(bool simd)
+    {
+        static const ResampleKernels &detected = DetectKernels();
+        return simd ? detected : KernelsScalar;
+    }
+
+    /**
+     * @brief Gets the values of 255 / alpha in 16.16 fixed-point, which restore straight alpha with a multiplication.
+     */
+    const Uint32* GetUnpremultiplyTable()
+    {
+        static const std::array<Uint32, 256> table = []
+        {
+            std::array<Uint32, 256> values{};
+            for (Uint32 a = 1; a < 256; a++) values[a] = ((255u << 16) + a / 2) / a;
+            return values;
+        }();
+
+        return table.data();
+    }
+
+    /**
+     * @brief Clamps the filtered colors to their alpha, which the negative lobes may exceed, and restores straight alpha if requested.
+     */
+    void FinishRow(gfx::Color* row, int count, bool premultiplied)
+    {
+        const Uint32 *reciprocals = GetUnpremultiplyTable();
+
+        for (int i = 0; i < count; i++)
+        {
+            gfx::Color &c = row[i];
+            if (c.a == 255) continue;
+
+            const Uint32 r = std::min(c.r, c.a), g = std::min(c.g, c.a), b = std::min(c.b, c.a);
+
+            if (premultiplied || c.a == 0)
+            {
+                c.r = r, c.g = g, c.b = b;
+            }
+            else
+            {
+                const Uint32 reciprocal = reciprocals[c.a];
+                c.r = (r * reciprocal + 0x8000) >> 16;
+                c.g = (g * reciprocal + 0x8000) >> 16;
+                c.b = (b * reciprocal + 0x8000) >> 16;
+            }
+        }
+    }
+
+    /**
+     * @brief Calls `func(begin, end)` over bands of rows, on the pool if there are several bands.
+     */
+    template <typename F>
+    void ForEachBand(utils::ThreadPool* pool, int rows, int width, F&& func)
+    {
+        // Bands of at least 64K pixels, so that small images are not slowed down by the synchronization
+        // and that few source rows are shared by two bands
+        constexpr int MinBandPixels = 64 * 1024;
+        const int rowsPerBand = std::max(1, MinBandPixels / std::max(1, width));
+        const int numBands = (rows + rowsPerBand - 1) / rowsPerBand;
+
+        auto band = [&](size_t index)
+        {
+            const int begin = static_cast<int>(index) * rowsPerBand;
+            func(begin, std::min(rows, begin + rowsPerBand));
+        };
+
+        if (pool && numBands > 1)
+        {
+            pool->ParallelFor(numBands, band);
+        }
+        else
+        {
+            for (int i = 0; i < numBands; i++) band(i);
+        }
+    }
+
+}
+
+/* Resampler Implementation */
+
+_gfx_impl::Resampler::Axis _gfx_impl::Resampler::ComputeAxis(int srcSize, int dstSize, gfx::ResizeFilter filter)
+{
+    constexpr int One = 1 << WeightBits;
+
+    const Filter f = GetFilter(filter);
+
+    // When shrinking, the filter is stretched so that every source pixel contributes
+    const double scale = static_cast<double>(srcSize) / dstSize;
+    const double filterScale = std::max(1.0, scale);
+    const double support = f.support * filterScale;
+
+    const int bound = 2 * static_cast<int>(std::ceil(support)) + 1;
+
+    std::vector<int> firsts(dstSize), counts(dstSize);
+    std::vector<Sint16> quantized(static_cast<size_t>(dstSize) * bound);
+    std::vector<double> weights(bound);
+    int taps = 0;
+
+    for (int i = 0; i < dstSize; i++)
+    {
+        const double center = (i + 0.5) * scale;
+        const int lo = std::max(0, static_cast<int>(std::floor(center - support)));
+        const int hi = std::min(srcSize, static_cast<int>(std::ceil(center + support)));
+
+        double sum = 0.0;
+
+        for (int j = lo; j < hi; j++)
+        {
+            sum += weights[j - lo] = f.func((j + 0.5 - center) / filterScale);
+        }
+
+        Sint16 *q = quantized.data() + static_cast<size_t>(i) * bound;
+        int first = lo, count = hi - lo;
+
+        if (sum == 0.0)
+        {
+            // Can only happen at the borders, the nearest pixel is taken
+            first = std::clamp(static_cast<int>(center), 0, srcSize - 1), count = 1;
+            q[0] = One;
+        }
+        else
+        {
+            int total = 0, largest = 0;
+
+            for (int k = 0; k < count; k++)
+            {
+                q[k] = static_cast<Sint16>(std::lround(weights[k] / sum * One));
+                if (std::abs(q[k]) > std::abs(q[largest])) largest = k;
+                total += q[k];
+            }
+
+            // The rounding error goes to the largest weight, so that a flat area stays flat
+            q[largest] = static_cast<Sint16>(q[largest] + One - total);
+
+            int begin = 0, end = count;
+            while (q[begin] == 0) begin++;
+            while (q[end - 1] == 0) end--;
+
+            std::copy(q + begin, q + end, q);
+            first = lo + begin, count = end - begin;
+        }
+
+        firsts[i] = first, counts[i] = count;
+        taps = std::max(taps, count);
+    }
+
+    // The SIMD kernels process the weights in pairs
+    taps += taps & 1;
+
+    Axis axis;
+    axis.taps = taps;
+    axis.starts.resize(dstSize);
+    axis.weights.assign(static_cast<size_t>(dstSize) * taps, 0);
+
+    for (int i = 0; i < dstSize; i++)
+    {
+        // The windows are shifted back at the end of the image, so that they stay within it when it is wide enough
+        const int start = std::clamp(firsts[i], 0, std::max(0, srcSize - taps));
+        const Sint16 *q = quantized.data() + static_cast<size_t>(i) * bound;
+
+        axis.starts[i] = start;
+        std::copy(q, q + counts[i], axis.weights.begin() + static_cast<size_t>(i) * taps + (firsts[i] - start));
+    }
+
+    return axis;
+}
+
+_gfx_impl::Resampler::Resampler(int srcWidth, int srcHeight, int dstWidth, int dstHeight, gfx::ResizeFilter filter)
+: horizontal(ComputeAxis(srcWidth, dstWidth, filter))
+, vertical(ComputeAxis(srcHeight, dstHeight, filter))
+, srcWidth(srcWidth), srcHeight(srcHeight)
+, dstWidth(dstWidth), dstHeight(dstHeight)
+{ }
+
+void _gfx_impl::Resampler::Resample(const gfx::Color* src, int srcStride, gfx::Color* dst, int dstStride,
+                                    bool premultiplied, utils::ThreadPool* pool, bool simd) const
+{
+    const ResampleKernels &kernels = GetKernels(simd);
+    const size_t rowSize = 4 * static_cast<size_t>(dstWidth);
+
+    // Each band of destination rows filters horizontally the source rows it needs into its own
+    // intermediate rows, which stay in cache, only the few rows shared by two bands being filtered twice
+    ForEachBand(pool, dstHeight, dstWidth, [&](int begin, int end)
+    {
+        int first = srcHeight, last = 0;
+
+        for (int y = begin; y < end; y++)
+        {
+            first = std::min(first, vertical.starts[y]);
+            last = std::max(last, std::min(srcHeight, vertical.starts[y] + vertical.taps));
+        }
+
+        // NOTE: Not initialized, every row read by the vertical pass is written by the horizontal one first
+        std::unique_ptr<Sint16[]> intermediate(new Sint16[rowSize * (last - first)]);
+
+        // Padded with transparent pixels, read by the windows wider than the image
+        std::vector<gfx::Color> line(srcWidth + horizontal.taps);
+
+        for (int y = first; y < last; y++)
+        {
+            const gfx::Color *row = src + static_cast<ptrdiff_t>(y) * srcStride;
+
+            if (premultiplied) std::copy(row, row + srcWidth, line.begin());
+            else kernels.PremultiplyRow(line.data(), row, srcWidth);
+
+            kernels.FilterRow(intermediate.get() + (y - first) * rowSize, line.data(),
+                horizontal.starts.data(), horizontal.weights.data(), horizontal.taps, dstWidth);
+        }
+
+        std::vector<const Sint16*> rows(vertical.taps);
+
+        for (int y = begin; y < end; y++)
+        {
+            const int start = vertical.starts[y];
+
+            // The rows beyond the image only have zero weights
+            for (int k = 0; k < vertical.taps; k++)
+            {
+                rows[k] = intermediate.get() + (std::min(start + k, last - 1) - first) * rowSize;
+            }
+
+            gfx::Color *row = dst + static_cast<ptrdiff_t>(y) * dstStride;
+            kernels.FilterColumn(row, rows.data(), vertical.weights.data() + static_cast<size_t>(y) * vertical.taps, vertical.taps, dstWidth);
+            FinishRow(row, dstWidth, premultiplied);
+        }
+    });
+}
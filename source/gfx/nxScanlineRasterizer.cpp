@@ -0,0 +1,221 @@
+/**
+ * Copyright (c) 2023-2024 Le Juez Victor
+ *
+ * This software is provided "as-is", without any express or implied warranty. In no event 
+ * will the authors be held liable for any damages arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose, including commercial 
+ * applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *   1. The origin of this software must not be misrepresented; you must not claim that you 
+ *   wrote the original software. If you use this software in a product, an acknowledgment 
+ *   in the product documentation would be appreciated but is not required.
+ *
+ *   2. Altered source versions must be plainly marked as such, and must not be misrepresented
+ *   as being the original software.
+ *
+ *   3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "gfx/nxScanlineRasterizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace nexus;
+
+_gfx_impl::ScanlineRasterizer::ScanlineRasterizer(int width, int height)
+: width(std::max(width, 0)), height(std::max(height, 0))
+{ }
+
+void _gfx_impl::ScanlineRasterizer::Clear()
+{
+    edges.clear();
+}
+
+void _gfx_impl::ScanlineRasterizer::AddEdge(const math::Vec2& a, const math::Vec2& b)
+{
+    if (a.y == b.y) return;
+
+    const bool down = a.y < b.y;
+    const math::Vec2 &top = down ? a : b, &bottom = down ? b : a;
+
+    edges.push_back({ top.x, top.y, (bottom.x - top.x) / (bottom.y - top.y), bottom.y, down ? 1 : -1, 0, 0 });
+}
+
+void _gfx_impl::ScanlineRasterizer::AddPolygon(const math::Vec2* vertices, size_t count)
+{
+    for (size_t i = 0, j = count - 1; i < count; j = i++)
+    {
+        AddEdge(vertices[j], vertices[i]);
+    }
+}
+
+void _gfx_impl::ScanlineRasterizer::Scan(gfx::FillRule rule, float firstY, float rowStep, int rowCount,
+                                         const std::function<void(int row, float xa, float xb)>& func)
+{
+    // Build the edge table, an edge crossing the rows whose sample position is within [y0, y1)
+
+    const float invStep = 1.0f / rowStep;
+
+    auto row = [=](float y)
+    {
+        return static_cast<int>(std::clamp(std::ceil((y - firstY) * invStep), 0.0f, static_cast<float>(rowCount)));
+    };
+
+    order.clear();
+
+    for (int i = 0; i < static_cast<int>(edges.size()); i++)
+    {
+        Edge &edge = edges[i];
+        edge.rowBegin = row(edge.y0), edge.rowEnd = row(edge.y1);
+        if (edge.rowBegin < edge.rowEnd) order.push_back(i);
+    }
+
+    std::sort(order.begin(), order.end(), [this](int a, int b)
+    {
+        return edges[a].rowBegin < edges[b].rowBegin;
+    });
+
+    // Walk the rows, only visiting the edges crossing each of them
+
+    active.clear();
+    size_t next = 0;
+
+    for (int r = 0; r < rowCount; r++)
+    {
+        if (active.empty())
+        {
+            if (next == order.size()) break;
+            r = std::max(r, edges[order[next]].rowBegin);   // Skip the empty rows
+        }
+
+        active.erase(std::remove_if(active.begin(), active.end(), [this, r](const ActiveEdge& a)
+        {
+            return edges[a.index].rowEnd <= r;
+        }), active.end());
+
+        for (; next < order.size() && edges[order[next]].rowBegin <= r; next++)
+        {
+            active.push_back({ 0.0f, order[next] });
+        }
+
+        // Intersections are computed from the end of the edge rather than
+        // incrementally, so that no error accumulates along tall edges
+        const float y = firstY + r * rowStep;
+
+        for (ActiveEdge& a : active)
+        {
+            const Edge &edge = edges[a.index];
+            a.x = edge.x0 + (y - edge.y0) * edge.dxdy;
+        }
+
+        // The order barely changes from a row to the next, which insertion sort handles in linear time
+        for (size_t i = 1; i < active.size(); i++)
+        {
+            const ActiveEdge a = active[i];
+            size_t j = i;
+
+            for (; j > 0 && active[j - 1].x > a.x; j--)
+            {
+                active[j] = active[j - 1];
+            }
+
+            active[j] = a;
+        }
+
+        // Report the intervals between the edges where the winding number makes the points inside
+
+        int winding = 0;
+        float start = 0.0f;
+
+        for (const ActiveEdge& a : active)
+        {
+            const bool wasInside = rule == gfx::FillRule::EvenOdd ? (winding & 1) : winding != 0;
+            winding += rule == gfx::FillRule::EvenOdd ? 1 : edges[a.index].winding;
+            const bool isInside = rule == gfx::FillRule::EvenOdd ? (winding & 1) : winding != 0;
+
+            if (!wasInside && isInside) start = a.x;
+            else if (wasInside && !isInside) func(r, start, a.x);
+        }
+    }
+}
+
+void _gfx_impl::ScanlineRasterizer::Rasterize(gfx::FillRule rule, const SpanFunc& func)
+{
+    const float right = static_cast<float>(width);
+
+    Scan(rule, 0.0f, 1.0f, height, [&](int y, float xa, float xb)
+    {
+        const int x0 = static_cast<int>(std::ceil(std::clamp(xa, 0.0f, right)));
+        const int x1 = static_cast<int>(std::ceil(std::clamp(xb, 0.0f, right)));
+        if (x0 < x1) func(y, x0, x1);
+    });
+}
+
+void _gfx_impl::ScanlineRasterizer::RasterizeCoverage(gfx::FillRule rule, const CoverageFunc& func)
+{
+    // Each interval [xa, xb) adds its overlap with every pixel to the coverage of the row. This is
+    // accumulated as differences at both ends, the pixels between them only being visited once per
+    // row by a prefix sum, instead of once per sub-scanline.
+
+    accumulation.assign(width + 2, 0.0f);
+
+    const float weight = 1.0f / SubScanlines;
+    const float right = static_cast<float>(width);
+
+    int currentY = -1, minX = width + 1, maxX = -1;
+
+    auto flush = [&]()
+    {
+        if (minX > maxX) return;
+
+        float sum = 0.0f;
+
+        for (int x = minX; x <= maxX; x++)
+        {
+            sum += accumulation[x];
+            accumulation[x] = std::clamp(sum, 0.0f, 1.0f);
+        }
+
+        const int x1 = std::min(maxX, width);
+        if (minX < x1) func(currentY, minX, x1, accumulation.data() + minX);
+
+        std::fill(accumulation.begin() + minX, accumulation.begin() + maxX + 1, 0.0f);
+        minX = width + 1, maxX = -1;
+    };
+
+    auto add = [&](float x, float w)
+    {
+        const int i = static_cast<int>(x);
+        const float f = x - i;
+
+        accumulation[i] += w * (1.0f - f);
+        accumulation[i + 1] += w * f;
+
+        minX = std::min(minX, i), maxX = std::max(maxX, i + 1);
+    };
+
+    // The pixel x covers [x - 0.5, x + 0.5), hence the intervals being shifted by half a pixel
+    Scan(rule, 0.5f * weight - 0.5f, weight, height * SubScanlines, [&](int row, float xa, float xb)
+    {
+        const int y = row / SubScanlines;
+
+        if (y != currentY)
+        {
+            flush();
+            currentY = y;
+        }
+
+        xa = std::clamp(xa + 0.5f, 0.0f, right);
+        xb = std::clamp(xb + 0.5f, 0.0f, right);
+
+        if (xa < xb)
+        {
+            add(xa, weight);
+            add(xb, -weight);
+        }
+    });
+
+    flush();
+}
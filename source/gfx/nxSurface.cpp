@@ -29,6 +29,9 @@
 #include "shape/2D/nxLine.hpp"
 #include "shape/2D/nxAABB.hpp"
 #include "core/nxRandom.hpp"
+#include "utils/nxThreadPool.hpp"
+#include "gfx/nxScanlineRasterizer.hpp"
+#include "gfx/nxBlitKernels.hpp"
 #include "gfx/nxPixel.hpp"
 #include "math/nxVec2.hpp"
 #include "math/nxMath.hpp"
@@ -36,11 +39,36 @@
 #include <SDL_surface.h>
 #include <SDL_pixels.h>
 #include <SDL_stdinc.h>
+#include <algorithm>
+#include <cstdint>
+#include <atomic>
+#include <cstring>
+#include <cctype>
+#include <vector>
 #include <limits>
 #include <cmath>
 
 using namespace nexus;
 
+/* Public Implementation Worker Pool */
+
+namespace {
+
+    // Pool set by gfx::SetWorkerPool, none by default
+    std::atomic<utils::ThreadPool*> workerPool{nullptr};
+
+}
+
+void gfx::SetWorkerPool(utils::ThreadPool* pool)
+{
+    workerPool.store(pool, std::memory_order_relaxed);
+}
+
+utils::ThreadPool* gfx::GetWorkerPool()
+{
+    return workerPool.load(std::memory_order_relaxed);
+}
+
 /* Public Static Implementation Surface */
 
 gfx::Surface gfx::Surface::New(int width, int height, const gfx::Color& color)
@@ -80,22 +108,600 @@ gfx::Surface gfx::Surface::NewChecked(int width, int height, int checksX, int ch
     return surface;
 }
 
-gfx::Surface gfx::Surface::NewWhiteNoise(int width, int height, float factor)
+gfx::Surface gfx::Surface::NewWhiteNoise(int width, int height, float factor, unsigned long seed)
 {
     gfx::Surface surface;
     surface.Create(width, height);
-    surface.DrawWhiteNoise({ 0, 0, width, height }, factor);
+    surface.DrawWhiteNoise({ 0, 0, width, height }, factor, seed);
     return surface;
 }
 
-gfx::Surface gfx::Surface::NewCellular(int width, int height, int tileSize)
+gfx::Surface gfx::Surface::NewCellular(int width, int height, int tileSize, unsigned long seed)
 {
     gfx::Surface surface;
     surface.Create(width, height);
-    surface.DrawCellular({ 0, 0, width, height }, tileSize);
+    surface.DrawCellular({ 0, 0, width, height }, tileSize, seed);
     return surface;
 }
 
+/* Private Implementation Surface (Blitting) */
+
+namespace {
+
+    /**
+     * @brief Draws a rectangle of an RGBA32 surface onto another RGBA32 surface with the blit kernels.
+     *
+     * Straight and premultiplied alpha blending are supported, without scaling or with bilinear filtering.
+     * The destination is clipped by its clip rectangle, like with SDL.
+     *
+     * @return False if nothing has been drawn because the surfaces or their settings require an SDL blit.
+     */
+    bool BlitRGBA32(SDL_Surface* src, SDL_Rect rectSrc, SDL_Surface* dst, const SDL_Rect& rectDst, bool premultiplied, bool bilinear)
+    {
+        if (src == dst || src->format->format != SDL_PIXELFORMAT_RGBA32 || dst->format->format != SDL_PIXELFORMAT_RGBA32)
+        {
+            return false;
+        }
+
+        // Color keys, color modulation and RLE surfaces are left to SDL
+        SDL_BlendMode blendMode;
+        Uint8 r, g, b, a;
+
+        SDL_GetSurfaceBlendMode(src, &blendMode);
+        SDL_GetSurfaceColorMod(src, &r, &g, &b);
+        SDL_GetSurfaceAlphaMod(src, &a);
+
+        if ((blendMode != SDL_BLENDMODE_BLEND && blendMode != SDL_BLENDMODE_NONE)
+         || (r & g & b & a) != 255 || SDL_HasColorKey(src) || (src->flags & SDL_RLEACCEL) || (dst->flags & SDL_RLEACCEL))
+        {
+            return false;
+        }
+
+        const bool scaled = rectSrc.w != rectDst.w || rectSrc.h != rectDst.h;
+
+        // Unscaled copies are already memory copies with SDL, and it scales with the nearest pixel
+        if ((!scaled && blendMode == SDL_BLENDMODE_NONE) || (scaled && !bilinear))
+        {
+            return false;
+        }
+
+        const SDL_Rect srcBounds = { 0, 0, src->w, src->h };
+        SDL_Rect area = rectDst;
+
+        if (!scaled)
+        {
+            // The source rectangle is clipped by the source surface, moving the destination with it
+            SDL_Rect clipped;
+            if (!SDL_IntersectRect(&rectSrc, &srcBounds, &clipped)) return true;
+
+            area.x += clipped.x - rectSrc.x, area.w = clipped.w;
+            area.y += clipped.y - rectSrc.y, area.h = clipped.h;
+            rectSrc = clipped;
+        }
+        else
+        {
+            // Source rectangles partially outside the surface are clipped by SDL, which scales the destination with them
+            SDL_Rect inside;
+
+            if (rectSrc.w < 2 || rectSrc.h < 2 || rectDst.w <= 0 || rectDst.h <= 0
+             || !SDL_IntersectRect(&rectSrc, &srcBounds, &inside) || !SDL_RectEquals(&inside, &rectSrc))
+            {
+                return false;
+            }
+        }
+
+        SDL_Rect clip;
+        SDL_GetClipRect(dst, &clip);
+
+        if (!SDL_IntersectRect(&area, &clip, &clip))
+        {
+            return true;
+        }
+
+        const _gfx_impl::BlitKernels &kernels = _gfx_impl::GetBlitKernels();
+        const bool blend = blendMode == SDL_BLENDMODE_BLEND;
+
+        auto srcRow = [src, &rectSrc](int y)
+        {
+            return reinterpret_cast<const gfx::Color*>(static_cast<const Uint8*>(src->pixels) + (rectSrc.y + y) * src->pitch) + rectSrc.x;
+        };
+
+        auto dstRow = [dst, &clip](int y)
+        {
+            return reinterpret_cast<gfx::Color*>(static_cast<Uint8*>(dst->pixels) + y * dst->pitch) + clip.x;
+        };
+
+        if (!scaled)
+        {
+            for (int y = clip.y; y < clip.y + clip.h; y++)
+            {
+                const gfx::Color *row = srcRow(y - area.y) + (clip.x - area.x);
+                if (premultiplied) kernels.BlendRowPremultiplied(dstRow(y), row, clip.w);
+                else kernels.BlendRow(dstRow(y), row, clip.w);
+            }
+
+            return true;
+        }
+
+        // Centers of the destination pixels in the source rectangle, in 16.16 fixed-point
+        const Sint32 du = static_cast<Sint32>((static_cast<Sint64>(rectSrc.w) << 16) / rectDst.w);
+        const Sint32 dv = static_cast<Sint32>((static_cast<Sint64>(rectSrc.h) << 16) / rectDst.h);
+        const Sint32 uStart = du / 2 - 0x8000 + (clip.x - rectDst.x) * du;
+        const Sint32 vStart = dv / 2 - 0x8000 + (clip.y - rectDst.y) * dv;
+        const Sint32 uMax = (rectSrc.w - 1) << 16, vMax = (rectSrc.h - 1) << 16;
+
+        // The samples beyond the centers of the border pixels are clamped to them
+        const int head = uStart < 0 ? std::min(clip.w, (-uStart + du - 1) / du) : 0;
+        const Sint32 uBody = uStart + head * du;
+        const int body = uBody > uMax ? 0 : std::min(clip.w - head, (uMax - uBody) / du + 1);
+        const int tail = clip.w - head - body;
+
+        // Straight alpha is premultiplied before filtering when blending, the result then being premultiplied
+        const bool premultiply = blend && !premultiplied;
+        std::vector<gfx::Color> samples(clip.w);
+
+        for (int y = 0; y < clip.h; y++)
+        {
+            const Sint32 v = std::clamp(vStart + y * dv, 0, vMax);
+            const int y0 = v >> 16, fy = (v >> 8) & 0xFF;
+            const gfx::Color *row0 = srcRow(y0), *row1 = srcRow(std::min(y0 + 1, rectSrc.h - 1));
+
+            kernels.ScaleRowBilinear(samples.data(), row0, row1, rectSrc.w, 0, 0, fy, head, premultiply);
+            kernels.ScaleRowBilinear(samples.data() + head, row0, row1, rectSrc.w, uStart + head * du, du, fy, body, premultiply);
+            kernels.ScaleRowBilinear(samples.data() + head + body, row0, row1, rectSrc.w, uMax, 0, fy, tail, premultiply);
+
+            gfx::Color *out = dstRow(clip.y + y);
+
+            if (!blend) std::memcpy(static_cast<void*>(out), samples.data(), clip.w * sizeof(gfx::Color));
+            else kernels.BlendRowPremultiplied(out, samples.data(), clip.w);
+        }
+
+        return true;
+    }
+
+}
+
+/* Private Implementation Surface (Filling) */
+
+namespace {
+
+    void FillPolygon(const gfx::Surface& target, const math::Vec2* vertices, size_t count,
+                     const gfx::Color& color, gfx::FillRule rule, bool antiAliased)
+    {
+        _gfx_impl::ScanlineRasterizer rasterizer(target.GetWidth(), target.GetHeight());
+        rasterizer.AddPolygon(vertices, count);
+
+        // Whole spans are copied from this row, which is converted at once for 32-bit formats
+        const std::vector<gfx::Color> fill(target.GetWidth(), color);
+
+        if (!antiAliased)
+        {
+            rasterizer.Rasterize(rule, [&](int y, int x0, int x1)
+            {
+                target.SetPixelsUnsafe(x0, y, fill.data(), x1 - x0);
+            });
+
+            return;
+        }
+
+        std::vector<gfx::Color> edges(target.GetWidth());
+
+        rasterizer.RasterizeCoverage(rule, [&](int y, int x0, int x1, const float* coverage)
+        {
+            // Runs of fully covered pixels are filled like without anti-aliasing,
+            // the other pixels are blended using their coverage as alpha
+
+            int x = x0;
+
+            while (x < x1)
+            {
+                int end = x;
+                const bool full = coverage[x - x0] * 255.0f + 0.5f >= 255.0f;
+
+                if (full)
+                {
+                    while (end < x1 && coverage[end - x0] * 255.0f + 0.5f >= 255.0f) end++;
+                    target.SetPixelsUnsafe(x, y, fill.data(), end - x);
+                }
+                else
+                {
+                    for (; end < x1 && coverage[end - x0] * 255.0f + 0.5f < 255.0f; end++)
+                    {
+                        gfx::Color c = color;
+                        c.a = static_cast<Uint8>(color.a * coverage[end - x0] + 0.5f);
+                        edges[end - x] = c;
+                    }
+
+                    target.BlendPixelsUnsafe(x, y, edges.data(), end - x);
+                }
+
+                x = end;
+            }
+        });
+    }
+
+    void FillTriangle(const gfx::Surface& target, _gfx_impl::ScanlineRasterizer& rasterizer, std::vector<gfx::Color>& row,
+                      const shape2D::Vertex& v0, const shape2D::Vertex& v1, const shape2D::Vertex& v2, const gfx::Surface* image)
+    {
+        const math::Vec2 &p0 = v0.position, &p1 = v1.position, &p2 = v2.position;
+
+        // Check if vertices are in clockwise order or degenerate, in which case the triangle cannot be rendered
+        const float area = (p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y);
+        if (area >= 0.0f) return;
+
+        // The attributes are linear over the triangle, so they are obtained from their gradients
+        // at the start of each span, then incremented from a pixel to the next
+        const float invArea = 1.0f / area;
+
+        const math::Vec4 c0 = v0.color.Normalized();
+        const math::Vec4 dc1 = v1.color.Normalized() - c0, dc2 = v2.color.Normalized() - c0;
+        const math::Vec4 dcdx = (dc1 * (p2.y - p0.y) - dc2 * (p1.y - p0.y)) * invArea;
+        const math::Vec4 dcdy = (dc2 * (p1.x - p0.x) - dc1 * (p2.x - p0.x)) * invArea;
+
+        const math::Vec2 &t0 = v0.texcoord;
+        const math::Vec2 dt1 = v1.texcoord - t0, dt2 = v2.texcoord - t0;
+        const math::Vec2 dtdx = (dt1 * (p2.y - p0.y) - dt2 * (p1.y - p0.y)) * invArea;
+        const math::Vec2 dtdy = (dt2 * (p1.x - p0.x) - dt1 * (p2.x - p0.x)) * invArea;
+
+        rasterizer.Clear();
+        rasterizer.AddEdge(p0, p1);
+        rasterizer.AddEdge(p1, p2);
+        rasterizer.AddEdge(p2, p0);
+
+        rasterizer.Rasterize(gfx::FillRule::EvenOdd, [&](int y, int x0, int x1)
+        {
+            const float dx = x0 - p0.x, dy = y - p0.y;
+            math::Vec4 color = c0 + dcdx * dx + dcdy * dy;
+
+            if (!image)
+            {
+                for (int x = x0; x < x1; x++, color += dcdx)
+                {
+                    row[x - x0] = color;
+                }
+            }
+            else
+            {
+                math::Vec2 uv = t0 + dtdx * dx + dtdy * dy;
+
+                for (int x = x0; x < x1; x++, color += dcdx, uv += dtdx)
+                {
+                    gfx::Color out = image->GetFrag(uv);
+                    out *= static_cast<gfx::Color>(color);
+                    row[x - x0] = out;
+                }
+            }
+
+            target.BlendPixelsUnsafe(x0, y, row.data(), x1 - x0);
+        });
+    }
+
+}
+
+/* Private Implementation Surface (Generation) */
+
+namespace {
+
+    /**
+     * @brief Fills the pixels [x0, x1) x [y0, y1) row by row, `func(y, colors)` computing the colors of the row y.
+     *
+     * RGBA32 rows are written in place, the other formats go through a row buffer. Large areas are
+     * split into bands of rows, generated in parallel when a worker pool is set, so `func` must only depend on its arguments.
+     */
+    template <typename F>
+    void GenerateRows(const gfx::Surface& target, int x0, int y0, int x1, int y1, F&& func)
+    {
+        const int width = x1 - x0, height = y1 - y0;
+        if (width <= 0 || height <= 0) return;
+
+        const bool direct = target.GetPixelFormat() == gfx::PixelFormat::RGBA32;
+        Uint8 *pixels = static_cast<Uint8*>(target.GetPixels());
+        const int pitch = target.GetPitch();
+
+        // Bands of at least 16K pixels, so that small surfaces are not slowed down by the synchronization
+        constexpr int MinBandPixels = 16 * 1024;
+        const int rowsPerBand = std::max(1, MinBandPixels / width);
+        const int numBands = (height + rowsPerBand - 1) / rowsPerBand;
+
+        auto band = [&](size_t index)
+        {
+            std::vector<gfx::Color> buffer(direct ? 0 : width);
+
+            const int start = y0 + static_cast<int>(index) * rowsPerBand;
+            const int end = std::min(y1, start + rowsPerBand);
+
+            for (int y = start; y < end; y++)
+            {
+                if (direct)
+                {
+                    func(y, reinterpret_cast<gfx::Color*>(pixels + y * pitch) + x0);
+                }
+                else
+                {
+                    func(y, buffer.data());
+                    target.SetPixelsUnsafe(x0, y, buffer.data(), width);
+                }
+            }
+        };
+
+        utils::ThreadPool *pool = gfx::GetWorkerPool();
+
+        if (pool && numBands > 1)
+        {
+            pool->ParallelFor(numBands, band);
+        }
+        else
+        {
+            for (int i = 0; i < numBands; i++) band(i);
+        }
+    }
+
+}
+
+/* Private Implementation Surface (Decoding) */
+
+namespace {
+
+    Uint32 ReadBE16(const Uint8* p) { return (Uint32(p[0]) << 8) | p[1]; }
+    Uint32 ReadLE16(const Uint8* p) { return (Uint32(p[1]) << 8) | p[0]; }
+    Uint32 ReadBE32(const Uint8* p) { return (ReadBE16(p) << 16) | ReadBE16(p + 2); }
+    Uint32 ReadLE32(const Uint8* p) { return (ReadLE16(p + 2) << 16) | ReadLE16(p); }
+
+    bool ReadByte(SDL_RWops* rw, Uint8& byte)
+    {
+        return SDL_RWread(rw, &byte, 1, 1) == 1;
+    }
+
+    /**
+     * @brief Walks the markers of a JPEG stream, from the one following the SOI marker, up to the first frame header.
+     */
+    bool ReadJpegSize(SDL_RWops* rw, math::IVec2& size)
+    {
+        Uint8 byte = 0;
+
+        while (ReadByte(rw, byte))
+        {
+            if (byte != 0xFF) continue;
+
+            // Markers may be preceded by any number of fill bytes
+            Uint8 marker = 0xFF;
+            while (marker == 0xFF) if (!ReadByte(rw, marker)) return false;
+
+            if (marker == 0x00 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8)) continue;   // No segment
+            if (marker == 0xD9 || marker == 0xDA) return false;                                     // EOI or SOS before any frame
+
+            Uint8 segment[7];
+            if (SDL_RWread(rw, segment, 1, 2) != 2) return false;
+            const Uint32 length = ReadBE16(segment);
+            if (length < 2) return false;
+
+            // SOF0 to SOF15, except DHT, JPG and DAC which share their range
+            if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+            {
+                if (SDL_RWread(rw, segment + 2, 1, 5) != 5) return false;
+                size = { static_cast<int>(ReadBE16(segment + 5)), static_cast<int>(ReadBE16(segment + 3)) };
+                return true;
+            }
+
+            if (SDL_RWseek(rw, length - 2, RW_SEEK_CUR) < 0) return false;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Reads the width and height of a PNM header, which are ASCII numbers separated by whitespace or comments.
+     */
+    bool ReadPnmSize(SDL_RWops* rw, math::IVec2& size)
+    {
+        int values[2] = {};
+
+        for (int& value : values)
+        {
+            Uint8 byte = 0;
+            if (!ReadByte(rw, byte)) return false;
+
+            while (std::isspace(byte) || byte == '#')
+            {
+                if (byte == '#') while (byte != '\n') if (!ReadByte(rw, byte)) return false;
+                if (!ReadByte(rw, byte)) return false;
+            }
+
+            if (!std::isdigit(byte)) return false;
+
+            for (value = 0; std::isdigit(byte); )
+            {
+                value = value * 10 + (byte - '0');
+                if (value > (1 << 24) || !ReadByte(rw, byte)) break;
+            }
+        }
+
+        size = { values[0], values[1] };
+        return true;
+    }
+
+    /**
+     * @brief Reads the size of an image from its header, for the formats whose header gives it directly.
+     * @return False if the format is not recognized or the header is invalid, the stream being rewound in any case.
+     */
+    bool ReadImageSize(SDL_RWops* rw, math::IVec2& size)
+    {
+        const Sint64 origin = SDL_RWtell(rw);
+
+        Uint8 header[26] = {};
+        const size_t count = SDL_RWread(rw, header, 1, sizeof(header));
+
+        bool found = true;
+
+        if (count >= 24 && std::memcmp(header, "\x89PNG\r\n\x1A\n", 8) == 0 && std::memcmp(header + 12, "IHDR", 4) == 0)
+        {
+            size = { static_cast<int>(ReadBE32(header + 16)), static_cast<int>(ReadBE32(header + 20)) };
+        }
+        else if (count >= 10 && (std::memcmp(header, "GIF87a", 6) == 0 || std::memcmp(header, "GIF89a", 6) == 0))
+        {
+            size = { static_cast<int>(ReadLE16(header + 6)), static_cast<int>(ReadLE16(header + 8)) };
+        }
+        else if (count >= 26 && header[0] == 'B' && header[1] == 'M')
+        {
+            // The old OS/2 header has 16-bit dimensions, the height of the others is negative for top-down images
+            if (ReadLE32(header + 14) == 12) size = { static_cast<int>(ReadLE16(header + 18)), static_cast<int>(ReadLE16(header + 20)) };
+            else size = { static_cast<Sint32>(ReadLE32(header + 18)), std::abs(static_cast<Sint32>(ReadLE32(header + 22))) };
+        }
+        else if (count >= 12 && std::memcmp(header, "qoif", 4) == 0)
+        {
+            size = { static_cast<int>(ReadBE32(header + 4)), static_cast<int>(ReadBE32(header + 8)) };
+        }
+        else if (count >= 2 && header[0] == 0xFF && header[1] == 0xD8)
+        {
+            SDL_RWseek(rw, origin + 2, RW_SEEK_SET);
+            found = ReadJpegSize(rw, size);
+        }
+        else if (count >= 3 && header[0] == 'P' && header[1] >= '1' && header[1] <= '6')
+        {
+            SDL_RWseek(rw, origin + 2, RW_SEEK_SET);
+            found = ReadPnmSize(rw, size);
+        }
+        else
+        {
+            found = false;
+        }
+
+        SDL_RWseek(rw, origin, RW_SEEK_SET);
+
+        return found && size.x > 0 && size.y > 0;
+    }
+
+    math::IVec2 QueryImageSize(SDL_RWops* rw)
+    {
+        math::IVec2 size;
+
+        if (!ReadImageSize(rw, size))
+        {
+            // Unknown header, the image is decoded to get its size
+            SDL_Surface *image = IMG_Load_RW(rw, 0);
+
+            if (image == nullptr)
+            {
+                SDL_RWclose(rw);
+                throw core::NexusException("Surface", "The size of the image could not be read.",
+                    "SDL_image", IMG_GetError());
+            }
+
+            size = { image->w, image->h };
+            SDL_FreeSurface(image);
+        }
+
+        SDL_RWclose(rw);
+
+        return size;
+    }
+
+    math::IVec2 DecodeInto(SDL_RWops* rw, void* pixels, size_t capacity, int pitch)
+    {
+        SDL_Surface *image = IMG_Load_RW(rw, 1);
+
+        if (image == nullptr)
+        {
+            throw core::NexusException("Surface", "The image could not be decoded.",
+                "SDL_image", IMG_GetError());
+        }
+
+        const int w = image->w, h = image->h;
+        if (pitch == 0) pitch = 4 * w;
+
+        const char *error = nullptr;
+
+        if (pixels == nullptr || reinterpret_cast<uintptr_t>(pixels) % 4 != 0) error = "The pixel buffer must be aligned on 4 bytes.";
+        else if (pitch < 4 * w || pitch % 4 != 0) error = "The pitch of the pixel buffer must be a multiple of 4 of at least 4 times the image width.";
+        else if (static_cast<size_t>(pitch) * h > capacity) error = "The pixel buffer is too small for the image.";
+
+        if (error)
+        {
+            SDL_FreeSurface(image);
+            throw core::NexusException("Surface", error);
+        }
+
+        // The decoded image is converted straight into the buffer, with a plain copy if it is already RGBA32
+        SDL_Surface *target = SDL_CreateRGBSurfaceWithFormatFrom(pixels, w, h, 32, pitch, SDL_PIXELFORMAT_RGBA32);
+        int result = -1;
+
+        if (target != nullptr)
+        {
+            // The pixels matching a color key are skipped by the blit, they are left transparent
+            if (SDL_HasColorKey(image)) SDL_FillRect(target, nullptr, 0);
+
+            SDL_SetSurfaceBlendMode(image, SDL_BLENDMODE_NONE);
+            result = SDL_BlitSurface(image, nullptr, target, nullptr);
+            SDL_FreeSurface(target);
+        }
+
+        SDL_FreeSurface(image);
+
+        if (result < 0)
+        {
+            throw core::NexusException("Surface", "The image could not be converted into the pixel buffer.",
+                "SDL", SDL_GetError());
+        }
+
+        return { w, h };
+    }
+
+}
+
+/* Public Static Implementation Surface (Decoding) */
+
+math::IVec2 gfx::Surface::QueryImageSize(const std::string& filePath)
+{
+    SDL_RWops *rw = SDL_RWFromFile(filePath.c_str(), "rb");
+
+    if (rw == nullptr)
+    {
+        throw core::NexusException("Surface", "The image file could not be opened.",
+            "SDL", SDL_GetError());
+    }
+
+    return ::QueryImageSize(rw);
+}
+
+math::IVec2 gfx::Surface::QueryImageSize(const void* data, size_t size)
+{
+    SDL_RWops *rw = SDL_RWFromConstMem(data, static_cast<int>(size));
+
+    if (rw == nullptr)
+    {
+        throw core::NexusException("Surface", "The image data could not be read.",
+            "SDL", SDL_GetError());
+    }
+
+    return ::QueryImageSize(rw);
+}
+
+math::IVec2 gfx::Surface::DecodeInto(const std::string& filePath, void* pixels, size_t capacity, int pitch)
+{
+    SDL_RWops *rw = SDL_RWFromFile(filePath.c_str(), "rb");
+
+    if (rw == nullptr)
+    {
+        throw core::NexusException("Surface", "The image file could not be opened.",
+            "SDL", SDL_GetError());
+    }
+
+    return ::DecodeInto(rw, pixels, capacity, pitch);
+}
+
+math::IVec2 gfx::Surface::DecodeInto(const void* data, size_t size, void* pixels, size_t capacity, int pitch)
+{
+    SDL_RWops *rw = SDL_RWFromConstMem(data, static_cast<int>(size));
+
+    if (rw == nullptr)
+    {
+        throw core::NexusException("Surface", "The image data could not be read.",
+            "SDL", SDL_GetError());
+    }
+
+    return ::DecodeInto(rw, pixels, capacity, pitch);
+}
+
 /* Public Implementation Surface */
 
 void gfx::Surface::Create(int width, int height, PixelFormat format)
@@ -113,6 +719,30 @@ void gfx::Surface::Create(int width, int height, PixelFormat format)
     Destroy(); surface = temp;
 }
 
+void gfx::Surface::CreateFrom(int width, int height, void* pixels, int pitch, PixelFormat format)
+{
+    const int bytesPerPixel = SDL_BYTESPERPIXEL(static_cast<Uint32>(format));
+    const int alignment = (bytesPerPixel == 2 || bytesPerPixel == 4) ? bytesPerPixel : 1;
+
+    if (pixels == nullptr || width <= 0 || height <= 0 || pitch < width * bytesPerPixel
+        || reinterpret_cast<uintptr_t>(pixels) % alignment != 0 || pitch % alignment != 0)
+    {
+        throw core::NexusException("Surface", "The pixel buffer is not valid for the given size and format.");
+    }
+
+    SDL_Surface *temp = SDL_CreateRGBSurfaceWithFormatFrom(pixels, width, height,
+        PixelInfo::CalculateDepth(format), pitch, static_cast<Uint32>(format));
+
+    if (temp == nullptr)
+    {
+        throw core::NexusException(
+            "Surface", "Error creating the Surface over the pixel buffer.",
+            "SDL", SDL_GetError());
+    }
+
+    Destroy(); surface = temp;
+}
+
 void gfx::Surface::Load(const std::string& filePath)
 {
     SDL_Surface *temp = IMG_Load(filePath.c_str());
@@ -223,7 +853,14 @@ void gfx::Surface::LoadFromMemory(const void* data, size_t size, core::ImageForm
 
 gfx::Color gfx::Surface::GetPixelUnsafe(const void* pixelAddress) const
 {
-    return gfx::Color(*static_cast<const Uint32*>(pixelAddress), surface->format);
+    gfx::Color color;
+
+    const bool direct = gfx::VisitDirectPixelFormat(GetPixelFormat(), [&](auto format)
+    {
+        color = gfx::PixelAccess<decltype(format)::value>::Load(pixelAddress);
+    });
+
+    return direct ? color : gfx::Color(*static_cast<const Uint32*>(pixelAddress), surface->format);
 }
 
 gfx::Color gfx::Surface::GetPixelUnsafe(int byteOffset) const
@@ -247,6 +884,23 @@ gfx::Color gfx::Surface::GetFragUnsafe(const math::Vec2& uv) const
     return GetPixelUnsafe(static_cast<Uint8*>(surface->pixels) + y * surface->pitch + x * surface->format->BytesPerPixel);
 }
 
+void gfx::Surface::GetPixelsUnsafe(int x, int y, gfx::Color* colors, int count) const
+{
+    const Uint8 *row = static_cast<const Uint8*>(surface->pixels) + y * surface->pitch + x * surface->format->BytesPerPixel;
+
+    const bool direct = gfx::VisitDirectPixelFormat(GetPixelFormat(), [&](auto format)
+    {
+        gfx::LoadPixelSpan<decltype(format)::value>(colors, row, count);
+    });
+
+    if (direct) return;
+
+    for (int i = 0; i < count; i++)
+    {
+        colors[i] = GetPixelUnsafe(row + i * surface->format->BytesPerPixel);
+    }
+}
+
 gfx::Color gfx::Surface::GetPixel(const void* pixelAddress) const
 {
     if (surface && pixelAddress >= surface->pixels && pixelAddress < static_cast<const Uint8*>(surface->pixels) + surface->w * surface->h * surface->format->BytesPerPixel)
@@ -352,23 +1006,70 @@ gfx::Surface gfx::Surface::Crop(shape2D::Rectangle areaToKeep) const
     return newSurface;
 }
 
-gfx::Surface& gfx::Surface::Resize(int newWidth, int newHeight)
+gfx::Surface& gfx::Surface::Resize(int newWidth, int newHeight, ResizeFilter filter)
 {
     if (!surface) throw core::NexusException("gfx::Surface", "Surface is not created yet. Cannot resize.");
+    if (newWidth <= 0 || newHeight <= 0) throw core::NexusException("gfx::Surface", "The new size of the surface must be greater than zero.");
+    if (newWidth == surface->w && newHeight == surface->h) return *this;
 
-    SDL_Surface* newSurface = SDL_CreateRGBSurface(surface->flags, newWidth, newHeight, surface->format->BitsPerPixel, surface->format->Rmask, surface->format->Gmask, surface->format->Bmask, surface->format->Amask);
-    if (!newSurface) throw core::NexusException("gfx::Surface", "Error creating the resized surface.",
-        "SDL", SDL_GetError());
+    // The resampler works on RGBA32 colors, the other formats are converted back and forth
+    const PixelFormat format = GetPixelFormat();
+    const bool direct = format == PixelFormat::RGBA32;
+
+    Surface converted = direct ? Surface() : Clone(PixelFormat::RGBA32);
+    const Surface &source = direct ? *this : converted;
+
+    Surface resized(newWidth, newHeight, Blank, PixelFormat::RGBA32);
+
+    _gfx_impl::Resampler(surface->w, surface->h, newWidth, newHeight, filter).Resample(
+        static_cast<const Color*>(source.GetPixels()), source.GetPitch() / 4,
+        static_cast<Color*>(resized.GetPixels()), resized.GetPitch() / 4,
+        premultipliedAlpha, GetWorkerPool());
 
-    SDL_Rect sourceRect = { 0, 0, std::min(newWidth, surface->w), std::min(newHeight, surface->h) };
-    SDL_BlitSurface(surface, &sourceRect, newSurface, nullptr);
+    Surface result = direct ? std::move(resized) : resized.Clone(format);
 
     SDL_FreeSurface(surface);
-    surface = newSurface;
+    surface = std::exchange(result.surface, nullptr);
 
     return *this;
 }
 
+std::vector<gfx::Surface> gfx::Surface::GenerateMipChain(ResizeFilter filter) const
+{
+    if (!surface) throw core::NexusException("gfx::Surface", "Surface is not created yet. Cannot generate the mip chain.");
+
+    int levelCount = 0;
+    for (int w = surface->w, h = surface->h; w > 1 || h > 1; w = std::max(1, w / 2), h = std::max(1, h / 2))
+    {
+        levelCount++;
+    }
+
+    std::vector<Surface> levels;
+    levels.reserve(levelCount);
+
+    // Each level is reduced from the previous one, the first from an RGBA32 copy if needed
+    Surface converted = GetPixelFormat() == PixelFormat::RGBA32 ? Surface() : Clone(PixelFormat::RGBA32);
+    const Surface *previous = converted.surface ? &converted : this;
+
+    for (int i = 0; i < levelCount; i++)
+    {
+        const int pw = previous->GetWidth(), ph = previous->GetHeight();
+        const int w = std::max(1, pw / 2), h = std::max(1, ph / 2);
+
+        Surface &level = levels.emplace_back(w, h, Blank, PixelFormat::RGBA32);
+
+        _gfx_impl::Resampler(pw, ph, w, h, filter).Resample(
+            static_cast<const Color*>(previous->GetPixels()), previous->GetPitch() / 4,
+            static_cast<Color*>(level.GetPixels()), level.GetPitch() / 4,
+            premultipliedAlpha, GetWorkerPool());
+
+        level.premultipliedAlpha = premultipliedAlpha;
+        previous = &level;
+    }
+
+    return levels;
+}
+
 gfx::Surface& gfx::Surface::ResizeCanvas(int newWidth, int newHeight, int offsetX, int offsetY, const Color& background)
 {
     if (!surface) throw core::NexusException("gfx::Surface", "Surface is not created yet. Cannot resize.");
@@ -594,7 +1295,12 @@ void gfx::Surface::SaveImage(const std::string& filePath, core::ImageFormat form
 
 void gfx::Surface::SetPixelUnsafe(void* pixelAddress, const gfx::Color& color) const
 {
-    *static_cast<Uint32*>(pixelAddress) = color.ToUint32(surface->format);
+    const bool direct = gfx::VisitDirectPixelFormat(GetPixelFormat(), [&](auto format)
+    {
+        gfx::PixelAccess<decltype(format)::value>::Store(pixelAddress, color);
+    });
+
+    if (!direct) *static_cast<Uint32*>(pixelAddress) = color.ToUint32(surface->format);
 }
 
 void gfx::Surface::SetPixelUnsafe(int byteOffset, const gfx::Color& color) const
@@ -618,6 +1324,44 @@ void gfx::Surface::SetFragUnsafe(const math::Vec2 uv, const gfx::Color& color) c
     SetPixelUnsafe(static_cast<Uint8*>(surface->pixels) + y * surface->pitch + x * surface->format->BytesPerPixel, color);
 }
 
+void gfx::Surface::SetPixelsUnsafe(int x, int y, const gfx::Color* colors, int count) const
+{
+    Uint8 *row = static_cast<Uint8*>(surface->pixels) + y * surface->pitch + x * surface->format->BytesPerPixel;
+
+    const bool direct = gfx::VisitDirectPixelFormat(GetPixelFormat(), [&](auto format)
+    {
+        gfx::StorePixelSpan<decltype(format)::value>(row, colors, count);
+    });
+
+    if (direct) return;
+
+    for (int i = 0; i < count; i++)
+    {
+        SetPixelUnsafe(row + i * surface->format->BytesPerPixel, colors[i]);
+    }
+}
+
+void gfx::Surface::BlendPixelsUnsafe(int x, int y, const gfx::Color* colors, int count) const
+{
+    Uint8 *row = static_cast<Uint8*>(surface->pixels) + y * surface->pitch + x * surface->format->BytesPerPixel;
+
+    const bool direct = gfx::VisitDirectPixelFormat(GetPixelFormat(), [&](auto format)
+    {
+        gfx::BlendPixelSpan<decltype(format)::value>(row, colors, count);
+    });
+
+    if (direct) return;
+
+    for (int i = 0; i < count; i++)
+    {
+        const gfx::Color& color = colors[i];
+        if (color.a == 0) continue;
+
+        void *pixel = row + i * surface->format->BytesPerPixel;
+        SetPixelUnsafe(pixel, color.a == 255 ? color : gfx::BlendPixel(GetPixelUnsafe(pixel), color));
+    }
+}
+
 bool gfx::Surface::SetPixel(void* pixelAddress, const gfx::Color& color) const
 {
     if (surface && pixelAddress >= surface->pixels && pixelAddress < static_cast<const Uint8*>(surface->pixels) + surface->w * surface->h * surface->format->BytesPerPixel)
@@ -677,21 +1421,22 @@ const gfx::Surface& gfx::Surface::DrawGradientLinear(shape2D::Rectangle dst, flo
     direction = (90 - direction) * math::Deg2Rad;
     const float c = std::cos(direction);
     const float s = std::sin(direction);
+    const float length = dst.w * c + dst.h * s;
 
     const math::Vec4 nStart = start.Normalized();
     const math::Vec4 nEnd = end.Normalized();
 
-    for (int y = dst.y; y < dst.h; y++)
+    GenerateRows(*this, dst.x, dst.y, dst.w, dst.h, [&](int y, gfx::Color* row)
     {
+        const float ys = y * s;
+
         for (int x = dst.x; x < dst.w; x++)
         {
             // Calculate the relative position of the pixel along the gradient direction
-            float pos = (x * c + y * s) / (dst.w * c + dst.h * s);
-            float factor = std::clamp(pos, 0.0f, 1.0f);
-
-            SetPixelUnsafe(x, y, nEnd * factor + nStart * (1.0f - factor));
+            const float factor = std::clamp((x * c + ys) / length, 0.0f, 1.0f);
+            row[x - dst.x] = nEnd * factor + nStart * (1.0f - factor);
         }
-    }
+    });
 
     return *this;
 }
@@ -703,21 +1448,24 @@ const gfx::Surface& gfx::Surface::DrawGradientRadial(shape2D::Rectangle dst, flo
 
     math::IVec2 center(dst.w * 0.5f, dst.h * 0.5f);
     const float radius = std::min(center.x, center.y);
+    const float invRange = 1.0f / (radius * (1.0f - density));
 
     const math::Vec4 nInner = inner.Normalized();
     const math::Vec4 nOuter = outer.Normalized();
 
-    for (int y = dst.y; y < dst.h; y++)
+    GenerateRows(*this, dst.x, dst.y, dst.w, dst.h, [&](int y, gfx::Color* row)
     {
+        const float dy2 = static_cast<float>((y - center.y) * (y - center.y));
+
         for (int x = dst.x; x < dst.w; x++)
         {
-            float dist = std::hypotf(x - center.x, y - center.y);
-            float factor = (dist - radius * density) / (radius * (1.0f - density));
-            factor = std::clamp(factor, 0.0f, 1.0f);
+            const float dx = x - center.x;
+            const float dist = std::sqrt(dx * dx + dy2);
+            const float factor = std::clamp((dist - radius * density) * invRange, 0.0f, 1.0f);
 
-            SetPixelUnsafe(x, y, nOuter * factor + nInner * (1.0f - factor));
+            row[x - dst.x] = nOuter * factor + nInner * (1.0f - factor);
         }
-    }
+    });
 
     return *this;
 }
@@ -727,33 +1475,30 @@ const gfx::Surface& gfx::Surface::DrawGradientSquare(shape2D::Rectangle dst, flo
     dst.SetPosition(dst.GetPosition().Clamp({ 0, 0 }, GetSize()));
     dst.SetSize(dst.GetSize().Clamp({ 0, 0 }, GetSize()));
 
-    math::IVec2 center(dst.w * 0.5f, dst.h * 0.5f);
+    const math::IVec2 center(dst.w * 0.5f, dst.h * 0.5f);
+    const math::Vec2 size(center);
 
     const math::Vec4 nInner = inner.Normalized();
     const math::Vec4 nOuter = outer.Normalized();
 
-    for (int y = dst.y; y < dst.h; y++)
+    GenerateRows(*this, dst.x, dst.y, dst.w, dst.h, [&](int y, gfx::Color* row)
     {
+        // Normalize the distances to the center by the dimensions of the gradient rectangle
+        const float distY = std::abs(y - center.y) / size.y;
+
         for (int x = dst.x; x < dst.w; x++)
         {
-            // Calculate the Manhattan distance from the center
-            math::Vec2 dist = (math::Vec2(x, y) - center).Abs();
-
-            // Normalize the distances by the dimensions of the gradient rectangle
-            math::Vec2 normalizedDist = dist / center;
-
-            // Calculate the total normalized Manhattan distance
-            float manhattanDist = std::max(normalizedDist.x, normalizedDist.y);
+            // Use the largest of both distances, which gives the square shape
+            const float dist = std::max(std::abs(x - center.x) / size.x, distY);
 
-            // Subtract the density from the manhattanDist, then divide by (1 - density)
+            // Subtract the density from the distance, then divide by (1 - density)
             // This makes the gradient start from the center when density is 0, and from the edge when density is 1
-            float factor = (manhattanDist - density) / (1.0f - density);
-            factor = std::clamp(factor, 0.0f, 1.0f);
+            const float factor = std::clamp((dist - density) / (1.0f - density), 0.0f, 1.0f);
 
             // Blend the colors based on the calculated factor
-            SetPixelUnsafe(x, y, nOuter * factor + nInner * (1.0f - factor));
+            row[x - dst.x] = nOuter * factor + nInner * (1.0f - factor);
         }
-    }
+    });
 
     return *this;
 }
@@ -763,96 +1508,101 @@ const gfx::Surface& gfx::Surface::DrawChecked(shape2D::Rectangle dst, int checks
     dst.SetPosition(dst.GetPosition().Clamp({ 0, 0 }, GetSize()));
     dst.SetSize(dst.GetSize().Clamp({ 0, 0 }, GetSize()));
 
-    int i = 0;
-    for (int y = dst.y; y < dst.h; y += checksY)
+    if (checksX <= 0 || checksY <= 0) return *this;
+
+    GenerateRows(*this, dst.x, dst.y, dst.w, dst.h, [&](int y, gfx::Color* row)
     {
-        for (int x = dst.x; x < dst.w; x += checksX)
+        // The color of the first check alternates from a row of checks to the next
+        bool odd = ((y - dst.y) / checksY) & 1;
+
+        for (int x = dst.x; x < dst.w; x += checksX, odd = !odd)
         {
-            DrawRectangle(x, y, checksX, checksY, i++ % 2 ? col1 : col2);
+            const int end = std::min(x + checksX, dst.w);
+            std::fill(row + (x - dst.x), row + (end - dst.x), odd ? col1 : col2);
         }
-        i++;
-    }
+    });
 
     return *this;
 }
 
-const gfx::Surface& gfx::Surface::DrawWhiteNoise(shape2D::Rectangle dst, float factor) const
+const gfx::Surface& gfx::Surface::DrawWhiteNoise(shape2D::Rectangle dst, float factor, unsigned long seed) const
 {
     dst.SetPosition(dst.GetPosition().Clamp({ 0, 0 }, GetSize()));
     dst.SetSize(dst.GetSize().Clamp({ 0, 0 }, GetSize()));
 
-    core::RandomGenerator gen;
+    // Each pixel gets the value of its position, so the noise does not depend on the order of generation
+    const core::CounterRandomGenerator gen(seed);
 
-    for (int y = dst.y; y < dst.h; y++)
+    GenerateRows(*this, dst.x, dst.y, dst.w, dst.h, [&](int y, gfx::Color* row)
     {
         for (int x = dst.x; x < dst.w; x++)
         {
-            SetPixelUnsafe(x, y, gen.Random(0.0f, 1.0f) < factor ? gfx::White : gfx::Black);
+            const Uint64 counter = (static_cast<Uint64>(y) << 32) | static_cast<Uint32>(x);
+            row[x - dst.x] = gen.GetFloat(counter) < factor ? gfx::White : gfx::Black;
         }
-    }
+    });
 
     return *this;
 }
 
-const gfx::Surface& gfx::Surface::DrawCellular(shape2D::Rectangle dst, int tileSize) const
+const gfx::Surface& gfx::Surface::DrawCellular(shape2D::Rectangle dst, int tileSize, unsigned long seed) const
 {
     dst.SetPosition(dst.GetPosition().Clamp({ 0, 0 }, GetSize()));
     dst.SetSize(dst.GetSize().Clamp({ 0, 0 }, GetSize()));
 
-    core::RandomGenerator gen;
+    if (tileSize <= 0) return *this;
 
-    int seedsPerRow = dst.w / tileSize;
-    int seedsPerCol = dst.h / tileSize;
-    int seedCount = seedsPerRow * seedsPerCol;
+    const core::CounterRandomGenerator gen(seed);
 
-    math::Vec2 *seeds = new math::Vec2[seedCount];
+    const int seedsPerRow = dst.w / tileSize;
+    const int seedsPerCol = dst.h / tileSize;
 
-    for (int i = 0; i < seedCount; i++)
+    // The seed of each tile only depends on the tile position
+    std::vector<math::Vec2> seeds(seedsPerRow * seedsPerCol);
+
+    for (int tileY = 0; tileY < seedsPerCol; tileY++)
     {
-        int y = (i / seedsPerRow) * tileSize + gen.Random(0, tileSize - 1);
-        int x = (i % seedsPerRow) * tileSize + gen.Random(0, tileSize - 1);
-        seeds[i] = math::Vec2(x, y);
+        for (int tileX = 0; tileX < seedsPerRow; tileX++)
+        {
+            const Uint64 counter = 2 * ((static_cast<Uint64>(tileY) << 32) | static_cast<Uint32>(tileX));
+            const int x = tileX * tileSize + gen.GetInt(counter, 0, tileSize - 1);
+            const int y = tileY * tileSize + gen.GetInt(counter + 1, 0, tileSize - 1);
+            seeds[tileY * seedsPerRow + tileX] = math::Vec2(x, y);
+        }
     }
 
-    for (int y = dst.y; y < dst.h; y++)
+    const float scale = 256.0f / tileSize;
+
+    GenerateRows(*this, dst.x, dst.y, dst.w, dst.h, [&](int y, gfx::Color* row)
     {
-        int tileY = y / tileSize;
+        const int tileY = y / tileSize;
+
+        // Neighbor rows of tiles
+        const int jMin = std::max(tileY - 1, 0), jMax = std::min(tileY + 1, seedsPerCol - 1);
 
         for (int x = dst.x; x < dst.w; x++)
         {
-            int tileX = x / tileSize;
+            const int tileX = x / tileSize;
+            const int iMin = std::max(tileX - 1, 0), iMax = std::min(tileX + 1, seedsPerRow - 1);
 
-            float minDistance = 65536.0f; //(float)strtod("Inf", NULL);
+            float minDistance2 = 65536.0f * 65536.0f;
 
-            // Check all adjacent tiles
-            for (int i = -1; i < 2; i++)
+            // Check all adjacent tiles, comparing the squared distances
+            for (int j = jMin; j <= jMax; j++)
             {
-                if (tileX + i < 0 || tileX + i >= seedsPerRow)
+                for (int i = iMin; i <= iMax; i++)
                 {
-                    continue;
-                }
-
-                for (int j = -1; j < 2; j++)
-                {
-                    if (tileY + j < 0 || tileY + j >= seedsPerCol)
-                    {
-                        continue;
-                    }
-
-                    const math::Vec2 &neighborSeed = seeds[(tileY + j) * seedsPerRow + tileX + i];
-
-                    float dist = std::hypotf(x - neighborSeed.x, y - neighborSeed.y);
-                    minDistance = std::min(minDistance, dist);
+                    const math::Vec2 &neighborSeed = seeds[j * seedsPerRow + i];
+                    const float dx = x - neighborSeed.x, dy = y - neighborSeed.y;
+                    minDistance2 = std::min(minDistance2, dx * dx + dy * dy);
                 }
             }
 
             // I made this up, but it seems to give good results at all tile sizes
-            Uint8 intensity = std::min(minDistance * 256.0f / tileSize, 255.0f);
-            SetPixelUnsafe(x, y, { intensity, intensity, intensity, 255 });
+            const Uint8 intensity = std::min(std::sqrt(minDistance2) * scale, 255.0f);
+            row[x - dst.x] = { intensity, intensity, intensity, 255 };
         }
-    }
-
-    delete[] seeds;
+    });
 
     return *this;
 }
@@ -1041,24 +1791,11 @@ const gfx::Surface& gfx::Surface::DrawCircleLines(const shape2D::Circle& circle,
     return DrawCircleLines(std::round(circle.center.x), std::round(circle.center.y), std::round(circle.radius), color);
 }
 
-const gfx::Surface& gfx::Surface::DrawPolygon(const shape2D::Polygon& poly, const gfx::Color& color) const
+const gfx::Surface& gfx::Surface::DrawPolygon(const shape2D::Polygon& poly, const gfx::Color& color, FillRule rule, bool antiAliased) const
 {
-    shape2D::AABB bounds = poly.GetAABB();
-
-    bounds.min = bounds.min.Clamp({ 0, 0 }, GetSize());
-    bounds.max = bounds.max.Clamp({ 0, 0 }, GetSize());
-
-    if (bounds.min == bounds.max) return *this;
-
-    for (int y = bounds.min.y; y < bounds.max.y; y++)
+    if (poly.vertices.size() >= 3)
     {
-        for (int x = bounds.min.x; x < bounds.max.x; x++)
-        {
-            if (poly.CollisionPoint(math::IVec2{ x, y }))
-            {
-                SetPixelUnsafe(x, y, color);
-            }
-        }
+        FillPolygon(*this, poly.vertices.data(), poly.vertices.size(), color, rule, antiAliased);
     }
 
     return *this;
@@ -1081,22 +1818,8 @@ const gfx::Surface& gfx::Surface::DrawTriangle(const math::Vec2& v0, const math:
 
 const gfx::Surface& gfx::Surface::DrawTriangle(const shape2D::Triangle& tri, const gfx::Color& color) const
 {
-    shape2D::AABB aabb = tri.GetAABB();
-    aabb.min.Clamp({ 0, 0 }, GetSize());
-    aabb.max.Clamp({ 0, 0 }, GetSize());
-
-    if (aabb.min == aabb.max) return *this;
-
-    for (int y = aabb.min.y; y < aabb.max.y; y++)
-    {
-        for (int x = aabb.min.x; x < aabb.max.x; x++)
-        {
-            if (tri.CollisionPoint(math::Vec2(x, y)))
-            {
-                SetPixelUnsafe(x, y, color);
-            }
-        }
-    }
+    const math::Vec2 vertices[3] = { tri.a, tri.b, tri.c };
+    FillPolygon(*this, vertices, 3, color, FillRule::EvenOdd, false);
 
     return *this;
 }
@@ -1117,158 +1840,20 @@ const gfx::Surface& gfx::Surface::DrawTriangleLines(const shape2D::Triangle& tri
 
 const gfx::Surface& gfx::Surface::DrawTriangleColors(const shape2D::Vertex& v0, const shape2D::Vertex& v1, const shape2D::Vertex& v2) const
 {
-    // Get integer 2D position coordinates
-    const math::IVec2 iV0(v0.position.x, v0.position.y);
-    const math::IVec2 iV1(v1.position.x, v1.position.y);
-    const math::IVec2 iV2(v2.position.x, v2.position.y);
-
-    // Check if vertices are in clockwise order or degenerate, in which case the triangle cannot be rendered
-    if ((iV1.x - iV0.x) * (iV2.y - iV0.y) - (iV2.x - iV0.x) * (iV1.y - iV0.y) >= 0.0f) return *this;
-
-    // Calculate the 2D bounding box of the triangle clamped to the surface dimensions
-    const math::Vector2<Uint16> min = iV0.Min(iV1.Min(iV2)).Clamp(
-        { 0, 0 }, { surface->w - 1, surface->h -1 });
-
-    const math::Vector2<Uint16> max = iV0.Max(iV1.Max(iV2)).Clamp(
-        { 0, 0 }, { surface->w - 1, surface->h -1 });
-
-    // If triangle is entirely outside the surface we can stop now
-    if (min == max) return *this;
-
-    // Calculate original edge weights relative to bounds.min
-    // Will be used to obtain barycentric coordinates by incrementing then averaging them
-    int w0Row = (min.x - iV1.x) * (iV2.y - iV1.y) - (iV2.x - iV1.x) * (min.y - iV1.y);
-    int w1Row = (min.x - iV2.x) * (iV0.y - iV2.y) - (iV0.x - iV2.x) * (min.y - iV2.y);
-    int w2Row = (min.x - iV0.x) * (iV1.y - iV0.y) - (iV1.x - iV0.x) * (min.y - iV0.y);
-
-    // Calculate weight increment steps for each edge
-    const math::IVec2 sW0(iV2.y - iV1.y, iV1.x - iV2.x);
-    const math::IVec2 sW1(iV0.y - iV2.y, iV2.x - iV0.x);
-    const math::IVec2 sW2(iV1.y - iV0.y, iV0.x - iV1.x);
-
-    // Normalize colors for barycentric interpolation
-    const math::Vec4 nColV0 = v0.color.Normalized();
-    const math::Vec4 nColV1 = v1.color.Normalized();
-    const math::Vec4 nColV2 = v2.color.Normalized();
-
-    // Fill the triangle with vertex colors
-    for (Uint16 y = min.y; y <= max.y; y++)
-    {
-        const Uint32 yOffset = y * this->GetPitch();
-        int w0 = w0Row, w1 = w1Row, w2 = w2Row;
-
-        for (Uint16 x = min.x; x <= max.x; x++)
-        {
-            if ((w0 | w1 | w2) >= 0)
-            {
-                const Uint32 byteOffset = yOffset + x * this->GetBytesPerPixel();
-
-                const float invSum = 1.0f / (w0 + w1 + w2);
-                const float aW0 = w0 * invSum, aW1 = w1 * invSum, aW2 = w2 * invSum;
-
-                gfx::Color out = nColV0 * aW0 + nColV1 * aW1 + nColV2 * aW2;
-
-                if (out.a && out.a != 255)
-                {
-                    const gfx::Color dst = this->GetPixelUnsafe(byteOffset);
-                    const Uint16 alpha = static_cast<Uint16>(out.a) + 1;
-                    const Uint16 invAlpha = 256 - alpha;
-
-                    out.a = static_cast<Uint8>((alpha * 256 + dst.a * invAlpha) >> 8);
-                    out.r = static_cast<Uint8>((out.r * alpha + dst.r * invAlpha) >> 8);
-                    out.g = static_cast<Uint8>((out.g * alpha + dst.g * invAlpha) >> 8);
-                    out.b = static_cast<Uint8>((out.b * alpha + dst.b * invAlpha) >> 8);
-                }
-
-                if (out.a)
-                {
-                    this->SetPixelUnsafe(byteOffset, out);
-                }
-            }
+    _gfx_impl::ScanlineRasterizer rasterizer(surface->w, surface->h);
+    std::vector<Color> row(surface->w);
 
-            w0 += sW0.x, w1 += sW1.x, w2 += sW2.x;
-        }
-
-        w0Row += sW0.y, w1Row += sW1.y, w2Row += sW2.y;
-    }
+    FillTriangle(*this, rasterizer, row, v0, v1, v2, nullptr);
 
     return *this;
 }
 
 const gfx::Surface& gfx::Surface::DrawTriangleImage(const shape2D::Vertex& v0, const shape2D::Vertex& v1, const shape2D::Vertex& v2, const gfx::Surface& image) const
 {
-    // Get integer 2D position coordinates
-    const math::Vector2<int> iV0(v0.position.x, v0.position.y);
-    const math::Vector2<int> iV1(v1.position.x, v1.position.y);
-    const math::Vector2<int> iV2(v2.position.x, v2.position.y);
-
-    // Check if vertices are in clockwise order or degenerate, in which case the triangle cannot be rendered
-    if ((iV1.x - iV0.x) * (iV2.y - iV0.y) - (iV2.x - iV0.x) * (iV1.y - iV0.y) >= 0.0f) return *this;
-
-    // Calculate the 2D bounding box of the triangle clamped to the surface dimensions
-    const math::Vector2<Uint16> min = iV0.Min(iV1.Min(iV2)).Clamp(
-        { 0, 0 }, math::Vector2<Uint16>(surface->w - 1, surface->h -1));
-
-    const math::Vector2<Uint16> max = iV0.Max(iV1.Max(iV2)).Clamp(
-        { 0, 0 }, math::Vector2<Uint16>(surface->w - 1, surface->h -1));
-
-    // Calculate original edge weights relative to bounds.min
-    // Will be used to obtain barycentric coordinates by incrementing then averaging them
-    int w0Row = (min.x - iV1.x) * (iV2.y - iV1.y) - (iV2.x - iV1.x) * (min.y - iV1.y);
-    int w1Row = (min.x - iV2.x) * (iV0.y - iV2.y) - (iV0.x - iV2.x) * (min.y - iV2.y);
-    int w2Row = (min.x - iV0.x) * (iV1.y - iV0.y) - (iV1.x - iV0.x) * (min.y - iV0.y);
-
-    // Calculate weight increment steps for each edge
-    const math::IVec2 sW0(iV2.y - iV1.y, iV1.x - iV2.x);
-    const math::IVec2 sW1(iV0.y - iV2.y, iV2.x - iV0.x);
-    const math::IVec2 sW2(iV1.y - iV0.y, iV0.x - iV1.x);
-
-    // Normalize colors for barycentric interpolation
-    const math::Vec4 nColV0 = v0.color.Normalized();
-    const math::Vec4 nColV1 = v1.color.Normalized();
-    const math::Vec4 nColV2 = v2.color.Normalized();
-
-    // Fill the triangle with the image based on the provided parameters
-    for (Uint16 y = min.y; y <= max.y; y++)
-    {
-        const Uint32 yOffset = y * this->GetPitch();
-        int w0 = w0Row, w1 = w1Row, w2 = w2Row;
-
-        for (Uint16 x = min.x; x <= max.x; x++)
-        {
-            if ((w0 | w1 | w2) >= 0)
-            {
-                const Uint32 byteOffset = yOffset + x * this->GetBytesPerPixel();
-
-                const float invSum = 1.0f / (w0 + w1 + w2);
-                const float aW0 = w0 * invSum, aW1 = w1 * invSum, aW2 = w2 * invSum;
-
-                gfx::Color out = image.GetFrag(v0.texcoord * aW0 + v1.texcoord * aW1 + v2.texcoord * aW2);
-                out *= static_cast<gfx::Color>(nColV0 * aW0 + nColV1 * aW1 + nColV2 * aW2);
-
-                if (out.a && out.a != 255)
-                {
-                    const gfx::Color dst = this->GetPixelUnsafe(byteOffset);
-                    const Uint16 alpha = static_cast<Uint16>(out.a) + 1;
-                    const Uint16 invAlpha = 256 - alpha;
-
-                    out.a = static_cast<Uint8>((alpha * 256 + dst.a * invAlpha) >> 8);
-                    out.r = static_cast<Uint8>((out.r * alpha + dst.r * invAlpha) >> 8);
-                    out.g = static_cast<Uint8>((out.g * alpha + dst.g * invAlpha) >> 8);
-                    out.b = static_cast<Uint8>((out.b * alpha + dst.b * invAlpha) >> 8);
-                }
-
-                if (out.a)
-                {
-                    this->SetPixelUnsafe(byteOffset, out);
-                }
-            }
-
-            w0 += sW0.x, w1 += sW1.x, w2 += sW2.x;
-        }
+    _gfx_impl::ScanlineRasterizer rasterizer(surface->w, surface->h);
+    std::vector<Color> row(surface->w);
 
-        w0Row += sW0.y, w1Row += sW1.y, w2Row += sW2.y;
-    }
+    FillTriangle(*this, rasterizer, row, v0, v1, v2, &image);
 
     return *this;
 }
@@ -1291,19 +1876,13 @@ const gfx::Surface& gfx::Surface::DrawQuadImage(const shape2D::Vertex& v0, const
 
 const gfx::Surface& gfx::Surface::DrawMesh(const shape2D::Mesh& mesh, const gfx::Surface* image) const
 {
-    if (!image)
-    {
-        for (int i = 0; i < mesh.vertices.size(); i += 3)
-        {
-            DrawTriangleColors(mesh.vertices[i], mesh.vertices[i + 1], mesh.vertices[i + 2]);
-        }
-    }
-    else
+    // The rasterizer and the row are shared by all the triangles of the mesh
+    _gfx_impl::ScanlineRasterizer rasterizer(surface->w, surface->h);
+    std::vector<Color> row(surface->w);
+
+    for (size_t i = 0; i + 2 < mesh.vertices.size(); i += 3)
     {
-        for (int i = 0; i < mesh.vertices.size(); i += 3)
-        {
-            DrawTriangleImage(mesh.vertices[i], mesh.vertices[i + 1], mesh.vertices[i + 2], *image);
-        }
+        FillTriangle(*this, rasterizer, row, mesh.vertices[i], mesh.vertices[i + 1], mesh.vertices[i + 2], image);
     }
 
     return *this;
@@ -1313,6 +1892,11 @@ gfx::Surface& gfx::Surface::DrawImage(const Surface& other, int x, int y, int ox
 {
     shape2D::Rectangle rectDst(x - ox, y - oy, other.GetWidth(), other.GetHeight());
 
+    if (BlitRGBA32(other.surface, other.GetRectSize(), surface, rectDst, other.premultipliedAlpha, other.bilinearScaling))
+    {
+        return *this;
+    }
+
     const bool lockedBefore = IsLocked();
     if (lockedBefore) Unlock();
 
@@ -1339,6 +1923,11 @@ gfx::Surface& gfx::Surface::DrawImageScaled(const Surface& other, float x, float
         std::round(x - ox * sx), std::round(y - oy * sy),
         std::round(other.GetWidth() * sx), std::round(other.GetHeight() * sy));
 
+    if (BlitRGBA32(other.surface, other.GetRectSize(), surface, rectDst, other.premultipliedAlpha, other.bilinearScaling))
+    {
+        return *this;
+    }
+
     const bool lockedBefore = IsLocked();
     if (lockedBefore) Unlock();
 
@@ -1361,6 +1950,11 @@ gfx::Surface& gfx::Surface::DrawImageScaled(const Surface& other, const math::Ve
 
 gfx::Surface& gfx::Surface::DrawImage(const Surface& other, const shape2D::Rectangle& rectSrc, shape2D::Rectangle rectDst)
 {
+    if (BlitRGBA32(other.surface, rectSrc, surface, rectDst, other.premultipliedAlpha, other.bilinearScaling))
+    {
+        return *this;
+    }
+
     const bool lockedBefore = IsLocked();
     if (lockedBefore) Unlock();
 